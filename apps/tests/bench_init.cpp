@@ -0,0 +1,117 @@
+#include <sirius.hpp>
+
+using namespace sirius;
+
+/* timers of the initialization stages; the list follows the order in which the stages are executed */
+static std::vector<std::string> const init_stages = {
+    "sirius::Simulation_context::init_comm",
+    "sirius::Unit_cell::initialize",
+    "sirius::Simulation_context::initialize|lat_sym",
+    "sirius::Simulation_context::init_fft_grid",
+    "sirius::Simulation_context::initialize|eigen_solver",
+    "sirius::Simulation_context::update",
+    "sirius::Unit_cell::update",
+    "sirius::Unit_cell::find_closest_neighbours",
+    "sirius::Unit_cell::find_nearest_neighbours",
+    "sirius::Unit_cell::get_symmetry",
+    "sirius::Simulation_context::update|gvec_coarse",
+    "sirius::Simulation_context::update|gvec",
+    "sirius::Simulation_context::update|gvec_shells",
+    "sirius::Simulation_context::update|check_gvec",
+    "sirius::Simulation_context::update|check_fft_grid",
+    "sirius::Simulation_context::init_atoms_to_grid_idx",
+    "sirius::Simulation_context::update|phase_factors",
+    "sirius::Simulation_context::update|radial_integrals",
+    "sirius::Simulation_context::update|augmentation_operator",
+    "sirius::Simulation_context::init_step_function",
+    "sirius::Simulation_context::initialize|print_info"};
+
+/* run the initialization of the simulation context several times and report the timings of each stage */
+void bench_init(cmd_args const& args__)
+{
+    auto fname  = args__.value<std::string>("input", "sirius.json");
+    auto repeat = args__.value<int>("repeat", 3);
+    auto out    = args__.value<std::string>("output", "bench_init.json");
+
+    std::vector<double> t_ctor;
+    std::vector<double> t_init;
+    int num_atoms{0};
+    int num_gvec{0};
+
+    for (int i = 0; i < repeat; i++) {
+        double t0 = -utils::wtime();
+        Simulation_context ctx(fname, mpi::Communicator::world());
+        t0 += utils::wtime();
+
+        double t1 = -utils::wtime();
+        ctx.initialize();
+        t1 += utils::wtime();
+
+        t_ctor.push_back(t0);
+        t_init.push_back(t1);
+        num_atoms = ctx.unit_cell().num_atoms();
+        num_gvec  = ctx.gvec().num_gvec();
+    }
+
+    if (mpi::Communicator::world().rank() != 0) {
+        return;
+    }
+
+    auto stat = [](std::vector<double> const& t) {
+        nlohmann::json dict;
+        dict["count"] = t.size();
+        if (t.size()) {
+            dict["total"] = std::accumulate(t.begin(), t.end(), 0.0);
+            dict["mean"]  = std::accumulate(t.begin(), t.end(), 0.0) / t.size();
+            dict["min"]   = *std::min_element(t.begin(), t.end());
+            dict["max"]   = *std::max_element(t.begin(), t.end());
+        }
+        return dict;
+    };
+
+    nlohmann::json dict;
+    dict["input"]         = fname;
+    dict["repeat"]        = repeat;
+    dict["num_atoms"]     = num_atoms;
+    dict["num_gvec"]      = num_gvec;
+    dict["num_ranks"]     = mpi::Communicator::world().size();
+    dict["num_threads"]   = omp_get_max_threads();
+    dict["constructor"]   = stat(t_ctor);
+    dict["initialize"]    = stat(t_init);
+
+    /* timings of the individual stages are available only if the code is compiled with the profiler */
+    auto timing_result = ::utils::global_rtgraph_timer.process();
+    std::printf("%-60s %12s %12s\n", "stage", "mean (sec.)", "fraction");
+    std::cout << utils::hbar(86, '-') << std::endl;
+    for (auto const& e : init_stages) {
+        auto t = timing_result.get_timings(e);
+        if (t.size()) {
+            dict["stages"][e] = stat(t);
+            double mean  = dict["stages"][e]["mean"].get<double>();
+            double total = dict["initialize"]["mean"].get<double>();
+            std::printf("%-60s %12.6f %11.2f%%\n", e.c_str(), mean, 100 * mean / total);
+        }
+    }
+    std::printf("%-60s %12.6f\n", "total", dict["initialize"]["mean"].get<double>());
+    dict["timers"] = nlohmann::json::parse(timing_result.json());
+
+    std::ofstream ofs(out, std::ofstream::out | std::ofstream::trunc);
+    ofs << dict.dump(4);
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args(argn, argv, {{"input=",  "{string} input file name"},
+                               {"repeat=", "{int} number of repetitions"},
+                               {"output=", "{string} name of the JSON report"}});
+
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+
+    sirius::initialize(1);
+    bench_init(args);
+    sirius::finalize();
+}
@@ -0,0 +1,118 @@
+#include <sirius.hpp>
+#include <testing.hpp>
+
+using namespace sirius;
+
+/* band solver and valence density generation with the given number of concurrent k-point teams */
+std::tuple<double, double, std::vector<double>>
+run_kp_teams(cmd_args const& args__, int num_teams__)
+{
+    auto pw_cutoff = args__.value<double>("pw_cutoff", 20);
+    auto gk_cutoff = args__.value<double>("gk_cutoff", 7);
+    auto N         = args__.value<int>("N", 1);
+    auto ngridk    = args__.value("ngridk", std::vector<int>({4, 4, 4}));
+    auto num_bands = args__.value<int>("num_bands", 20);
+
+    auto json_conf = R"({
+      "parameters" : {
+        "electronic_structure_method" : "pseudopotential",
+        "use_symmetry" : false,
+        "xc_functionals" : ["XC_LDA_X", "XC_LDA_C_PZ"]
+      },
+      "iterative_solver" : {
+        "type" : "davidson"
+      }
+    })"_json;
+    json_conf["parameters"]["pw_cutoff"]        = pw_cutoff;
+    json_conf["parameters"]["gk_cutoff"]        = gk_cutoff;
+    json_conf["parameters"]["num_bands"]        = num_bands;
+    json_conf["control"]["num_kpoint_teams"]    = num_teams__;
+
+    std::vector<r3::vector<double>> coord;
+    double p = 1.0 / N;
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < N; j++) {
+            for (int k = 0; k < N; k++) {
+                coord.push_back(r3::vector<double>(i * p, j * p, k * p));
+            }
+        }
+    }
+
+    auto ctx_ptr = create_simulation_context(json_conf, {{5.0 * N, 0, 0}, {0, 5.0 * N, 0}, {0, 0, 5.0 * N}},
+            N * N * N, coord, true, true);
+    auto& ctx = *ctx_ptr;
+
+    K_point_set kset(ctx, r3::vector<int>(ngridk[0], ngridk[1], ngridk[2]), r3::vector<int>(0, 0, 0), false);
+
+    Density rho(ctx);
+    Potential pot(ctx);
+    rho.initial_density();
+    pot.generate(rho, ctx.use_symmetry(), true);
+
+    Hamiltonian0<double> H0(pot, false);
+    Band band(ctx);
+    band.initialize_subspace(kset, H0);
+
+    double t_solve = -utils::wtime();
+    band.solve<double, double>(kset, H0, 1e-6);
+    t_solve += utils::wtime();
+
+    kset.find_band_occupancies<double>();
+
+    double t_rho = -utils::wtime();
+    rho.generate<double>(kset, false, false, true);
+    t_rho += utils::wtime();
+
+    std::vector<double> eval;
+    for (int ik = 0; ik < kset.num_kpoints(); ik++) {
+        for (int j = 0; j < ctx.num_bands(); j++) {
+            eval.push_back(kset.get<double>(ik)->band_energy(j, 0));
+        }
+    }
+    return std::make_tuple(t_solve, t_rho, eval);
+}
+
+void bench_kp_teams(cmd_args const& args__)
+{
+    auto num_teams = args__.value<int>("num_teams", 4);
+
+    auto r0 = run_kp_teams(args__, 1);
+    auto r1 = run_kp_teams(args__, num_teams);
+
+    double diff{0};
+    for (size_t i = 0; i < std::get<2>(r0).size(); i++) {
+        diff = std::max(diff, std::abs(std::get<2>(r0)[i] - std::get<2>(r1)[i]));
+    }
+
+    if (mpi::Communicator::world().rank() == 0) {
+        std::printf("number of OpenMP threads : %i\n", omp_get_max_threads());
+        std::printf("%-24s %16s %16s\n", "", "sequential", "concurrent");
+        std::printf("%-24s %16i %16i\n", "k-point teams", 1, num_teams);
+        std::printf("%-24s %16.6f %16.6f\n", "Band::solve (sec.)", std::get<0>(r0), std::get<0>(r1));
+        std::printf("%-24s %16.6f %16.6f\n", "Density::generate (sec.)", std::get<1>(r0), std::get<1>(r1));
+        std::printf("maximum difference of eigen-values : %18.12e\n", diff);
+    }
+    if (diff > 1e-5) {
+        RTE_THROW("eigen-values of the sequential and concurrent runs differ");
+    }
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args(argn, argv, {{"pw_cutoff=", "(double) plane-wave cutoff for density and potential"},
+                               {"gk_cutoff=", "(double) plane-wave cutoff for wave-functions"},
+                               {"N=", "(int) cell multiplicity"},
+                               {"ngridk=", "(int[3]) k-point grid"},
+                               {"num_bands=", "(int) number of bands"},
+                               {"num_teams=", "(int) number of concurrent k-point teams"}});
+
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+
+    sirius::initialize(1);
+    bench_kp_teams(args);
+    sirius::finalize();
+}
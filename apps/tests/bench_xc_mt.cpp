@@ -0,0 +1,192 @@
+#include <sirius.hpp>
+
+using namespace sirius;
+
+/* largest difference of the batch of functions from the reference, relative to the largest reference value */
+double max_rel_diff(std::vector<Flm> const& f__, std::vector<Flm> const& ref__)
+{
+    double d{0};
+    double fmax{0};
+    for (size_t i = 0; i < f__.size(); i++) {
+        for (size_t j = 0; j < f__[i].size(); j++) {
+            d    = std::max(d, std::abs(f__[i][j] - ref__[i][j]));
+            fmax = std::max(fmax, std::abs(ref__[i][j]));
+        }
+    }
+    return (fmax > 0) ? d / fmax : d;
+}
+
+/* time the XC potential in the muffin-tins for a batch of atoms, for the same atoms one by one with a persistent
+   workspace and with a temporary workspace per call; the results of the batch must match the ones of the single
+   atoms */
+int bench_xc_mt(cmd_args const& args__)
+{
+    auto repeat = args__.value<int>("repeat", 10);
+    auto lmax   = args__.value<int>("lmax", 8);
+    auto nmag   = args__.value<int>("num_mag_dims", 0);
+    auto nb     = args__.value<int>("batch", 4);
+    auto xc     = args__.value<std::string>("xc", "XC_GGA_X_PBE,XC_GGA_C_PBE");
+    auto tol    = args__.value<double>("tol", 1e-12);
+
+    auto json_conf = R"({
+      "parameters" : {
+        "electronic_structure_method" : "full_potential_lapwlo",
+        "use_symmetry" : false
+      }
+    })"_json;
+    json_conf["parameters"]["num_mag_dims"] = nmag;
+
+    Simulation_context ctx(json_conf);
+
+    ctx.lmax_apw(lmax);
+    ctx.lmax_pot(lmax);
+    ctx.lmax_rho(lmax);
+
+    /* add a new atom type to the unit cell */
+    auto& atype = ctx.unit_cell().add_atom_type("Cu");
+    atype.zn(29);
+    atype.set_radial_grid(radial_grid_t::lin_exp, 1500, 1e-6, 2.0, 6);
+    atype.set_free_atom_radial_grid(Radial_grid_lin_exp<double>(5000, 1e-6, 20.0));
+    std::vector<double> atom_rho(atype.free_atom_radial_grid().num_points());
+    for (int i = 0; i < atype.free_atom_radial_grid().num_points(); i++) {
+        auto x = atype.free_atom_radial_grid(i);
+        atom_rho[i] = 2 * std::sqrt(atype.zn()) * std::exp(-x);
+    }
+    atype.free_atom_density(atom_rho);
+    for (int l = 0; l <= lmax; l++) {
+        atype.add_aw_descriptor(-1, l, 0.15, 0, 0);
+        atype.add_aw_descriptor(-1, l, 0.15, 1, 0);
+    }
+    ctx.unit_cell().set_lattice_vectors({{5, 0, 0}, {0, 5, 0}, {0, 0, 5}});
+    ctx.unit_cell().add_atom("Cu", {0, 0, 0}, {0, 0, 1});
+
+    ctx.pw_cutoff(10);
+    ctx.initialize();
+
+    Density rho(ctx);
+    rho.initial_density();
+
+    SHT sht(sddk::device_t::CPU, lmax);
+
+    std::vector<XC_functional> xc_func;
+    std::stringstream iss(xc);
+    std::string e;
+    while (std::getline(iss, e, ',')) {
+        xc_func.emplace_back(XC_functional(ctx.spfft<double>(), ctx.unit_cell().lattice_vectors(), e,
+                                           ctx.num_spins()));
+    }
+
+    int ia{0};
+    auto& rgrid = ctx.unit_cell().atom(ia).radial_grid();
+    int ncomp   = nmag + 1;
+
+    /* the density of the i-th atom of the batch is the density of the atom scaled by (1 + i / 4), so that a
+     * mix-up of the atoms in the batch changes the result */
+    std::vector<Flm> rho_own;
+    std::vector<Flm> vxc_lm;
+    std::vector<Flm> exc_lm;
+    std::vector<Flm> vxc_ref;
+    std::vector<Flm> exc_ref;
+    for (int i = 0; i < nb; i++) {
+        for (int j = 0; j < ncomp; j++) {
+            auto const& src = (j == 0) ? rho.rho().mt()[ia] : rho.mag(j - 1).mt()[ia];
+            rho_own.emplace_back(src.angular_domain_size(), rgrid);
+            std::copy(src.at(sddk::memory_t::host), src.at(sddk::memory_t::host) + src.size(),
+                      rho_own.back().at(sddk::memory_t::host));
+            rho_own.back() *= (1 + 0.25 * i);
+            vxc_lm.emplace_back(utils::lmmax(lmax), rgrid);
+            vxc_ref.emplace_back(utils::lmmax(lmax), rgrid);
+        }
+        exc_lm.emplace_back(utils::lmmax(lmax), rgrid);
+        exc_ref.emplace_back(utils::lmmax(lmax), rgrid);
+    }
+    std::vector<Flm const*> rho_lm(nb * ncomp);
+    std::vector<Flm*> vxc_ptr(nb * ncomp);
+    std::vector<Flm*> exc_ptr(nb);
+    for (int i = 0; i < nb; i++) {
+        for (int j = 0; j < ncomp; j++) {
+            rho_lm[i * ncomp + j]  = &rho_own[i * ncomp + j];
+            vxc_ptr[i * ncomp + j] = &vxc_lm[i * ncomp + j];
+        }
+        exc_ptr[i] = &exc_lm[i];
+    }
+
+    /* arguments of the i-th atom; the output goes to the reference functions */
+    auto atom_args = [&](int i) {
+        std::vector<Flm*> vxc(ncomp);
+        for (int j = 0; j < ncomp; j++) {
+            vxc[j] = &vxc_ref[i * ncomp + j];
+        }
+        return std::make_tuple(std::vector<Flm const*>(rho_lm.begin() + i * ncomp, rho_lm.begin() + (i + 1) * ncomp),
+                               vxc, std::vector<Flm*>({&exc_ref[i]}));
+    };
+
+    Xc_mt_workspace ws;
+    /* first call sizes the workspace */
+    xc_mt(rgrid, sht, xc_func, nmag, rho_lm, vxc_ptr, exc_ptr, ws);
+
+    double t_batch = -utils::wtime();
+    for (int k = 0; k < repeat; k++) {
+        xc_mt(rgrid, sht, xc_func, nmag, rho_lm, vxc_ptr, exc_ptr, ws);
+    }
+    t_batch += utils::wtime();
+
+    double t_ws = -utils::wtime();
+    for (int k = 0; k < repeat; k++) {
+        for (int i = 0; i < nb; i++) {
+            auto a = atom_args(i);
+            xc_mt(rgrid, sht, xc_func, nmag, std::get<0>(a), std::get<1>(a), std::get<2>(a), ws);
+        }
+    }
+    t_ws += utils::wtime();
+
+    double diff_ws = std::max(max_rel_diff(vxc_lm, vxc_ref), max_rel_diff(exc_lm, exc_ref));
+
+    double t_tmp = -utils::wtime();
+    for (int k = 0; k < repeat; k++) {
+        for (int i = 0; i < nb; i++) {
+            auto a = atom_args(i);
+            xc_mt(rgrid, sht, xc_func, nmag, std::get<0>(a), std::get<1>(a), std::get<2>(a)[0]);
+        }
+    }
+    t_tmp += utils::wtime();
+
+    double diff_tmp = std::max(max_rel_diff(vxc_lm, vxc_ref), max_rel_diff(exc_lm, exc_ref));
+
+    std::printf("lmax: %i, num_mag_dims: %i, radial points: %i, angular points: %i, batch size: %i\n", lmax, nmag,
+                rgrid.num_points(), sht.num_points(), nb);
+    std::printf("batch of atoms       : %12.6f sec. per atom\n", t_batch / repeat / nb);
+    std::printf("persistent workspace : %12.6f sec. per atom\n", t_ws / repeat / nb);
+    std::printf("temporary workspace  : %12.6f sec. per atom\n", t_tmp / repeat / nb);
+    std::printf("max. relative difference of Vxc and Exc from the batch\n");
+    std::printf("persistent workspace : %12.6e\n", diff_ws);
+    std::printf("temporary workspace  : %12.6e\n", diff_tmp);
+
+    if (diff_ws > tol || diff_tmp > tol) {
+        std::printf("Fail: the results of the batch differ from the ones of the single atoms\n");
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args(argn, argv, {{"repeat=", "{int} number of repetitions"},
+                               {"lmax=", "{int} maximum orbital quantum number of the density and potential"},
+                               {"num_mag_dims=", "{int} number of magnetic dimensions (0, 1 or 3)"},
+                               {"batch=", "{int} number of atoms in a batch"},
+                               {"xc=", "{string} comma-separated list of XC functionals"},
+                               {"tol=", "{double} tolerance of the relative difference between the batch and the "
+                                        "single atoms"}});
+
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+
+    sirius::initialize(1);
+    int result = bench_xc_mt(args);
+    sirius::finalize();
+    return result;
+}
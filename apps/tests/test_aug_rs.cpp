@@ -0,0 +1,196 @@
+#include <sirius.hpp>
+#include <testing.hpp>
+
+using namespace sirius;
+
+/* Compare the real-space augmentation with the reciprocal-space one. The augmentation charge is generated with
+ * Density::generate_rho_aug_rs() and Density::generate_rho_aug() for a random density matrix and for the density
+ * matrices of the single pairs of beta-projectors; the largest error of the pairs comes from the channels of the
+ * highest angular momentum. The D-operator is generated from the same effective potential in two contexts, which
+ * differ only by settings.augmentation, because Potential::generate_D_operator_matrix() selects the method from the
+ * settings.
+ *
+ * The real-space method works with the Q(r) filtered by the window W(q) of Augmentation_operator_rs. The window
+ * multiplies all plane-wave coefficients of the augmentation charge by W(|G|), so the reference charge and the
+ * potential of the D-operator are multiplied by the same window; the remaining difference is the error of the
+ * truncation at the sphere boundary. The difference to the unfiltered charge is printed for information. */
+
+/* window of the filtering integral */
+double
+window(Simulation_context const& ctx__, int igloc__)
+{
+    for (int iat = 0; iat < ctx__.unit_cell().num_atom_types(); iat++) {
+        if (ctx__.unit_cell().atom_type(iat).augment()) {
+            return ctx__.augmentation_op_rs(iat).window(ctx__.gvec().gvec_len<sddk::index_domain_t::local>(igloc__));
+        }
+    }
+    return 1;
+}
+
+/* relative L2 difference of the augmentation charges of the current density matrix */
+double
+rho_aug_diff(Simulation_context const& ctx__, Density& rho__, bool filter__)
+{
+    auto rho_aug_g = rho__.generate_rho_aug();
+    auto rho_aug_r = rho__.generate_rho_aug_rs();
+
+    double d[] = {0, 0};
+    for (int iv = 0; iv < ctx__.num_mag_dims() + 1; iv++) {
+        for (int igloc = 0; igloc < ctx__.gvec().count(); igloc++) {
+            auto z = rho_aug_g(igloc, iv);
+            if (filter__) {
+                z *= window(ctx__, igloc);
+            }
+            d[0] += std::norm(rho_aug_r(igloc, iv) - z);
+            d[1] += std::norm(z);
+        }
+    }
+    ctx__.comm().allreduce(d, 2);
+    return std::sqrt(d[0] / d[1]);
+}
+
+std::unique_ptr<Simulation_context>
+create_context(std::string const& fname__, std::string const& augmentation__, double radius_scale__,
+               std::vector<std::string> const& xc__)
+{
+    auto ctx = std::make_unique<Simulation_context>(fname__, mpi::Communicator::world());
+    ctx->cfg().parameters().use_symmetry(false);
+    ctx->cfg().settings().augmentation(augmentation__);
+    if (radius_scale__ > 0) {
+        ctx->cfg().settings().augmentation_radius_scale(radius_scale__);
+    }
+    if (xc__.size()) {
+        ctx->cfg().parameters().xc_functionals(xc__);
+    }
+    ctx->initialize();
+    return ctx;
+}
+
+int
+test_aug_rs(cmd_args const& args__)
+{
+    auto fname        = args__.value<std::string>("input", "sirius.json");
+    auto radius_scale = args__.value<double>("radius_scale", 0);
+    auto xc           = args__.value<std::string>("xc", std::vector<std::string>());
+    auto tol          = args__.value<double>("tol", 1e-4);
+
+    auto ctx_g_ptr = create_context(fname, "reciprocal", radius_scale, xc);
+    auto ctx_r_ptr = create_context(fname, "real_space", radius_scale, xc);
+    auto& ctx_g    = *ctx_g_ptr;
+    auto& ctx_r    = *ctx_r_ptr;
+
+    Density rho_g(ctx_g);
+    Density rho_r(ctx_r);
+
+    /* random Hermitian density matrix */
+    auto& dm = rho_r.density_matrix();
+    dm.zero();
+    std::srand(123);
+    auto rnd = []() { return static_cast<double>(std::rand()) / RAND_MAX - 0.5; };
+    int num_dm = (ctx_r.num_mag_dims() == 3) ? 3 : ctx_r.num_spins();
+    for (int ia = 0; ia < ctx_r.unit_cell().num_atoms(); ia++) {
+        int nbf = ctx_r.unit_cell().atom(ia).mt_basis_size();
+        for (int ispn = 0; ispn < num_dm; ispn++) {
+            for (int xi2 = 0; xi2 < nbf; xi2++) {
+                for (int xi1 = 0; xi1 <= xi2; xi1++) {
+                    std::complex<double> z(rnd(), (xi1 == xi2 && ispn < 2) ? 0 : rnd());
+                    if (xi1 == xi2 && ispn < 2) {
+                        z += 1;
+                    }
+                    dm(xi1, xi2, ispn, ia) = z;
+                    dm(xi2, xi1, ispn, ia) = std::conj(z);
+                }
+            }
+        }
+    }
+
+    double err_rho  = rho_aug_diff(ctx_r, rho_r, true);
+    double err_filt = rho_aug_diff(ctx_r, rho_r, false);
+
+    /* single pairs of beta-projectors of the first atom */
+    double err_pair{0};
+    int l_pair[] = {-1, -1};
+    auto& type = ctx_r.unit_cell().atom(0).type();
+    for (int xi2 = 0; xi2 < type.mt_basis_size(); xi2++) {
+        for (int xi1 = 0; xi1 <= xi2; xi1++) {
+            dm.zero();
+            dm(xi1, xi2, 0, 0) = 1;
+            dm(xi2, xi1, 0, 0) = 1;
+            double e = rho_aug_diff(ctx_r, rho_r, true);
+            if (e > err_pair) {
+                err_pair  = e;
+                l_pair[0] = type.indexb(xi1).l;
+                l_pair[1] = type.indexb(xi2).l;
+            }
+        }
+    }
+
+    /* effective potential of the superposed atomic densities */
+    rho_g.initial_density();
+    Potential pot_g(ctx_g);
+    pot_g.generate(rho_g, false, true);
+
+    Potential pot_r(ctx_r);
+    for (int iv = 0; iv < ctx_r.num_mag_dims() + 1; iv++) {
+        for (int igloc = 0; igloc < ctx_r.gvec().count(); igloc++) {
+            pot_g.component(iv).rg().f_pw_local(igloc) *= window(ctx_r, igloc);
+            pot_r.component(iv).rg().f_pw_local(igloc) = pot_g.component(iv).rg().f_pw_local(igloc);
+        }
+    }
+
+    pot_g.generate_D_operator_matrix();
+    pot_r.generate_D_operator_matrix();
+
+    double d_max{0};
+    double d_diff{0};
+    for (int ia = 0; ia < ctx_r.unit_cell().num_atoms(); ia++) {
+        auto& atom_g = ctx_g.unit_cell().atom(ia);
+        auto& atom_r = ctx_r.unit_cell().atom(ia);
+        if (!atom_r.type().augment()) {
+            continue;
+        }
+        int nbf = atom_r.mt_basis_size();
+        for (int iv = 0; iv < ctx_r.num_mag_dims() + 1; iv++) {
+            for (int xi2 = 0; xi2 < nbf; xi2++) {
+                for (int xi1 = 0; xi1 < nbf; xi1++) {
+                    d_max  = std::max(d_max, std::abs(atom_g.d_mtrx(xi1, xi2, iv)));
+                    d_diff = std::max(d_diff, std::abs(atom_r.d_mtrx(xi1, xi2, iv) - atom_g.d_mtrx(xi1, xi2, iv)));
+                }
+            }
+        }
+    }
+    double err_d = d_diff / d_max;
+
+    bool ok = err_rho < tol && err_pair < tol && err_d < tol;
+    if (ctx_r.comm().rank() == 0) {
+        std::printf("radius scale: %.3f\n", ctx_r.cfg().settings().augmentation_radius_scale());
+        std::printf("rel. error of the augmentation charge : %12.6e\n", err_rho);
+        std::printf("rel. difference to the unfiltered Q   : %12.6e\n", err_filt);
+        std::printf("max. rel. error of the single pairs   : %12.6e (l1 = %i, l2 = %i)\n", err_pair, l_pair[0],
+                    l_pair[1]);
+        std::printf("max. error of the D-operator          : %12.6e (rel. %12.6e)\n", d_diff, err_d);
+        std::printf("%s\n", ok ? "OK" : "Fail");
+    }
+    return ok ? 0 : 1;
+}
+
+int
+main(int argn, char** argv)
+{
+    cmd_args args(argn, argv, {{"input=", "{string} input file name"},
+                               {"radius_scale=", "{double} scale of the augmentation sphere radius"},
+                               {"xc=", "{string} colon-separated list of XC functionals which override the input"},
+                               {"tol=", "{double} tolerance of the relative errors"}
+                              });
+
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+
+    sirius::initialize(1);
+    int result = test_aug_rs(args);
+    sirius::finalize();
+    return result;
+}
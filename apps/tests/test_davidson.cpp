@@ -1,6 +1,8 @@
 #include <sirius.hpp>
 #include <testing.hpp>
 #include "band/davidson.hpp"
+#include "band/chebyshev.hpp"
+#include "band/lobpcg.hpp"
 
 using namespace sirius;
 
@@ -43,9 +45,10 @@ void init_wf(K_point<T>* kp__, wf::Wave_functions<T>& phi__, int num_bands__, in
 }
 
 template <typename T, typename F>
-void
+int
 diagonalize(Simulation_context& ctx__, std::array<double, 3> vk__, Potential& pot__, double res_tol__,
-            double eval_tol__, bool only_kin__, int subspace_size__, bool estimate_eval__, bool extra_ortho__)
+            double eval_tol__, bool only_kin__, int subspace_size__, bool estimate_eval__, bool extra_ortho__,
+            std::string const& itsol__, double tol__)
 {
     K_point<T> kp(ctx__, &vk__[0], 1.0);
     kp.initialize();
@@ -60,15 +63,74 @@ diagonalize(Simulation_context& ctx__, std::array<double, 3> vk__, Potential& po
     for (int i = 0; i < ctx__.num_bands(); i++) {
         kp.band_energy(i, 0, 0);
     }
-    init_wf(&kp, kp.spinor_wave_functions(), ctx__.num_bands(), 0);
-
 
     const int num_bands = ctx__.num_bands();
     bool locking{true};
 
-    auto result = davidson<T, F, davidson_evp_t::hamiltonian>(Hk, wf::num_bands(num_bands),
-            wf::num_mag_dims(ctx__.num_mag_dims()), kp.spinor_wave_functions(), [&](int i, int ispn){return eval_tol__;}, res_tol__,
-            60, locking, subspace_size__, estimate_eval__, extra_ortho__, std::cout, 2);
+    /* keep the starting guess to run all solvers from the same point */
+    wf::Wave_functions<T> psi0(kp.gkvec_sptr(), wf::num_mag_dims(ctx__.num_mag_dims() == 3 ? 3 : 0),
+            wf::num_bands(num_bands), sddk::memory_t::host);
+    init_wf(&kp, psi0, num_bands, 0);
+
+    davidson_result_t result;
+    std::map<std::string, std::pair<double, davidson_result_t>> results;
+    /* names of the solvers in the order in which they were run; the first one is the reference */
+    std::vector<std::string> order;
+
+    for (auto name : {"davidson", "chebyshev", "lobpcg"}) {
+        /* "both" is kept for compatibility and selects Davidson and Chebyshev solvers */
+        bool run = (itsol__ == name) || (itsol__ == "all") ||
+                   (itsol__ == "both" && std::string(name) != "lobpcg");
+        if (!run) {
+            continue;
+        }
+        order.push_back(name);
+        for (int ispn = 0; ispn < psi0.num_sc().get(); ispn++) {
+            wf::copy(sddk::memory_t::host, psi0, wf::spin_index(ispn), wf::band_range(0, num_bands),
+                    kp.spinor_wave_functions(), wf::spin_index(ispn), wf::band_range(0, num_bands));
+        }
+        double t = -utils::wtime();
+        if (std::string(name) == "davidson") {
+            result = davidson<T, F, davidson_evp_t::hamiltonian>(Hk, wf::num_bands(num_bands),
+                    wf::num_mag_dims(ctx__.num_mag_dims()), kp.spinor_wave_functions(),
+                    [&](int i, int ispn){return eval_tol__;}, res_tol__, 60, locking, subspace_size__,
+                    estimate_eval__, extra_ortho__, std::cout, 2);
+        } else if (std::string(name) == "lobpcg") {
+            result = lobpcg<T, F>(Hk, wf::num_bands(num_bands), wf::num_mag_dims(ctx__.num_mag_dims()),
+                    kp.spinor_wave_functions(), [&](int i, int ispn){return eval_tol__;}, res_tol__, 200,
+                    estimate_eval__, extra_ortho__, std::cout, 2);
+        } else {
+            result = chebyshev<T, F>(Hk, wf::num_bands(num_bands), wf::num_mag_dims(ctx__.num_mag_dims()),
+                    kp.spinor_wave_functions(), [&](int i, int ispn){return eval_tol__;}, res_tol__, 200,
+                    std::cout, 2);
+        }
+        t += utils::wtime();
+        results[name] = std::make_pair(t, davidson_result_t{result.niter, sddk::mdarray<double, 2>(num_bands, 1)});
+        for (int i = 0; i < num_bands; i++) {
+            results[name].second.eval(i, 0) = result.eval(i, 0);
+        }
+    }
+
+    int result_code{0};
+    if (mpi::Communicator::world().rank() == 0) {
+        for (auto& name : order) {
+            auto& e = results.at(name);
+            printf("%-10s : time = %12.6f sec., number of iterations = %i\n", name.c_str(), e.first, e.second.niter);
+        }
+        auto& ref = results.at(order.front()).second;
+        for (size_t j = 1; j < order.size(); j++) {
+            auto& e = results.at(order[j]).second;
+            double max_diff{0};
+            for (int i = 0; i < num_bands; i++) {
+                max_diff = std::max(max_diff, std::abs(ref.eval(i, 0) - e.eval(i, 0)));
+            }
+            printf("maximum difference between %s and %s eigen-values: %20.16e : %s\n", order.front().c_str(),
+                    order[j].c_str(), max_diff, (max_diff < tol__) ? "OK" : "Fail");
+            if (max_diff >= tol__) {
+                result_code++;
+            }
+        }
+    }
 
     if (mpi::Communicator::world().rank() == 0 && only_kin__) {
         std::vector<double> ekin(kp.num_gkvec());
@@ -82,7 +144,10 @@ diagonalize(Simulation_context& ctx__, std::array<double, 3> vk__, Potential& po
             max_diff = std::max(max_diff, std::abs(ekin[i] - result.eval(i, 0)));
             printf("%20.16f %20.16f %20.16e\n", ekin[i], result.eval(i, 0), std::abs(ekin[i] - result.eval(i, 0)));
         }
-        printf("maximum eigen-value difference: %20.16e\n", max_diff);
+        printf("maximum eigen-value difference: %20.16e : %s\n", max_diff, (max_diff < tol__) ? "OK" : "Fail");
+        if (max_diff >= tol__) {
+            result_code++;
+        }
     }
 
     if (mpi::Communicator::world().rank() == 0 && !only_kin__) {
@@ -91,9 +156,11 @@ diagonalize(Simulation_context& ctx__, std::array<double, 3> vk__, Potential& po
             printf("e[%i] = %20.16f\n", i, result.eval(i, 0));
         }
     }
+    mpi::Communicator::world().bcast(&result_code, 1, 0);
+    return result_code;
 }
 
-void test_davidson(cmd_args const& args__)
+int test_davidson(cmd_args const& args__)
 {
     auto pw_cutoff     = args__.value<double>("pw_cutoff", 30);
     auto gk_cutoff     = args__.value<double>("gk_cutoff", 10);
@@ -108,6 +175,15 @@ void test_davidson(cmd_args const& args__)
     auto subspace_size = args__.value<int>("subspace_size", 2);
     auto estimate_eval = !args__.exist("use_res_norm");
     auto extra_ortho   = args__.exist("extra_ortho");
+    auto itsol         = args__.value<std::string>("itsol", "davidson");
+    auto tol           = args__.value<double>("tol", 10 * res_tol);
+
+    if (itsol != "davidson" && itsol != "chebyshev" && itsol != "lobpcg" && itsol != "both" && itsol != "all") {
+        if (mpi::Communicator::world().rank() == 0) {
+            printf("unknown iterative solver: %s\n", itsol.c_str());
+        }
+        return 1;
+    }
 
     int num_bands{-1};
     num_bands = args__.value<int>("num_bands", num_bands);
@@ -163,6 +239,7 @@ void test_davidson(cmd_args const& args__)
     pot.generate(rho, ctx.use_symmetry(), true);
     pot.zero();
 
+    int result{0};
     /* repeat several times for the accurate performance measurment */
     for (int r = 0; r < 1; r++) {
         std::array<double, 3> vk({0.1, 0.1, 0.1});
@@ -171,18 +248,22 @@ void test_davidson(cmd_args const& args__)
         }
         if (precision_wf == "fp32" && precision_hs == "fp32") {
 #if defined(USE_FP32)
-            diagonalize<float, std::complex<float>>(ctx, vk, pot, res_tol, eval_tol, only_kin, subspace_size, estimate_eval, extra_ortho);
+            result += diagonalize<float, std::complex<float>>(ctx, vk, pot, res_tol, eval_tol, only_kin, subspace_size,
+                    estimate_eval, extra_ortho, itsol, tol);
 #endif
         }
         if (precision_wf == "fp32" && precision_hs == "fp64") {
 #if defined(USE_FP32)
-            diagonalize<float, std::complex<double>>(ctx, vk, pot, res_tol, eval_tol, only_kin, subspace_size, estimate_eval, extra_ortho);
+            result += diagonalize<float, std::complex<double>>(ctx, vk, pot, res_tol, eval_tol, only_kin, subspace_size,
+                    estimate_eval, extra_ortho, itsol, tol);
 #endif
         }
         if (precision_wf == "fp64" && precision_hs == "fp64") {
-            diagonalize<double, std::complex<double>>(ctx, vk, pot, res_tol, eval_tol, only_kin, subspace_size, estimate_eval, extra_ortho);
+            result += diagonalize<double, std::complex<double>>(ctx, vk, pot, res_tol, eval_tol, only_kin, subspace_size,
+                    estimate_eval, extra_ortho, itsol, tol);
         }
     }
+    return result;
 }
 
 int main(int argn, char** argv)
@@ -199,8 +280,10 @@ int main(int argn, char** argv)
                                {"subspace_size=", "(int) size of the diagonalization subspace"},
                                {"use_res_norm",   "use residual norm to estimate the convergence"},
                                {"extra_ortho",    "use second orthogonalisation"},
+                               {"itsol=",         "(string) iterative solver: davidson, chebyshev, lobpcg, both (davidson and chebyshev) or all"},
                                {"precision_wf=",  "{string} precision of wave-functions"},
                                {"precision_hs=",  "{string} precision of the Hamiltonian subspace"},
+                               {"tol=",           "(double) tolerance of the eigen-value difference between the solvers (default: 10 res_tol)"},
                                {"only_kin",       "use kinetic-operator only"}
                               });
 
@@ -211,11 +294,12 @@ int main(int argn, char** argv)
     }
 
     sirius::initialize(1);
-    test_davidson(args);
+    int result = test_davidson(args);
     int rank = mpi::Communicator::world().rank();
     sirius::finalize();
     if (rank == 0)  {
         const auto timing_result = ::utils::global_rtgraph_timer.process();
         std::cout<< timing_result.print();
     }
+    return result;
 }
@@ -0,0 +1,259 @@
+#include <sirius.hpp>
+#include <testing.hpp>
+#include "linalg/eigensolver.hpp"
+
+using namespace sirius;
+
+/* Move the atoms along a smooth path and compare the density and the wave-functions which are extrapolated by
+ * DFT_ground_state::update() with the self-consistent solution obtained from scratch at each new geometry. Both
+ * must be closer to the reference than the solution of the previous geometry. */
+
+std::unique_ptr<Simulation_context>
+create_context(std::string const& fname__, std::string const& rho__, std::string const& wf__,
+               std::vector<r3::vector<double>> const& positions__)
+{
+    auto ctx = std::make_unique<Simulation_context>(fname__, mpi::Communicator::world());
+    ctx->cfg().parameters().use_symmetry(false);
+    ctx->cfg().settings().extrapolation_rho(rho__);
+    ctx->cfg().settings().extrapolation_wf(wf__);
+    for (int ia = 0; ia < ctx->unit_cell().num_atoms(); ia++) {
+        ctx->unit_cell().atom(ia).set_position(positions__[ia]);
+    }
+    ctx->initialize();
+    return ctx;
+}
+
+/* relative difference of the plane-wave coefficients of the densities */
+double
+rho_diff(Simulation_context const& ctx__, std::vector<std::complex<double>> const& rho__, Density const& rho_ref__)
+{
+    double d[] = {0, 0};
+    for (int igloc = 0; igloc < ctx__.gvec().count(); igloc++) {
+        d[0] += std::norm(rho__[igloc] - rho_ref__.rho().rg().f_pw_local(igloc));
+        d[1] += std::norm(rho_ref__.rho().rg().f_pw_local(igloc));
+    }
+    ctx__.comm().allreduce(d, 2);
+    return std::sqrt(d[0] / d[1]);
+}
+
+/* Distance between the occupied subspaces of the wave-functions. The wave-functions are aligned to the reference
+ * with U = O (O^H O)^{-1/2}, O = <psi|psi_ref>, and the norm of psi U - psi_ref is returned; it does not depend on
+ * the unitary mixing of the states inside the subspace. */
+double
+wf_diff(Simulation_context& ctx__, wf::spin_range spins__, int nb__, wf::Wave_functions<double> const& psi__,
+        wf::Wave_functions<double> const& psi_ref__)
+{
+    using F = std::complex<double>;
+
+    la::dmatrix<F> o(nb__, nb__);
+    la::dmatrix<F> m(nb__, nb__);
+    la::dmatrix<F> m_ref(nb__, nb__);
+    wf::inner(ctx__.spla_context(), sddk::memory_t::host, spins__, psi__, wf::band_range(0, nb__), psi_ref__,
+              wf::band_range(0, nb__), o, 0, 0);
+    wf::inner(ctx__.spla_context(), sddk::memory_t::host, spins__, psi__, wf::band_range(0, nb__), psi__,
+              wf::band_range(0, nb__), m, 0, 0);
+    wf::inner(ctx__.spla_context(), sddk::memory_t::host, spins__, psi_ref__, wf::band_range(0, nb__), psi_ref__,
+              wf::band_range(0, nb__), m_ref, 0, 0);
+
+    /* O^H O = Z e Z^H */
+    la::dmatrix<F> a(nb__, nb__);
+    for (int i = 0; i < nb__; i++) {
+        for (int j = 0; j < nb__; j++) {
+            a(i, j) = 0;
+            for (int k = 0; k < nb__; k++) {
+                a(i, j) += std::conj(o(k, i)) * o(k, j);
+            }
+        }
+    }
+    la::dmatrix<F> z(nb__, nb__);
+    std::vector<double> eval(nb__);
+    auto solver = la::Eigensolver_factory("lapack");
+    if (solver->solve(nb__, nb__, a, eval.data(), z)) {
+        RTE_THROW("error in diagonalization");
+    }
+    /* U = O Z e^{-1/2} Z^H */
+    la::dmatrix<F> u(nb__, nb__);
+    for (int i = 0; i < nb__; i++) {
+        for (int j = 0; j < nb__; j++) {
+            F s{0};
+            for (int l = 0; l < nb__; l++) {
+                F t{0};
+                for (int k = 0; k < nb__; k++) {
+                    t += o(i, k) * z(k, l);
+                }
+                s += t * std::conj(z(j, l)) / std::sqrt(std::max(eval[l], 1e-14));
+            }
+            u(i, j) = s;
+        }
+    }
+    /* |psi U - psi_ref|^2 = Tr(U^H M U) + Tr(M_ref) - 2 Re Tr(U^H O) */
+    double d{0};
+    for (int j = 0; j < nb__; j++) {
+        d += m_ref(j, j).real();
+        for (int i = 0; i < nb__; i++) {
+            d -= 2 * std::real(std::conj(u(i, j)) * o(i, j));
+            for (int k = 0; k < nb__; k++) {
+                d += std::real(std::conj(u(i, j)) * m(i, k) * u(k, j));
+            }
+        }
+    }
+    return std::sqrt(std::max(d, 0.0) / nb__);
+}
+
+int
+test_extrapolation(cmd_args const& args__)
+{
+    auto fname     = args__.value<std::string>("input", "sirius.json");
+    auto num_steps = args__.value<int>("num_steps", 4);
+    auto amplitude = args__.value<double>("amplitude", 0.004);
+    auto type_rho  = args__.value<std::string>("extrapolation_rho", "second_order");
+    auto type_wf   = args__.value<std::string>("extrapolation_wf", "second_order");
+
+    std::vector<r3::vector<double>> positions;
+    {
+        Simulation_context ctx(fname, mpi::Communicator::world());
+        for (int ia = 0; ia < ctx.unit_cell().num_atoms(); ia++) {
+            positions.push_back(ctx.unit_cell().atom(ia).position());
+        }
+    }
+    /* smooth path of the atoms */
+    auto path = [&](int step) {
+        auto p = positions;
+        for (int ia = 0; ia < static_cast<int>(p.size()); ia++) {
+            double s = amplitude * step;
+            p[ia] = p[ia] + r3::vector<double>(s * (1 + 0.3 * ia), -0.6 * s + 0.1 * s * step, 0.4 * s * (ia % 2));
+        }
+        return p;
+    };
+
+    auto ctx_ptr = create_context(fname, type_rho, type_wf, path(0));
+    auto& ctx    = *ctx_ptr;
+    auto& inp    = ctx.cfg().parameters();
+    if (ctx.gamma_point()) {
+        RTE_THROW("Gamma-point case is not supported by the test");
+    }
+
+    K_point_set kset(ctx, inp.ngridk(), inp.shiftk(), false);
+    DFT_ground_state dft(kset);
+    dft.initial_state();
+    dft.find(inp.density_tol(), inp.energy_tol(), ctx.cfg().iterative_solver().energy_tolerance(),
+             inp.num_dft_iter(), false);
+
+    int num_sc = (ctx.num_mag_dims() == 3) ? 1 : ctx.num_spins();
+
+    int result{0};
+    for (int step = 1; step <= num_steps; step++) {
+        /* solution of the previous geometry */
+        std::vector<std::complex<double>> rho_prev(ctx.gvec().count());
+        for (int igloc = 0; igloc < ctx.gvec().count(); igloc++) {
+            rho_prev[igloc] = dft.density().rho().rg().f_pw_local(igloc);
+        }
+        std::map<int, std::unique_ptr<wf::Wave_functions<double>>> psi_prev;
+        for (int ikloc = 0; ikloc < kset.spl_num_kpoints().local_size(); ikloc++) {
+            int ik   = kset.spl_num_kpoints(ikloc);
+            auto kp  = kset.get<double>(ik);
+            auto& psi = kp->spinor_wave_functions();
+            psi_prev[ik] = wave_function_factory(ctx, *kp, psi.num_wf(), psi.num_md(), false);
+            for (int is = 0; is < psi.num_sc().get(); is++) {
+                wf::copy(sddk::memory_t::host, psi, wf::spin_index(is), wf::band_range(0, psi.num_wf().get()),
+                         *psi_prev[ik], wf::spin_index(is), wf::band_range(0, psi.num_wf().get()));
+            }
+        }
+
+        auto pos = path(step);
+        for (int ia = 0; ia < ctx.unit_cell().num_atoms(); ia++) {
+            ctx.unit_cell().atom(ia).set_position(pos[ia]);
+        }
+        dft.update();
+
+        std::vector<std::complex<double>> rho_ext(ctx.gvec().count());
+        for (int igloc = 0; igloc < ctx.gvec().count(); igloc++) {
+            rho_ext[igloc] = dft.density().rho().rg().f_pw_local(igloc);
+        }
+
+        /* reference solution from scratch */
+        auto ctx_ref_ptr = create_context(fname, "none", "none", pos);
+        auto& ctx_ref    = *ctx_ref_ptr;
+        K_point_set kset_ref(ctx_ref, inp.ngridk(), inp.shiftk(), false);
+        DFT_ground_state dft_ref(kset_ref);
+        dft_ref.initial_state();
+        auto r_ref = dft_ref.find(inp.density_tol(), inp.energy_tol(),
+                                  ctx_ref.cfg().iterative_solver().energy_tolerance(), inp.num_dft_iter(), false);
+
+        double drho_prev = rho_diff(ctx, rho_prev, dft_ref.density());
+        double drho_ext  = rho_diff(ctx, rho_ext, dft_ref.density());
+
+        double dwf_prev{0};
+        double dwf_ext{0};
+        for (int ikloc = 0; ikloc < kset.spl_num_kpoints().local_size(); ikloc++) {
+            int ik      = kset.spl_num_kpoints(ikloc);
+            auto kp     = kset.get<double>(ik);
+            auto kp_ref = kset_ref.get<double>(ik);
+            for (int ispn_step = 0; ispn_step < num_sc; ispn_step++) {
+                auto sr = (ctx.num_mag_dims() == 3) ? wf::spin_range(0, 2) : wf::spin_range(ispn_step);
+                /* occupied states of the reference */
+                int nocc{0};
+                for (int j = 0; j < ctx.num_bands(); j++) {
+                    if (kp_ref->band_occupancy(j, ispn_step) > 0.5 * ctx.max_occupancy()) {
+                        nocc = j + 1;
+                    }
+                }
+                if (nocc == 0) {
+                    continue;
+                }
+                auto& psi_ref = kp_ref->spinor_wave_functions();
+                dwf_prev = std::max(dwf_prev, wf_diff(ctx, sr, nocc, *psi_prev[ik], psi_ref));
+                dwf_ext  = std::max(dwf_ext, wf_diff(ctx, sr, nocc, kp->spinor_wave_functions(), psi_ref));
+            }
+        }
+        kset.comm().allreduce<double, mpi::op_t::max>(&dwf_prev, 1);
+        kset.comm().allreduce<double, mpi::op_t::max>(&dwf_ext, 1);
+
+        auto r = dft.find(inp.density_tol(), inp.energy_tol(), ctx.cfg().iterative_solver().energy_tolerance(),
+                          inp.num_dft_iter(), false);
+        double de = std::abs(dft.total_energy() - dft_ref.total_energy());
+
+        /* the density is extrapolated from the first step (superposed atomic densities), the wave-functions once
+         * two geometries are known */
+        bool ok = de < 1e-6;
+        if (type_rho != "none") {
+            ok = ok && drho_ext < drho_prev;
+        }
+        if (type_wf != "none" && step > 1 && inp.precision_wf() == "fp64") {
+            ok = ok && dwf_ext < dwf_prev;
+        }
+        if (ctx.comm().rank() == 0) {
+            std::printf("step %i: rel. error of rho (previous / extrapolated): %12.6e / %12.6e, "
+                        "error of psi (previous / extrapolated): %12.6e / %12.6e\n"
+                        "        SCF iterations (extrapolated / scratch): %i / %i, energy difference: %12.6e : %s\n",
+                        step, drho_prev, drho_ext, dwf_prev, dwf_ext, r.value("num_scf_iterations", -1),
+                        r_ref.value("num_scf_iterations", -1), de, ok ? "OK" : "Fail");
+        }
+        if (!ok) {
+            result++;
+        }
+    }
+    return result;
+}
+
+int
+main(int argn, char** argv)
+{
+    cmd_args args(argn, argv, {{"input=", "{string} input file name"},
+                               {"num_steps=", "{int} number of ionic steps"},
+                               {"amplitude=", "{double} displacement of the atoms per step in fractional coordinates"},
+                               {"extrapolation_rho=", "{string} extrapolation of the density"},
+                               {"extrapolation_wf=", "{string} extrapolation of the wave-functions"}
+                              });
+
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+
+    sirius::initialize(1);
+    int result = test_extrapolation(args);
+    sirius::finalize();
+    return result;
+}
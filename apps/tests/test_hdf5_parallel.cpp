@@ -1,23 +1,73 @@
-#include <sirius.h>
+#include <sirius.hpp>
 
-void test1()
+/* each rank writes a block of columns of a global matrix with a collective hyperslab write; the matrix is then
+ * read back by all ranks and checked */
+void test1(int n__, int m__)
 {
-    /*if (mpi_comm_world().rank() == 0) {
-        sirius::HDF5_tree f("f.h5", true);
-        std::vector<double> buf(100, 0);
-        f.create_node("aaa");
-        f["aaa"].write("vec", buf);
-    */ 
-    mpi_comm_world().barrier();
-    sirius::HDF5_tree f("f.h5", false);
-    
-    
-}
+    auto& comm = mpi::Communicator::world();
+
+    sddk::splindex<sddk::splindex_t::block> spl(m__, comm.size(), comm.rank());
 
+    sddk::mdarray<double, 2> a(n__, spl.local_size());
+    for (int j = 0; j < spl.local_size(); j++) {
+        for (int i = 0; i < n__; i++) {
+            a(i, j) = i + spl[j] * n__;
+        }
+    }
+
+    double t0 = -utils::wtime();
+    {
+        sddk::HDF5_tree f("f.h5", sddk::hdf5_access_t::truncate, comm);
+        f.create_node("node1");
+        f["node1"].create_dataset<double>("a", {n__, m__});
+        if (spl.local_size()) {
+            f["node1"].write_hyperslab("a", a.at(sddk::memory_t::host), {0, spl.global_offset()},
+                                       {n__, spl.local_size()}, true);
+        } else {
+            f["node1"].write_hyperslab<double>("a", nullptr, {}, {}, true);
+        }
+    }
+    t0 += utils::wtime();
+
+    sddk::mdarray<double, 2> b(n__, m__);
+    {
+        sddk::HDF5_tree f("f.h5", sddk::hdf5_access_t::read_only);
+        f["node1"].read("a", b);
+    }
+    for (int j = 0; j < m__; j++) {
+        for (int i = 0; i < n__; i++) {
+            if (b(i, j) != i + j * n__) {
+                std::stringstream s;
+                s << "wrong value of element (" << i << ", " << j << ")";
+                RTE_THROW(s);
+            }
+        }
+    }
+    if (comm.rank() == 0) {
+        std::printf("written %li Mb in %f sec.\n", (sizeof(double) * n__ * m__) >> 20, t0);
+    }
+}
 
 int main(int argn, char** argv)
 {
+    cmd_args args;
+    args.register_key("--n=", "{int} number of rows");
+    args.register_key("--m=", "{int} number of columns");
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+
     sirius::initialize(1);
-    test1();
+#if defined(H5_HAVE_PARALLEL)
+    test1(args.value<int>("n", 1000), args.value<int>("m", 100));
+#else
+    if (mpi::Communicator::world().rank() == 0) {
+        std::printf("HDF5 library is not compiled with the parallel support, test is skipped\n");
+    }
+#endif
     sirius::finalize();
 }
@@ -121,36 +121,60 @@ int main(int argn, char** argv)
     input.beta(beta);
     input.max_history(max_history);
 
-    for (auto const mixer_name : {"anderson", "anderson_stable", "broyden2", "linear"}) {
-        input.type(mixer_name);
+    // the same properties with the exact Newton step -(A - I)^{-1} of f(x) = (A - I)x - b as preconditioner
+    // of the residual
+    auto precond_function_prop = mixer_function_prop;
+    precond_function_prop.precondition = [](std::vector<double>& x) -> void {
+        for (size_t i = 0; i < x.size(); ++i)
+            x[i] /= -(1.0 + 1.0 / (i + 1));
+    };
+
+    int result{0};
+
+    for (bool precond : {false, true}) {
+        auto const& prop = precond ? precond_function_prop : mixer_function_prop;
 
-        std::cout << "max history = " << input.max_history()
-              << ". beta = " << input.beta()
-              << ". dim = " << n
-              << ". mixer = " << input.type() << '\n';
+        for (auto const mixer_name : {"anderson", "anderson_stable", "broyden2", "linear"}) {
+            input.type(mixer_name);
 
-        auto mixer = mixer::Mixer_factory<std::vector<double>>(input);
+            std::cout << "max history = " << input.max_history()
+                  << ". beta = " << input.beta()
+                  << ". dim = " << n
+                  << ". mixer = " << input.type()
+                  << ". preconditioner = " << (precond ? "yes" : "no") << '\n';
 
-        std::vector<double> x(n, 0.0);
-        mixer->initialize_function<0>(mixer_function_prop, x, n);
+            auto mixer = mixer::Mixer_factory<std::vector<double>>(input);
 
-        std::cout.precision(std::numeric_limits<double>::digits10);
-        std::cout << std::setw(8) << "iter" << std::setw(30) << "||res||" << std::setw(30) << "||err||" << '\n';
+            std::vector<double> x(n, 0.0);
+            mixer->initialize_function<0>(prop, x, n);
 
-        for (size_t step = 0; step < max_iter; ++step) {
-            // input = g(output)
-            // residual = input - output = g(output) - output = f(output)
-            mixer->get_output<0>(x);
-            auto g_of_x = g(A, x, b);
-            mixer->set_input<0>(g_of_x);
+            std::cout.precision(std::numeric_limits<double>::digits10);
+            std::cout << std::setw(8) << "iter" << std::setw(30) << "||res||" << std::setw(30) << "||err||" << '\n';
 
-            auto residual_norm = mixer->mix(tol);
-            std::cout << std::setw(8) << step
-                    << std::setw(30) << residual_norm
-                    << std::setw(30) <<  error_norm(x, true_x) << '\n';
+            bool converged{false};
+            for (size_t step = 0; step < max_iter; ++step) {
+                // input = g(output)
+                // residual = input - output = g(output) - output = f(output)
+                mixer->get_output<0>(x);
+                auto g_of_x = g(A, x, b);
+                mixer->set_input<0>(g_of_x);
 
-            if (residual_norm < tol)
-                break;
+                auto residual_norm = mixer->mix(tol);
+                std::cout << std::setw(8) << step
+                        << std::setw(30) << residual_norm
+                        << std::setw(30) <<  error_norm(x, true_x) << '\n';
+
+                if (residual_norm < tol) {
+                    converged = true;
+                    break;
+                }
+            }
+            // with the exact preconditioner every mixer must converge
+            if (precond && !converged) {
+                std::cout << "preconditioned " << mixer_name << " mixer did not converge\n";
+                result = 1;
+            }
         }
     }
+    return result;
 }
@@ -0,0 +1,322 @@
+#include <sirius.hpp>
+#include <testing.hpp>
+#include "mixer/mixer_factory.hpp"
+#include "mixer/mixer_functions.hpp"
+#include "mixer/mixer_gvec.hpp"
+
+using namespace sirius;
+
+/* Mixing of the plane-wave coefficients of the periodic functions: the Hartree-energy metric of the real-space
+ * mixer and the G-space mode of the mixer. Both tests use a simple cubic cell without atomic potential and a linear
+ * model of the SCF map with a known fixed point. */
+
+/* history of the residual norms and the final plane-wave coefficients of the mixed function */
+struct mix_result
+{
+    std::vector<double> rms;
+    std::vector<std::complex<double>> f;
+};
+
+/* mixers which are checked */
+std::vector<std::string> const mixer_names = {"anderson", "anderson_stable", "broyden2", "linear"};
+
+auto
+create_context(double pw_cutoff__)
+{
+    auto json_conf = R"({
+      "parameters" : {
+        "electronic_structure_method" : "pseudopotential",
+        "use_symmetry" : false
+      }
+    })"_json;
+    json_conf["parameters"]["pw_cutoff"] = pw_cutoff__;
+    json_conf["parameters"]["gk_cutoff"] = pw_cutoff__ / 2;
+
+    return create_simulation_context(json_conf, {{5.0, 0, 0}, {0, 5.0, 0}, {0, 0, 5.0}}, 1,
+            {r3::vector<double>(0, 0, 0)}, false, false);
+}
+
+/* full dictionary of the mixer parameters; config_t::mixer_t keeps a reference to it */
+nlohmann::json
+create_mixer_dict()
+{
+    return R"({
+      "mixer" : {
+        "type" : "anderson",
+        "beta" : 0.5,
+        "beta0" : 0.15,
+        "linear_mix_rms_tol" : 1e6,
+        "beta_scaling_factor" : 1,
+        "max_history" : 8,
+        "use_hartree" : false,
+        "gvec_mixing" : false,
+        "gmax" : 0,
+        "preconditioner" : "none",
+        "q0" : 1.5,
+        "resta_eps0" : 10,
+        "resta_rs" : 5,
+        "history_fp32" : false
+      }
+    })"_json;
+}
+
+/* Mix a periodic function in the Hartree-energy metric with the given function properties. The SCF map is linear
+ * in the plane-wave coefficients, f_out(G) = t(G) + c(G) (f_in(G) - t(G)), with a fixed point t(G). The map reads
+ * the plane-wave coefficients of the mixer output, so they must be consistent with the real-space values. */
+mix_result
+run_mixer_hartree(Simulation_context& ctx__, config_t::mixer_t const& mixer_cfg__,
+                  mixer::FunctionProperties<Periodic_function<double>> const& prop__,
+                  Periodic_function<double> const& t__, int num_steps__)
+{
+    auto& gv = ctx__.gvec();
+
+    auto mixer = mixer::Mixer_factory<Periodic_function<double>>(mixer_cfg__);
+
+    Periodic_function<double> f(ctx__);
+    mixer->initialize_function<0>(prop__, f, ctx__);
+
+    mix_result result;
+    for (int step = 0; step < num_steps__; step++) {
+        mixer->get_output<0>(f);
+        for (int igloc = 0; igloc < gv.count(); igloc++) {
+            double g2 = std::pow(gv.gvec_len<sddk::index_domain_t::local>(igloc), 2);
+            double c  = 0.8 - 1.6 / (1 + g2);
+            auto t    = t__.rg().f_pw_local(igloc);
+            f.rg().f_pw_local(igloc) = t + c * (f.rg().f_pw_local(igloc) - t);
+        }
+        f.rg().fft_transform(1);
+        mixer->set_input<0>(f);
+        result.rms.push_back(mixer->mix(1e-14));
+        if (result.rms.back() < 1e-12) {
+            break;
+        }
+    }
+    mixer->get_output<0>(f);
+
+    for (int igloc = 0; igloc < gv.count(); igloc++) {
+        result.f.push_back(f.rg().f_pw_local(igloc));
+    }
+    return result;
+}
+
+int test_mixer_hartree(cmd_args const& args__)
+{
+    auto pw_cutoff = args__.value<double>("pw_cutoff", 10);
+    auto num_steps = args__.value<int>("num_steps", 30);
+
+    auto ctx_ptr = create_context(pw_cutoff);
+    auto& ctx = *ctx_ptr;
+
+    /* fixed point of the SCF map */
+    Periodic_function<double> t(ctx);
+    auto& spfft = ctx.spfft<double>();
+    for (int z = 0; z < spfft.local_z_length(); z++) {
+        for (int y = 0; y < spfft.dim_y(); y++) {
+            for (int x = 0; x < spfft.dim_x(); x++) {
+                double rx = double(x) / spfft.dim_x();
+                double ry = double(y) / spfft.dim_y();
+                double rz = double(z + spfft.local_z_offset()) / spfft.dim_z();
+                int ir    = x + spfft.dim_x() * (y + spfft.dim_y() * z);
+                t.rg().value(ir) = std::exp(std::cos(twopi * rx) + 0.5 * std::sin(twopi * (ry + rz)));
+            }
+        }
+    }
+    t.rg().fft_transform(-1);
+
+    auto mixer_dict = create_mixer_dict();
+    config_t::mixer_t mixer_cfg(mixer_dict);
+    mixer_cfg.use_hartree(true);
+
+    /* the same properties with the linear combination expressed through copy, scal and axpy */
+    auto prop_fused = mixer::periodic_function_property_modified(false);
+    mixer::FunctionProperties<Periodic_function<double>> prop_ref(prop_fused.size, prop_fused.inner,
+            prop_fused.scal, prop_fused.copy, prop_fused.axpy, prop_fused.rotate, prop_fused.precondition);
+
+    int result{0};
+    for (auto const& mixer_name : mixer_names) {
+        mixer_cfg.type(mixer_name);
+
+        auto r1 = run_mixer_hartree(ctx, mixer_cfg, prop_fused, t, num_steps);
+        auto r0 = run_mixer_hartree(ctx, mixer_cfg, prop_ref, t, num_steps);
+
+        double diff_rms{0};
+        for (size_t i = 0; i < std::min(r0.rms.size(), r1.rms.size()); i++) {
+            diff_rms = std::max(diff_rms, std::abs(r0.rms[i] - r1.rms[i]) / std::max(r0.rms[i], 1e-14));
+        }
+        double diff_f{0};
+        double err_f{0};
+        for (int igloc = 0; igloc < ctx.gvec().count(); igloc++) {
+            diff_f = std::max(diff_f, std::abs(r0.f[igloc] - r1.f[igloc]));
+            /* the G=0 component is not controlled by the Hartree metric */
+            if (igloc != 0 || !ctx.gvec().skip_g0()) {
+                err_f = std::max(err_f, std::abs(r1.f[igloc] - t.rg().f_pw_local(igloc)));
+            }
+        }
+        ctx.comm().allreduce<double, mpi::op_t::max>(&diff_f, 1);
+        ctx.comm().allreduce<double, mpi::op_t::max>(&err_f, 1);
+
+        bool ok = (r0.rms.size() == r1.rms.size()) && diff_rms < 1e-8 && diff_f < 1e-10;
+        /* the linear mixer converges slowly; the others must reach the fixed point */
+        if (mixer_name != "linear") {
+            ok = ok && err_f < 1e-6;
+        }
+        if (ctx.comm().rank() == 0) {
+            std::printf("%-16s steps: %2i / %2i, rms: %12.6e, max. rel. diff. of rms: %12.6e, max. diff. of f: "
+                        "%12.6e, error of f: %12.6e : %s\n", mixer_name.c_str(), static_cast<int>(r1.rms.size()),
+                        static_cast<int>(r0.rms.size()), r1.rms.back(), diff_rms, diff_f, err_f,
+                        ok ? "OK" : "Fail");
+        }
+        if (!ok) {
+            result++;
+        }
+    }
+    return result;
+}
+
+/* Mix the plane-wave coefficients of a model charge density in the G-space mode. The SCF map is linear and mimics
+ * the charge sloshing of a metal, F(x) = x - a (1 + q_TF^2 / G^2) (x - t), with a fixed point t. The small-G
+ * components diverge for the plain mixing and are damped by the Kerker preconditioner. */
+mix_result
+run_mixer_gvec(config_t::mixer_t const& mixer_cfg__, std::shared_ptr<mixer::Mixer_gvec const> gv__,
+               mixer::Gvec_function const& t__, double qtf__, int num_steps__)
+{
+    auto mixer = mixer::Mixer_factory<mixer::Gvec_function>(mixer_cfg__);
+
+    /* the G=0 component is fixed by the number of electrons */
+    mixer::Gvec_function f(gv__, 1, false);
+    for (int i = 0; i < gv__->count(); i++) {
+        if (gv__->is_g0(i)) {
+            f.value(i, 0, t__.value(i, 0));
+        }
+    }
+    mixer->initialize_function<0>(mixer::gvec_function_property(mixer_cfg__, true), f, gv__, 1,
+                                  mixer_cfg__.history_fp32());
+
+    mix_result result;
+    for (int step = 0; step < num_steps__; step++) {
+        mixer->get_output<0>(f);
+        for (int i = 0; i < gv__->count(); i++) {
+            if (gv__->is_g0(i)) {
+                continue;
+            }
+            double g2 = std::pow(gv__->glen(i), 2);
+            auto t    = t__.value(i, 0);
+            f.value(i, 0, f.value(i, 0) - 0.8 * (1 + qtf__ * qtf__ / g2) * (f.value(i, 0) - t));
+        }
+        mixer->set_input<0>(f);
+        result.rms.push_back(mixer->mix(1e-14));
+        if (result.rms.back() < 1e-12) {
+            break;
+        }
+    }
+    mixer->get_output<0>(f);
+
+    for (int i = 0; i < gv__->count(); i++) {
+        result.f.push_back(f.value(i, 0));
+    }
+    return result;
+}
+
+int test_mixer_gvec(cmd_args const& args__)
+{
+    auto pw_cutoff = args__.value<double>("pw_cutoff", 10);
+    auto num_steps = args__.value<int>("num_steps", 60);
+    auto qtf       = args__.value<double>("qtf", 3);
+    auto precond   = args__.value<std::string>("preconditioner", "kerker");
+
+    auto ctx_ptr = create_context(pw_cutoff);
+    auto& ctx = *ctx_ptr;
+
+    auto gv = std::make_shared<mixer::Mixer_gvec const>(ctx.gvec(), pw_cutoff);
+
+    /* fixed point of the SCF map */
+    mixer::Gvec_function t(gv, 1, false);
+    for (int i = 0; i < gv->count(); i++) {
+        auto G = ctx.gvec().gvec<sddk::index_domain_t::local>(gv->igloc(i));
+        double g2 = std::pow(gv->glen(i), 2);
+        t.value(i, 0, std::exp(-g2 / 8) * std::complex<double>(1 + 0.3 * std::cos(G[0] + 2 * G[1]),
+                                                               0.2 * std::sin(G[2] - G[0])));
+    }
+    double tnorm{0};
+    for (int i = 0; i < gv->count(); i++) {
+        tnorm = std::max(tnorm, std::abs(t.value(i, 0)));
+    }
+    ctx.comm().allreduce<double, mpi::op_t::max>(&tnorm, 1);
+
+    auto mixer_dict = create_mixer_dict();
+    config_t::mixer_t mixer_cfg(mixer_dict);
+    mixer_cfg.gvec_mixing(true);
+    mixer_cfg.preconditioner(precond);
+
+    int result{0};
+    for (auto const& mixer_name : mixer_names) {
+        mixer_cfg.type(mixer_name);
+
+        mixer_cfg.history_fp32(false);
+        auto r64 = run_mixer_gvec(mixer_cfg, gv, t, qtf, num_steps);
+        mixer_cfg.history_fp32(true);
+        auto r32 = run_mixer_gvec(mixer_cfg, gv, t, qtf, num_steps);
+
+        double err64{0};
+        double err32{0};
+        double diff{0};
+        for (int i = 0; i < gv->count(); i++) {
+            err64 = std::max(err64, std::abs(r64.f[i] - t.value(i, 0)));
+            err32 = std::max(err32, std::abs(r32.f[i] - t.value(i, 0)));
+            diff  = std::max(diff, std::abs(r64.f[i] - r32.f[i]));
+        }
+        for (auto e : {&err64, &err32, &diff}) {
+            ctx.comm().allreduce<double, mpi::op_t::max>(e, 1);
+            *e /= tnorm;
+        }
+        /* the fp32 history follows the fp64 one until the residual reaches the single precision round-off */
+        double diff_rms{0};
+        for (size_t i = 0; i < std::min(r64.rms.size(), r32.rms.size()); i++) {
+            if (r64.rms[i] > 1e-4 * r64.rms[0]) {
+                diff_rms = std::max(diff_rms, std::abs(r64.rms[i] - r32.rms[i]) / r64.rms[i]);
+            }
+        }
+
+        /* the linear mixer converges slowly; the others must reach the fixed point */
+        double tol64 = (mixer_name == "linear") ? 1e-6 : 1e-10;
+        bool ok = err64 < tol64 && err32 < 1e-5 && diff < 1e-5 && diff_rms < 1e-3;
+        if (ctx.comm().rank() == 0) {
+            std::printf("%-16s steps (fp64 / fp32): %2i / %2i, rel. error of f (fp64 / fp32): %12.6e / %12.6e, "
+                        "rel. diff. of f: %12.6e, max. rel. diff. of rms: %12.6e : %s\n", mixer_name.c_str(),
+                        static_cast<int>(r64.rms.size()), static_cast<int>(r32.rms.size()), err64, err32, diff,
+                        diff_rms, ok ? "OK" : "Fail");
+        }
+        if (!ok) {
+            result++;
+        }
+    }
+    return result;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args(argn, argv, {{"pw_cutoff=", "(double) plane-wave cutoff for density and potential"},
+                               {"num_steps=", "(int) maximum number of mixing steps"},
+                               {"qtf=", "(double) Thomas-Fermi screening wave-vector of the model response"},
+                               {"preconditioner=", "(string) preconditioner of the residual in the G-space mode"}
+                              });
+
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+
+    sirius::initialize(1);
+    int result{0};
+    if (mpi::Communicator::world().rank() == 0) {
+        std::printf("Hartree-energy metric\n");
+    }
+    result += test_mixer_hartree(args);
+    if (mpi::Communicator::world().rank() == 0) {
+        std::printf("G-space mixing\n");
+    }
+    result += test_mixer_gvec(args);
+    sirius::finalize();
+    return result;
+}
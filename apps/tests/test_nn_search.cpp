@@ -0,0 +1,130 @@
+#include <sirius.hpp>
+
+using namespace sirius;
+
+/* compare direct and cell-list search of nearest neighbours on a growing N x N x N supercell of a
+ * distorted fcc lattice; check the closest neighbour found with the bounded search against the full list */
+void test_nn_search(int nmax__, double R__, int repeat__)
+{
+    std::printf("   N  num_atoms   direct (sec.)   cell_list (sec.)   speedup   closest (sec.)\n");
+    for (int N = 1; N <= nmax__; N++) {
+        Simulation_context ctx(R"({"parameters" : {"electronic_structure_method" : "pseudopotential"}})"_json);
+
+        double a{7.0};
+        ctx.unit_cell().set_lattice_vectors({N * a, 0.1, 0}, {0, N * a, 0.2}, {0.3, 0, N * a});
+        ctx.unit_cell().add_atom_type("A");
+
+        std::vector<r3::vector<double>> basis = {{0, 0, 0}, {0.5, 0.5, 0}, {0.5, 0, 0.5}, {0, 0.5, 0.5}};
+        for (int i0 = 0; i0 < N; i0++) {
+            for (int i1 = 0; i1 < N; i1++) {
+                for (int i2 = 0; i2 < N; i2++) {
+                    for (auto& b : basis) {
+                        r3::vector<double> p;
+                        for (int x : {0, 1, 2}) {
+                            p[x] = (r3::vector<int>(i0, i1, i2)[x] + b[x] + 0.01 * utils::random<double>()) / N;
+                        }
+                        ctx.unit_cell().add_atom("A", p);
+                    }
+                }
+            }
+        }
+        auto& uc = ctx.unit_cell();
+
+        std::vector<std::vector<nearest_neighbour_descriptor>> nn_ref(uc.num_atoms());
+
+        double t[3] = {0, 0, 0};
+        for (int k = 0; k < repeat__; k++) {
+            ctx.cfg().settings().nn_search("direct");
+            t[0] -= utils::wtime();
+            uc.find_nearest_neighbours(R__);
+            t[0] += utils::wtime();
+            for (int ia = 0; ia < uc.num_atoms(); ia++) {
+                nn_ref[ia].resize(uc.num_nearest_neighbours(ia));
+                for (int i = 0; i < uc.num_nearest_neighbours(ia); i++) {
+                    nn_ref[ia][i] = uc.nearest_neighbour(i, ia);
+                }
+            }
+
+            ctx.cfg().settings().nn_search("cell_list");
+            t[1] -= utils::wtime();
+            uc.find_nearest_neighbours(R__);
+            t[1] += utils::wtime();
+
+            t[2] -= utils::wtime();
+            uc.find_closest_neighbours();
+            t[2] += utils::wtime();
+        }
+
+        /* both methods must give the same ordered list of neighbours */
+        for (int ia = 0; ia < uc.num_atoms(); ia++) {
+            if (uc.num_nearest_neighbours(ia) != static_cast<int>(nn_ref[ia].size())) {
+                std::stringstream s;
+                s << "wrong number of nearest neighbours for atom " << ia << std::endl
+                  << "  direct: " << nn_ref[ia].size() << ", cell_list: " << uc.num_nearest_neighbours(ia);
+                RTE_THROW(s);
+            }
+            for (int i = 0; i < uc.num_nearest_neighbours(ia); i++) {
+                auto& nn = uc.nearest_neighbour(i, ia);
+                if (nn.atom_id != nn_ref[ia][i].atom_id || nn.translation != nn_ref[ia][i].translation ||
+                    nn.distance != nn_ref[ia][i].distance) {
+                    std::stringstream s;
+                    s << "nearest neighbour " << i << " of atom " << ia << " doesn't match";
+                    RTE_THROW(s);
+                }
+            }
+        }
+
+        /* the closest neighbour is the first one after the atom itself */
+        for (int ia = 0; ia < uc.num_atoms(); ia++) {
+            if (nn_ref[ia].size() > 1) {
+                auto& nn = uc.closest_neighbour(ia);
+                if (nn.atom_id != nn_ref[ia][1].atom_id || nn.translation != nn_ref[ia][1].translation ||
+                    nn.distance != nn_ref[ia][1].distance) {
+                    std::stringstream s;
+                    s << "closest neighbour of atom " << ia << " doesn't match";
+                    RTE_THROW(s);
+                }
+            }
+        }
+
+        /* an explicit radius below the bond length leaves the atoms without neighbours; the muffin-tin radii
+         * then fall back to rmt_max */
+        double d = uc.min_bond_length();
+        ctx.cfg().parameters().nn_radius(0.5 * d);
+        uc.find_closest_neighbours();
+        for (int ia = 0; ia < uc.num_atoms(); ia++) {
+            if (uc.closest_neighbour(ia).atom_id != -1) {
+                std::stringstream s;
+                s << "atom " << ia << " has a neighbour outside of the search radius";
+                RTE_THROW(s);
+            }
+        }
+        ctx.cfg().parameters().nn_radius(-1);
+        uc.find_closest_neighbours();
+        if (uc.min_bond_length() != d) {
+            RTE_THROW("wrong minimum bond length");
+        }
+
+        std::printf("%4i %10i %15.6f %18.6f %9.2f %16.6f\n", N, uc.num_atoms(), t[0] / repeat__, t[1] / repeat__,
+                    t[0] / t[1], t[2] / repeat__);
+    }
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+    args.register_key("--N=", "{int} maximum supercell size");
+    args.register_key("--R=", "{double} cluster radius");
+    args.register_key("--repeat=", "{int} number of repetitions");
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+
+    sirius::initialize(1);
+    test_nn_search(args.value<int>("N", 6), args.value<double>("R", 10), args.value<int>("repeat", 3));
+    sirius::finalize();
+}
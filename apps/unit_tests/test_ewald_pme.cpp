@@ -0,0 +1,139 @@
+#include <sirius.hpp>
+#include "testing.hpp"
+#include "dft/ewald.hpp"
+
+/* compare the reciprocal-space Ewald energy and forces of the particle-mesh Ewald method with the direct sum */
+
+using namespace sirius;
+
+int run_test(cmd_args const& args)
+{
+    auto json_conf = R"({
+      "parameters" : {
+        "electronic_structure_method" : "pseudopotential",
+        "use_symmetry" : false,
+        "pw_cutoff" : 20,
+        "gk_cutoff" : 6
+      }
+    })"_json;
+
+    /* distorted 2x2x2 supercell */
+    std::vector<r3::vector<double>> coord;
+    for (int i = 0; i < 2; i++) {
+        for (int j = 0; j < 2; j++) {
+            for (int k = 0; k < 2; k++) {
+                int n = coord.size();
+                coord.push_back(r3::vector<double>(0.5 * i + 0.013 * n, 0.5 * j + 0.021 * (n % 3),
+                                                   0.5 * k + 0.017 * (n % 5)));
+            }
+        }
+    }
+    auto ctx_ptr = create_simulation_context(json_conf, {{7.0, 0, 0}, {0.5, 8.0, 0}, {0, -0.3, 9.0}},
+                                             static_cast<int>(coord.size()), coord, false, false);
+    auto& ctx  = *ctx_ptr;
+    auto& gvec = ctx.gvec();
+    auto& uc   = ctx.unit_cell();
+
+    double alpha = ctx.ewald_lambda();
+    int ig0      = gvec.skip_g0();
+
+    std::vector<double> f(gvec.count(), 0);
+    for (int igloc = ig0; igloc < gvec.count(); igloc++) {
+        double g2 = std::pow(gvec.gvec_len<sddk::index_domain_t::local>(igloc), 2);
+        f[igloc]  = std::exp(-g2 / (4 * alpha)) / g2;
+    }
+
+    auto sf_direct = ewald_structure_factor(ctx, gvec);
+
+    Ewald_pme pme(ctx, 12);
+    auto sf_pme = pme.structure_factor();
+
+    double scale = (gvec.reduced() ? 2.0 : 1.0) * twopi / uc.omega();
+
+    double e_direct{0};
+    double e_pme{0};
+    for (int igloc = ig0; igloc < gvec.count(); igloc++) {
+        e_direct += scale * f[igloc] * std::norm(sf_direct[igloc]);
+        e_pme += scale * f[igloc] * std::norm(sf_pme[igloc]);
+    }
+    ctx.comm().allreduce(&e_direct, 1);
+    ctx.comm().allreduce(&e_pme, 1);
+
+    if (std::abs(e_direct - e_pme) > 1e-10) {
+        std::cout << "energy : " << e_direct << " " << e_pme << " diff : " << std::abs(e_direct - e_pme) << std::endl;
+        return 1;
+    }
+
+    /* direct reciprocal-space forces */
+    sddk::mdarray<double, 2> f_direct(3, uc.num_atoms());
+    f_direct.zero();
+    for (int ia = 0; ia < uc.num_atoms(); ia++) {
+        for (int igloc = ig0; igloc < gvec.count(); igloc++) {
+            auto G = gvec.gvec_cart<sddk::index_domain_t::local>(igloc);
+            auto z = std::conj(sf_direct[igloc]) *
+                     ctx.gvec_phase_factor(gvec.gvec<sddk::index_domain_t::local>(igloc), ia);
+            for (int x : {0, 1, 2}) {
+                f_direct(x, ia) += 2 * scale * f[igloc] * uc.atom(ia).zn() * z.imag() * G[x];
+            }
+        }
+    }
+    ctx.comm().allreduce(&f_direct(0, 0), static_cast<int>(f_direct.size()));
+
+    auto f_pme = pme.forces(sf_pme, f);
+
+    /* the interpolation error of the forces is compared with the largest force */
+    double diff{0};
+    double fmax{0};
+    for (int ia = 0; ia < uc.num_atoms(); ia++) {
+        for (int x : {0, 1, 2}) {
+            diff = std::max(diff, std::abs(f_direct(x, ia) - f_pme(x, ia)));
+            fmax = std::max(fmax, std::abs(f_direct(x, ia)));
+        }
+    }
+    if (diff > 1e-10 * fmax) {
+        std::cout << "maximum difference of forces : " << diff << ", maximum force : " << fmax << std::endl;
+        return 2;
+    }
+
+    /* the cached particle-mesh Ewald method of the context must follow the atomic positions */
+    json_conf["settings"]["ewald"]           = "pme";
+    json_conf["settings"]["ewald_pme_order"] = 12;
+    auto ctx_pme_ptr = create_simulation_context(json_conf, {{7.0, 0, 0}, {0.5, 8.0, 0}, {0, -0.3, 9.0}},
+                                                 static_cast<int>(coord.size()), coord, false, false);
+    auto& ctx_pme = *ctx_pme_ptr;
+    for (auto c : {&ctx, &ctx_pme}) {
+        c->unit_cell().atom(3).set_position(coord[3] + r3::vector<double>(0.031, -0.012, 0.007));
+        c->update();
+    }
+    sf_direct = ewald_structure_factor(ctx, gvec);
+    sf_pme    = ewald_structure_factor(ctx_pme, ctx_pme.gvec());
+    e_direct  = 0;
+    e_pme     = 0;
+    for (int igloc = ig0; igloc < gvec.count(); igloc++) {
+        e_direct += scale * f[igloc] * std::norm(sf_direct[igloc]);
+        e_pme += scale * f[igloc] * std::norm(sf_pme[igloc]);
+    }
+    ctx.comm().allreduce(&e_direct, 1);
+    ctx.comm().allreduce(&e_pme, 1);
+
+    if (std::abs(e_direct - e_pme) > 1e-10) {
+        std::cout << "energy after the update : " << e_direct << " " << e_pme << " diff : "
+                  << std::abs(e_direct - e_pme) << std::endl;
+        return 3;
+    }
+
+    return 0;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+
+    args.parse_args(argn, argv);
+
+    sirius::initialize(true);
+    auto result = call_test(argv[0], run_test, args);
+    sirius::finalize();
+
+    return result;
+}
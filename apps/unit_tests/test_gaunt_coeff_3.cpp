@@ -0,0 +1,137 @@
+#include <sirius.hpp>
+#include "testing.hpp"
+
+/* test of the packed storage of Gaunt coefficients and the benchmark of the contraction kernels against the
+   layout of separately allocated vectors of {lm3, l3, coef} structures */
+
+using namespace sirius;
+
+template <typename T>
+int test_gaunt_packed(std::function<T(int, int, int, int, int, int)> get__)
+{
+    int lmax1{4};
+    int lmax3{8};
+    int lmax2{4};
+
+    Gaunt_coefficients<T> gc(lmax1, lmax3, lmax2, get__);
+
+    std::vector<double> v(utils::lmmax(lmax3));
+    std::vector<std::complex<double>> z(utils::lmmax(lmax3));
+    for (int lm = 0; lm < utils::lmmax(lmax3); lm++) {
+        v[lm] = utils::random<double>();
+        z[lm] = utils::random<std::complex<double>>();
+    }
+
+    double diff{0};
+    for (int l1 = 0; l1 <= lmax1; l1++) {
+        for (int m1 = -l1; m1 <= l1; m1++) {
+            for (int l2 = 0; l2 <= lmax2; l2++) {
+                for (int m2 = -l2; m2 <= l2; m2++) {
+                    int lm1 = utils::lm(l1, m1);
+                    int lm2 = utils::lm(l2, m2);
+                    T s1{0};
+                    std::complex<double> s2{0};
+                    for (int l3 = 0; l3 <= lmax3; l3++) {
+                        for (int m3 = -l3; m3 <= l3; m3++) {
+                            T g = get__(l1, l3, l2, m1, m3, m2);
+                            s1 += g * v[utils::lm(l3, m3)];
+                            s2 += g * z[utils::lm(l3, m3)];
+                        }
+                    }
+                    diff += std::abs(s1 - gc.sum_L3_gaunt(lm1, lm2, v.data()));
+                    diff += std::abs(s2 - gc.sum_L3_gaunt(lm1, lm2, z.data()));
+                    for (int k = 0; k < gc.num_gaunt(lm1, lm2); k++) {
+                        auto g = gc.gaunt(lm1, lm2, k);
+                        diff += std::abs(g.coef - get__(l1, g.l3, l2, m1, g.lm3 - g.l3 * g.l3 - g.l3, m2));
+                    }
+                }
+            }
+        }
+    }
+    /* check the {lm3} : {lm1, lm2} grouping against the full tensor */
+    auto full = gc.get_full_set_L3();
+    for (int lm3 = 0; lm3 < utils::lmmax(lmax3); lm3++) {
+        for (int k = 0; k < gc.num_gaunt(lm3); k++) {
+            auto g = gc.gaunt(lm3, k);
+            diff += std::abs(g.coef - full(lm3, g.lm1, g.lm2));
+        }
+    }
+    return (diff < 1e-10) ? 0 : 1;
+}
+
+void bench()
+{
+    int lmax{8};
+    int lmmax = utils::lmmax(lmax);
+    int lmmax3 = utils::lmmax(2 * lmax);
+    int nrep{200};
+
+    Gaunt_coefficients<std::complex<double>> gc(lmax, 2 * lmax, lmax, SHT::gaunt_hybrid);
+
+    /* previous layout: one vector of structures for each pair of lm1 and lm2 */
+    sddk::mdarray<std::vector<gaunt_L3<std::complex<double>>>, 2> gc_aos(lmmax, lmmax);
+    for (int lm2 = 0; lm2 < lmmax; lm2++) {
+        for (int lm1 = 0; lm1 < lmmax; lm1++) {
+            for (int k = 0; k < gc.num_gaunt(lm1, lm2); k++) {
+                gc_aos(lm1, lm2).push_back(gc.gaunt(lm1, lm2, k));
+            }
+        }
+    }
+
+    std::vector<double> v(lmmax3);
+    for (int lm = 0; lm < lmmax3; lm++) {
+        v[lm] = utils::random<double>();
+    }
+
+    std::complex<double> s1{0};
+    double t0 = -utils::wtime();
+    for (int i = 0; i < nrep; i++) {
+        for (int lm2 = 0; lm2 < lmmax; lm2++) {
+            for (int lm1 = 0; lm1 < lmmax; lm1++) {
+                auto const& g = gc_aos(lm1, lm2);
+                for (size_t k = 0; k < g.size(); k++) {
+                    s1 += g[k].coef * v[g[k].lm3];
+                }
+            }
+        }
+    }
+    t0 += utils::wtime();
+
+    std::complex<double> s2{0};
+    double t1 = -utils::wtime();
+    for (int i = 0; i < nrep; i++) {
+        for (int lm2 = 0; lm2 < lmmax; lm2++) {
+            for (int lm1 = 0; lm1 < lmmax; lm1++) {
+                s2 += gc.sum_L3_gaunt(lm1, lm2, v.data());
+            }
+        }
+    }
+    t1 += utils::wtime();
+
+    std::cout << "vector of structures : " << t0 << " sec." << std::endl;
+    std::cout << "packed rows          : " << t1 << " sec." << std::endl;
+    std::cout << "difference           : " << std::abs(s1 - s2) << std::endl;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+    args.register_key("--bench", "run the benchmark of the packed storage against the vector of structures");
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+
+    if (args.exist("bench")) {
+        bench();
+        return 0;
+    }
+
+    int err{0};
+    err += call_test("packed <Rlm|Rlm|Rlm>", []() { return test_gaunt_packed<double>(SHT::gaunt_rrr); });
+    err += call_test("packed <Ylm|Rlm|Ylm>", []() { return test_gaunt_packed<std::complex<double>>(SHT::gaunt_hybrid); });
+    return std::min(err, 1);
+}
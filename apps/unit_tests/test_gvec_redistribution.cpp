@@ -0,0 +1,88 @@
+#include <sirius.hpp>
+#include "testing.hpp"
+
+/* redistribute plane-wave coefficients between an external list of G-vectors and the native distribution */
+
+using namespace sirius;
+
+/* test function with the property f(-G) = f(G)^{*} */
+std::complex<double> f(r3::vector<int> G__)
+{
+    return std::complex<double>(G__[0] * G__[0] + 2 * G__[1] * G__[1] + 3 * G__[2] * G__[2] + G__[0] * G__[1],
+                                G__[0] + 2 * G__[1] + 3 * G__[2]);
+}
+
+int test_redistribution(fft::Gvec const& gvec__)
+{
+    auto& comm = gvec__.comm();
+
+    /* external distribution: cyclic in the reverse order; in the reduced case every second G-vector is inverted */
+    std::vector<int> gvl;
+    std::vector<std::complex<double>> f_ext;
+    for (int ig = gvec__.num_gvec() - 1; ig >= 0; ig--) {
+        if (ig % comm.size() == comm.rank()) {
+            auto G = gvec__.gvec<sddk::index_domain_t::global>(ig);
+            if (gvec__.reduced() && ig % 2) {
+                G = G * (-1);
+            }
+            for (int x : {0, 1, 2}) {
+                gvl.push_back(G[x]);
+            }
+            f_ext.push_back(f(G));
+        }
+    }
+    int ngv = static_cast<int>(f_ext.size());
+
+    fft::Gvec_redistribution scatter_plan(gvec__, comm, ngv, gvl.data(), true);
+    std::vector<std::complex<double>> f_pw(gvec__.count());
+    scatter_plan.scatter(f_ext.data(), f_pw.data());
+
+    double diff{0};
+    for (int igloc = 0; igloc < gvec__.count(); igloc++) {
+        diff += std::abs(f_pw[igloc] - f(gvec__.gvec<sddk::index_domain_t::local>(igloc)));
+    }
+
+    fft::Gvec_redistribution gather_plan(gvec__, comm, ngv, gvl.data(), false);
+    std::vector<std::complex<double>> f_ext1(ngv);
+    gather_plan.gather(f_pw.data(), f_ext1.data());
+    for (int i = 0; i < ngv; i++) {
+        diff += std::abs(f_ext1[i] - f_ext[i]);
+    }
+    comm.allreduce(&diff, 1);
+
+    if (diff > 1e-12) {
+        std::cout << "difference : " << diff << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int run_test(cmd_args const& args)
+{
+    double cutoff = args.value<double>("cutoff", 10);
+
+    r3::matrix<double> M;
+    M(0, 0) = M(1, 1) = M(2, 2) = 1.0;
+    M(0, 1) = 0.1;
+    M(0, 2) = 0.2;
+    M(2, 0) = 0.3;
+
+    fft::Gvec gvec(M, cutoff, mpi::Communicator::world(), false);
+    fft::Gvec gvec_r(M, cutoff, mpi::Communicator::world(), true);
+
+    return test_redistribution(gvec) + test_redistribution(gvec_r);
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+    args.register_key("--cutoff=", "{double} cutoff radius in G-space");
+
+    args.parse_args(argn, argv);
+
+    sirius::initialize(true);
+    auto result = call_test(argv[0], run_test, args);
+    sirius::finalize();
+
+    return result;
+}
@@ -8,21 +8,24 @@
 using double_complex = std::complex<double>;
 using namespace sddk;
 
+/* type of the memory pool used in the tests */
+memory_pool_t pool_type{memory_pool_t::first_fit};
+
 void test1()
 {
-    memory_pool mp(memory_t::host);
+    memory_pool mp(memory_t::host, 0, pool_type);
 }
 
 void test2()
 {
-    memory_pool mp(memory_t::host);
+    memory_pool mp(memory_t::host, 0, pool_type);
     auto ptr = mp.allocate<double_complex>(1024);
     mp.free(ptr);
 }
 
 void test2a()
 {
-    memory_pool mp(memory_t::host);
+    memory_pool mp(memory_t::host, 0, pool_type);
     auto ptr = mp.allocate<double_complex>(1024);
     mp.free(ptr);
     ptr = mp.allocate<double_complex>(512);
@@ -31,7 +34,7 @@ void test2a()
 
 void test3()
 {
-    memory_pool mp(memory_t::host);
+    memory_pool mp(memory_t::host, 0, pool_type);
     auto p1 = mp.allocate<double_complex>(1024);
     auto p2 = mp.allocate<double_complex>(2024);
     auto p3 = mp.allocate<double_complex>(3024);
@@ -42,7 +45,7 @@ void test3()
 
 void test3a()
 {
-    memory_pool mp(memory_t::host);
+    memory_pool mp(memory_t::host, 0, pool_type);
     mp.allocate<double_complex>(1024);
     mp.allocate<double_complex>(2024);
     mp.allocate<double_complex>(3024);
@@ -51,7 +54,7 @@ void test3a()
 
 void test4()
 {
-    memory_pool mp(memory_t::host);
+    memory_pool mp(memory_t::host, 0, pool_type);
     mp.allocate<double_complex>(1024);
     mp.reset();
     mp.allocate<double_complex>(1024);
@@ -65,7 +68,7 @@ void test4()
 
 void test5()
 {
-    memory_pool mp(memory_t::host);
+    memory_pool mp(memory_t::host, 0, pool_type);
 
     for (int k = 0; k < 2; k++) {
         std::vector<double*> vp;
@@ -137,7 +140,7 @@ void test6()
             t0 += test_alloc(sz);
         }
     }
-    memory_pool mp(memory_t::host);
+    memory_pool mp(memory_t::host, 0, pool_type);
     double t1{0};
     for (int k = 0; k < 8; k++) {
         for (int i = 10; i < 30; i++) {
@@ -157,7 +160,7 @@ void test6a()
             t0 += test_alloc(sz);
         }
     }
-    memory_pool mp(memory_t::host);
+    memory_pool mp(memory_t::host, 0, pool_type);
     double t1{0};
     for (int k = 0; k < 500; k++) {
         for (int i = 2; i < 1024; i++) {
@@ -171,7 +174,7 @@ void test6a()
 
 void test7()
 {
-    memory_pool mp(memory_t::host);
+    memory_pool mp(memory_t::host, 0, pool_type);
 
     int N = 10000;
     std::vector<double*> v(N);
@@ -200,7 +203,7 @@ void test7()
 
 //void test8()
 //{
-//    memory_pool mp(memory_t::host);
+//    memory_pool mp(memory_t::host, 0, pool_type);
 //    mdarray<double_complex, 2> aa(mp, 100, 100);
 //    aa.deallocate(memory_t::host);
 //    //memory_pool::unique_ptr<double> up;
@@ -266,7 +269,7 @@ void test9()
             t0 += test_alloc_array(sz);
         }
     }
-    memory_pool mp(memory_t::host);
+    memory_pool mp(memory_t::host, 0, pool_type);
     double t1{0};
     for (int k = 0; k < 500; k++) {
         for (int i = 2; i < 1024; i++) {
@@ -277,26 +280,100 @@ void test9()
     std::cout << "std::malloc time: " << t0 << ", sddk::memory_pool time: " << t1 << "\n";
 }
 
+/* check the size classes and the statistics of the pool */
+void test10()
+{
+    for (size_t sz = 1; sz < (size_t(1) << 24); sz = sz * 3 / 2 + 1) {
+        int c = memory_size_classes::size_class(sz);
+        if (memory_size_classes::class_size(c) < sz) {
+            throw std::runtime_error("size class is too small");
+        }
+        if (c > 0 && memory_size_classes::class_size(c - 1) >= sz) {
+            throw std::runtime_error("size class is not the smallest one");
+        }
+    }
+
+#if defined(SIRIUS_USE_MEMORY_POOL)
+    memory_pool mp(memory_t::host, 0, pool_type);
+    auto p1 = mp.allocate<double>(1000);
+    auto p2 = mp.allocate<double>(3000);
+    size_t hwm = mp.high_water_mark();
+    if (hwm < 4000 * sizeof(double) || mp.used_size() != hwm) {
+        throw std::runtime_error("wrong high water mark");
+    }
+    mp.free(p1);
+    mp.free(p2);
+    if (mp.used_size() != 0 || mp.high_water_mark() != hwm) {
+        throw std::runtime_error("wrong used size");
+    }
+    /* memory of the freed chunk must be reused */
+    p1 = mp.allocate<double>(1000);
+    if (mp.total_size() - mp.free_size() > hwm) {
+        throw std::runtime_error("memory is not reused");
+    }
+    mp.free(p1);
+    if (mp.fragmentation() < 0 || mp.fragmentation() >= 1) {
+        throw std::runtime_error("wrong fragmentation");
+    }
+#endif
+}
+
+/* many short-lived allocations of random size with a few long-lived ones */
+void bench()
+{
+    int N = 1000;
+    int nrep = 1000;
+    for (auto t : {memory_pool_t::first_fit, memory_pool_t::size_class}) {
+        memory_pool mp(memory_t::host, 0, t);
+        std::vector<double*> v(N);
+        std::vector<size_t> sz(N);
+        for (int i = 0; i < N; i++) {
+            sz[i] = (utils::rand() & 0b11111111111111) + 1;
+        }
+        double t0 = wtime();
+        for (int k = 0; k < nrep; k++) {
+            for (int i = 0; i < N; i++) {
+                v[i] = mp.allocate<double>(sz[(i + k) % N]);
+            }
+            for (int i = 0; i < N; i += 2) {
+                mp.free(v[i]);
+            }
+            for (int i = 1; i < N; i += 2) {
+                mp.free(v[i]);
+            }
+        }
+        t0 = wtime() - t0;
+        std::cout << "pool type: " << (t == memory_pool_t::first_fit ? "first_fit " : "size_class")
+                  << ", time: " << t0 << " sec., total size: " << (mp.total_size() >> 20) << " Mb, "
+                  << "high water mark: " << (mp.high_water_mark() >> 20) << " Mb" << std::endl;
+    }
+}
+
 int run_test()
 {
-    test1();
-    test2();
-    test2a();
-    test3();
-    test3a();
-    test4();
-    test5();
-    //test6();
-    //test6a();
-    test7();
-    //test8();
-    //test9();
+    for (auto t : {memory_pool_t::first_fit, memory_pool_t::size_class}) {
+        pool_type = t;
+        test1();
+        test2();
+        test2a();
+        test3();
+        test3a();
+        test4();
+        test5();
+        //test6();
+        //test6a();
+        test7();
+        //test8();
+        //test9();
+        test10();
+    }
     return 0;
 }
 
 int main(int argn, char** argv)
 {
     cmd_args args;
+    args.register_key("--bench", "run the benchmark of the memory pools");
 
     args.parse_args(argn, argv);
     if (args.exist("help")) {
@@ -305,6 +382,11 @@ int main(int argn, char** argv)
         return 0;
     }
 
+    if (args.exist("bench")) {
+        bench();
+        return 0;
+    }
+
     printf("%-30s", "testing memory pool: ");
     int result = run_test();
     if (result) {
@@ -0,0 +1,79 @@
+#include <sirius.hpp>
+#include "testing.hpp"
+#include "radial/radial_integrals.hpp"
+
+/* store the tables of radial integrals in the cache file and read them back */
+
+using namespace sirius;
+
+int test_ri_cache()
+{
+    std::string fname("test_ri_cache.h5");
+
+    Radial_grid_lin<double> grid_q(300, 0, 30);
+
+    sddk::mdarray<Spline<double>, 2> v(2, 2);
+    v(0, 0) = Spline<double>(grid_q, [](double q) { return std::exp(-q / 5) * std::cos(q); });
+    v(1, 0) = Spline<double>(grid_q, [](double q) { return 1.0 / (1 + q * q); });
+    /* v(0, 1) is left empty */
+    v(1, 1) = Spline<double>(grid_q, [](double q) { return std::sin(q) / (1 + q); });
+
+    auto& comm = mpi::Communicator::self();
+
+    std::string label("test");
+    auto key = utils::hash128().update(label.data(), label.size()).digest();
+
+    save_radial_integrals(fname, key, grid_q, comm, v.at(sddk::memory_t::host), static_cast<int>(v.size()));
+
+    sddk::mdarray<Spline<double>, 2> v1(2, 2);
+    if (!load_radial_integrals(fname, key, grid_q, comm, v1.at(sddk::memory_t::host),
+                               static_cast<int>(v1.size()))) {
+        std::cout << "failed to load the radial integrals" << std::endl;
+        return 1;
+    }
+    if (v1(0, 1).num_points() != 0) {
+        std::cout << "empty spline is not preserved" << std::endl;
+        return 2;
+    }
+    for (int i = 0; i < 4; i++) {
+        if (i == 2) {
+            continue;
+        }
+        for (int iq = 0; iq < grid_q.num_points() - 1; iq++) {
+            double dq = 0.37 * grid_q.dx(iq);
+            if (v[i](iq, dq) != v1[i](iq, dq)) {
+                std::cout << "wrong interpolated value for spline " << i << " at q = " << grid_q[iq] + dq
+                          << std::endl;
+                return 3;
+            }
+        }
+    }
+
+    /* tables for a different q-grid must not be loaded */
+    Radial_grid_lin<double> grid_q1(300, 0, 31);
+    sddk::mdarray<Spline<double>, 2> v2(2, 2);
+    if (load_radial_integrals(fname, key, grid_q1, comm, v2.at(sddk::memory_t::host),
+                              static_cast<int>(v2.size()))) {
+        std::cout << "radial integrals are loaded for a different q-grid" << std::endl;
+        return 4;
+    }
+
+    /* tables for different input radial functions must not be loaded */
+    auto key1 = utils::hash128().update(label.data(), label.size() - 1).digest();
+    if (load_radial_integrals(fname, key1, grid_q, comm, v2.at(sddk::memory_t::host),
+                              static_cast<int>(v2.size()))) {
+        std::cout << "radial integrals are loaded for a different key of the inputs" << std::endl;
+        return 5;
+    }
+    std::remove(fname.c_str());
+
+    return 0;
+}
+
+int main(int argn, char** argv)
+{
+    sirius::initialize(true);
+    int result = call_test("test_ri_cache", test_ri_cache);
+    sirius::finalize();
+    return result;
+}
@@ -497,6 +497,34 @@ void test12()
     printf("        v2 - exact: %18.16f\n", std::abs(v2 - exact_val));
 }
 
+/* inner products through the integration weights must match sirius::inner() */
+void test13()
+{
+    printf("\n");
+    printf("test13: inner products with the integration weights of a spline\n");
+    int N = 1500;
+    Radial_grid_exp<double> r(N, 1e-6, 6);
+    Spline<double> g(r, [](double x){return x * std::exp(-x);});
+    for (int m = 0; m <= 2; m++) {
+        for (int np : {N, N / 2}) {
+            auto w = g.inner_weights(m, np);
+            for (int k = 1; k <= 3; k++) {
+                Spline<double> f(r, [k](double x){return std::sin(k * x) / x;});
+                double v1 = inner(f, g, m, np);
+                double v2{0};
+                for (int ir = 0; ir < N; ir++) {
+                    v2 += w[ir] * f(ir);
+                }
+                if (std::abs(v1 - v2) > 1e-12 * std::max(1.0, std::abs(v1))) {
+                    printf("wrong inner product for m = %i, num_points = %i: %18.12f %18.12f\n", m, np, v1, v2);
+                    exit(1);
+                }
+            }
+        }
+    }
+    printf("OK\n");
+}
+
 int main(int argn, char** argv)
 {
     sirius::initialize(1);
@@ -547,6 +575,7 @@ int main(int argn, char** argv)
 
     test11();
     test12();
+    test13();
 
     //for (int i = 0; i < 5; i++) {
     //    printf("grid type: %i\n", i);
@@ -0,0 +1,98 @@
+#include <vector>
+#include "SDDK/omp.hpp"
+#include "SDDK/memory.hpp"
+#include "utils/profiler.hpp"
+#include "testing.hpp"
+
+/* check that the team index is seen by all threads of the nested parallel regions */
+int run_test(cmd_args const& args)
+{
+    int num_teams = args.value<int>("num_teams", 2);
+    int num_inner = args.value<int>("num_inner", 2);
+
+    omp_set_num_threads(num_teams * num_inner);
+
+    std::vector<int> num_err(num_teams, 0);
+    std::vector<int> num_inner_threads(num_teams, 0);
+    std::vector<sddk::memory_pool*> pool(num_teams, nullptr);
+
+    sddk::run_in_thread_teams(num_teams, [&](int team) {
+        pool[team] = &sddk::get_memory_pool(sddk::memory_t::host);
+        #pragma omp parallel
+        {
+            #pragma omp single
+            num_inner_threads[team] = omp_get_num_threads();
+
+            if (sddk::thread_team_id() != team ||
+                &sddk::get_memory_pool(sddk::memory_t::host) != pool[team]) {
+                #pragma omp atomic update
+                num_err[team]++;
+            }
+        }
+    });
+
+    int result{0};
+    for (int t = 0; t < num_teams; t++) {
+        if (num_err[t]) {
+            printf("team %i: wrong team index or memory pool in %i of %i inner threads\n", t, num_err[t],
+                   num_inner_threads[t]);
+            result++;
+        }
+        if (num_inner_threads[t] != num_inner) {
+            printf("team %i: expected %i inner threads, got %i\n", t, num_inner, num_inner_threads[t]);
+            result++;
+        }
+        for (int t1 = 0; t1 < t; t1++) {
+            if (pool[t] == pool[t1]) {
+                printf("teams %i and %i share the memory pool\n", t1, t);
+                result++;
+            }
+        }
+    }
+    /* the timers of the nested threads of a team must not keep the timings of the previous team runs */
+    for (int it = 0; it < 3; it++) {
+        std::vector<int> num_stale(num_teams, 0);
+        sddk::run_in_thread_teams(num_teams, [&](int team) {
+            #pragma omp parallel
+            {
+                if (team != 0) {
+                    auto& timer = ::utils::rtgraph_timer();
+                    timer.start("test_thread_teams");
+                    timer.stop("test_thread_teams");
+                    if (timer.process().get_timings("test_thread_teams").size() != 1) {
+                        #pragma omp atomic update
+                        num_stale[team]++;
+                    }
+                }
+            }
+        });
+        for (int t = 0; t < num_teams; t++) {
+            if (num_stale[t]) {
+                printf("run %i, team %i: timings of the previous runs are kept in %i inner threads\n", it, t,
+                       num_stale[t]);
+                result++;
+            }
+        }
+    }
+    /* outside of the teams the main team is active */
+    if (sddk::thread_team_id() != 0 || &sddk::get_memory_pool(sddk::memory_t::host) != pool[0]) {
+        printf("wrong team index after the teams have finished\n");
+        result++;
+    }
+    return result;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+    args.register_key("--num_teams=", "{int} number of thread teams");
+    args.register_key("--num_inner=", "{int} number of threads in each team");
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+
+    return sirius::call_test(argv[0], run_test, args);
+}
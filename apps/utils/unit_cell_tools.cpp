@@ -339,7 +339,7 @@ int main(int argn, char** argv)
     if (args.exist("cif")) {
         Simulation_context ctx(args.value<std::string>("input", "sirius.json"), mpi::Communicator::self());
         ctx.unit_cell().write_cif();
-        ctx.unit_cell().find_nearest_neighbours(20);
+        ctx.unit_cell().find_closest_neighbours();
         std::printf("minimum bond length: %20.12f\n", ctx.unit_cell().min_bond_length());
     }
     if (args.exist("mol")) {
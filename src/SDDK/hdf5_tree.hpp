@@ -28,6 +28,7 @@
 #include <fstream>
 #include <hdf5.h>
 #include "memory.hpp"
+#include "mpi/communicator.hpp"
 
 namespace sddk {
 
@@ -110,6 +111,9 @@ class HDF5_tree
     /// True if this is a root node
     bool root_node_{true};
 
+    /// True if the file is opened with MPI-IO by all ranks of the communicator.
+    bool parallel_{false};
+
     /// Auxiliary class to handle HDF5 Group object
     class HDF5_group
     {
@@ -174,6 +178,14 @@ class HDF5_tree
             }
         }
 
+        /// Constructor which gets a copy of the dataspace of the existing dataset.
+        explicit HDF5_dataspace(hid_t dataset_id__)
+        {
+            if ((id_ = H5Dget_space(dataset_id__)) < 0) {
+                TERMINATE("error in H5Dget_space()");
+            }
+        }
+
         /// Destructor.
         ~HDF5_dataspace()
         {
@@ -230,13 +242,120 @@ class HDF5_tree
     };
 
     /// Constructor to create branches of the HDF5 tree.
-    HDF5_tree(hid_t file_id__, const std::string& path__)
+    HDF5_tree(hid_t file_id__, const std::string& path__, bool parallel__)
         : path_(path__)
         , file_id_(file_id__)
         , root_node_(false)
+        , parallel_(parallel__)
     {
     }
 
+    /// Open or create the file with the given file access property list.
+    void open(hdf5_access_t access__, hid_t fapl__)
+    {
+        if (H5open() < 0) {
+            TERMINATE("error in H5open()");
+        }
+
+        if (false) {
+            H5Eset_auto(H5E_DEFAULT, NULL, NULL);
+        }
+
+        switch (access__) {
+            case hdf5_access_t::truncate: {
+                file_id_ = H5Fcreate(file_name_.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, fapl__);
+                if (file_id_ < 0) {
+                    TERMINATE("error in H5Fcreate()");
+                }
+                break;
+            }
+            case hdf5_access_t::read_write: {
+                file_id_ = H5Fopen(file_name_.c_str(), H5F_ACC_RDWR, fapl__);
+                break;
+            }
+            case hdf5_access_t::read_only: {
+                file_id_ = H5Fopen(file_name_.c_str(), H5F_ACC_RDONLY, fapl__);
+                break;
+            }
+        }
+        if (file_id_ < 0) {
+            TERMINATE("H5Fopen() failed");
+        }
+
+        path_ = "/";
+    }
+
+    /// Select a hyperslab in the dataspace.
+    /** Offsets and sizes are given in the same order as the dimensions of the dataset. Empty size selects
+     *  nothing. */
+    static void select_hyperslab(hid_t space_id__, std::vector<int> const& offset__, std::vector<int> const& count__)
+    {
+        if (count__.empty()) {
+            if (H5Sselect_none(space_id__) < 0) {
+                TERMINATE("error in H5Sselect_none()");
+            }
+            return;
+        }
+        int n = static_cast<int>(count__.size());
+        std::vector<hsize_t> start(n);
+        std::vector<hsize_t> count(n);
+        for (int i = 0; i < n; i++) {
+            start[n - i - 1] = offset__[i];
+            count[n - i - 1] = count__[i];
+        }
+        if (H5Sselect_hyperslab(space_id__, H5S_SELECT_SET, start.data(), NULL, count.data(), NULL) < 0) {
+            TERMINATE("error in H5Sselect_hyperslab()");
+        }
+    }
+
+    /// Create dataset transfer property list.
+    /** Returns H5P_DEFAULT unless a collective transfer is requested for the file opened with MPI-IO. */
+    hid_t create_xfer_plist(bool collective__) const
+    {
+#if defined(H5_HAVE_PARALLEL)
+        if (parallel_ && collective__) {
+            hid_t plist = H5Pcreate(H5P_DATASET_XFER);
+            H5Pset_dxpl_mpio(plist, H5FD_MPIO_COLLECTIVE);
+            return plist;
+        }
+#endif
+        return H5P_DEFAULT;
+    }
+
+    /// Write or read a hyperslab of the existing dataset.
+    template <typename T>
+    void hyperslab_io(bool write__, std::string const& name__, T* data__, std::vector<int> const& offset__,
+                      std::vector<int> const& count__, bool collective__)
+    {
+        HDF5_group group(file_id_, path_);
+
+        HDF5_dataset dataset(group.id(), name__);
+
+        HDF5_dataspace file_space(dataset.id());
+        select_hyperslab(file_space.id(), offset__, count__);
+
+        HDF5_dataspace mem_space(count__.empty() ? std::vector<int>({1}) : count__);
+        if (count__.empty()) {
+            select_hyperslab(mem_space.id(), offset__, count__);
+        }
+
+        hid_t xfer = create_xfer_plist(collective__);
+        herr_t status;
+        if (write__) {
+            status = H5Dwrite(dataset.id(), hdf5_type_wrapper<T>::type_id(), mem_space.id(), file_space.id(), xfer,
+                              data__);
+        } else {
+            status = H5Dread(dataset.id(), hdf5_type_wrapper<T>::type_id(), mem_space.id(), file_space.id(), xfer,
+                             data__);
+        }
+        if (xfer != H5P_DEFAULT) {
+            H5Pclose(xfer);
+        }
+        if (status < 0) {
+            TERMINATE(write__ ? "error in H5Dwrite()" : "error in H5Dread()");
+        }
+    }
+
     /// Write a multidimensional array.
     template <typename T>
     void write(const std::string& name, T const* data, std::vector<int> const& dims)
@@ -281,36 +400,27 @@ class HDF5_tree
     HDF5_tree(const std::string& file_name__, hdf5_access_t access__)
         : file_name_(file_name__)
     {
-        if (H5open() < 0) {
-            TERMINATE("error in H5open()");
-        }
-
-        if (false) {
-            H5Eset_auto(H5E_DEFAULT, NULL, NULL);
-        }
+        open(access__, H5P_DEFAULT);
+    }
 
-        switch (access__) {
-            case hdf5_access_t::truncate: {
-                file_id_ = H5Fcreate(file_name_.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
-                if (file_id_ < 0) {
-                    TERMINATE("error in H5Fcreate()");
-                }
-                break;
-            }
-            case hdf5_access_t::read_write: {
-                file_id_ = H5Fopen(file_name_.c_str(), H5F_ACC_RDWR, H5P_DEFAULT);
-                break;
-            }
-            case hdf5_access_t::read_only: {
-                file_id_ = H5Fopen(file_name_.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
-                break;
-            }
-        }
-        if (file_id_ < 0) {
-            TERMINATE("H5Fopen() failed");
+    /// Constructor to create the HDF5 tree with the parallel (MPI-IO) access.
+    /** This is a collective call for all ranks of the communicator. Creation of groups and datasets is also
+     *  collective: all ranks must call create_node(), create_dataset() and write() with the same arguments.
+     *  Hyperslabs of the existing datasets can be written independently or collectively. */
+    HDF5_tree(const std::string& file_name__, hdf5_access_t access__, mpi::Communicator const& comm__)
+        : file_name_(file_name__)
+        , parallel_(true)
+    {
+#if defined(H5_HAVE_PARALLEL)
+        hid_t fapl = H5Pcreate(H5P_FILE_ACCESS);
+        if (H5Pset_fapl_mpio(fapl, comm__.native(), MPI_INFO_NULL) < 0) {
+            TERMINATE("error in H5Pset_fapl_mpio()");
         }
-
-        path_ = "/";
+        open(access__, fapl);
+        H5Pclose(fapl);
+#else
+        TERMINATE("HDF5 library is not compiled with the parallel support");
+#endif
     }
 
     /// Destructor.
@@ -457,10 +567,49 @@ class HDF5_tree
         read(name, &vec[0], (int)vec.size());
     }
 
+    /// Create a dataset of a given dimensions without writing the data.
+    /** Dimensions are given in the same order as for the mdarray (the fastest index goes first). */
+    template <typename T>
+    void create_dataset(std::string const& name__, std::vector<int> const& dims__)
+    {
+        HDF5_group group(file_id_, path_);
+
+        HDF5_dataspace dataspace(dims__);
+
+        HDF5_dataset dataset(group, dataspace, name__, hdf5_type_wrapper<T>::type_id());
+    }
+
+    /// Write a hyperslab of the existing dataset.
+    /** The hyperslab is given by the offset and size in each dimension of the dataset; data of the hyperslab is
+     *  packed in the buffer. Empty size means that this rank doesn't write anything, which is needed to take part
+     *  in the collective write. Collective write is only possible for the file opened with the parallel access,
+     *  otherwise the flag is ignored. */
+    template <typename T>
+    void write_hyperslab(std::string const& name__, T const* data__, std::vector<int> const& offset__,
+                         std::vector<int> const& count__, bool collective__ = false)
+    {
+        hyperslab_io(true, name__, const_cast<T*>(data__), offset__, count__, collective__);
+    }
+
+    /// Read a hyperslab of the existing dataset.
+    template <typename T>
+    void read_hyperslab(std::string const& name__, T* data__, std::vector<int> const& offset__,
+                        std::vector<int> const& count__, bool collective__ = false)
+    {
+        hyperslab_io(false, name__, data__, offset__, count__, collective__);
+    }
+
+    /// Check if the object with a given name exists at the current location.
+    bool exists(std::string const& name__) const
+    {
+        std::string name = path_ + name__;
+        return H5Lexists(file_id_, name.c_str(), H5P_DEFAULT) > 0;
+    }
+
     HDF5_tree operator[](const std::string& path__)
     {
         std::string new_path = path_ + path__ + "/";
-        return HDF5_tree(file_id_, new_path);
+        return HDF5_tree(file_id_, new_path, parallel_);
     }
 
     HDF5_tree operator[](int idx)
@@ -468,7 +617,7 @@ class HDF5_tree
         std::stringstream s;
         s << idx;
         std::string new_path = path_ + s.str() + "/";
-        return HDF5_tree(file_id_, new_path);
+        return HDF5_tree(file_id_, new_path, parallel_);
     }
 };
 
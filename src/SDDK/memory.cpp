@@ -1,17 +1,27 @@
 #include "memory.hpp"
+#include "utils/env.hpp"
+#include "omp.hpp"
+#include <mutex>
 
 namespace sddk {
 
 /// Return a memory pool.
-/** A memory pool is created when this function called for the first time. */
+/** A memory pool is created when this function called for the first time. The type of the pool is taken from
+ *  the SIRIUS_MEMORY_POOL environment variable. Each thread team gets its own set of pools. */
 sddk::memory_pool&
 get_memory_pool(sddk::memory_t M__)
 {
-    static std::map<sddk::memory_t, sddk::memory_pool> memory_pool_;
-    if (memory_pool_.count(M__) == 0) {
-        memory_pool_.emplace(M__, sddk::memory_pool(M__));
+    static std::map<std::pair<int, sddk::memory_t>, sddk::memory_pool> memory_pool_;
+    static std::mutex mtx;
+
+    auto key = std::make_pair(thread_team_id(), M__);
+
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = memory_pool_.find(key);
+    if (it == memory_pool_.end()) {
+        it = memory_pool_.emplace(key, sddk::memory_pool(M__, 0, get_memory_pool_t(env::get_memory_pool_type()))).first;
     }
-    return memory_pool_.at(M__);
+    return it->second;
 }
 
 } // namespace sddk
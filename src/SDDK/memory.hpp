@@ -28,6 +28,8 @@
 #include <list>
 #include <iostream>
 #include <map>
+#include <unordered_map>
+#include <vector>
 #include <memory>
 #include <cstring>
 #include <functional>
@@ -469,28 +471,259 @@ struct memory_subblock_descriptor
     uint8_t* unaligned_ptr_;
 };
 
+/// Type of the memory pool.
+enum class memory_pool_t
+{
+    /// Sub-blocks are allocated from a list of large memory blocks using the first-fit search.
+    first_fit,
+    /// Chunks of memory are rounded to a size class and recycled through the free lists of each class.
+    size_class
+};
+
+/// Get type of the memory pool from the string.
+inline memory_pool_t get_memory_pool_t(std::string name__)
+{
+    std::transform(name__.begin(), name__.end(), name__.begin(), ::tolower);
+    std::map<std::string, memory_pool_t> const m = {
+        {"first_fit", memory_pool_t::first_fit},
+        {"size_class", memory_pool_t::size_class}
+    };
+
+    if (m.count(name__) == 0) {
+        std::stringstream s;
+        s << "get_memory_pool_t(): wrong label of the memory_pool_t enumerator: " << name__;
+        throw std::runtime_error(s.str());
+     }
+     return m.at(name__);
+}
+
+/// Descriptor of the memory chunk of the size-class memory pool.
+struct memory_chunk_descriptor
+{
+    /// Storage buffer of the chunk.
+    std::unique_ptr<uint8_t, memory_t_deleter_base> buffer_;
+    /// Index of the size class.
+    int size_class_{0};
+    /// Number of bytes that were requested (used for the fragmentation statistics).
+    size_t size_requested_{0};
+};
+
+/// Free lists of memory chunks segregated by size.
+/** Requested sizes are rounded up to the size class. There are four size classes per power of two:
+ *  \f$ 2^k \cdot \{5,6,7,8\}/4 \f$, such that at most 25% of the allocated memory is lost to the rounding.
+ *  The smallest class is \f$ 2^8 \f$ bytes. The index of the class is computed in O(1) from the position of the
+ *  highest bit of the size. Chunks are never split or merged; a freed chunk is pushed to the free list of its
+ *  class and is reused by the next request of the same class. */
+class memory_size_classes
+{
+  private:
+    /// Smallest chunk size is 2^min_bits_ bytes.
+    static const int min_bits_{8};
+    /// Free chunks of each size class.
+    std::vector<std::vector<memory_chunk_descriptor>> free_chunks_;
+    /// Allocated chunks, indexed by the returned (aligned) pointer.
+    std::unordered_map<uint8_t*, memory_chunk_descriptor> used_chunks_;
+    /// Total size of all chunks.
+    size_t total_size_{0};
+    /// Total size of the free chunks.
+    size_t free_size_{0};
+    /// Total number of bytes requested by the allocated chunks.
+    size_t requested_size_{0};
+
+    /// Position of the highest non-zero bit.
+    static inline int highest_bit(size_t n__)
+    {
+#if defined(__GNUC__)
+        return 63 - __builtin_clzll(static_cast<unsigned long long>(n__));
+#else
+        int k{0};
+        while (n__ >>= 1) {
+            k++;
+        }
+        return k;
+#endif
+    }
+
+  public:
+    /// Return the index of size class for the given size in bytes.
+    static inline int size_class(size_t size__)
+    {
+        if (size__ <= (size_t(1) << min_bits_)) {
+            return 0;
+        }
+        size_t n = size__ - 1;
+        int k    = highest_bit(n);
+        int sub  = static_cast<int>((n >> (k - 2)) & 3);
+        return 1 + (k - min_bits_) * 4 + sub;
+    }
+
+    /// Return the size in bytes of the given size class.
+    static inline size_t class_size(int c__)
+    {
+        if (c__ == 0) {
+            return size_t(1) << min_bits_;
+        }
+        int k   = min_bits_ + (c__ - 1) / 4;
+        int sub = (c__ - 1) % 4;
+        return size_t(5 + sub) << (k - 2);
+    }
+
+    /// Get a chunk of at least size__ bytes.
+    /** Returns the unaligned pointer to the beginning of the chunk. The chunk is registered under the key that is
+     *  returned by the aligner function. */
+    template <typename F>
+    uint8_t* allocate(size_t size__, memory_t M__, F&& align__)
+    {
+        int c = size_class(size__);
+        if (static_cast<int>(free_chunks_.size()) <= c) {
+            free_chunks_.resize(c + 1);
+        }
+        memory_chunk_descriptor chunk;
+        if (free_chunks_[c].empty()) {
+            chunk.buffer_ = get_unique_ptr<uint8_t>(class_size(c), M__);
+            total_size_ += class_size(c);
+        } else {
+            chunk = std::move(free_chunks_[c].back());
+            free_chunks_[c].pop_back();
+            free_size_ -= class_size(c);
+        }
+        chunk.size_class_     = c;
+        chunk.size_requested_ = size__;
+        requested_size_ += size__;
+
+        auto ptr = chunk.buffer_.get();
+        used_chunks_[align__(ptr)] = std::move(chunk);
+        return ptr;
+    }
+
+    /// Return the chunk to the free list of its size class.
+    void free(uint8_t* ptr__)
+    {
+        auto it = used_chunks_.find(ptr__);
+        if (it == used_chunks_.end()) {
+            throw std::runtime_error("memory_size_classes::free(): pointer is not found");
+        }
+        int c = it->second.size_class_;
+        requested_size_ -= it->second.size_requested_;
+        free_size_ += class_size(c);
+        free_chunks_[c].push_back(std::move(it->second));
+        used_chunks_.erase(it);
+    }
+
+    /// Move all allocated chunks to the free lists.
+    void reset()
+    {
+        for (auto& e : used_chunks_) {
+            free_chunks_[e.second.size_class_].push_back(std::move(e.second));
+        }
+        used_chunks_.clear();
+        free_size_      = total_size_;
+        requested_size_ = 0;
+    }
+
+    /// Release all memory.
+    void clear()
+    {
+        free_chunks_.clear();
+        used_chunks_.clear();
+        total_size_     = 0;
+        free_size_      = 0;
+        requested_size_ = 0;
+    }
+
+    inline size_t total_size() const
+    {
+        return total_size_;
+    }
+
+    inline size_t free_size() const
+    {
+        return free_size_;
+    }
+
+    inline size_t requested_size() const
+    {
+        return requested_size_;
+    }
+
+    /// Return the number of free chunks.
+    size_t num_free_chunks() const
+    {
+        size_t n{0};
+        for (auto& e : free_chunks_) {
+            n += e.size();
+        }
+        return n;
+    }
+
+    inline size_t num_used_chunks() const
+    {
+        return used_chunks_.size();
+    }
+
+    void print() const
+    {
+        for (int c = 0; c < static_cast<int>(free_chunks_.size()); c++) {
+            if (free_chunks_[c].size()) {
+                std::cout << "size class: " << c << ", chunk size: " << class_size(c)
+                          << ", free chunks: " << free_chunks_[c].size() << "\n";
+            }
+        }
+    }
+};
+
 //// Memory pool.
-/** This class stores list of allocated memory blocks. Each of the blocks can be divided into subblocks. When subblock
- *  is deallocated it is merged with previous or next free subblock in the memory block. If this was the last subblock
- *  in the block of memory, the (now) free block of memory is merged with the neighbours (if any are available).
+/** In the default (first-fit) mode this class stores list of allocated memory blocks. Each of the blocks can be
+ *  divided into subblocks. When subblock is deallocated it is merged with previous or next free subblock in the
+ *  memory block. If this was the last subblock in the block of memory, the (now) free block of memory is merged
+ *  with the neighbours (if any are available).
+ *
+ *  In the size-class mode the memory is handled by sddk::memory_size_classes: allocation and deallocation don't
+ *  scan the list of blocks and the lookup of the pointer is done in a hash table. This is faster for a large
+ *  number of short-lived temporary arrays at the cost of some memory lost to the rounding of sizes.
  */
 class memory_pool
 {
   private:
     /// Type of memory that is handeled by this pool.
     memory_t M_;
+    /// Type of the pool.
+    memory_pool_t type_{memory_pool_t::first_fit};
     /// List of blocks of allocated memory.
     std::list<memory_block_descriptor> memory_blocks_;
     /// Mapping between an allocated pointer and a subblock descriptor.
     std::map<uint8_t*, memory_subblock_descriptor> map_ptr_;
+    /// Free lists of the size-class pool.
+    memory_size_classes size_classes_;
+    /// Size of the currently allocated memory, including the alignment and rounding.
+    size_t used_size_{0};
+    /// Maximum size of the allocated memory.
+    size_t high_water_mark_{0};
+
+    /// Align the pointer.
+    static inline uint8_t* align_ptr(uint8_t* ptr__, size_t align_size__)
+    {
+        auto uip = reinterpret_cast<std::uintptr_t>(ptr__);
+        if (uip % align_size__) {
+            uip += (align_size__ - uip % align_size__);
+        }
+        return reinterpret_cast<uint8_t*>(uip);
+    }
+
+    inline void update_used_size(size_t size__)
+    {
+        used_size_ += size__;
+        high_water_mark_ = std::max(high_water_mark_, used_size_);
+    }
 
   public:
 
     /// Constructor
-    memory_pool(memory_t M__, size_t initial_size__ = 0)
+    memory_pool(memory_t M__, size_t initial_size__ = 0, memory_pool_t type__ = memory_pool_t::first_fit)
         : M_(M__)
+        , type_(type__)
     {
-        if (initial_size__) {
+        if (initial_size__ && type_ == memory_pool_t::first_fit) {
             memory_blocks_.push_back(memory_block_descriptor(initial_size__, M_));
         }
     }
@@ -505,6 +738,16 @@ class memory_pool
         /* size of the memory block in bytes */
         size_t size = num_elements__ * sizeof(T) + align_size;
 
+        if (type_ == memory_pool_t::size_class) {
+            uint8_t* aligned_ptr{nullptr};
+            size_classes_.allocate(size, M_, [&](uint8_t* ptr) {
+                aligned_ptr = align_ptr(ptr, align_size);
+                return aligned_ptr;
+            });
+            update_used_size(memory_size_classes::class_size(memory_size_classes::size_class(size)));
+            return reinterpret_cast<T*>(aligned_ptr);
+        }
+
         uint8_t* ptr{nullptr};
 
         /* iterate over existing blocks */
@@ -550,14 +793,11 @@ class memory_pool
         msb.size_ = size;
         /* beginning of the block (unaligned) */
         msb.unaligned_ptr_ = ptr;
-        auto uip = reinterpret_cast<std::uintptr_t>(ptr);
         /* align the pointer */
-        if (uip % align_size) {
-            uip += (align_size - uip % align_size);
-        }
-        auto aligned_ptr = reinterpret_cast<uint8_t*>(uip);
+        auto aligned_ptr = align_ptr(ptr, align_size);
         /* add to the hash table */
         map_ptr_[aligned_ptr] = msb;
+        update_used_size(size);
         return reinterpret_cast<T*>(aligned_ptr);
 #else
         return sddk::allocate<T>(num_elements__, M_);
@@ -569,8 +809,15 @@ class memory_pool
     {
 #if defined(SIRIUS_USE_MEMORY_POOL)
         auto ptr = reinterpret_cast<uint8_t*>(ptr__);
+        if (type_ == memory_pool_t::size_class) {
+            size_t used = size_classes_.total_size() - size_classes_.free_size();
+            size_classes_.free(ptr);
+            used_size_ -= used - (size_classes_.total_size() - size_classes_.free_size());
+            return;
+        }
         /* get a descriptor of this pointer */
         auto& msb = map_ptr_.at(ptr);
+        used_size_ -= msb.size_;
         /* free the sub-block */
         msb.it_->free_subblock(msb.unaligned_ptr_, msb.size_);
         /* remove this pointer from the hash table */
@@ -600,23 +847,31 @@ class memory_pool
             it->free_subblocks_.push_back(std::make_pair(0, it->size_));
         }
         map_ptr_.clear();
+        size_classes_.reset();
+        used_size_ = 0;
     }
 
     /// Clear memory pool and release all memory.
     void clear()
     {
         memory_blocks_.clear();
+        size_classes_.clear();
     }
 
     void print()
     {
         std::cout << "--- memory pool status ---\n";
-        int i{0};
-        for (auto& e: memory_blocks_) {
-            std::cout << "memory block: " << i << ", capacity: " << e.size_
-                      << ", free size: " << e.get_free_size() << "\n";
-            i++;
+        if (type_ == memory_pool_t::size_class) {
+            size_classes_.print();
+        } else {
+            int i{0};
+            for (auto& e: memory_blocks_) {
+                std::cout << "memory block: " << i << ", capacity: " << e.size_
+                          << ", free size: " << e.get_free_size() << "\n";
+                i++;
+            }
         }
+        std::cout << "high water mark: " << high_water_mark_ << ", fragmentation: " << fragmentation() << "\n";
     }
 
     /// Return the type of memory this pool is managing.
@@ -625,9 +880,18 @@ class memory_pool
         return M_;
     }
 
+    /// Return the type of the pool.
+    inline memory_pool_t type() const
+    {
+        return type_;
+    }
+
     /// Return the total capacity of the memory pool.
     size_t total_size() const
     {
+        if (type_ == memory_pool_t::size_class) {
+            return size_classes_.total_size();
+        }
         size_t s{0};
         for (auto it = memory_blocks_.begin(); it != memory_blocks_.end(); it++) {
             s += it->size_;
@@ -638,6 +902,9 @@ class memory_pool
     /// Get the total free size of the memory pool.
     size_t free_size() const
     {
+        if (type_ == memory_pool_t::size_class) {
+            return size_classes_.free_size();
+        }
         size_t s{0};
         for (auto it = memory_blocks_.begin(); it != memory_blocks_.end(); it++) {
             s += it->get_free_size();
@@ -646,8 +913,12 @@ class memory_pool
     }
 
     /// Get the number of free memory blocks.
+    /** In the size-class mode this is the number of free chunks. */
     size_t num_blocks() const
     {
+        if (type_ == memory_pool_t::size_class) {
+            return size_classes_.num_free_chunks();
+        }
         size_t s{0};
         for (auto it = memory_blocks_.begin(); it != memory_blocks_.end(); it++) {
             s += it->free_subblocks_.size();
@@ -658,8 +929,44 @@ class memory_pool
     /// Get the number of stored pointers.
     size_t num_stored_ptr() const
     {
+        if (type_ == memory_pool_t::size_class) {
+            return size_classes_.num_used_chunks();
+        }
         return map_ptr_.size();
     }
+
+    /// Get the size of currently allocated memory.
+    inline size_t used_size() const
+    {
+        return used_size_;
+    }
+
+    /// Get the maximum size of allocated memory since the creation of the pool.
+    inline size_t high_water_mark() const
+    {
+        return high_water_mark_;
+    }
+
+    /// Get the fraction of memory that is wasted.
+    /** In the first-fit mode this is the external fragmentation: the fraction of free memory that doesn't belong
+     *  to the largest free sub-block. In the size-class mode this is the internal fragmentation: the fraction of
+     *  allocated memory that was added by the rounding to the size class. */
+    double fragmentation() const
+    {
+        if (type_ == memory_pool_t::size_class) {
+            size_t used = size_classes_.total_size() - size_classes_.free_size();
+            return used ? 1.0 - static_cast<double>(size_classes_.requested_size()) / used : 0.0;
+        }
+        size_t max_free{0};
+        size_t free{0};
+        for (auto& e : memory_blocks_) {
+            for (auto& b : e.free_subblocks_) {
+                max_free = std::max(max_free, b.second);
+                free += b.second;
+            }
+        }
+        return free ? 1.0 - static_cast<double>(max_free) / free : 0.0;
+    }
 };
 
 void memory_pool_deleter::memory_pool_deleter_impl::free(void* ptr__)
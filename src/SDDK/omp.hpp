@@ -25,6 +25,8 @@
 #ifndef __OMP_HPP__
 #define __OMP_HPP__
 
+#include <algorithm>
+
 #if defined(_OPENMP)
 
 #include <omp.h>
@@ -55,6 +57,86 @@ inline double omp_get_wtime()
     return 0;
 }
 
+inline void omp_set_num_threads(int n)
+{
+}
+
+inline int omp_get_max_active_levels()
+{
+    return 1;
+}
+
+inline void omp_set_max_active_levels(int n)
+{
+}
+
+inline int omp_get_level()
+{
+    return 0;
+}
+
+inline int omp_get_ancestor_thread_num(int level)
+{
+    return 0;
+}
+
 #endif
 
+namespace sddk {
+
+/// Nesting level of the parallel region in which the thread teams are running.
+/** Zero if there are no active thread teams. */
+inline int& thread_team_level()
+{
+    static int level{0};
+    return level;
+}
+
+/// Number of completed calls to run_in_thread_teams().
+/** Per-thread data of the teams (e.g. the timers) that was created before the last call has finished is stale
+ *  and can be discarded by the thread that owns it. */
+inline int& thread_team_generation()
+{
+    static int generation{0};
+    return generation;
+}
+
+/// Index of the thread team to which the calling thread belongs.
+/** Teams are used to process several k-points concurrently. The main team has index 0; the other teams have
+ *  their own memory pools, SPLA contexts and timers. The index is the number of the ancestor thread at the level
+ *  of the team region, so it is also valid in the parallel regions nested inside a team. */
+inline int thread_team_id()
+{
+    int level = thread_team_level();
+    if (level == 0 || omp_get_level() < level) {
+        return 0;
+    }
+    return omp_get_ancestor_thread_num(level);
+}
+
+/// Run a function in a number of concurrent thread teams.
+/** The function is called by the master thread of each team with the index of the team. The available threads
+ *  are split between the teams and nested parallelism is enabled for the duration of the call. */
+template <typename F>
+inline void run_in_thread_teams(int num_teams__, F&& f__)
+{
+    int num_threads = omp_get_max_threads();
+    int max_levels  = omp_get_max_active_levels();
+    omp_set_max_active_levels(std::max(max_levels, omp_get_level() + 2));
+
+    thread_team_level() = omp_get_level() + 1;
+    #pragma omp parallel num_threads(num_teams__)
+    {
+        /* split the remaining threads between the teams */
+        omp_set_num_threads(std::max(1, num_threads / num_teams__));
+        f__(omp_get_thread_num());
+    }
+    thread_team_level() = 0;
+    thread_team_generation()++;
+
+    omp_set_max_active_levels(max_levels);
+}
+
+} // namespace sddk
+
 #endif
@@ -315,6 +315,42 @@ get_ks(void* const* h)
     return static_cast<utils::any_ptr*>(*h)->get<sirius::K_point_set>();
 }
 
+/// Cached plans to redistribute the plane-wave coefficients between the host code and SIRIUS.
+/** A plan is identified by the native set of G-vectors, the Fortran handler of the host communicator and the
+ *  direction of the exchange. It is rebuilt if the local list of Miller indices changes on any rank. */
+struct pw_coeffs_plan_t
+{
+    std::unique_ptr<fft::Gvec_redistribution> plan;
+    int ngv{-1};
+    uint64_t hash{0};
+};
+
+static std::map<std::tuple<fft::Gvec const*, int, bool>, pw_coeffs_plan_t> pw_coeffs_plans;
+
+/// Return a redistribution plan for the host list of G-vectors.
+/** Coefficients are scattered within the host communicator and gathered within the communicator of G-vectors. */
+static fft::Gvec_redistribution const&
+get_pw_coeffs_plan(fft::Gvec const& gvec__, int fcomm__, int ngv__, int const* gvl__, bool scatter__)
+{
+    mpi::Communicator comm(MPI_Comm_f2c(fcomm__));
+    auto const& comm_exch = scatter__ ? comm : gvec__.comm();
+
+    auto h   = utils::hash(gvl__, 3 * ngv__ * sizeof(int));
+    auto key = std::make_tuple(&gvec__, fcomm__, scatter__);
+
+    int rebuild = (!pw_coeffs_plans.count(key) || pw_coeffs_plans[key].ngv != ngv__ ||
+                   pw_coeffs_plans[key].hash != h) ? 1 : 0;
+    comm_exch.allreduce<int, mpi::op_t::max>(&rebuild, 1);
+
+    if (rebuild) {
+        auto& p = pw_coeffs_plans[key];
+        p.plan  = std::make_unique<fft::Gvec_redistribution>(gvec__, comm_exch, ngv__, gvl__, scatter__);
+        p.ngv   = ngv__;
+        p.hash  = h;
+    }
+    return *pw_coeffs_plans.at(key).plan;
+}
+
 /// Index of Rlm in QE in the block of lm coefficients for a given l.
 static inline int
 idx_m_qe(int m__)
@@ -1263,6 +1299,8 @@ sirius_free_object_handler(void** handler__, int* error_code__)
         [&]() {
             if (*handler__ != nullptr) {
                 delete static_cast<utils::any_ptr*>(*handler__);
+                /* plans may refer to the G-vectors of the deleted object */
+                pw_coeffs_plans.clear();
             }
             *handler__ = nullptr;
         },
@@ -2573,38 +2611,19 @@ sirius_set_pw_coeffs(void* const* handler__, char const* label__, std::complex<d
                 assert(gvl__ != nullptr);
                 assert(comm__ != nullptr);
 
-                mpi::Communicator comm(MPI_Comm_f2c(*comm__));
-                sddk::mdarray<int, 2> gvec(gvl__, 3, *ngv__);
+                auto& plan = get_pw_coeffs_plan(gs.ctx().gvec(), *comm__, *ngv__, gvl__, true);
 
-                std::vector<std::complex<double>> v(gs.ctx().gvec().num_gvec(), 0);
-                #pragma omp parallel for schedule(static)
-                for (int i = 0; i < *ngv__; i++) {
+                if (gs.ctx().gamma_point() && plan.missing().size()) {
+                    sddk::mdarray<int, 2> gvec(gvl__, 3, *ngv__);
+                    int i = plan.missing().front();
                     r3::vector<int> G(gvec(0, i), gvec(1, i), gvec(2, i));
-                    // auto gvc = gs.ctx().unit_cell().reciprocal_lattice_vectors() * r3::vector<double>(G[0], G[1],
-                    // G[2]); if (gvc.length() > gs.ctx().pw_cutoff()) {
-                    //    continue;
-                    //}
-                    int ig = gs.ctx().gvec().index_by_gvec(G);
-                    if (ig >= 0) {
-                        v[ig] = pw_coeffs__[i];
-                    } else {
-                        if (gs.ctx().gamma_point()) {
-                            ig = gs.ctx().gvec().index_by_gvec(G * (-1));
-                            if (ig == -1) {
-                                std::stringstream s;
-                                auto gvc = dot(gs.ctx().unit_cell().reciprocal_lattice_vectors(),
-                                               r3::vector<double>(G[0], G[1], G[2]));
-                                s << "wrong index of G-vector" << std::endl
-                                  << "input G-vector: " << G << " (length: " << gvc.length() << " [a.u.^-1])"
-                                  << std::endl;
-                                RTE_THROW(s);
-                            } else {
-                                v[ig] = std::conj(pw_coeffs__[i]);
-                            }
-                        }
-                    }
+                    std::stringstream s;
+                    auto gvc = dot(gs.ctx().unit_cell().reciprocal_lattice_vectors(),
+                                   r3::vector<double>(G[0], G[1], G[2]));
+                    s << "wrong index of G-vector" << std::endl
+                      << "input G-vector: " << G << " (length: " << gvc.length() << " [a.u.^-1])" << std::endl;
+                    RTE_THROW(s);
                 }
-                comm.allreduce(v.data(), gs.ctx().gvec().num_gvec());
 
                 std::map<std::string, sirius::Smooth_periodic_function<double>*> func = {
                     {"rho", &gs.density().rho().rg()},
@@ -2625,7 +2644,7 @@ sirius_set_pw_coeffs(void* const* handler__, char const* label__, std::complex<d
                     RTE_THROW("wrong label: " + label);
                 }
 
-                func.at(label)->scatter_f_pw(v);
+                plan.scatter(pw_coeffs__, &func.at(label)->f_pw_local(0));
 
                 if (transform_to_rg__ && *transform_to_rg__) {
                     func.at(label)->fft_transform(1);
@@ -2688,9 +2707,6 @@ sirius_get_pw_coeffs(void* const* handler__, char const* label__, std::complex<d
                 assert(gvl__ != NULL);
                 assert(comm__ != NULL);
 
-                mpi::Communicator comm(MPI_Comm_f2c(*comm__));
-                sddk::mdarray<int, 2> gvec(gvl__, 3, *ngv__);
-
                 std::map<std::string, sirius::Smooth_periodic_function<double>*> func = {
                     {"rho", &gs.density().rho().rg()},
                     {"magz", &gs.density().mag(0).rg()},
@@ -2703,40 +2719,21 @@ sirius_get_pw_coeffs(void* const* handler__, char const* label__, std::complex<d
                 if (!func.count(label)) {
                     RTE_THROW("wrong label: " + label);
                 }
-                auto v = func.at(label)->gather_f_pw();
+                auto& plan = get_pw_coeffs_plan(gs.ctx().gvec(), *comm__, *ngv__, gvl__, false);
 
-                for (int i = 0; i < *ngv__; i++) {
+                if (plan.missing().size()) {
+                    sddk::mdarray<int, 2> gvec(gvl__, 3, *ngv__);
+                    int i = plan.missing().front();
                     r3::vector<int> G(gvec(0, i), gvec(1, i), gvec(2, i));
-
-                    // auto gvc = gs.ctx().unit_cell().reciprocal_lattice_vectors() * r3::vector<double>(G[0], G[1],
-                    // G[2]); if (gvc.length() > gs.ctx().pw_cutoff()) {
-                    //    pw_coeffs__[i] = 0;
-                    //    continue;
-                    //}
-
-                    bool is_inverse{false};
-                    int ig = gs.ctx().gvec().index_by_gvec(G);
-                    if (ig == -1 && gs.ctx().gvec().reduced()) {
-                        ig         = gs.ctx().gvec().index_by_gvec(G * (-1));
-                        is_inverse = true;
-                    }
-                    if (ig == -1) {
-                        std::stringstream s;
-                        auto gvc =
-                            dot(gs.ctx().unit_cell().reciprocal_lattice_vectors(), r3::vector<double>(G[0], G[1], G[2]));
-                        s << "wrong index of G-vector" << std::endl
-                          << "input G-vector: " << G << " (length: " << gvc.length() << " [a.u.^-1])" << std::endl;
-                        WARNING(s);
-                        pw_coeffs__[i] = 0;
-                        //RTE_THROW(s);
-                    } else {
-                        if (is_inverse) {
-                            pw_coeffs__[i] = std::conj(v[ig]);
-                        } else {
-                            pw_coeffs__[i] = v[ig];
-                        }
-                    }
+                    std::stringstream s;
+                    auto gvc =
+                        dot(gs.ctx().unit_cell().reciprocal_lattice_vectors(), r3::vector<double>(G[0], G[1], G[2]));
+                    s << "wrong index of G-vector" << std::endl
+                      << "input G-vector: " << G << " (length: " << gvc.length() << " [a.u.^-1])" << std::endl;
+                    WARNING(s);
                 }
+
+                plan.gather(&func.at(label)->f_pw_local(0), pw_coeffs__);
             }
         },
         error_code__);
@@ -0,0 +1,428 @@
+// Copyright (c) 2013-2023 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file chebyshev.hpp
+ *
+ *  \brief Chebyshev-filtered subspace iteration solver.
+ */
+
+#ifndef __CHEBYSHEV_HPP__
+#define __CHEBYSHEV_HPP__
+
+#include "davidson.hpp"
+#include "linalg/eigenproblem.hpp"
+
+namespace sirius {
+
+/// Estimate the upper bound of the Hamiltonian spectrum with a few steps of the Lanczos algorithm.
+/** The bound is the largest eigen-value of the Lanczos tridiagonal matrix plus the norm of the last
+ *  Lanczos residual vector (Y. Zhou and R.-C. Li, Linear Algebra Appl. 435, 480 (2011)).
+ */
+template <typename T, typename F>
+inline double
+estimate_spectrum_upper_bound(Hamiltonian_k<T>& Hk__, wf::spin_range sr__, wf::num_mag_dims num_md__,
+        int num_steps__)
+{
+    PROFILE("sirius::estimate_spectrum_upper_bound");
+
+    auto& ctx = Hk__.H0().ctx();
+    auto& kp  = Hk__.kp();
+
+    sddk::memory_t mem = ctx.processing_unit_memory_t();
+
+    /* v_{j-1}, v_{j} and f = H v_{j} */
+    std::array<std::unique_ptr<wf::Wave_functions<T>>, 3> w;
+    for (auto& e : w) {
+        e = wave_function_factory(ctx, kp, wf::num_bands(1), num_md__, false);
+    }
+
+    /* pseudo-random starting vector which does not depend on the G-vector distribution */
+    std::vector<double> tmp(4096);
+    utils::rnd(true);
+    for (auto& e : tmp) {
+        e = utils::random<double>() - 0.5;
+    }
+    w[1]->zero(sddk::memory_t::host);
+    for (int ispn = 0; ispn < w[1]->num_sc().get(); ispn++) {
+        for (int igk_loc = kp.gkvec().skip_g0(); igk_loc < kp.num_gkvec_loc(); igk_loc++) {
+            int igk = kp.gkvec().offset() + igk_loc;
+            w[1]->pw_coeffs(igk_loc, wf::spin_index(ispn), wf::band_index(0)) = tmp[(igk + 1021 * ispn) & 0xFFF];
+        }
+    }
+
+    std::vector<wf::device_memory_guard> mg;
+    mg.emplace_back(w[0]->memory_guard(mem));
+    mg.emplace_back(w[1]->memory_guard(mem, wf::copy_to::device));
+    mg.emplace_back(w[2]->memory_guard(mem));
+
+    auto br = wf::band_range(0, 1);
+
+    auto dot = [&](wf::Wave_functions<T> const& x__, wf::Wave_functions<T> const& y__)
+    {
+        return std::real(wf::inner_diag<T, F>(mem, x__, y__, sr__, wf::num_bands(1))[0]);
+    };
+
+    /* y <- a * x + b * y */
+    auto axpby = [&](double a__, wf::Wave_functions<T> const* x__, double b__, wf::Wave_functions<T>& y__)
+    {
+        real_type<F> a = a__;
+        real_type<F> b = b__;
+        wf::axpby<T, real_type<F>>(mem, sr__, br, &a, x__, &b, &y__);
+    };
+
+    axpby(0, nullptr, 1.0 / std::sqrt(dot(*w[1], *w[1])), *w[1]);
+
+    std::vector<double> alpha;
+    std::vector<double> beta;
+    double f_norm{0};
+
+    for (int j = 0; j < num_steps__; j++) {
+        /* f = H v_{j} - beta_{j-1} v_{j-1} - alpha_{j} v_{j} */
+        Hk__.template apply_h_s<F>(sr__, br, *w[1], w[2].get(), nullptr);
+        if (j > 0) {
+            axpby(-beta.back(), w[0].get(), 1.0, *w[2]);
+        }
+        alpha.push_back(dot(*w[1], *w[2]));
+        axpby(-alpha.back(), w[1].get(), 1.0, *w[2]);
+
+        f_norm = std::sqrt(dot(*w[2], *w[2]));
+        if (j == num_steps__ - 1 || f_norm < 1e-10) {
+            break;
+        }
+        beta.push_back(f_norm);
+
+        /* v_{j-1} <- v_{j}, v_{j} <- f / |f| */
+        std::swap(w[0], w[1]);
+        std::swap(w[1], w[2]);
+        axpby(0, nullptr, 1.0 / f_norm, *w[1]);
+    }
+
+    int n = static_cast<int>(alpha.size());
+
+    la::dmatrix<double> tri(n, n);
+    tri.zero();
+    for (int i = 0; i < n; i++) {
+        tri(i, i) = alpha[i];
+        if (i < n - 1) {
+            tri(i, i + 1) = tri(i + 1, i) = beta[i];
+        }
+    }
+    std::vector<double> eval(n);
+    la::dmatrix<double> z(n, n);
+    if (la::Eigensolver_lapack().solve(n, tri, eval.data(), z)) {
+        RTE_THROW("error in diagonalziation of the Lanczos matrix");
+    }
+
+    return eval[n - 1] + f_norm;
+}
+
+/// Solve the eigen-problem using the Chebyshev-filtered subspace iteration.
+/** Each step of the solver consists of the Rayleigh-Ritz projection in the subspace of the current
+    wave-functions and the application of the Chebyshev polynomial filter to the Ritz vectors:
+    \f[
+      |\psi_{i}\rangle \leftarrow C_{m}\Big( \frac{\hat H - c}{e} \Big) |\psi_{i}\rangle
+    \f]
+    with \f$ c = (a + b) / 2 \f$ and \f$ e = (b - a) / 2 \f$, where \f$ a \f$ is the largest Ritz value and
+    \f$ b \f$ is the upper bound of the spectrum. The filter damps the unwanted part of the spectrum \f$ [a, b] \f$
+    and amplifies the wanted states below \f$ a \f$. The three-term recurrence of the Chebyshev polynomials is scaled
+    to prevent the overflow (Y. Zhou et al., J. Comput. Phys. 219, 172 (2006)). Contrary to the Davidson method the
+    filter is a sequence of \f$ \hat H \f$ applications to a fixed block of wave-functions and the basis is
+    orthogonalized only once per step.
+
+    The degree \f$ m \f$ of the polynomial is adapted in each step: for each unconverged band the number of
+    filter applications required to reduce the residual norm to the tolerance is estimated from the growth rate
+    \f$ \rho_i = |t_i| + \sqrt{t_i^2 - 1} \f$, \f$ t_i = (\epsilon_i - c) / e \f$ of the Chebyshev polynomial.
+
+    Only the standard eigen-value problem (\f$ \hat S = 1 \f$, norm-conserving pseudopotentials) is supported.
+    The function throws for the ultrasoft and PAW pseudopotentials and for the full-potential case; use the
+    Davidson solver there, or the LOBPCG solver for the pseudopotentials.
+
+\tparam T                     Precision type of wave-functions (float or double).
+\tparam F                     Type of the subspace matrices.
+\param [in]     Hk            Hamiltonian for a given k-point.
+\param [in]     num_bands     Number of eigen-states (bands) to compute.
+\param [in]     num_mag_dims  Number of magnetic dimensions (0, 1 or 3).
+\param [in,out] psi           Wave-functions. On input they are used for the starting guess of the subspace basis.
+                              On output they are the solutions of Hk|psi> = e|psi> eigen-problem.
+\param [in]     tolerance     Lambda-function for the band energy tolerance.
+\param [in]     res_tol       Residual tolerance.
+\param [in]     num_steps     Number of iterative steps.
+\param [out]    out           Output stream.
+\param [in]     verbosity     Verbosity level.
+\return                       Number of steps and list of eigen-values.
+*/
+template <typename T, typename F>
+inline auto
+chebyshev(Hamiltonian_k<T>& Hk__, wf::num_bands num_bands__, wf::num_mag_dims num_mag_dims__,
+        wf::Wave_functions<T>& psi__, std::function<double(int, int)> tolerance__, double res_tol__,
+        int num_steps__, std::ostream& out__, int verbosity__)
+{
+    PROFILE("sirius::chebyshev");
+
+    PROFILE_START("sirius::chebyshev|init");
+    auto& ctx = Hk__.H0().ctx();
+    print_memory_usage(out__, FILE_LINE);
+
+    auto& kp = Hk__.kp();
+
+    auto& itso = ctx.cfg().iterative_solver();
+
+    if (ctx.full_potential() || ctx.unit_cell().augment()) {
+        RTE_THROW("Chebyshev filter is implemented only for the norm-conserving pseudopotentials");
+    }
+
+    /* true if this is a non-collinear case */
+    const bool nc_mag = (num_mag_dims__.get() == 3);
+
+    auto num_md = wf::num_mag_dims(nc_mag ? 3 : 0);
+
+    /* number of spin components, treated simultaneously */
+    const int num_sc = nc_mag ? 2 : 1;
+
+    /* number of spinor components stored under the same band index */
+    const int num_spinors = (num_mag_dims__.get() == 1) ? 2 : 1;
+
+    const int nb = num_bands__.get();
+
+    if (nb > kp.num_gkvec()) {
+        RTE_THROW("number of bands is larger than the size of the basis");
+    }
+
+    /* alias for memory pool */
+    auto& mp = get_memory_pool(ctx.host_memory_t());
+
+    sddk::memory_t mem = ctx.processing_unit_memory_t();
+
+    using wf_t = wf::Wave_functions<T>;
+
+    std::vector<wf::device_memory_guard> mg;
+
+    mg.emplace_back(psi__.memory_guard(mem, wf::copy_to::device | wf::copy_to::host));
+
+    /* basis functions of the Rayleigh-Ritz step */
+    auto phi = wave_function_factory(ctx, kp, num_bands__, num_md, false);
+    mg.emplace_back(phi->memory_guard(mem));
+    auto hphi = wave_function_factory(ctx, kp, num_bands__, num_md, false);
+    mg.emplace_back(hphi->memory_guard(mem));
+    auto sphi = wave_function_factory(ctx, kp, num_bands__, num_md, false);
+    mg.emplace_back(sphi->memory_guard(mem));
+
+    /* vectors of the three-term recurrence; after the Rayleigh-Ritz step they hold H|psi> and S|psi> */
+    auto w1 = wave_function_factory(ctx, kp, num_bands__, num_md, false);
+    mg.emplace_back(w1->memory_guard(mem));
+    auto w2 = wave_function_factory(ctx, kp, num_bands__, num_md, false);
+    mg.emplace_back(w2->memory_guard(mem));
+
+    /* residuals; also used as a temporary array in orthogonalize() */
+    auto res = wave_function_factory(ctx, kp, num_bands__, num_md, false);
+    mg.emplace_back(res->memory_guard(mem));
+
+    int const bs = ctx.cyclic_block_size();
+
+    la::dmatrix<F> H(nb, nb, ctx.blacs_grid(), bs, bs, mp);
+    la::dmatrix<F> evec(nb, nb, ctx.blacs_grid(), bs, bs, mp);
+
+    if (is_device_memory(mem)) {
+        auto& mpd = get_memory_pool(mem);
+        if (ctx.blacs_grid().comm().size() == 1) {
+            evec.allocate(mpd);
+            H.allocate(mpd);
+        }
+    }
+
+    int const num_ortho_steps = itso.extra_ortho() ? 2 : 1;
+
+    int const min_degree = std::max(1, itso.chebyshev_degree());
+    int const max_degree = std::max(min_degree, itso.chebyshev_max_degree());
+
+    auto& std_solver = ctx.std_evp_solver();
+
+    davidson_result_t result{0, sddk::mdarray<double, 2>(nb, num_spinors)};
+
+    if (verbosity__ >= 1) {
+         RTE_OUT(out__) << "starting Chebyshev filtered subspace iteration" << std::endl
+               << "  number of bands     : " << nb << std::endl
+               << "  polynomial degree   : " << min_degree << " - " << max_degree << std::endl
+               << "  number of spins     : " << ((num_mag_dims__.get() == 0) ? 1 : 2) << std::endl
+               << "  non-collinear       : " << nc_mag << std::endl;
+    }
+    PROFILE_STOP("sirius::chebyshev|init");
+
+    auto br = wf::band_range(0, nb);
+
+    /* y <- a * x + b * y for all bands */
+    auto axpby = [&](wf::spin_range sr__, double a__, wf_t const* x__, double b__, wf_t& y__)
+    {
+        std::vector<real_type<F>> a(nb, a__);
+        std::vector<real_type<F>> b(nb, b__);
+        wf::axpby<T, real_type<F>>(mem, sr__, br, a.data(), x__, b.data(), &y__);
+    };
+
+    PROFILE_START("sirius::chebyshev|iter");
+    for (int ispin_step = 0; ispin_step < num_spinors; ispin_step++) {
+        auto sr = nc_mag ? wf::spin_range(0, 2) : wf::spin_range(ispin_step);
+
+        double upper_bound = estimate_spectrum_upper_bound<T, F>(Hk__, sr, num_md, itso.num_lanczos_steps());
+
+        if (verbosity__ >= 1) {
+            RTE_OUT(out__) << "ispin_step " << ispin_step << " out of " << num_spinors
+                           << ", upper bound of the spectrum : " << upper_bound << std::endl;
+        }
+
+        sddk::mdarray<real_type<F>, 1> eval(nb);
+        sddk::mdarray<real_type<F>, 1> eval_old(nb);
+        eval_old = []() { return 1e10; };
+
+        /* eigen-values in the precision of the wave-functions for the residuals */
+        sddk::mdarray<T, 1> eval_wf(nb);
+        if (is_device_memory(mem)) {
+            eval_wf.allocate(mem);
+        }
+
+        /* trial basis functions */
+        for (int ispn = 0; ispn < num_sc; ispn++) {
+            wf::copy(mem, psi__, wf::spin_index(nc_mag ? ispn : ispin_step), br, *phi, wf::spin_index(ispn), br);
+        }
+
+        int degree{min_degree};
+
+        for (int iter_step = 0; iter_step < num_steps__; iter_step++) {
+            PROFILE_START("sirius::chebyshev|rayleigh_ritz");
+            Hk__.template apply_h_s<F>(sr, br, *phi, hphi.get(), sphi.get());
+            for (int j = 0; j < num_ortho_steps; j++) {
+                wf::orthogonalize(ctx.spla_context(), mem, sr, wf::band_range(0, 0), br, *phi, *sphi,
+                        {phi.get(), hphi.get(), sphi.get()}, H, *res, false);
+            }
+            Band(ctx).set_subspace_mtrx(0, nb, 0, *phi, *hphi, H);
+
+            if (std_solver.solve(nb, nb, H, &eval[0], evec)) {
+                RTE_THROW("error in diagonalziation");
+            }
+            ctx.evp_work_count(1);
+
+            /* compute Ritz vectors and H, S applied to them */
+            for (auto s = sr.begin(); s != sr.end(); s++) {
+                auto sp = phi->actual_spin_index(s);
+                wf::transform(ctx.spla_context(), mem, evec, 0, 0, 1.0, *phi, sp, br, 0.0, psi__, s, br);
+                wf::transform(ctx.spla_context(), mem, evec, 0, 0, 1.0, *hphi, sp, br, 0.0, *w1, sp, br);
+                wf::transform(ctx.spla_context(), mem, evec, 0, 0, 1.0, *sphi, sp, br, 0.0, *w2, sp, br);
+            }
+
+            eval_wf = [&](size_t j) -> T { return eval[j]; };
+            if (is_device_memory(mem)) {
+                eval_wf.copy_to(mem);
+            }
+            compute_residuals<T>(mem, sr, num_bands__, eval_wf, *w1, *w2, *res);
+            auto res_norm = wf::inner_diag<T, F>(mem, *res, *res, sr, num_bands__);
+            PROFILE_STOP("sirius::chebyshev|rayleigh_ritz");
+
+            for (int j = 0; j < nb; j++) {
+                result.eval(j, ispin_step) = eval[j];
+            }
+            result.niter++;
+
+            /* bounds of the filtered interval */
+            double a = eval[nb - 1];
+            double b = std::max(upper_bound, 2 * a - eval[0]);
+            double c = 0.5 * (b + a);
+            double e = 0.5 * (b - a);
+
+            /* check convergence and estimate the polynomial degree for the next step */
+            int num_unconverged{0};
+            int new_degree{0};
+            for (int j = 0; j < nb; j++) {
+                double r = std::sqrt(std::real(res_norm[j]));
+                bool converged = itso.converge_by_energy() ?
+                    (std::abs(eval[j] - eval_old[j]) <= tolerance__(j, sr.spinor_index())) : (r <= res_tol__);
+                if (!converged) {
+                    num_unconverged++;
+                    double t = std::abs(eval[j] - c) / e;
+                    /* states at the edge of the filtered interval don't define the degree */
+                    if (t > 1 + 1e-8 && r > res_tol__) {
+                        double rho = t + std::sqrt(t * t - 1);
+                        new_degree = std::max(new_degree,
+                                static_cast<int>(std::ceil(std::log(r / res_tol__) / std::log(rho))));
+                    }
+                }
+            }
+            degree = std::min(std::max(new_degree, min_degree), max_degree);
+
+            if (verbosity__ >= 2) {
+                RTE_OUT(out__) << "iter_step " << iter_step << ", unconverged : " << num_unconverged
+                               << ", filter interval : [" << a << ", " << b << "], degree : " << degree << std::endl;
+            }
+            if (verbosity__ >= 4) {
+                for (int j = 0; j < nb; j++) {
+                    RTE_OUT(out__) << "eval[" << j << "]=" << eval[j] << ", diff=" << std::abs(eval[j] - eval_old[j])
+                                   << ", res=" << std::sqrt(std::real(res_norm[j])) << std::endl;
+                }
+            }
+
+            if (num_unconverged == 0 || iter_step == num_steps__ - 1) {
+                break;
+            }
+
+            sddk::copy(eval, eval_old);
+
+            PROFILE_START("sirius::chebyshev|filter");
+            /* x = psi, y = (H x - c x) * sigma / e where H|psi> is already stored in w1 */
+            wf_t* x = phi.get();
+            wf_t* y = w1.get();
+            wf_t* z = w2.get();
+            for (auto s = sr.begin(); s != sr.end(); s++) {
+                wf::copy(mem, psi__, s, br, *x, x->actual_spin_index(s), br);
+            }
+            double sigma = e / (eval[0] - c);
+            double const tau = 2 / sigma;
+            axpby(sr, -c * sigma / e, x, sigma / e, *y);
+
+            for (int k = 2; k <= degree; k++) {
+                double sigma1 = 1.0 / (tau - sigma);
+                /* z = (H y - c y) * 2 sigma1 / e - sigma * sigma1 * x */
+                Hk__.template apply_h_s<F>(sr, br, *y, z, nullptr);
+                axpby(sr, -2 * sigma1 * c / e, y, 2 * sigma1 / e, *z);
+                axpby(sr, -sigma * sigma1, x, 1.0, *z);
+
+                auto tmp = x;
+                x = y;
+                y = z;
+                z = tmp;
+                sigma = sigma1;
+            }
+            /* filtered functions are the new basis of the Rayleigh-Ritz step */
+            if (y != phi.get()) {
+                for (auto s = sr.begin(); s != sr.end(); s++) {
+                    auto sp = phi->actual_spin_index(s);
+                    wf::copy(mem, *y, sp, br, *phi, sp, br);
+                }
+            }
+            PROFILE_STOP("sirius::chebyshev|filter");
+        }
+        print_memory_usage(out__, FILE_LINE);
+    }
+    PROFILE_STOP("sirius::chebyshev|iter");
+
+    mg.clear();
+    print_memory_usage(out__, FILE_LINE);
+    return result;
+}
+
+} // namespace
+
+#endif
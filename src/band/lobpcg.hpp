@@ -0,0 +1,338 @@
+// Copyright (c) 2013-2023 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+/** \file lobpcg.hpp
+ *
+ *  \brief Locally optimal block preconditioned conjugate gradient solver.
+ */
+
+#ifndef __LOBPCG_HPP__
+#define __LOBPCG_HPP__
+
+#include "davidson.hpp"
+
+namespace sirius {
+
+/// Solve the eigen-problem using the locally optimal block preconditioned conjugate gradient method.
+/** The Rayleigh-Ritz problem is solved in the subspace spanned by the current approximation to eigen-vectors
+    \f$ X \f$, the conjugate directions \f$ P \f$ and the preconditioned residuals \f$ W \f$ (A. V. Knyazev,
+    SIAM J. Sci. Comput. 23, 517 (2001)). In contrast to the Davidson method the basis doesn't grow with the number
+    of iterations and its size never exceeds three times the number of bands.
+
+    Soft locking is used: converged bands stay in the \f$ X \f$ block and are updated by the Rayleigh-Ritz step, but
+    they don't contribute the residuals and conjugate directions to the basis. The new conjugate directions are
+    computed in the implicit form
+    \f[
+      P' = W C_{W} + P C_{P}, \quad X' = X C_{X} + P'
+    \f]
+    where \f$ C \f$ are the blocks of Ritz coefficients, such that \f$ H \f$ and \f$ S \f$ are applied only to the
+    new residuals.
+
+    The solver keeps the basis \f$ [X P W] \f$, the \f$ H \f$- and \f$ S \f$-applied basis and one block of
+    residuals, i.e. ten blocks of the size of the wave-functions. For the norm-conserving pseudopotentials
+    \f$ S = 1 \f$ and the \f$ S \f$-applied basis is not stored, which leaves seven blocks.
+
+\tparam T                     Precision type of wave-functions (float or double).
+\tparam F                     Type of the subspace matrices.
+\param [in]     Hk            Hamiltonian for a given k-point.
+\param [in]     num_bands     Number of eigen-states (bands) to compute.
+\param [in]     num_mag_dims  Number of magnetic dimensions (0, 1 or 3).
+\param [in,out] psi           Wave-functions. On input they are used for the starting guess of the subspace basis.
+                              On output they are the solutions of Hk|psi> = e S|psi> eigen-problem.
+\param [in]     tolerance     Lambda-function for the band energy tolerance.
+\param [in]     res_tol       Residual tolerance.
+\param [in]     num_steps     Number of iterative steps.
+\param [in]     estimate_eval Use the change of the eigen-values and not the residual norm as a convergence criterion.
+\param [in]     extra_ortho   Orthogonalize new subspace basis one extra time.
+\param [out]    out           Output stream.
+\param [in]     verbosity     Verbosity level.
+\return                       Number of steps and list of eigen-values.
+*/
+template <typename T, typename F>
+inline auto
+lobpcg(Hamiltonian_k<T>& Hk__, wf::num_bands num_bands__, wf::num_mag_dims num_mag_dims__,
+        wf::Wave_functions<T>& psi__, std::function<double(int, int)> tolerance__, double res_tol__,
+        int num_steps__, bool estimate_eval__, bool extra_ortho__, std::ostream& out__, int verbosity__)
+{
+    PROFILE("sirius::lobpcg");
+
+    PROFILE_START("sirius::lobpcg|init");
+    auto& ctx = Hk__.H0().ctx();
+    print_memory_usage(out__, FILE_LINE);
+
+    auto& kp = Hk__.kp();
+
+    if (ctx.full_potential()) {
+        RTE_THROW("LOBPCG solver is implemented only for the pseudopotential methods");
+    }
+
+    /* true if this is a non-collinear case */
+    const bool nc_mag = (num_mag_dims__.get() == 3);
+
+    auto num_md = wf::num_mag_dims(nc_mag ? 3 : 0);
+
+    /* number of spin components, treated simultaneously */
+    const int num_sc = nc_mag ? 2 : 1;
+
+    /* number of spinor components stored under the same band index */
+    const int num_spinors = (num_mag_dims__.get() == 1) ? 2 : 1;
+
+    const int nb = num_bands__.get();
+
+    if (3 * nb > kp.num_gkvec()) {
+        RTE_THROW("subspace size is too large!");
+    }
+
+    /* alias for memory pool */
+    auto& mp = get_memory_pool(ctx.host_memory_t());
+
+    sddk::memory_t mem = ctx.processing_unit_memory_t();
+
+    using wf_t = wf::Wave_functions<T>;
+
+    std::vector<wf::device_memory_guard> mg;
+
+    mg.emplace_back(psi__.memory_guard(mem, wf::copy_to::device | wf::copy_to::host));
+
+    /* true if S is not the identity operator */
+    const bool augment = ctx.unit_cell().augment();
+
+    /* basis functions X, P, W and H, S applied to them */
+    auto phi = wave_function_factory(ctx, kp, wf::num_bands(3 * nb), num_md, false);
+    mg.emplace_back(phi->memory_guard(mem));
+    auto hphi = wave_function_factory(ctx, kp, wf::num_bands(3 * nb), num_md, false);
+    mg.emplace_back(hphi->memory_guard(mem));
+    /* S|phi> = |phi> for the norm-conserving pseudopotentials */
+    std::unique_ptr<wf_t> sphi_buf;
+    wf_t* sphi{phi.get()};
+    if (augment) {
+        sphi_buf = wave_function_factory(ctx, kp, wf::num_bands(3 * nb), num_md, false);
+        mg.emplace_back(sphi_buf->memory_guard(mem));
+        sphi = sphi_buf.get();
+    }
+    /* distinct blocks of the basis which are transformed together */
+    std::vector<wf_t*> basis({phi.get(), hphi.get()});
+    if (augment) {
+        basis.push_back(sphi);
+    }
+
+    /* residuals; also used as a temporary array in the update of the basis and in orthogonalize() */
+    auto tp = wave_function_factory(ctx, kp, num_bands__, num_md, false);
+    mg.emplace_back(tp->memory_guard(mem));
+
+    int const bs = ctx.cyclic_block_size();
+
+    la::dmatrix<F> H(3 * nb, 3 * nb, ctx.blacs_grid(), bs, bs, mp);
+    la::dmatrix<F> evec(3 * nb, 3 * nb, ctx.blacs_grid(), bs, bs, mp);
+
+    if (is_device_memory(mem)) {
+        auto& mpd = get_memory_pool(mem);
+        if (ctx.blacs_grid().comm().size() == 1) {
+            evec.allocate(mpd);
+            H.allocate(mpd);
+        }
+    }
+
+    int const num_ortho_steps = extra_ortho__ ? 2 : 1;
+
+    /* get diagonal elements for preconditioning */
+    auto h_o_diag = Hk__.template get_h_o_diag_pw<T, 3>();
+
+    auto& std_solver = ctx.std_evp_solver();
+
+    davidson_result_t result{0, sddk::mdarray<double, 2>(nb, num_spinors)};
+
+    if (verbosity__ >= 1) {
+         RTE_OUT(out__) << "starting LOBPCG iterative solver" << std::endl
+               << "  number of bands     : " << nb << std::endl
+               << "  number of spins     : " << ((num_mag_dims__.get() == 0) ? 1 : 2) << std::endl
+               << "  non-collinear       : " << nc_mag << std::endl;
+    }
+    PROFILE_STOP("sirius::lobpcg|init");
+
+    PROFILE_START("sirius::lobpcg|iter");
+    for (int ispin_step = 0; ispin_step < num_spinors; ispin_step++) {
+        auto sr = nc_mag ? wf::spin_range(0, 2) : wf::spin_range(ispin_step);
+
+        sddk::mdarray<real_type<F>, 1> eval(nb);
+        sddk::mdarray<real_type<F>, 1> eval_old(nb);
+        eval_old = []() { return 1e10; };
+
+        /* trial basis functions */
+        for (int ispn = 0; ispn < num_sc; ispn++) {
+            wf::copy(mem, psi__, wf::spin_index(nc_mag ? ispn : ispin_step), wf::band_range(0, nb), *phi,
+                    wf::spin_index(ispn), wf::band_range(0, nb));
+        }
+        Hk__.template apply_h_s<F>(sr, wf::band_range(0, nb), *phi, hphi.get(), sphi_buf.get());
+        wf::orthogonalize(ctx.spla_context(), mem, sr, wf::band_range(0, 0), wf::band_range(0, nb), *phi, *sphi,
+                basis, H, *tp, false);
+
+        /* current size of the basis */
+        int N{nb};
+
+        for (int iter_step = 0; iter_step < num_steps__; iter_step++) {
+            PROFILE_START("sirius::lobpcg|rayleigh_ritz");
+            Band(ctx).set_subspace_mtrx(0, N, 0, *phi, *hphi, H);
+
+            if (std_solver.solve(N, nb, H, &eval[0], evec)) {
+                RTE_THROW("error in diagonalziation");
+            }
+            ctx.evp_work_count(std::pow(static_cast<double>(N) / nb, 3));
+            PROFILE_STOP("sirius::lobpcg|rayleigh_ritz");
+
+            PROFILE_START("sirius::lobpcg|update");
+            /* P' = [P W] C_{PW} is computed in tp and stored in [nb, 2 nb) of the basis, where [P W] is no
+             * longer needed; X' = X C_X + P' is accumulated in tp and then moved to the beginning */
+            for (auto s = sr.begin(); s != sr.end(); s++) {
+                auto sp = phi->actual_spin_index(s);
+                auto br_x = wf::band_range(0, nb);
+                for (auto w : basis) {
+                    if (N > nb) {
+                        wf::transform(ctx.spla_context(), mem, evec, nb, 0, 1.0, *w, sp, wf::band_range(nb, N),
+                                0.0, *tp, sp, br_x);
+                        wf::copy(mem, *tp, sp, br_x, *w, sp, wf::band_range(nb, 2 * nb));
+                    }
+                    wf::transform(ctx.spla_context(), mem, evec, 0, 0, 1.0, *w, sp, br_x, (N > nb) ? 1.0 : 0.0,
+                            *tp, sp, br_x);
+                    wf::copy(mem, *tp, sp, br_x, *w, sp, br_x);
+                }
+                wf::copy(mem, *phi, sp, br_x, psi__, s, br_x);
+            }
+            for (int j = 0; j < nb; j++) {
+                result.eval(j, ispin_step) = eval[j];
+            }
+            result.niter++;
+
+            /* residuals of all bands */
+            sddk::mdarray<T, 1> eval_wf(nb);
+            eval_wf = [&](size_t j) -> T { return eval[j]; };
+            if (is_device_memory(mem)) {
+                eval_wf.allocate(mem).copy_to(mem);
+            }
+            compute_residuals<T>(mem, sr, num_bands__, eval_wf, *hphi, *sphi, *tp);
+            auto res_norm = wf::inner_diag<T, F>(mem, *tp, *tp, sr, num_bands__);
+
+            /* soft locking: only unconverged bands contribute to the new basis */
+            std::vector<int> active;
+            for (int j = 0; j < nb; j++) {
+                bool converged = estimate_eval__ ?
+                    (std::abs(eval[j] - eval_old[j]) <= tolerance__(j, sr.spinor_index())) :
+                    (std::sqrt(std::real(res_norm[j])) <= res_tol__);
+                if (!converged) {
+                    active.push_back(j);
+                }
+            }
+            int na = static_cast<int>(active.size());
+
+            if (verbosity__ >= 2) {
+                RTE_OUT(out__) << "iter_step " << iter_step << ", basis size : " << N
+                               << ", unconverged : " << na << std::endl;
+            }
+            if (verbosity__ >= 4) {
+                for (int j = 0; j < nb; j++) {
+                    RTE_OUT(out__) << "eval[" << j << "]=" << eval[j] << ", diff=" << std::abs(eval[j] - eval_old[j])
+                                   << ", res=" << std::sqrt(std::real(res_norm[j])) << std::endl;
+                }
+            }
+
+            if (na == 0 || iter_step == num_steps__ - 1) {
+                PROFILE_STOP("sirius::lobpcg|update");
+                break;
+            }
+            sddk::copy(eval, eval_old);
+
+            /* preconditioned and normalized residuals of active bands: W */
+            sddk::mdarray<T, 1> eval_a(na);
+            for (int k = 0; k < na; k++) {
+                eval_a[k] = eval[active[k]];
+                if (active[k] != k) {
+                    for (auto s = sr.begin(); s != sr.end(); s++) {
+                        auto sp = tp->actual_spin_index(s);
+                        wf::copy(mem, *tp, sp, wf::band_range(active[k], active[k] + 1), *tp, sp,
+                                wf::band_range(k, k + 1));
+                    }
+                }
+            }
+            if (is_device_memory(mem)) {
+                eval_a.allocate(mem).copy_to(mem);
+            }
+            apply_preconditioner<T>(mem, sr, wf::num_bands(na), *tp, h_o_diag.first, h_o_diag.second, eval_a);
+            auto w_norm = wf::inner_diag<T, F>(mem, *tp, *tp, sr, wf::num_bands(na));
+            std::vector<real_type<F>> norm1;
+            for (auto e : w_norm) {
+                norm1.push_back(1.0 / std::sqrt(std::real(e)));
+            }
+            wf::axpby<T, real_type<F>>(mem, sr, wf::band_range(0, na), nullptr, nullptr, norm1.data(), tp.get());
+
+            /* prevent numerical noise in the Gamma-point case */
+            if (std::is_same<F, real_type<F>>::value && tp->comm().rank() == 0) {
+                if (is_device_memory(mem)) {
+#if defined(SIRIUS_GPU)
+                    make_real_g0_gpu(tp->at(mem, 0, sr.begin(), wf::band_index(0)), tp->ld(), na);
+#endif
+                } else {
+                    for (int k = 0; k < na; k++) {
+                        tp->pw_coeffs(0, sr.begin(), wf::band_index(k)) =
+                            tp->pw_coeffs(0, sr.begin(), wf::band_index(k)).real();
+                    }
+                }
+            }
+
+            /* new basis: X | P | W; the conjugate directions of the active bands are packed in place */
+            int np = (N > nb) ? na : 0;
+            for (auto s = sr.begin(); s != sr.end(); s++) {
+                auto sp = phi->actual_spin_index(s);
+                for (int k = 0; k < np; k++) {
+                    if (active[k] != k) {
+                        for (auto w : basis) {
+                            wf::copy(mem, *w, sp, wf::band_range(nb + active[k], nb + active[k] + 1), *w, sp,
+                                    wf::band_range(nb + k, nb + k + 1));
+                        }
+                    }
+                }
+                wf::copy(mem, *tp, sp, wf::band_range(0, na), *phi, sp, wf::band_range(nb + np, nb + np + na));
+            }
+            Hk__.template apply_h_s<F>(sr, wf::band_range(nb + np, nb + np + na), *phi, hphi.get(), sphi_buf.get());
+            N = nb + np + na;
+
+            /* P and W are orthogonalized one after the other, such that the temporary array of nb bands
+             * is sufficient */
+            for (int j = 0; j < num_ortho_steps; j++) {
+                if (np) {
+                    wf::orthogonalize(ctx.spla_context(), mem, sr, wf::band_range(0, nb), wf::band_range(nb, nb + np),
+                            *phi, *sphi, basis, H, *tp, true);
+                }
+                wf::orthogonalize(ctx.spla_context(), mem, sr, wf::band_range(0, nb + np), wf::band_range(nb + np, N),
+                        *phi, *sphi, basis, H, *tp, true);
+            }
+            PROFILE_STOP("sirius::lobpcg|update");
+        }
+        print_memory_usage(out__, FILE_LINE);
+    }
+    PROFILE_STOP("sirius::lobpcg|iter");
+
+    mg.clear();
+    print_memory_usage(out__, FILE_LINE);
+    return result;
+}
+
+} // namespace
+
+#endif
@@ -21,8 +21,11 @@
  *
  *   \brief Contains interfaces to the sirius::Band solvers.
  */
+#include <numeric>
 #include "band.hpp"
 #include "davidson.hpp"
+#include "chebyshev.hpp"
+#include "lobpcg.hpp"
 
 namespace sirius {
 
@@ -82,7 +85,7 @@ Band::solve_pseudo_potential(Hamiltonian_k<T>& Hk__, double itsol_tol__, double
         } else {
             STOP();
         }
-    } else if (itso.type() == "davidson") {
+    } else if (itso.type() == "davidson" || itso.type() == "chebyshev" || itso.type() == "lobpcg") {
         auto& kp = Hk__.kp();
 
         auto tolerance = [&](int j__, int ispn__) -> double {
@@ -101,10 +104,20 @@ Band::solve_pseudo_potential(Hamiltonian_k<T>& Hk__, double itsol_tol__, double
         std::stringstream s;
         std::ostream* out = (kp.comm().rank() == 0) ? &std::cout : &s;
 
-        auto result = davidson<T, F, davidson_evp_t::hamiltonian>(Hk__, wf::num_bands(ctx_.num_bands()),
-                wf::num_mag_dims(ctx_.num_mag_dims()), kp.spinor_wave_functions(), tolerance,
-                itso.residual_tolerance(), itso.num_steps(), itso.locking(), itso.subspace_size(),
-                itso.converge_by_energy(), itso.extra_ortho(), *out, 0);
+        davidson_result_t result;
+        if (itso.type() == "davidson") {
+            result = davidson<T, F, davidson_evp_t::hamiltonian>(Hk__, wf::num_bands(ctx_.num_bands()),
+                    wf::num_mag_dims(ctx_.num_mag_dims()), kp.spinor_wave_functions(), tolerance,
+                    itso.residual_tolerance(), itso.num_steps(), itso.locking(), itso.subspace_size(),
+                    itso.converge_by_energy(), itso.extra_ortho(), *out, 0);
+        } else if (itso.type() == "lobpcg") {
+            result = lobpcg<T, F>(Hk__, wf::num_bands(ctx_.num_bands()), wf::num_mag_dims(ctx_.num_mag_dims()),
+                    kp.spinor_wave_functions(), tolerance, itso.residual_tolerance(), itso.num_steps(),
+                    itso.converge_by_energy(), itso.extra_ortho(), *out, 0);
+        } else {
+            result = chebyshev<T, F>(Hk__, wf::num_bands(ctx_.num_bands()), wf::num_mag_dims(ctx_.num_mag_dims()),
+                    kp.spinor_wave_functions(), tolerance, itso.residual_tolerance(), itso.num_steps(), *out, 0);
+        }
         niter = result.niter;
         for (int ispn = 0; ispn < ctx_.num_spinors(); ispn++) {
             for (int j = 0; j < ctx_.num_bands(); j++) {
@@ -135,30 +148,48 @@ Band::solve(K_point_set& kset__, Hamiltonian0<T>& H0__, double itsol_tol__) cons
     print_memory_usage(ctx_.out(),FILE_LINE);
 
     double empy_tol{itsol_tol__};
-    if (ctx_.cfg().iterative_solver().type() == "davidson") {
+    if (ctx_.cfg().iterative_solver().type() != "exact") {
         empy_tol = std::max(itsol_tol__ * ctx_.cfg().settings().itsol_tol_ratio(),
                                    ctx_.cfg().iterative_solver().empty_states_tolerance());
         ctx_.out(2, __func__) << "iterative solver tolerance (occupied, empty): " << itsol_tol__ << " "
                               << itsol_tol__ + empy_tol << std::endl;
     }
 
-    int num_dav_iter{0};
+    /* k-point dependent part of the local operator is stored in H0, so each additional team needs its own copy */
+    int num_teams = kset__.num_kpoint_teams();
+    std::vector<std::unique_ptr<Hamiltonian0<T>>> H0_team;
+    for (int i = 1; i < num_teams; i++) {
+        H0_team.emplace_back(new Hamiltonian0<T>(H0__.potential(), false));
+    }
+
+    std::vector<int> num_dav_iter_team(num_teams, 0);
+    double t_loop = -utils::wtime();
     /* solve secular equation and generate wave functions */
-    for (int ikloc = 0; ikloc < kset__.spl_num_kpoints().local_size(); ikloc++) {
+    kset__.for_each_local_kpoint([&](int ikloc, int team) {
         int ik  = kset__.spl_num_kpoints(ikloc);
         auto kp = kset__.get<T>(ik);
 
-        auto Hk = H0__(*kp);
+        auto& H0 = (team == 0) ? H0__ : *H0_team[team - 1];
+
+        double t = -utils::wtime();
+        auto Hk = H0(*kp);
         if (ctx_.full_potential()) {
             solve_full_potential<T>(Hk, itsol_tol__);
         } else {
             if (ctx_.gamma_point() && (ctx_.so_correction() == false)) {
-                num_dav_iter += solve_pseudo_potential<T, F>(Hk, itsol_tol__, empy_tol);
+                num_dav_iter_team[team] += solve_pseudo_potential<T, F>(Hk, itsol_tol__, empy_tol);
             } else {
-                num_dav_iter += solve_pseudo_potential<T, std::complex<F>>(Hk, itsol_tol__, empy_tol);
+                num_dav_iter_team[team] += solve_pseudo_potential<T, std::complex<F>>(Hk, itsol_tol__, empy_tol);
             }
         }
-    }
+        t += utils::wtime();
+        kset__.solve_time(ik, t);
+    });
+    t_loop += utils::wtime();
+    ctx_.out(2, __func__) << "time of the k-point loop: " << t_loop << " sec. (" << num_teams
+                          << " k-point team(s))" << std::endl;
+
+    int num_dav_iter = std::accumulate(num_dav_iter_team.begin(), num_dav_iter_team.end(), 0);
     kset__.comm().allreduce(&num_dav_iter, 1);
     ctx_.num_itsol_steps(num_dav_iter);
     if (!ctx_.full_potential()) {
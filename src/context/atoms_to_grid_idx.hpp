@@ -0,0 +1,294 @@
+// Copyright (c) 2013-2023 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file atoms_to_grid_idx.hpp
+ *
+ *  \brief Contains definition and implementation of sirius::Atoms_to_grid_idx class.
+ */
+
+#ifndef __ATOMS_TO_GRID_IDX_HPP__
+#define __ATOMS_TO_GRID_IDX_HPP__
+
+#include <array>
+#include <vector>
+#include "unit_cell/unit_cell.hpp"
+
+namespace sirius {
+
+/// List of real-space grid points inside the spheres around atoms.
+/** Points are stored in the compressed sparse row format: the points of atom ia occupy the range
+ *  [offset(ia), offset(ia + 1)) of the packed arrays of grid indices, distances to the atom and Cartesian
+ *  vectors from the atom to the points. If the sphere overlaps with its own periodic images, the same grid point
+ *  is stored once for each image inside the sphere. Only the local z-slab of the (distributed) FFT grid is
+ *  considered; grid indices are local to the slab.
+ *
+ *  The regular FFT grid itself serves as a cell list: for each atom only the grid points inside the bounding box
+ *  of its sphere are checked, with the periodic wrapping of the grid coordinates instead of the explicit
+ *  periodic images of the atom. The list can be updated incrementally: only the atoms which have moved or
+ *  which have a new sphere radius are recomputed.
+ */
+class Atoms_to_grid_idx
+{
+  private:
+    /// Offset of the first point of each atom in the packed arrays (num_atoms + 1 elements).
+    std::vector<int> offset_;
+    /// Packed indices of the grid points inside the local z-slab.
+    std::vector<int> index_;
+    /// Packed distances between the grid points and the atoms.
+    std::vector<double> distance_;
+    /// Packed Cartesian vectors from the atoms to the grid points.
+    std::vector<r3::vector<double>> coord_;
+    /// Fractional positions of the atoms for which the list was built.
+    std::vector<r3::vector<double>> position_;
+    /// Radii of the spheres for which the list was built.
+    std::vector<double> radius_;
+    /// Lattice vectors for which the list was built.
+    r3::matrix<double> lattice_vectors_;
+    /// Dimensions of the FFT grid.
+    std::array<int, 3> dims_{0, 0, 0};
+    /// Offset of the local z-slab.
+    int z_offset_{0};
+    /// Size of the local z-slab.
+    int z_length_{0};
+
+    /// Call a function for each local grid point inside the sphere around the atom.
+    /** The function receives the local index of the point and the Cartesian vector from the atom to the point. */
+    template <typename F>
+    void for_each_point(Unit_cell const& uc__, int ia__, F&& f__) const
+    {
+        auto const& pos = position_[ia__];
+        double R        = radius_[ia__];
+
+        /* bounding box of the sphere in the grid coordinates; the distance between the planes of the constant
+         * fractional coordinate x is 2pi / |b_x| */
+        auto const& b = uc__.reciprocal_lattice_vectors();
+        std::array<int, 3> jmin, jmax;
+        for (int x : {0, 1, 2}) {
+            double w = R * r3::vector<double>(b(0, x), b(1, x), b(2, x)).length() / twopi;
+            jmin[x]  = static_cast<int>(std::floor((pos[x] - w) * dims_[x]));
+            jmax[x]  = static_cast<int>(std::ceil((pos[x] + w) * dims_[x]));
+        }
+        auto wrap = [](int j, int n) { return ((j % n) + n) % n; };
+
+        for (int j2 = jmin[2]; j2 <= jmax[2]; j2++) {
+            int jz = wrap(j2, dims_[2]);
+            if (jz < z_offset_ || jz >= z_offset_ + z_length_) {
+                continue;
+            }
+            for (int j1 = jmin[1]; j1 <= jmax[1]; j1++) {
+                int jy = wrap(j1, dims_[1]);
+                for (int j0 = jmin[0]; j0 <= jmax[0]; j0++) {
+                    r3::vector<double> v(static_cast<double>(j0) / dims_[0] - pos[0],
+                                         static_cast<double>(j1) / dims_[1] - pos[1],
+                                         static_cast<double>(j2) / dims_[2] - pos[2]);
+                    auto vc = uc__.get_cartesian_coordinates(v);
+                    if (vc.length() < R) {
+                        int jx = wrap(j0, dims_[0]);
+                        f__(jx + dims_[0] * (jy + (jz - z_offset_) * dims_[1]), vc);
+                    }
+                }
+            }
+        }
+    }
+
+    /// Number of grid points inside the sphere of the atom.
+    int count_points(Unit_cell const& uc__, int ia__) const
+    {
+        int n{0};
+        for_each_point(uc__, ia__, [&n](int, r3::vector<double> const&) { n++; });
+        return n;
+    }
+
+    /// Store grid points of the atom starting from the given position in the packed arrays.
+    void fill_points(Unit_cell const& uc__, int ia__, int offset__, std::vector<int>& index__,
+                     std::vector<double>& distance__, std::vector<r3::vector<double>>& coord__) const
+    {
+        int i = offset__;
+        for_each_point(uc__, ia__, [&](int ir, r3::vector<double> const& vc) {
+            index__[i]    = ir;
+            distance__[i] = vc.length();
+            coord__[i]    = vc;
+            i++;
+        });
+    }
+
+  public:
+    /// Default constructor creates an empty list.
+    Atoms_to_grid_idx()
+    {
+    }
+
+    /// Build the full list of grid points.
+    /** \param [in] uc       Unit cell.
+     *  \param [in] radius   Radius of the sphere around each atom.
+     *  \param [in] dims     Dimensions of the FFT grid.
+     *  \param [in] z_offset Offset of the local z-slab of the FFT grid.
+     *  \param [in] z_length Size of the local z-slab of the FFT grid.
+     */
+    void build(Unit_cell const& uc__, std::vector<double> const& radius__, std::array<int, 3> dims__,
+               int z_offset__, int z_length__)
+    {
+        PROFILE("sirius::Atoms_to_grid_idx::build");
+
+        int na = uc__.num_atoms();
+
+        lattice_vectors_ = uc__.lattice_vectors();
+        dims_            = dims__;
+        z_offset_        = z_offset__;
+        z_length_        = z_length__;
+        position_.resize(na);
+        radius_.resize(na);
+        for (int ia = 0; ia < na; ia++) {
+            position_[ia] = uc__.atom(ia).position();
+            radius_[ia]   = radius__[uc__.atom(ia).type_id()];
+        }
+
+        offset_ = std::vector<int>(na + 1, 0);
+        #pragma omp parallel for schedule(dynamic)
+        for (int ia = 0; ia < na; ia++) {
+            offset_[ia + 1] = count_points(uc__, ia);
+        }
+        for (int ia = 0; ia < na; ia++) {
+            offset_[ia + 1] += offset_[ia];
+        }
+        index_    = std::vector<int>(offset_[na]);
+        distance_ = std::vector<double>(offset_[na]);
+        coord_    = std::vector<r3::vector<double>>(offset_[na]);
+        #pragma omp parallel for schedule(dynamic)
+        for (int ia = 0; ia < na; ia++) {
+            fill_points(uc__, ia, offset_[ia], index_, distance_, coord_);
+        }
+    }
+
+    /// Update the list after the change of atomic positions.
+    /** If the lattice vectors, the FFT grid or the number of atoms have changed the list is rebuilt from scratch.
+     *  Otherwise only the atoms whose positions or sphere radii have changed are recomputed. Return the number of
+     *  recomputed atoms. */
+    int update(Unit_cell const& uc__, std::vector<double> const& radius__, std::array<int, 3> dims__,
+               int z_offset__, int z_length__)
+    {
+        PROFILE("sirius::Atoms_to_grid_idx::update");
+
+        int na = uc__.num_atoms();
+
+        bool rebuild = (static_cast<int>(position_.size()) != na) || (dims__ != dims_) ||
+                       (z_offset__ != z_offset_) || (z_length__ != z_length_);
+        for (int i = 0; i < 3 && !rebuild; i++) {
+            for (int j = 0; j < 3; j++) {
+                if (lattice_vectors_(i, j) != uc__.lattice_vectors()(i, j)) {
+                    rebuild = true;
+                }
+            }
+        }
+        if (rebuild) {
+            build(uc__, radius__, dims__, z_offset__, z_length__);
+            return na;
+        }
+
+        /* find atoms which have moved */
+        std::vector<int> moved;
+        for (int ia = 0; ia < na; ia++) {
+            auto pos = uc__.atom(ia).position();
+            double R = radius__[uc__.atom(ia).type_id()];
+            if ((pos - position_[ia]).length() > 1e-12 || R != radius_[ia]) {
+                position_[ia] = pos;
+                radius_[ia]   = R;
+                moved.push_back(ia);
+            }
+        }
+        if (moved.empty()) {
+            return 0;
+        }
+
+        /* new number of points for each atom */
+        std::vector<int> counts(na);
+        for (int ia = 0; ia < na; ia++) {
+            counts[ia] = num_points(ia);
+        }
+        #pragma omp parallel for schedule(dynamic)
+        for (int i = 0; i < static_cast<int>(moved.size()); i++) {
+            counts[moved[i]] = count_points(uc__, moved[i]);
+        }
+
+        std::vector<int> offset(na + 1, 0);
+        for (int ia = 0; ia < na; ia++) {
+            offset[ia + 1] = offset[ia] + counts[ia];
+        }
+
+        std::vector<int> index(offset[na]);
+        std::vector<double> distance(offset[na]);
+        std::vector<r3::vector<double>> coord(offset[na]);
+        std::vector<bool> is_moved(na, false);
+        for (int ia : moved) {
+            is_moved[ia] = true;
+        }
+        /* copy unchanged atoms and compute the moved ones */
+        #pragma omp parallel for schedule(dynamic)
+        for (int ia = 0; ia < na; ia++) {
+            if (is_moved[ia]) {
+                fill_points(uc__, ia, offset[ia], index, distance, coord);
+            } else {
+                std::copy(index_.begin() + offset_[ia], index_.begin() + offset_[ia + 1], index.begin() + offset[ia]);
+                std::copy(distance_.begin() + offset_[ia], distance_.begin() + offset_[ia + 1],
+                          distance.begin() + offset[ia]);
+                std::copy(coord_.begin() + offset_[ia], coord_.begin() + offset_[ia + 1], coord.begin() + offset[ia]);
+            }
+        }
+        offset_   = std::move(offset);
+        index_    = std::move(index);
+        distance_ = std::move(distance);
+        coord_    = std::move(coord);
+
+        return static_cast<int>(moved.size());
+    }
+
+    /// Offset of the first grid point of the atom in the packed arrays.
+    inline int offset(int ia__) const
+    {
+        return offset_[ia__];
+    }
+
+    /// Number of grid points inside the sphere of the atom.
+    inline int num_points(int ia__) const
+    {
+        return offset_[ia__ + 1] - offset_[ia__];
+    }
+
+    /// Local index of the grid point by its position in the packed array.
+    inline int index(int i__) const
+    {
+        return index_[i__];
+    }
+
+    /// Distance between the grid point and the atom by the position in the packed array.
+    inline double distance(int i__) const
+    {
+        return distance_[i__];
+    }
+
+    /// Cartesian vector from the atom to the grid point by the position in the packed array.
+    inline auto const& coord(int i__) const
+    {
+        return coord_[i__];
+    }
+};
+
+} // namespace sirius
+
+#endif // __ATOMS_TO_GRID_IDX_HPP__
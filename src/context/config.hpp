@@ -103,6 +103,99 @@ class config_t
             }
             dict_["/mixer/use_hartree"_json_pointer] = use_hartree__;
         }
+        /// Mix the plane-wave coefficients of density and magnetization instead of their real-space values
+        /**
+            Only for the PP-PW case. The mixer stores only the coefficients below gmax, which reduces the memory of the history. The coefficients above gmax are taken from the new density.
+        */
+        inline auto gvec_mixing() const
+        {
+            return dict_.at("/mixer/gvec_mixing"_json_pointer).get<bool>();
+        }
+        inline void gvec_mixing(bool gvec_mixing__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/mixer/gvec_mixing"_json_pointer] = gvec_mixing__;
+        }
+        /// Cutoff (a.u.^-1) of the plane-wave coefficients which are mixed in the G-space mode
+        /**
+            Zero or negative value means the plane-wave cutoff of the density.
+        */
+        inline auto gmax() const
+        {
+            return dict_.at("/mixer/gmax"_json_pointer).get<double>();
+        }
+        inline void gmax(double gmax__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/mixer/gmax"_json_pointer] = gmax__;
+        }
+        /// Preconditioner of the charge density residual in the G-space mixing mode
+        /**
+            Kerker: P(G) = G^2 / (G^2 + q0^2), suited for metals. Resta: P(G) = (q0^2 sin(G*rs) / (eps0*G*rs) + G^2) / (q0^2 + G^2), suited for semiconductors and insulators.
+        */
+        inline auto preconditioner() const
+        {
+            return dict_.at("/mixer/preconditioner"_json_pointer).get<std::string>();
+        }
+        inline void preconditioner(std::string preconditioner__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/mixer/preconditioner"_json_pointer] = preconditioner__;
+        }
+        /// Screening wave-vector (a.u.^-1) of the Kerker and Resta preconditioners
+        inline auto q0() const
+        {
+            return dict_.at("/mixer/q0"_json_pointer).get<double>();
+        }
+        inline void q0(double q0__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/mixer/q0"_json_pointer] = q0__;
+        }
+        /// Static dielectric constant of the Resta preconditioner
+        inline auto resta_eps0() const
+        {
+            return dict_.at("/mixer/resta_eps0"_json_pointer).get<double>();
+        }
+        inline void resta_eps0(double resta_eps0__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/mixer/resta_eps0"_json_pointer] = resta_eps0__;
+        }
+        /// Screening length (a.u.) of the Resta preconditioner
+        inline auto resta_rs() const
+        {
+            return dict_.at("/mixer/resta_rs"_json_pointer).get<double>();
+        }
+        inline void resta_rs(double resta_rs__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/mixer/resta_rs"_json_pointer] = resta_rs__;
+        }
+        /// Store the vectors of the G-space mixing in single precision
+        inline auto history_fp32() const
+        {
+            return dict_.at("/mixer/history_fp32"_json_pointer).get<bool>();
+        }
+        inline void history_fp32(bool history_fp32__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/mixer/history_fp32"_json_pointer] = history_fp32__;
+        }
       private:
         nlohmann::json& dict_;
     };
@@ -131,6 +224,25 @@ class config_t
             }
             dict_["/settings/nprii_vloc"_json_pointer] = nprii_vloc__;
         }
+        /// Directory of the on-disk cache of the interpolated radial integrals.
+        /**
+            If set, the tables of the radial integrals of the pseudopotential species are stored in HDF5
+            files in this directory, one file per kind of integrals, named after the format version and the 128-bit
+            FNV-1a hash of the radial functions, radial grids and q-grid. The hash is also stored in the file.
+            A table is read instead of being recomputed when the file exists and the stored hash matches.
+            The directory must exist. Empty string disables the cache.
+        */
+        inline auto ri_cache() const
+        {
+            return dict_.at("/settings/ri_cache"_json_pointer).get<std::string>();
+        }
+        inline void ri_cache(std::string ri_cache__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/settings/ri_cache"_json_pointer] = ri_cache__;
+        }
         /// Point density (in a.u.^-1) for interpolating radial integrals of the beta projectors
         inline auto nprii_beta() const
         {
@@ -314,6 +426,22 @@ class config_t
             }
             dict_["/settings/sht_coverage"_json_pointer] = sht_coverage__;
         }
+        /// Maximum number of atoms of the same type for which the muffin-tin XC potential is computed together
+        /**
+            The spherical harmonic transformations of all atoms in a batch are done with one GEMM. The
+            memory of the XC workspace of each thread grows linearly with the batch size.
+        */
+        inline auto xc_mt_batch_size() const
+        {
+            return dict_.at("/settings/xc_mt_batch_size"_json_pointer).get<int>();
+        }
+        inline void xc_mt_batch_size(int xc_mt_batch_size__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/settings/xc_mt_batch_size"_json_pointer] = xc_mt_batch_size__;
+        }
         /// Density RMS tolerance to switch to FP64 implementation. If zero, estimation of iterative solver tolerance is used.
         inline auto fp32_to_fp64_rms() const
         {
@@ -326,6 +454,122 @@ class config_t
             }
             dict_["/settings/fp32_to_fp64_rms"_json_pointer] = fp32_to_fp64_rms__;
         }
+        /// Algorithm used to find the nearest neighbours of atoms.
+        /**
+            `direct` loops over all atoms in all lattice translations of the bounding supercell;
+            `cell_list` bins atoms in a grid of cells and only visits the cells that overlap the search sphere.
+        */
+        inline auto nn_search() const
+        {
+            return dict_.at("/settings/nn_search"_json_pointer).get<std::string>();
+        }
+        inline void nn_search(std::string nn_search__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/settings/nn_search"_json_pointer] = nn_search__;
+        }
+        /// Method to compute the reciprocal-space part of the ion-ion Ewald energy, forces and stress.
+        /**
+            `direct` sums the phase factors of all atoms for each G-vector (O(N_atoms x N_G));
+            `pme` spreads the ionic charges on the fine FFT grid with cardinal B-splines and computes the
+            structure factor with a single FFT (smooth particle-mesh Ewald).
+        */
+        inline auto ewald() const
+        {
+            return dict_.at("/settings/ewald"_json_pointer).get<std::string>();
+        }
+        inline void ewald(std::string ewald__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/settings/ewald"_json_pointer] = ewald__;
+        }
+        /// Order of the cardinal B-splines used in the particle-mesh Ewald method.
+        /**
+            Must be even. The error of the interpolated structure factor decreases as (G/G_grid)^order.
+        */
+        inline auto ewald_pme_order() const
+        {
+            return dict_.at("/settings/ewald_pme_order"_json_pointer).get<int>();
+        }
+        inline void ewald_pme_order(int ewald_pme_order__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/settings/ewald_pme_order"_json_pointer] = ewald_pme_order__;
+        }
+        /// Method to add the augmentation charge to the density and to compute the D-operator matrix.
+        /**
+            `reciprocal` sums the plane-wave coefficients Q(G) with the phase factors of all atoms
+            (O(N_atoms x N_G)); `real_space` places the Q(r) functions, filtered to the plane-wave cutoff,
+            on the points of the fine FFT grid inside the spheres around atoms (O(N_atoms)). The filter is a smooth window
+            which removes the components between 2/3 of the cutoff and the cutoff, so the augmentation charge differs from
+            the `reciprocal` method at large G. Forces and stress are not implemented for `real_space`.
+        */
+        inline auto augmentation() const
+        {
+            return dict_.at("/settings/augmentation"_json_pointer).get<std::string>();
+        }
+        inline void augmentation(std::string augmentation__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/settings/augmentation"_json_pointer] = augmentation__;
+        }
+        /// Radius of the spheres for the real-space augmentation in units of the radius of Q(r).
+        /**
+            The filtered Q(r) functions are truncated at this radius. The error of the truncation is measured
+            by apps/tests/test_aug_rs.cpp and documented in Augmentation_operator_rs.
+        */
+        inline auto augmentation_radius_scale() const
+        {
+            return dict_.at("/settings/augmentation_radius_scale"_json_pointer).get<double>();
+        }
+        inline void augmentation_radius_scale(double augmentation_radius_scale__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/settings/augmentation_radius_scale"_json_pointer] = augmentation_radius_scale__;
+        }
+        /// Extrapolation of the charge density to the new atomic positions.
+        /**
+            `atomic` subtracts the superposed free-atom densities at the old positions and adds them at
+            the new positions; `first_order` and `second_order` additionally extrapolate the remaining density
+            difference from the last two or three geometries. `none` keeps the density of the previous geometry.
+        */
+        inline auto extrapolation_rho() const
+        {
+            return dict_.at("/settings/extrapolation_rho"_json_pointer).get<std::string>();
+        }
+        inline void extrapolation_rho(std::string extrapolation_rho__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/settings/extrapolation_rho"_json_pointer] = extrapolation_rho__;
+        }
+        /// Extrapolation of the wave-functions to the new atomic positions.
+        /**
+            Wave-functions of the last two or three geometries are aligned to the current ones and
+            extrapolated with the same coefficients as the density.
+        */
+        inline auto extrapolation_wf() const
+        {
+            return dict_.at("/settings/extrapolation_wf"_json_pointer).get<std::string>();
+        }
+        inline void extrapolation_wf(std::string extrapolation_wf__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/settings/extrapolation_wf"_json_pointer] = extrapolation_wf__;
+        }
       private:
         nlohmann::json& dict_;
     };
@@ -416,6 +660,12 @@ class config_t
         {
         }
         /// Type of the iterative solver.
+        /**
+            Chebyshev-filtered subspace iteration is only available for the norm-conserving pseudopotentials;
+            the run stops with an error for the ultrasoft and PAW pseudopotentials and for the full-potential method.
+            LOBPCG solver works with the fixed basis of three times the number of bands and is only available
+            for the pseudopotential methods.
+        */
         inline auto type() const
         {
             return dict_.at("/iterative_solver/type"_json_pointer).get<std::string>();
@@ -618,6 +868,46 @@ class config_t
             }
             dict_["/iterative_solver/extra_ortho"_json_pointer] = extra_ortho__;
         }
+        /// Minimum (and initial) degree of the Chebyshev filter polynomial.
+        inline auto chebyshev_degree() const
+        {
+            return dict_.at("/iterative_solver/chebyshev_degree"_json_pointer).get<int>();
+        }
+        inline void chebyshev_degree(int chebyshev_degree__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/iterative_solver/chebyshev_degree"_json_pointer] = chebyshev_degree__;
+        }
+        /// Maximum degree of the Chebyshev filter polynomial.
+        /**
+            The degree is adapted in each step of the solver from the residual norms and the position
+            of the Ritz values with respect to the filtered interval, but it never exceeds this value.
+        */
+        inline auto chebyshev_max_degree() const
+        {
+            return dict_.at("/iterative_solver/chebyshev_max_degree"_json_pointer).get<int>();
+        }
+        inline void chebyshev_max_degree(int chebyshev_max_degree__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/iterative_solver/chebyshev_max_degree"_json_pointer] = chebyshev_max_degree__;
+        }
+        /// Number of Lanczos steps used to estimate the upper bound of the Hamiltonian spectrum.
+        inline auto num_lanczos_steps() const
+        {
+            return dict_.at("/iterative_solver/num_lanczos_steps"_json_pointer).get<int>();
+        }
+        inline void num_lanczos_steps(int num_lanczos_steps__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/iterative_solver/num_lanczos_steps"_json_pointer] = num_lanczos_steps__;
+        }
       private:
         nlohmann::json& dict_;
     };
@@ -955,6 +1245,95 @@ class config_t
             }
             dict_["/control/gvec_chunk_size"_json_pointer] = gvec_chunk_size__;
         }
+        /// Number of bands transformed together in the application of the local Hamiltonian.
+        /**
+            If larger than one, each k-point keeps this number of independent copies of the coarse-grid FFT
+            transform and the bands are pushed through SpFFT multi-transforms in batches. This amortizes the
+            setup cost and overlaps the communication of the transforms at the expense of extra FFT buffers.
+        */
+        inline auto fft_batch_size() const
+        {
+            return dict_.at("/control/fft_batch_size"_json_pointer).get<int>();
+        }
+        inline void fft_batch_size(int fft_batch_size__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/control/fft_batch_size"_json_pointer] = fft_batch_size__;
+        }
+        /// Number of local k-points processed concurrently by each MPI rank.
+        /**
+            If larger than one, the OpenMP threads of a rank are split into this number of teams and the
+            local k-points are distributed between the teams in the band diagonalization and in the generation
+            of the valence density. Each team has its own memory pools, SPLA context and copy of the coarse-grid
+            FFT transform. Only used for the pseudopotential methods on CPU when each k-point is handled by a
+            single MPI rank; otherwise the k-points are processed one after another.
+        */
+        inline auto num_kpoint_teams() const
+        {
+            return dict_.at("/control/num_kpoint_teams"_json_pointer).get<int>();
+        }
+        inline void num_kpoint_teams(int num_kpoint_teams__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/control/num_kpoint_teams"_json_pointer] = num_kpoint_teams__;
+        }
+        /// If true then the wave-functions are written to the storage file together with the density and potential.
+        /**
+            The wave-functions are saved at the end of the ground state calculation (pseudopotential case
+            only) and are used by DFT_ground_state::restart_state() instead of the initial subspace.
+        */
+        inline auto save_wave_functions() const
+        {
+            return dict_.at("/control/save_wave_functions"_json_pointer).get<bool>();
+        }
+        inline void save_wave_functions(bool save_wave_functions__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/control/save_wave_functions"_json_pointer] = save_wave_functions__;
+        }
+        /// Mode of writing the k-point set to the HDF5 storage file (`serial` or `parallel`).
+        /**
+            In the serial mode k-points are written one after another by the root rank of each k-point.
+            In the parallel mode the file is opened with MPI-IO by all ranks and the wave-functions of all
+            k-points are written concurrently with collective hyperslab writes. Requires HDF5 compiled with
+            parallel support.
+        */
+        inline auto hdf5_io() const
+        {
+            return dict_.at("/control/hdf5_io"_json_pointer).get<std::string>();
+        }
+        inline void hdf5_io(std::string hdf5_io__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/control/hdf5_io"_json_pointer] = hdf5_io__;
+        }
+        /// Distribution of k-points between MPI ranks (`block`, `cost` or `measured`).
+        /**
+            In the `block` mode each rank gets an equal number of k-points. In the `cost` mode the k-points are
+            distributed according to the estimated cost of the band diagonalization, which depends on the number of
+            G+k vectors. In the `measured` mode the initial distribution is the same as in the `cost` mode, but
+            between the SCF iterations the k-points are redistributed using the measured time of the band solver
+            (pseudopotential case only).
+        */
+        inline auto kpoint_distribution() const
+        {
+            return dict_.at("/control/kpoint_distribution"_json_pointer).get<std::string>();
+        }
+        inline void kpoint_distribution(std::string kpoint_distribution__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/control/kpoint_distribution"_json_pointer] = kpoint_distribution__;
+        }
       private:
         nlohmann::json& dict_;
     };
@@ -32,6 +32,7 @@
 #include "utils/env.hpp"
 #include "SDDK/omp.hpp"
 #include "potential/xc_functional.hpp"
+#include "dft/ewald.hpp"
 #include "linalg/linalg_spla.hpp"
 
 namespace sirius {
@@ -111,6 +112,8 @@ spfft::GridFloat& Simulation_context::spfft_grid_coarse<float>()
 void
 Simulation_context::init_fft_grid()
 {
+    PROFILE("sirius::Simulation_context::init_fft_grid");
+
     if (!(cfg().control().fft_mode() == "serial" || cfg().control().fft_mode() == "parallel")) {
         RTE_THROW("wrong FFT mode");
     }
@@ -369,6 +372,10 @@ Simulation_context::initialize()
             cfg().iterative_solver().type("davidson");
         }
     }
+    if (full_potential() && (cfg().iterative_solver().type() == "chebyshev" ||
+                             cfg().iterative_solver().type() == "lobpcg")) {
+        RTE_THROW("iterative solver " + cfg().iterative_solver().type() + " is not available for the full-potential methods");
+    }
     /* set default values for the G-vector cutoff */
     if (pw_cutoff() <= 0) {
         pw_cutoff(full_potential() ? 12 : 20);
@@ -383,6 +390,8 @@ Simulation_context::initialize()
 
     /* check the lattice symmetries */
     if (use_symmetry()) {
+        PROFILE("sirius::Simulation_context::initialize|lat_sym");
+
         auto lv = r3::matrix<double>(unit_cell().lattice_vectors());
 
         auto lat_sym = find_lat_sym(lv, cfg().control().spglib_tolerance());
@@ -545,6 +554,8 @@ Simulation_context::initialize()
     std_evp_solver_name(evsn[0]);
     gen_evp_solver_name(evsn[1]);
 
+    PROFILE_START("sirius::Simulation_context::initialize|eigen_solver");
+
     std_evp_solver_ = la::Eigensolver_factory(std_evp_solver_name());
     gen_evp_solver_ = la::Eigensolver_factory(gen_evp_solver_name());
 
@@ -562,6 +573,8 @@ Simulation_context::initialize()
         blacs_grid_ = std::make_unique<la::BLACS_grid>(mpi::Communicator::self(), 1, 1);
     }
 
+    PROFILE_STOP("sirius::Simulation_context::initialize|eigen_solver");
+
     /* setup the cyclic block size */
     if (cyclic_block_size() < 0) {
         double a = std::min(std::log2(double(num_bands()) / blacs_grid_->num_ranks_col()),
@@ -576,6 +589,7 @@ Simulation_context::initialize()
 
     /* placeholder for augmentation operator for each atom type */
     augmentation_op_.resize(unit_cell().num_atom_types());
+    augmentation_op_rs_.resize(unit_cell().num_atom_types());
 
     if (this->hubbard_correction()) {
         /* if spin orbit coupling or non collinear magnetisms are activated, then
@@ -601,6 +615,7 @@ Simulation_context::initialize()
     ::sirius::print_memory_usage(this->out(), FILE_LINE);
 
     if (verbosity() >= 1 && comm().rank() == 0) {
+        PROFILE("sirius::Simulation_context::initialize|print_info");
         print_info(this->out());
     }
 
@@ -939,6 +954,12 @@ Simulation_context::update()
     /* update unit cell (reciprocal lattice, etc.) */
     unit_cell().update();
 
+    /* the real-space part of the Ewald summation needs only the neighbours at which erfc(sqrt(lambda) * r) is
+     * above the double precision round-off, erfc(6) = 2e-17; a list of explicit radius is built by the unit cell */
+    if (!full_potential() && cfg().parameters().nn_radius() < 0) {
+        unit_cell().find_nearest_neighbours(6.0 / std::sqrt(ewald_lambda()));
+    }
+
     /* get new reciprocal vector */
     auto rlv = unit_cell().reciprocal_lattice_vectors();
 
@@ -947,6 +968,8 @@ Simulation_context::update()
     /* create a list of G-vectors for corase FFT grid; this is done only once,
        the next time only reciprocal lattice of the G-vectors is updated */
     if (!gvec_coarse_) {
+        PROFILE("sirius::Simulation_context::update|gvec_coarse");
+
         /* create list of coarse G-vectors */
         gvec_coarse_ = std::make_unique<fft::Gvec>(rlv, 2 * gk_cutoff(), comm(), cfg().control().reduce_gvec(),
                 cfg().control().spglib_tolerance());
@@ -987,6 +1010,8 @@ Simulation_context::update()
 
     /* create a list of G-vectors for dense FFT grid; G-vectors are divided between all available MPI ranks.*/
     if (!gvec_) {
+        PROFILE("sirius::Simulation_context::update|gvec");
+
         gvec_     = std::make_shared<fft::Gvec>(pw_cutoff(), *gvec_coarse_);
         gvec_fft_ = std::make_shared<fft::Gvec_fft>(*gvec_, comm_fft(), comm_ortho_fft());
 
@@ -1041,10 +1066,14 @@ Simulation_context::update()
     /* After each update of the lattice vectors we might get a different set of G-vector shells.
      * Always update the mapping between the canonical FFT distribution and "local G-shells"
      * distribution which is used in symmetriezation of lattice periodic functions. */
+    PROFILE_START("sirius::Simulation_context::update|gvec_shells");
     remap_gvec_ = std::make_unique<fft::Gvec_shells>(gvec());
+    PROFILE_STOP("sirius::Simulation_context::update|gvec_shells");
 
     /* check symmetry of G-vectors */
     if (unit_cell().num_atoms() != 0 && use_symmetry() && cfg().control().verification() >= 1) {
+        PROFILE("sirius::Simulation_context::update|check_gvec");
+
         check_gvec(gvec(), unit_cell().symmetry());
         if (!full_potential()) {
             check_gvec(gvec_coarse(), unit_cell().symmetry());
@@ -1054,6 +1083,8 @@ Simulation_context::update()
 
     /* check if FFT grid is OK; this check is especially needed if the grid is set as external parameter */
     if (cfg().control().verification() >= 0) {
+        PROFILE("sirius::Simulation_context::update|check_fft_grid");
+
         #pragma omp parallel for
         for (int igloc = 0; igloc < gvec().count(); igloc++) {
             int ig = gvec().offset() + igloc;
@@ -1081,37 +1112,52 @@ Simulation_context::update()
         init_atoms_to_grid_idx(cfg().control().rmt_max());
     }
 
+    PROFILE_START("sirius::Simulation_context::update|phase_factors");
+
     std::pair<int, int> limits(0, 0);
     for (int x : {0, 1, 2}) {
         limits.first  = std::min(limits.first, fft_grid().limits(x).first);
         limits.second = std::max(limits.second, fft_grid().limits(x).second);
     }
 
-    /* recompute phase factors for atoms */
-    phase_factors_ = sddk::mdarray<std::complex<double>, 3>(3, limits, unit_cell().num_atoms(), sddk::memory_t::host, "phase_factors_");
-    #pragma omp parallel for
-    for (int i = limits.first; i <= limits.second; i++) {
-        for (int ia = 0; ia < unit_cell().num_atoms(); ia++) {
-            auto pos = unit_cell().atom(ia).position();
-            for (int x : {0, 1, 2}) {
-                phase_factors_(x, i, ia) = std::exp(std::complex<double>(0.0, twopi * (i * pos[x])));
+    /* phase factors depend only on the fractional coordinates of atoms and on the Miller indices of G-vectors;
+       they are recomputed only if the atoms have moved */
+    std::vector<r3::vector<double>> positions(unit_cell().num_atoms());
+    for (int ia = 0; ia < unit_cell().num_atoms(); ia++) {
+        positions[ia] = unit_cell().atom(ia).position();
+    }
+    if (positions != phase_factors_positions_ ||
+        static_cast<int>(phase_factors_.size(1)) != limits.second - limits.first + 1 ||
+        static_cast<int>(phase_factors_t_.size(0)) != gvec().count() ||
+        static_cast<int>(phase_factors_t_.size(1)) != unit_cell().num_atom_types()) {
+        /* recompute phase factors for atoms */
+        phase_factors_ = sddk::mdarray<std::complex<double>, 3>(3, limits, unit_cell().num_atoms(),
+                sddk::memory_t::host, "phase_factors_");
+        #pragma omp parallel for
+        for (int i = limits.first; i <= limits.second; i++) {
+            for (int ia = 0; ia < unit_cell().num_atoms(); ia++) {
+                auto pos = unit_cell().atom(ia).position();
+                for (int x : {0, 1, 2}) {
+                    phase_factors_(x, i, ia) = std::exp(std::complex<double>(0.0, twopi * (i * pos[x])));
+                }
             }
         }
-    }
 
-    /* recompute phase factors for atom types */
-    phase_factors_t_ = sddk::mdarray<std::complex<double>, 2>(gvec().count(), unit_cell().num_atom_types());
-    #pragma omp parallel for schedule(static)
-    for (int igloc = 0; igloc < gvec().count(); igloc++) {
-        /* global index of G-vector */
-        int ig = gvec().offset() + igloc;
-        for (int iat = 0; iat < unit_cell().num_atom_types(); iat++) {
-            std::complex<double> z(0, 0);
-            for (int ia = 0; ia < unit_cell().atom_type(iat).num_atoms(); ia++) {
-                z += gvec_phase_factor(ig, unit_cell().atom_type(iat).atom_id(ia));
+        /* recompute structure factors of atom types */
+        phase_factors_t_ = sddk::mdarray<std::complex<double>, 2>(gvec().count(), unit_cell().num_atom_types());
+        #pragma omp parallel for schedule(static)
+        for (int igloc = 0; igloc < gvec().count(); igloc++) {
+            /* global index of G-vector */
+            int ig = gvec().offset() + igloc;
+            for (int iat = 0; iat < unit_cell().num_atom_types(); iat++) {
+                std::complex<double> z(0, 0);
+                for (int ia = 0; ia < unit_cell().atom_type(iat).num_atoms(); ia++) {
+                    z += gvec_phase_factor(ig, unit_cell().atom_type(iat).atom_id(ia));
+                }
+                phase_factors_t_(igloc, iat) = z;
             }
-            phase_factors_t_(igloc, iat) = z;
         }
+        phase_factors_positions_ = positions;
     }
 
     if (use_symmetry()) {
@@ -1128,6 +1174,15 @@ Simulation_context::update()
         }
     }
 
+    PROFILE_STOP("sirius::Simulation_context::update|phase_factors");
+
+    if (cfg().settings().ewald() == "pme") {
+        auto grid = fft::get_min_grid(2 * pw_cutoff(), unit_cell().reciprocal_lattice_vectors());
+        if (!ewald_pme_ || ewald_pme_->grid() != grid) {
+            ewald_pme_ = std::make_shared<Ewald_pme>(*this, cfg().settings().ewald_pme_order());
+        }
+    }
+
     switch (this->processing_unit()) {
         case sddk::device_t::CPU: {
             break;
@@ -1140,6 +1195,8 @@ Simulation_context::update()
 
     /* create or update radial integrals */
     if (!full_potential()) {
+        PROFILE_START("sirius::Simulation_context::update|radial_integrals");
+
         /* find the new maximum length of G-vectors */
         double new_pw_cutoff{this->pw_cutoff()};
         for (int igloc = 0; igloc < gvec().count(); igloc++) {
@@ -1219,6 +1276,9 @@ Simulation_context::update()
                 new Radial_integrals_atomic_wf<true>(unit_cell(), new_gk_cutoff, 20, idxr_wf, ps_wf, ps_atomic_wf_ri_djl_callback_));
         }
 
+        PROFILE_STOP("sirius::Simulation_context::update|radial_integrals");
+
+        PROFILE_START("sirius::Simulation_context::update|augmentation_operator");
         for (int iat = 0; iat < unit_cell().num_atom_types(); iat++) {
             if (unit_cell().atom_type(iat).augment() && unit_cell().atom_type(iat).num_atoms() > 0) {
                 augmentation_op_[iat] = std::make_unique<Augmentation_operator>(unit_cell().atom_type(iat), gvec(), aug_ri(), aug_ri_djl());
@@ -1227,6 +1287,23 @@ Simulation_context::update()
                 augmentation_op_[iat] = nullptr;
             }
         }
+        if (cfg().settings().augmentation() == "real_space") {
+            std::vector<double> radius(unit_cell().num_atom_types(), 0);
+            for (int iat = 0; iat < unit_cell().num_atom_types(); iat++) {
+                if (augmentation_op_[iat]) {
+                    augmentation_op_rs_[iat] = std::make_unique<Augmentation_operator_rs>(unit_cell().atom_type(iat),
+                        new_pw_cutoff, cfg().settings().augmentation_radius_scale(), cfg().settings().nprii_aug(),
+                        aug_ri());
+                    radius[iat] = augmentation_op_rs_[iat]->radius();
+                } else {
+                    augmentation_op_rs_[iat] = nullptr;
+                }
+            }
+            std::array<int, 3> dims{spfft<double>().dim_x(), spfft<double>().dim_y(), spfft<double>().dim_z()};
+            aug_to_grid_idx_.update(unit_cell(), radius, dims, spfft<double>().local_z_offset(),
+                                    spfft<double>().local_z_length());
+        }
+        PROFILE_STOP("sirius::Simulation_context::update|augmentation_operator");
     }
 
     if (full_potential()) { // TODO: add corresponging radial integarls of Theta
@@ -1327,79 +1404,19 @@ Simulation_context::init_atoms_to_grid_idx(double R__)
 
     auto Rmt = unit_cell().find_mt_radii(1, true);
 
-    double R{0};
-    for (auto e : Rmt) {
-        R = std::max(e, R);
-    }
-
-    //double R = R__;
-
-    atoms_to_grid_idx_.resize(unit_cell().num_atoms());
-
-    r3::vector<double> delta(1.0 / spfft<double>().dim_x(), 1.0 / spfft<double>().dim_y(), 1.0 / spfft<double>().dim_z());
+    std::array<int, 3> dims{spfft<double>().dim_x(), spfft<double>().dim_y(), spfft<double>().dim_z()};
 
-    int z_off = spfft<double>().local_z_offset();
-    r3::vector<int> grid_beg(0, 0, z_off);
-    r3::vector<int> grid_end(spfft<double>().dim_x(), spfft<double>().dim_y(), z_off + spfft<double>().local_z_length());
-    std::vector<r3::vector<double>> verts_cart{{-R, -R, -R}, {R, -R, -R}, {-R, R, -R}, {R, R, -R},
-                                             {-R, -R, R},  {R, -R, R},  {-R, R, R},  {R, R, R}};
-
-    auto bounds_box = [&](r3::vector<double> pos) {
-        std::vector<r3::vector<double>> verts;
-
-        /* pos is a position of atom */
-        for (auto v : verts_cart) {
-            verts.push_back(pos + unit_cell().get_fractional_coordinates(v));
-        }
-
-        std::pair<r3::vector<int>, r3::vector<int>> bounds_ind;
-
-        for (int x : {0, 1, 2}) {
-            std::sort(verts.begin(), verts.end(),
-                      [x](r3::vector<double>& a, r3::vector<double>& b) { return a[x] < b[x]; });
-            bounds_ind.first[x]  = std::max(static_cast<int>(verts[0][x] / delta[x]) - 1, grid_beg[x]);
-            bounds_ind.second[x] = std::min(static_cast<int>(verts[5][x] / delta[x]) + 1, grid_end[x]);
-        }
-
-        return bounds_ind;
-    };
-
-    #pragma omp parallel for
-    for (int ia = 0; ia < unit_cell().num_atoms(); ia++) {
-
-        std::vector<std::pair<int, double>> atom_to_ind_map;
-
-        for (int t0 = -1; t0 <= 1; t0++) {
-            for (int t1 = -1; t1 <= 1; t1++) {
-                for (int t2 = -1; t2 <= 1; t2++) {
-                    auto pos = unit_cell().atom(ia).position() + r3::vector<double>(t0, t1, t2);
-
-                    /* find the small box around this atom */
-                    auto box = bounds_box(pos);
-
-                    for (int j0 = box.first[0]; j0 < box.second[0]; j0++) {
-                        for (int j1 = box.first[1]; j1 < box.second[1]; j1++) {
-                            for (int j2 = box.first[2]; j2 < box.second[2]; j2++) {
-                                auto v = pos - r3::vector<double>(delta[0] * j0, delta[1] * j1, delta[2] * j2);
-                                auto r = unit_cell().get_cartesian_coordinates(v).length();
-                                if (r < Rmt[unit_cell().atom(ia).type_id()]) {
-                                    auto ir = fft_grid_.index_by_coord(j0, j1, j2 - z_off);
-                                    atom_to_ind_map.push_back({ir, r});
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
-
-        atoms_to_grid_idx_[ia] = std::move(atom_to_ind_map);
-    }
+    /* the list is rebuilt from scratch only if the lattice or the FFT grid have changed; otherwise only the atoms
+     * which have moved are updated */
+    atoms_to_grid_idx_.update(unit_cell(), Rmt, dims, spfft<double>().local_z_offset(),
+                              spfft<double>().local_z_length());
 }
 
 void
 Simulation_context::init_step_function()
 {
+    PROFILE("sirius::Simulation_context::init_step_function");
+
     auto v = make_periodic_function<sddk::index_domain_t::global>([&](int iat, double g) {
         auto R = unit_cell().atom_type(iat).mt_radius();
         return unit_step_function_form_factors(R, g);
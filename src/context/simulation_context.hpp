@@ -30,6 +30,7 @@
 #include <spla/spla.hpp>
 
 #include "simulation_parameters.hpp"
+#include "atoms_to_grid_idx.hpp"
 #include "mpi/mpi_grid.hpp"
 #include "radial/radial_integrals.hpp"
 #include "utils/utils.hpp"
@@ -38,6 +39,7 @@
 #include "gpu/acc.hpp"
 #include "symmetry/rotation.hpp"
 #include "fft/fft.hpp"
+#include "SDDK/omp.hpp"
 
 #ifdef SIRIUS_GPU
 extern "C" void generate_phase_factors_gpu(int num_gvec_loc__, int num_atoms__, int const* gvec__,
@@ -83,13 +85,17 @@ print_memory_usage(OUT&& out__, std::string file_and_line__ = "")
         out__ << "[mem.pool] " << labels[i] << ": total capacity: " << (mp[i]->total_size() >> 20) << " Mb, "
               << "free: " << (mp[i]->free_size() >> 20) << " Mb, "
               << "num.blocks: " <<  mp[i]->num_blocks() << ", "
-              << "num.pointers: " << mp[i]->num_stored_ptr() << std::endl;
+              << "num.pointers: " << mp[i]->num_stored_ptr() << ", "
+              << "high water mark: " << (mp[i]->high_water_mark() >> 20) << " Mb, "
+              << "fragmentation: " << mp[i]->fragmentation() << std::endl;
     }
 }
 
 /// Utility function to generate LAPW unit step function.
 double unit_step_function_form_factors(double R__, double g__);
 
+class Ewald_pme;
+
 /// Simulation context is a set of parameters and objects describing a single simulation.
 /** The order of initialization of the simulation context is the following: first, the default parameter
     values are set in the constructor, then (optionally) import() method is called and the parameters are
@@ -165,9 +171,17 @@ class Simulation_context : public Simulation_parameters
     /// 1D phase factors of the symmetry operations.
     sddk::mdarray<std::complex<double>, 3> sym_phase_factors_;
 
-    /// Phase factors for atom types.
+    /// Structure factors of atom types for the local set of G-vectors.
     sddk::mdarray<std::complex<double>, 2> phase_factors_t_;
 
+    /// Atomic positions for which the phase and structure factors were computed.
+    std::vector<r3::vector<double>> phase_factors_positions_;
+
+    /// Grid and FFT plan of the particle-mesh Ewald method.
+    /** Created in update() if the particle-mesh Ewald method is selected in settings.ewald and recreated only
+        if the size of the grid changes with the lattice. */
+    std::shared_ptr<Ewald_pme> ewald_pme_;
+
     /// Lattice coordinats of G-vectors in a GPU-friendly ordering.
     sddk::mdarray<int, 2> gvec_coord_;
 
@@ -234,7 +248,10 @@ class Simulation_context : public Simulation_parameters
     std::function<void(int, int, double*, double*)> vloc_ri_djl_callback_{nullptr};
 
     /// List of real-space point indices for each of the atoms.
-    std::vector<std::vector<std::pair<int, double>>> atoms_to_grid_idx_;
+    Atoms_to_grid_idx atoms_to_grid_idx_;
+
+    /// List of real-space points inside the spheres of the real-space augmentation operator.
+    Atoms_to_grid_idx aug_to_grid_idx_;
 
     /// Plane wave expansion coefficients of the step function.
     sddk::mdarray<std::complex<double>, 1> theta_pw_;
@@ -246,6 +263,10 @@ class Simulation_context : public Simulation_parameters
     /** The augmentation operator is used by Density, Potential, Q_operator, and Non_local_functor classes. */
     std::vector<std::unique_ptr<Augmentation_operator>> augmentation_op_;
 
+    /// Real-space augmentation operator for each atom type.
+    /** Created only if the real-space augmentation is selected in settings.augmentation. */
+    std::vector<std::unique_ptr<Augmentation_operator_rs>> augmentation_op_rs_;
+
     /// Standard eigen-value problem solver.
     std::unique_ptr<la::Eigensolver> std_evp_solver_;
 
@@ -264,6 +285,9 @@ class Simulation_context : public Simulation_parameters
     /// Spla context.
     std::shared_ptr<::spla::Context> spla_ctx_{new ::spla::Context{SPLA_PU_HOST}};
 
+    /// Spla contexts of the additional thread teams used for the concurrent processing of k-points.
+    std::vector<std::unique_ptr<::spla::Context>> spla_ctx_team_;
+
     std::ostream* output_stream_{nullptr};
     std::ofstream output_file_stream_;
 
@@ -397,11 +421,18 @@ class Simulation_context : public Simulation_parameters
     /// Update context after setting new lattice vectors or atomic coordinates.
     void update();
 
-    auto const& atoms_to_grid_idx_map(int ia__) const
+    /// Return the list of real-space grid points inside the spheres around atoms.
+    auto const& atoms_to_grid_idx() const
     {
-        return atoms_to_grid_idx_[ia__];
+        return atoms_to_grid_idx_;
     };
 
+    /// Return the list of real-space grid points inside the spheres of the real-space augmentation operator.
+    auto const& aug_to_grid_idx() const
+    {
+        return aug_to_grid_idx_;
+    }
+
     auto& unit_cell()
     {
         return *unit_cell_;
@@ -563,6 +594,25 @@ class Simulation_context : public Simulation_parameters
         return gvec_phase_factor(gvec().gvec<sddk::index_domain_t::global>(ig__), ia__);
     }
 
+    /// Structure factor of an atom type for a local G-vector.
+    /** The factors
+     *  \f[
+     *    S_t({\bf G}) = \sum_{\alpha \in t} e^{i{\bf G}{\bf r}_{\alpha}}
+     *  \f]
+     *  are computed once per geometry in update() and are shared by all G-space builders (local potential,
+     *  pseudo-core and free-atom densities, Ewald sum, stress tensor). */
+    inline auto structure_factor(int igloc__, int iat__) const
+    {
+        return phase_factors_t_(igloc__, iat__);
+    }
+
+    /// Particle-mesh Ewald method for the ionic structure factor.
+    inline auto const& ewald_pme() const
+    {
+        RTE_ASSERT(ewald_pme_ != nullptr);
+        return *ewald_pme_;
+    }
+
     inline auto const& gvec_coord() const
     {
         return gvec_coord_;
@@ -747,6 +797,13 @@ class Simulation_context : public Simulation_parameters
         return *augmentation_op_[iat__];
     }
 
+    /// Returns a constant pointer to the real-space augmentation operator of a given atom type.
+    inline auto const& augmentation_op_rs(int iat__) const
+    {
+        RTE_ASSERT(augmentation_op_rs_[iat__] != nullptr);
+        return *augmentation_op_rs_[iat__];
+    }
+
     /// Type of the host memory for arrays used in linear algebra operations.
     /** For CPU execution this is normal host memory, for GPU execution this is pinned memory. */
     inline auto host_memory_t() const
@@ -791,18 +848,31 @@ class Simulation_context : public Simulation_parameters
         return fft_coarse_grid_;
     }
 
+    /// Return the Spla context of the calling thread team.
     auto const& spla_context() const
     {
-        return *spla_ctx_;
+        int t = sddk::thread_team_id();
+        return (t == 0) ? *spla_ctx_ : *spla_ctx_team_[t - 1];
     }
 
     auto& spla_context()
     {
-        return *spla_ctx_;
+        int t = sddk::thread_team_id();
+        return (t == 0) ? *spla_ctx_ : *spla_ctx_team_[t - 1];
+    }
+
+    /// Create Spla contexts for the given number of thread teams.
+    /** Must be called outside of the parallel region. */
+    void init_thread_teams(int num_teams__)
+    {
+        while (static_cast<int>(spla_ctx_team_.size()) < num_teams__ - 1) {
+            spla_ctx_team_.emplace_back(new ::spla::Context{SPLA_PU_HOST});
+        }
     }
 
     inline double evp_work_count(double w__ = 0) const
     {
+        #pragma omp atomic
         evp_work_count_ += w__;
         return evp_work_count_;
     }
@@ -810,12 +880,14 @@ class Simulation_context : public Simulation_parameters
     /// Keep track of the total number of wave-functions to which the local operator was applied.
     inline int num_loc_op_applied(int n = 0) const
     {
+        #pragma omp atomic
         num_loc_op_applied_ += n;
         return num_loc_op_applied_;
     }
 
     inline int num_itsol_steps(int n = 0) const
     {
+        #pragma omp atomic
         num_itsol_steps_ += n;
         return num_itsol_steps_;
     }
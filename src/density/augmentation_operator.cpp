@@ -186,4 +186,226 @@ void Augmentation_operator::generate_pw_coeffs_gvec_deriv(int nu__)
     }
 }
 
+Augmentation_operator_rs::Augmentation_operator_rs(Atom_type const& atom_type__, double gmax__,
+                                                   double radius_scale__, int np__,
+                                                   Radial_integrals_aug<false> const& ri__)
+    : atom_type_(atom_type__)
+    , gaunt_coefs_(atom_type__.indexr().lmax(), 2 * atom_type__.indexr().lmax(), atom_type__.indexr().lmax(),
+                   SHT::gaunt_rrr)
+{
+    PROFILE("sirius::Augmentation_operator_rs");
+
+    int lmax_beta = atom_type_.indexr().lmax();
+    int lmax      = 2 * lmax_beta;
+
+    /* number of beta-projectors */
+    int nbf = atom_type_.mt_basis_size();
+    /* number of beta-projector radial functions */
+    int nbrf = atom_type_.mt_radial_basis_size();
+    /* only half of Q_{xi,xi'} matrix is stored */
+    int nqlm = nbf * (nbf + 1) / 2;
+    /* packed index of radial functions */
+    int nrf12 = nbrf * (nbrf + 1) / 2;
+
+    /* flatten the indices */
+    idx_        = sddk::mdarray<int, 2>(3, nqlm);
+    sym_weight_ = sddk::mdarray<double, 1>(nqlm);
+    for (int xi2 = 0; xi2 < nbf; xi2++) {
+        for (int xi1 = 0; xi1 <= xi2; xi1++) {
+            int idx12 = utils::packed_index(xi1, xi2);
+
+            idx_(0, idx12)     = atom_type_.indexb(xi1).lm;
+            idx_(1, idx12)     = atom_type_.indexb(xi2).lm;
+            idx_(2, idx12)     = utils::packed_index(atom_type_.indexb(xi1).idxrf, atom_type_.indexb(xi2).idxrf);
+            sym_weight_(idx12) = (xi1 == xi2) ? 1 : 2;
+        }
+    }
+
+    /* find the radius of the original Q(r) functions */
+    double rq{0};
+    for (int idxrf2 = 0; idxrf2 < nbrf; idxrf2++) {
+        int l2 = atom_type_.indexr(idxrf2).l;
+        for (int idxrf1 = 0; idxrf1 <= idxrf2; idxrf1++) {
+            int l1 = atom_type_.indexr(idxrf1).l;
+            for (int l3 = std::abs(l1 - l2); l3 <= l1 + l2; l3 += 2) {
+                auto const& q = atom_type_.q_radial_function(idxrf1, idxrf2, l3);
+                for (int ir = q.num_points() - 1; ir >= 0; ir--) {
+                    if (std::abs(q(ir)) > 1e-12) {
+                        rq = std::max(rq, q[ir]);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    if (rq == 0) {
+        RTE_THROW("augmentation functions of atom type " + atom_type_.label() + " are zero");
+    }
+    radius_ = radius_scale__ * rq;
+    gmax_   = gmax__;
+
+    /* q-grid of the filtering integral; Simpson's rule needs an odd number of points */
+    int nq = std::max(3, static_cast<int>(np__ * gmax__) + 1);
+    if (nq % 2 == 0) {
+        nq++;
+    }
+    double dq = gmax__ / (nq - 1);
+
+    /* radial integrals multiplied by the integration weights */
+    sddk::mdarray<double, 3> ri(nrf12, lmax + 1, nq);
+    #pragma omp parallel for
+    for (int iq = 0; iq < nq; iq++) {
+        double q = iq * dq;
+        double w = (iq == 0 || iq == nq - 1) ? 1 : ((iq % 2) ? 4 : 2);
+        w *= (2.0 / pi) * q * q * dq * window(q) / 3;
+        auto v = ri__.values(atom_type_.id(), q);
+        for (int l = 0; l <= lmax; l++) {
+            for (int i = 0; i < nrf12; i++) {
+                ri(i, l, iq) = v(i, l) * w;
+            }
+        }
+    }
+
+    /* the linear grid must resolve the oscillations of the spherical Bessel functions at the cutoff */
+    int nr = static_cast<int>(radius_ * std::max(100.0, 10 * gmax__)) + 2;
+    rgrid_ = Radial_grid_lin<double>(nr, 0, radius_);
+
+    sddk::mdarray<double, 3> qrf(nr, nrf12, lmax + 1);
+    qrf.zero();
+    #pragma omp parallel for schedule(dynamic)
+    for (int ir = 0; ir < nr; ir++) {
+        std::vector<double> jl(lmax + 1);
+        for (int iq = 0; iq < nq; iq++) {
+            Spherical_Bessel_functions::sbessel(lmax, iq * dq * rgrid_[ir], jl.data());
+            for (int l = 0; l <= lmax; l++) {
+                for (int i = 0; i < nrf12; i++) {
+                    qrf(ir, i, l) += ri(i, l, iq) * jl[l];
+                }
+            }
+        }
+    }
+
+    qrf_ = sddk::mdarray<Spline<double>, 2>(nrf12, lmax + 1);
+    for (int l = 0; l <= lmax; l++) {
+        for (int i = 0; i < nrf12; i++) {
+            qrf_(i, l) = Spline<double>(rgrid_, std::vector<double>(&qrf(0, i, l), &qrf(0, i, l) + nr));
+        }
+    }
+}
+
+void Augmentation_operator_rs::values_at_point(r3::vector<double> const& r__, double* qrf__, double* rlm__) const
+{
+    int lmax  = 2 * atom_type_.indexr().lmax();
+    int nrf12 = static_cast<int>(qrf_.size(0));
+
+    auto rtp = r3::spherical_coordinates(r__);
+    sf::spherical_harmonics(lmax, rtp[1], rtp[2], rlm__);
+
+    /* position of the point on the linear radial grid */
+    int ir    = std::min(static_cast<int>(rtp[0] / rgrid_.dx(0)), rgrid_.num_points() - 2);
+    double dx = rtp[0] - rgrid_[ir];
+    for (int l = 0; l <= lmax; l++) {
+        for (int i = 0; i < nrf12; i++) {
+            qrf__[i + l * nrf12] = qrf_(i, l)(ir, dx);
+        }
+    }
+}
+
+void Augmentation_operator_rs::add_rho(Atoms_to_grid_idx const& atg__, int ia__, int i__,
+                                       sddk::mdarray<double, 3> const& dm__, sddk::mdarray<double, 2>& rho__) const
+{
+    int lmax  = 2 * atom_type_.indexr().lmax();
+    int lmmax = utils::lmmax(lmax);
+    int nrf12 = static_cast<int>(qrf_.size(0));
+    int nqlm  = static_cast<int>(idx_.size(1));
+    int ncomp = static_cast<int>(rho__.size(1));
+
+    auto l_by_lm = utils::l_by_lm(lmax);
+
+    /* expand the augmentation charge of the atom in the filtered radial functions and spherical harmonics */
+    sddk::mdarray<double, 3> a(nrf12, lmmax, ncomp);
+    a.zero();
+    for (int iv = 0; iv < ncomp; iv++) {
+        for (int idx12 = 0; idx12 < nqlm; idx12++) {
+            double z = sym_weight_(idx12) * dm__(idx12, i__, iv);
+            auto row = gaunt_coefs_.gaunt_row(idx_(0, idx12), idx_(1, idx12));
+            for (int k = 0; k < row.size; k++) {
+                a(idx_(2, idx12), row.lm3[k], iv) += z * row.coef[k];
+            }
+        }
+    }
+
+    int offs = atg__.offset(ia__);
+    #pragma omp parallel
+    {
+        std::vector<double> qrf(nrf12 * (lmax + 1));
+        std::vector<double> rlm(lmmax);
+        #pragma omp for
+        for (int j = offs; j < offs + atg__.num_points(ia__); j++) {
+            values_at_point(atg__.coord(j), qrf.data(), rlm.data());
+            int ir = atg__.index(j);
+            for (int iv = 0; iv < ncomp; iv++) {
+                double v{0};
+                for (int lm = 0; lm < lmmax; lm++) {
+                    double const* q = &qrf[l_by_lm[lm] * nrf12];
+                    double t{0};
+                    for (int i = 0; i < nrf12; i++) {
+                        t += a(i, lm, iv) * q[i];
+                    }
+                    v += t * rlm[lm];
+                }
+                /* the same point can be listed for several periodic images of the atom */
+                #pragma omp atomic update
+                rho__(ir, iv) += v;
+            }
+        }
+    }
+}
+
+void Augmentation_operator_rs::integrate(Atoms_to_grid_idx const& atg__, int ia__, int i__,
+                                         sddk::mdarray<double, 2> const& f__, double dv__,
+                                         sddk::mdarray<double, 3>& d__) const
+{
+    int lmax  = 2 * atom_type_.indexr().lmax();
+    int lmmax = utils::lmmax(lmax);
+    int nrf12 = static_cast<int>(qrf_.size(0));
+    int nqlm  = static_cast<int>(idx_.size(1));
+    int ncomp = static_cast<int>(f__.size(1));
+
+    auto l_by_lm = utils::l_by_lm(lmax);
+
+    /* integrals of the functions with the filtered radial functions and spherical harmonics */
+    sddk::mdarray<double, 3> b(nrf12, lmmax, ncomp);
+    b.zero();
+
+    std::vector<double> qrf(nrf12 * (lmax + 1));
+    std::vector<double> rlm(lmmax);
+    int offs = atg__.offset(ia__);
+    for (int j = offs; j < offs + atg__.num_points(ia__); j++) {
+        values_at_point(atg__.coord(j), qrf.data(), rlm.data());
+        int ir = atg__.index(j);
+        for (int iv = 0; iv < ncomp; iv++) {
+            double f = f__(ir, iv) * dv__;
+            for (int lm = 0; lm < lmmax; lm++) {
+                double const* q = &qrf[l_by_lm[lm] * nrf12];
+                double t = f * rlm[lm];
+                for (int i = 0; i < nrf12; i++) {
+                    b(i, lm, iv) += t * q[i];
+                }
+            }
+        }
+    }
+
+    for (int iv = 0; iv < ncomp; iv++) {
+        for (int idx12 = 0; idx12 < nqlm; idx12++) {
+            auto row = gaunt_coefs_.gaunt_row(idx_(0, idx12), idx_(1, idx12));
+            double d{0};
+            for (int k = 0; k < row.size; k++) {
+                d += row.coef[k] * b(idx_(2, idx12), row.lm3[k], iv);
+            }
+            d__(idx12, i__, iv) = d;
+        }
+    }
+}
+
 } // namespace sirius
@@ -27,6 +27,7 @@
 
 #include "radial/radial_integrals.hpp"
 #include "fft/gvec.hpp"
+#include "context/atoms_to_grid_idx.hpp"
 
 #if defined(SIRIUS_GPU)
 extern "C" {
@@ -286,6 +287,120 @@ class Augmentation_operator
     }
 };
 
+/// Augmentation charge operator Q(r) on the points of the real-space grid around atoms.
+/** The plane-wave coefficients \f$ Q_{\xi \xi'}({\bf G}) \f$ of the augmentation operator are replaced by
+ *  \f$ W(G) Q_{\xi \xi'}({\bf G}) \f$, which are the Fourier transform of the function
+ *  \f[
+ *    \tilde Q_{\xi \xi'}({\bf r}) = \sum_{\ell_3 m_3} \langle \ell_1 m_1 | \ell_3 m_3 | \ell_2 m_2 \rangle
+ *      \tilde Q^{\ell_3}_{\ell_1 \nu_1, \ell_2 \nu_2}(r) R_{\ell_3 m_3}(\hat {\bf r}), \quad
+ *    \tilde Q^{\ell}_{\nu \nu'}(r) = \frac{2}{\pi} \int_{0}^{G_{max}} W(q) q^2 j_{\ell}(qr)
+ *      \int Q^{\ell}_{\nu \nu'}(r') j_{\ell}(qr') r'^2 dr' dq
+ *  \f]
+ *  i.e. of the pseudized radial functions of Q(r). The window \f$ W(q) \f$ is equal to 1 below \f$ 2G_{max}/3 \f$
+ *  and goes to zero at the cutoff as \f$ \cos^2 \f$. The filtered radial functions are tabulated once per atom type
+ *  and placed on the grid points inside the sphere around each atom; the same functions are used for the density and
+ *  for the D-operator matrix.
+ *
+ *  With a sharp cutoff the filtered functions would decay as \f$ \cos(G_{max} r) / r^2 \f$ and the error of the
+ *  truncation at the sphere boundary would decrease only as \f$ R^{-1/2} \f$. With the smooth window they decay as
+ *  \f$ r^{-4} \f$ and the error converges with the radius. For Ni with d-projectors and a plane-wave cutoff of
+ *  30 a.u.^-1 the relative error of the augmentation charge in the worst channel is 2.6e-4, 2.1e-5 and 8.0e-6 for
+ *  the sphere radius 1, 1.5 and 2 times the radius of Q(r), and 2.8e-5, 2.0e-6 and 7.2e-7 for a general density
+ *  matrix; the relative error of the D-operator matrix is below 1e-6 (see apps/tests/test_aug_rs.cpp). The window
+ *  itself changes the augmentation charge of a general density matrix by 6.8e-4 with respect to the
+ *  reciprocal-space method.
+ *
+ *  This allows to add the augmentation charge to the density and to compute the D-operator matrix at the cost
+ *  proportional to the number of atoms instead of the number of atoms times the number of G-vectors. Forces and
+ *  stress are not implemented for this method.
+ */
+class Augmentation_operator_rs
+{
+  private:
+    Atom_type const& atom_type_;
+
+    /// Gaunt coefficients of three real spherical harmonics.
+    Gaunt_coefficients<double> gaunt_coefs_;
+
+    /// Radius of the sphere around the atom.
+    double radius_{0};
+
+    /// Plane-wave cutoff of the filtered functions.
+    double gmax_{0};
+
+    /// Linear radial grid on which the filtered radial functions are tabulated.
+    Radial_grid<double> rgrid_;
+
+    /// Filtered radial functions for each packed index of the radial functions and each l.
+    sddk::mdarray<Spline<double>, 2> qrf_;
+
+    /// Indices lm1, lm2, and idxrf12 for each packed index of the beta-projectors.
+    sddk::mdarray<int, 2> idx_;
+
+    /// Weight of the packed index: 2 for the off-diagonal and 1 for the diagonal elements.
+    sddk::mdarray<double, 1> sym_weight_;
+
+    /// Values of the filtered radial functions and of the real spherical harmonics at a grid point.
+    void values_at_point(r3::vector<double> const& r__, double* qrf__, double* rlm__) const;
+
+  public:
+    /// Constructor.
+    /**\param [in] atom_type    Atom type instance.
+     * \param [in] gmax         Plane-wave cutoff of the filtered functions.
+     * \param [in] radius_scale Radius of the sphere in units of the radius of Q(r).
+     * \param [in] np           Point density of the q-grid for the filtering integral.
+     * \param [in] ri           Radial integrals of the Q(r) with spherical Bessel functions.
+     */
+    Augmentation_operator_rs(Atom_type const& atom_type__, double gmax__, double radius_scale__, int np__,
+                             Radial_integrals_aug<false> const& ri__);
+
+    /// Add the augmentation charge of an atom to the functions on the local part of the real-space grid.
+    /** \param [in]    atg  List of grid points around atoms.
+     *  \param [in]    ia   Global index of the atom.
+     *  \param [in]    i    Index of the atom in the list of atoms of this type.
+     *  \param [in]    dm   Auxiliary density matrix dm(idx12, i, iv) of the atoms of this type.
+     *  \param [inout] rho  Density and magnetization rho(ir, iv) on the local part of the grid.
+     */
+    void add_rho(Atoms_to_grid_idx const& atg__, int ia__, int i__, sddk::mdarray<double, 3> const& dm__,
+                 sddk::mdarray<double, 2>& rho__) const;
+
+    /// Integrate the functions on the local part of the real-space grid with Q(r) of an atom.
+    /** \param [in]    atg  List of grid points around atoms.
+     *  \param [in]    ia   Global index of the atom.
+     *  \param [in]    i    Index of the atom in the list of atoms of this type.
+     *  \param [in]    f    Functions f(ir, iv) on the local part of the grid.
+     *  \param [in]    dv   Volume element of the grid.
+     *  \param [out]   d    Integrals d(idx12, i, iv) for the packed index of the beta-projectors.
+     */
+    void integrate(Atoms_to_grid_idx const& atg__, int ia__, int i__, sddk::mdarray<double, 2> const& f__,
+                   double dv__, sddk::mdarray<double, 3>& d__) const;
+
+    /// Radius of the sphere around the atom.
+    inline double radius() const
+    {
+        return radius_;
+    }
+
+    /// Window W(q) of the filtering integral.
+    /** The window is equal to 1 below 2/3 of the cutoff and goes smoothly to zero at the cutoff. */
+    inline double window(double q__) const
+    {
+        double q0 = 2 * gmax_ / 3;
+        if (q__ <= q0) {
+            return 1;
+        }
+        if (q__ >= gmax_) {
+            return 0;
+        }
+        return std::pow(std::cos(0.5 * pi * (q__ - q0) / (gmax_ - q0)), 2);
+    }
+
+    Atom_type const& atom_type() const
+    {
+        return atom_type_;
+    }
+};
+
 } // namespace sirius
 
 #endif // __AUGMENTATION_OPERATOR_H__
@@ -165,16 +165,24 @@ Density::initial_density()
     }
 }
 
-void
-Density::initial_density_pseudo()
+std::vector<std::complex<double>>
+Density::atomic_density_pw() const
 {
+    PROFILE("sirius::Density::atomic_density_pw");
+
     /* get lenghts of all G shells */
     auto q = ctx_.gvec().shells_len();
     /* get form-factors for all G shells */
     // TODO: MPI parallelise over G-shells
     auto ff = ctx_.ps_rho_ri().values(q, ctx_.comm());
-    /* make Vloc(G) */
-    auto v = ctx_.make_periodic_function<sddk::index_domain_t::local>(ff);
+    /* make rho(G) */
+    return ctx_.make_periodic_function<sddk::index_domain_t::local>(ff);
+}
+
+void
+Density::initial_density_pseudo()
+{
+    auto v = atomic_density_pw();
 
     if (ctx_.cfg().control().print_checksum()) {
         auto z1 = sddk::mdarray<std::complex<double>, 1>(&v[0], ctx_.gvec().count()).checksum();
@@ -228,14 +236,14 @@ Density::initial_density_pseudo()
             return (1 - std::pow(x / R, 2)) * std::exp(x / R) / norm;
         };
 
-        for (int ia = 0; ia < unit_cell_.num_atoms(); ia++) {
-            auto& atom_to_grid_map = ctx_.atoms_to_grid_idx_map(ia);
+        auto const& atg = ctx_.atoms_to_grid_idx();
 
+        for (int ia = 0; ia < unit_cell_.num_atoms(); ia++) {
             auto v = unit_cell_.atom(ia).vector_field();
 
-            for (auto coord : atom_to_grid_map) {
-                int ir   = coord.first;
-                double r = coord.second;
+            for (int i = atg.offset(ia); i < atg.offset(ia + 1); i++) {
+                int ir   = atg.index(i);
+                double r = atg.distance(i);
                 double f = w(Rmt[unit_cell_.atom(ia).type_id()], r);
                 mag(0).rg().value(ir) += v[2] * f;
                 if (ctx_.num_mag_dims() == 3) {
@@ -530,7 +538,7 @@ Density::generate_paw_atom_density(int ialoc__)
 
                 /* add nonzero coefficients */
                 for (int inz = 0; inz < num_non_zero_gc; inz++) {
-                    auto& lm3coef = GC.gaunt(lm1, lm2, inz);
+                    auto lm3coef = GC.gaunt(lm1, lm2, inz);
 
                     /* iterate over radial points */
                     for (int irad = 0; irad < grid.num_points(); irad++) {
@@ -744,7 +752,8 @@ Density::add_k_point_contribution_rg(K_point<T>* kp__, std::array<wf::Wave_funct
         density_rg.copy_to(sddk::memory_t::host);
     }
 
-    /* switch from real density matrix to density and magnetization */
+    /* switch from real density matrix to density and magnetization; k-points may be processed concurrently */
+    #pragma omp critical(rho_mag_coarse)
     switch (ctx_.num_mag_dims()) {
         case 3: {
             #pragma omp parallel for
@@ -1193,7 +1202,8 @@ Density::augment()
         return;
     }
 
-    auto rho_aug = generate_rho_aug();
+    auto rho_aug = (ctx_.cfg().settings().augmentation() == "real_space") ? generate_rho_aug_rs()
+                                                                          : generate_rho_aug();
 
     for (int iv = 0; iv < ctx_.num_mag_dims() + 1; iv++) {
         #pragma omp parallel for schedule(static)
@@ -1252,11 +1262,23 @@ Density::generate_valence(K_point_set const& ks__)
 
     auto mem = ctx_.processing_unit() == sddk::device_t::CPU ? sddk::memory_t::host : sddk::memory_t::device;
 
+    /* each additional k-point team accumulates its own density matrix */
+    int num_teams = ks__.num_kpoint_teams();
+    std::vector<sddk::mdarray<std::complex<double>, 4>> density_matrix_team;
+    for (int i = 1; i < num_teams && density_matrix_.size(); i++) {
+        density_matrix_team.emplace_back(density_matrix_.size(0), density_matrix_.size(1), density_matrix_.size(2),
+                density_matrix_.size(3));
+        density_matrix_team.back().zero();
+    }
+
+    double t_loop = -utils::wtime();
     /* start the main loop over k-points */
-    for (int ikloc = 0; ikloc < ks__.spl_num_kpoints().local_size(); ikloc++) {
+    ks__.for_each_local_kpoint([&](int ikloc, int team) {
         int ik  = ks__.spl_num_kpoints(ikloc);
         auto kp = ks__.get<T>(ik);
 
+        auto& dm = (team == 0 || density_matrix_team.empty()) ? density_matrix_ : density_matrix_team[team - 1];
+
         std::array<wf::Wave_functions_fft<T>, 2> wf_fft;
 
         std::vector<wf::device_memory_guard> mg;
@@ -1274,20 +1296,30 @@ Density::generate_valence(K_point_set const& ks__)
         }
 
         if (ctx_.full_potential()) {
-            add_k_point_contribution_dm_fplapw<T>(ctx_, *kp, density_matrix_);
+            add_k_point_contribution_dm_fplapw<T>(ctx_, *kp, dm);
         } else {
             if (ctx_.gamma_point() && (ctx_.so_correction() == false)) {
-                add_k_point_contribution_dm_pwpp<T, T>(ctx_, *kp, density_matrix_);
+                add_k_point_contribution_dm_pwpp<T, T>(ctx_, *kp, dm);
             } else {
-                add_k_point_contribution_dm_pwpp<T, std::complex<T>>(ctx_, *kp, density_matrix_);
+                add_k_point_contribution_dm_pwpp<T, std::complex<T>>(ctx_, *kp, dm);
             }
             if (occupation_matrix_) {
+                #pragma omp critical(occupation_matrix)
                 occupation_matrix_->add_k_point_contribution(*kp);
             }
         }
 
         /* add contribution from regular space grid */
         add_k_point_contribution_rg(kp, wf_fft);
+    });
+    t_loop += utils::wtime();
+    ctx_.out(2, __func__) << "time of the k-point loop: " << t_loop << " sec. (" << num_teams
+                          << " k-point team(s))" << std::endl;
+
+    for (auto const& dm : density_matrix_team) {
+        for (size_t i = 0; i < dm.size(); i++) {
+            density_matrix_[i] += dm[i];
+        }
     }
 
     if (density_matrix_.size()) {
@@ -1520,6 +1552,56 @@ Density::generate_rho_aug()
     return rho_aug;
 }
 
+sddk::mdarray<std::complex<double>, 2>
+Density::generate_rho_aug_rs()
+{
+    PROFILE("sirius::Density::generate_rho_aug_rs");
+
+    int ncomp = ctx_.num_mag_dims() + 1;
+
+    auto const& atg = ctx_.aug_to_grid_idx();
+
+    sddk::mdarray<double, 2> rho_rg(fft::spfft_grid_size_local(ctx_.spfft<double>()), ncomp);
+    rho_rg.zero();
+
+    for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
+        auto& atom_type = unit_cell_.atom_type(iat);
+
+        if (!atom_type.augment() || atom_type.num_atoms() == 0) {
+            continue;
+        }
+
+        auto dm = density_matrix_aux(this->density_matrix(), iat);
+
+        for (int i = 0; i < atom_type.num_atoms(); i++) {
+            ctx_.augmentation_op_rs(iat).add_rho(atg, atom_type.atom_id(i), i, dm, rho_rg);
+        }
+    }
+
+    sddk::mdarray<std::complex<double>, 2> rho_aug(ctx_.gvec().count(), ncomp);
+
+    Smooth_periodic_function<double> f(ctx_.spfft<double>(), ctx_.gvec_fft_sptr());
+    for (int iv = 0; iv < ncomp; iv++) {
+        #pragma omp parallel for schedule(static)
+        for (int ir = 0; ir < static_cast<int>(rho_rg.size(0)); ir++) {
+            f.value(ir) = rho_rg(ir, iv);
+        }
+        f.fft_transform(-1);
+        #pragma omp parallel for schedule(static)
+        for (int igloc = 0; igloc < ctx_.gvec().count(); igloc++) {
+            rho_aug(igloc, iv) = f.f_pw_local(igloc);
+        }
+    }
+
+    if (ctx_.cfg().control().print_checksum()) {
+        auto cs = rho_aug.checksum();
+        ctx_.comm().allreduce(&cs, 1);
+        utils::print_checksum("rho_aug", cs, ctx_.out());
+    }
+
+    return rho_aug;
+}
+
 template <int num_mag_dims>
 void Density::reduce_density_matrix(Atom_type const& atom_type__, int ia__, sddk::mdarray<std::complex<double>, 4> const& zdens__,
                                     sddk::mdarray<double, 3>& mt_density_matrix__)
@@ -1537,9 +1619,10 @@ void Density::reduce_density_matrix(Atom_type const& atom_type__, int ia__, sddk
             for (int lm2 = utils::lm(l2, -l2); lm2 <= utils::lm(l2, l2); lm2++, xi2++) {
                 int xi1 = atom_type__.indexb().index_by_idxrf(idxrf1);
                 for (int lm1 = utils::lm(l1, -l1); lm1 <= utils::lm(l1, l1); lm1++, xi1++) {
-                    for (int k = 0; k < atom_type__.gaunt_coefs().num_gaunt(lm1, lm2); k++) {
-                        int lm3 = atom_type__.gaunt_coefs().gaunt(lm1, lm2, k).lm3;
-                        auto gc = atom_type__.gaunt_coefs().gaunt(lm1, lm2, k).coef;
+                    auto row = atom_type__.gaunt_coefs().gaunt_row(lm1, lm2);
+                    for (int k = 0; k < row.size; k++) {
+                        int lm3 = row.lm3[k];
+                        auto gc = row.coef[k];
                         switch (num_mag_dims) {
                             case 3: {
                                 mt_density_matrix__(lm3, offs, 2) += 2.0 * std::real(zdens__(xi1, xi2, 2, ia__) * gc);
@@ -1761,13 +1844,12 @@ Density::compute_atomic_mag_mom() const
     sddk::mdarray<double, 2> mmom(3, unit_cell_.num_atoms());
     mmom.zero();
 
+    auto const& atg = ctx_.atoms_to_grid_idx();
+
     #pragma omp parallel for
     for (int ia = 0; ia < unit_cell_.num_atoms(); ia++) {
-
-        auto& atom_to_grid_map = ctx_.atoms_to_grid_idx_map(ia);
-
-        for (auto coord : atom_to_grid_map) {
-            int ir = coord.first;
+        for (int i = atg.offset(ia); i < atg.offset(ia + 1); i++) {
+            int ir = atg.index(i);
             for (int j = 0; j < ctx_.num_mag_dims(); j++) {
                 mmom(j, ia) += mag(j).rg().value(ir);
             }
@@ -1866,10 +1948,32 @@ Density::mixer_init(config_t::mixer_t const& mixer_cfg__)
     this->mixer_ =
         mixer::Mixer_factory<Periodic_function<double>, Periodic_function<double>, Periodic_function<double>,
                              Periodic_function<double>, sddk::mdarray<std::complex<double>, 4>,
-                             PAW_density<double>, Hubbard_matrix>(mixer_cfg__);
+                             PAW_density<double>, Hubbard_matrix, mixer::Gvec_function, mixer::Gvec_function>(mixer_cfg__);
+
+    mixer_gvec_ = nullptr;
+    if (mixer_cfg__.gvec_mixing()) {
+        if (ctx_.full_potential()) {
+            RTE_THROW("Mixer: G-space mixing is implemented only for PP-PW case");
+        }
+        double gmax = (mixer_cfg__.gmax() > 0) ? std::min(mixer_cfg__.gmax(), ctx_.pw_cutoff()) : ctx_.pw_cutoff();
+        mixer_gvec_ = std::make_shared<mixer::Mixer_gvec>(ctx_.gvec(), gmax);
 
-    /* initialize functions */
-    if (mixer_cfg__.use_hartree()) {
+        this->fft_transform(-1);
+
+        /* the coefficients are passed to and from the mixer in double precision */
+        mixer_pw_[0] = std::make_unique<mixer::Gvec_function>(mixer_gvec_, 1, false);
+        mixer_pw_[0]->pack(0, component(0).rg().f_pw_local());
+        this->mixer_->initialize_function<7>(mixer::gvec_function_property(mixer_cfg__, true), *mixer_pw_[0],
+                                             mixer_gvec_, 1, mixer_cfg__.history_fp32());
+        if (ctx_.num_mag_dims() > 0) {
+            mixer_pw_[1] = std::make_unique<mixer::Gvec_function>(mixer_gvec_, ctx_.num_mag_dims(), false);
+            for (int j = 0; j < ctx_.num_mag_dims(); j++) {
+                mixer_pw_[1]->pack(j, component(j + 1).rg().f_pw_local());
+            }
+            this->mixer_->initialize_function<8>(mixer::gvec_function_property(mixer_cfg__, false), *mixer_pw_[1],
+                                                 mixer_gvec_, ctx_.num_mag_dims(), mixer_cfg__.history_fp32());
+        }
+    } else if (mixer_cfg__.use_hartree()) {
         if (ctx_.full_potential()) {
             RTE_THROW("Mixer: Hartree residual energy is implemented only for PP-PW case");
         }
@@ -1877,12 +1981,14 @@ Density::mixer_init(config_t::mixer_t const& mixer_cfg__)
     } else {
         this->mixer_->initialize_function<0>(func_prop, component(0), ctx_, [&](int ia){return lmax_t(ctx_.lmax_rho());});
     }
-    if (ctx_.num_mag_dims() > 0) {
-        this->mixer_->initialize_function<1>(func_prop, component(1), ctx_, [&](int ia){return lmax_t(ctx_.lmax_rho());});
-    }
-    if (ctx_.num_mag_dims() > 1) {
-        this->mixer_->initialize_function<2>(func_prop, component(2), ctx_, [&](int ia){return lmax_t(ctx_.lmax_rho());});
-        this->mixer_->initialize_function<3>(func_prop, component(3), ctx_, [&](int ia){return lmax_t(ctx_.lmax_rho());});
+    if (!mixer_gvec_) {
+        if (ctx_.num_mag_dims() > 0) {
+            this->mixer_->initialize_function<1>(func_prop, component(1), ctx_, [&](int ia){return lmax_t(ctx_.lmax_rho());});
+        }
+        if (ctx_.num_mag_dims() > 1) {
+            this->mixer_->initialize_function<2>(func_prop, component(2), ctx_, [&](int ia){return lmax_t(ctx_.lmax_rho());});
+            this->mixer_->initialize_function<3>(func_prop, component(3), ctx_, [&](int ia){return lmax_t(ctx_.lmax_rho());});
+        }
     }
 
     this->mixer_->initialize_function<4>(density_prop, density_matrix_, unit_cell_.max_mt_basis_size(),
@@ -1901,13 +2007,26 @@ Density::mixer_input()
 {
     PROFILE("sirius::Density::mixer_input");
 
-    mixer_->set_input<0>(component(0));
-    if (ctx_.num_mag_dims() > 0) {
-        mixer_->set_input<1>(component(1));
-    }
-    if (ctx_.num_mag_dims() > 1) {
-        mixer_->set_input<2>(component(2));
-        mixer_->set_input<3>(component(3));
+    if (mixer_gvec_) {
+        /* make sure that the plane-wave coefficients are consistent with the real-space values */
+        this->fft_transform(-1);
+        mixer_pw_[0]->pack(0, component(0).rg().f_pw_local());
+        mixer_->set_input<7>(*mixer_pw_[0]);
+        if (ctx_.num_mag_dims() > 0) {
+            for (int j = 0; j < ctx_.num_mag_dims(); j++) {
+                mixer_pw_[1]->pack(j, component(j + 1).rg().f_pw_local());
+            }
+            mixer_->set_input<8>(*mixer_pw_[1]);
+        }
+    } else {
+        mixer_->set_input<0>(component(0));
+        if (ctx_.num_mag_dims() > 0) {
+            mixer_->set_input<1>(component(1));
+        }
+        if (ctx_.num_mag_dims() > 1) {
+            mixer_->set_input<2>(component(2));
+            mixer_->set_input<3>(component(3));
+        }
     }
 
     mixer_->set_input<4>(density_matrix_);
@@ -1926,13 +2045,25 @@ Density::mixer_output()
 {
     PROFILE("sirius::Density::mixer_output");
 
-    mixer_->get_output<0>(component(0));
-    if (ctx_.num_mag_dims() > 0) {
-        mixer_->get_output<1>(component(1));
-    }
-    if (ctx_.num_mag_dims() > 1) {
-        mixer_->get_output<2>(component(2));
-        mixer_->get_output<3>(component(3));
+    if (mixer_gvec_) {
+        /* coefficients above the mixing cutoff are kept from the new density */
+        mixer_->get_output<7>(*mixer_pw_[0]);
+        mixer_pw_[0]->unpack(0, component(0).rg().f_pw_local());
+        if (ctx_.num_mag_dims() > 0) {
+            mixer_->get_output<8>(*mixer_pw_[1]);
+            for (int j = 0; j < ctx_.num_mag_dims(); j++) {
+                mixer_pw_[1]->unpack(j, component(j + 1).rg().f_pw_local());
+            }
+        }
+    } else {
+        mixer_->get_output<0>(component(0));
+        if (ctx_.num_mag_dims() > 0) {
+            mixer_->get_output<1>(component(1));
+        }
+        if (ctx_.num_mag_dims() > 1) {
+            mixer_->get_output<2>(component(2));
+            mixer_->get_output<3>(component(3));
+        }
     }
 
     mixer_->get_output<4>(density_matrix_);
@@ -1945,8 +2076,13 @@ Density::mixer_output()
         mixer_->get_output<6>(*occupation_matrix_);
     }
 
-    /* transform mixed density to plane-wave domain */
-    this->fft_transform(-1);
+    if (mixer_gvec_) {
+        /* transform mixed density to real space */
+        this->fft_transform(1);
+    } else {
+        /* transform mixed density to plane-wave domain */
+        this->fft_transform(-1);
+    }
 }
 
 double
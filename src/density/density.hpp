@@ -32,6 +32,7 @@
 #include "function3d/spheric_function_set.hpp"
 #include "k_point/k_point_set.hpp"
 #include "mixer/mixer.hpp"
+#include "mixer/mixer_gvec.hpp"
 #include "occupation_matrix.hpp"
 
 #if defined(SIRIUS_GPU)
@@ -243,10 +244,17 @@ class Density : public Field4D
 
     /// Density mixer.
     /** Mix the following objects: density, x-,y-,z-components of magnetisation, density matrix and
-        PAW density of atoms. */
+        PAW density of atoms. In the G-space mixing mode the plane-wave coefficients of the density and
+        magnetisation are mixed instead of the first four functions. */
     std::unique_ptr<mixer::Mixer<Periodic_function<double>, Periodic_function<double>, Periodic_function<double>,
                                  Periodic_function<double>, sddk::mdarray<std::complex<double>, 4>, PAW_density<double>,
-                                 Hubbard_matrix>> mixer_;
+                                 Hubbard_matrix, mixer::Gvec_function, mixer::Gvec_function>> mixer_;
+
+    /// List of G-vectors mixed in the G-space mixing mode; null pointer if the real-space values are mixed.
+    std::shared_ptr<mixer::Mixer_gvec const> mixer_gvec_;
+
+    /// Plane-wave coefficients of the density and magnetisation passed to and from the mixer in the G-space mode.
+    std::array<std::unique_ptr<mixer::Gvec_function>, 2> mixer_pw_;
 
     /// Generate atomic densities in the case of PAW.
     void generate_paw_atom_density(int iapaw__);
@@ -350,6 +358,9 @@ class Density : public Field4D
 
     void initial_density_pseudo();
 
+    /// Superposition of the free atom densities for the local set of G-vectors and current atomic positions.
+    std::vector<std::complex<double>> atomic_density_pw() const;
+
     void initial_density_full_pot();
 
     void normalize();
@@ -401,6 +412,13 @@ class Density : public Field4D
     /// Generate augmentation charge density.
     sddk::mdarray<std::complex<double>, 2> generate_rho_aug();
 
+    /// Generate augmentation charge density on the real-space grid.
+    /** The filtered Q(r) functions are placed on the points of the fine FFT grid around each atom (see
+     *  Augmentation_operator_rs) and transformed to the plane-wave domain with one FFT per component. All
+     *  coefficients, including G=0, come from the same truncated functions which are integrated with the effective
+     *  potential in Potential::generate_D_operator_matrix_rs(), so the two operations are adjoint. */
+    sddk::mdarray<std::complex<double>, 2> generate_rho_aug_rs();
+
     /// Return core leakage for a specific atom symmetry class
     inline double core_leakage(int ic) const
     {
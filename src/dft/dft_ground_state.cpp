@@ -24,6 +24,7 @@
 
 #include <iomanip>
 #include "dft_ground_state.hpp"
+#include "linalg/eigensolver.hpp"
 #include "utils/profiler.hpp"
 
 namespace sirius {
@@ -51,6 +52,251 @@ DFT_ground_state::initial_state()
     }
 }
 
+void
+DFT_ground_state::restart_state()
+{
+    PROFILE("sirius::DFT_ground_state::restart_state");
+
+    density_.load();
+    potential_.load();
+    if (!ctx_.full_potential()) {
+        if (ctx_.cfg().parameters().precision_wf() == "fp32") {
+#if defined(USE_FP32)
+            Hamiltonian0<float> H0(potential_, true);
+            Band(ctx_).initialize_subspace(kset_, H0);
+#else
+            RTE_THROW("not compiled with FP32 support");
+#endif
+        } else {
+            Hamiltonian0<double> H0(potential_, true);
+            Band(ctx_).initialize_subspace(kset_, H0);
+        }
+        bool has_kset{false};
+        {
+            sddk::HDF5_tree fin(storage_file_name, sddk::hdf5_access_t::read_only);
+            has_kset = fin.exists("K_point_set");
+        }
+        if (has_kset) {
+            int nk = kset_.load(storage_file_name);
+            std::stringstream s;
+            s << "wave-functions of " << nk << " out of " << kset_.num_kpoints() << " k-points are loaded";
+            ctx_.message(1, __func__, s);
+        }
+    }
+}
+
+/* rotate the wave-functions of the previous geometry to the best match of the current ones
+ *
+ * For O = <psi|psi_ref> the unitary transformation U = O (O^H O)^{-1/2} minimizes |psi U - psi_ref|, which removes
+ * the arbitrary mixing of the (near-)degenerate states between the two geometries. */
+template <typename F>
+static auto
+align_wave_functions(Simulation_context& ctx__, wf::spin_range spins__, wf::Wave_functions<double> const& psi__,
+        wf::Wave_functions<double> const& psi_ref__)
+{
+    int nb = psi__.num_wf().get();
+
+    la::dmatrix<F> o(nb, nb);
+    wf::inner(ctx__.spla_context(), sddk::memory_t::host, spins__, psi__, wf::band_range(0, nb), psi_ref__,
+            wf::band_range(0, nb), o, 0, 0);
+
+    /* A = O^H O */
+    la::dmatrix<F> a(nb, nb);
+    la::wrap(la::lib_t::blas).gemm('C', 'N', nb, nb, nb, &la::constant<F>::one(), o.at(sddk::memory_t::host),
+            o.ld(), o.at(sddk::memory_t::host), o.ld(), &la::constant<F>::zero(), a.at(sddk::memory_t::host), a.ld());
+
+    la::dmatrix<F> z(nb, nb);
+    std::vector<double> eval(nb);
+    auto solver = la::Eigensolver_factory("lapack");
+    if (solver->solve(nb, nb, a, eval.data(), z)) {
+        RTE_THROW("error in diagonalization");
+    }
+    /* A^{-1/2} = Z e^{-1/2} Z^H; states which are lost between the geometries are dropped */
+    la::dmatrix<F> zs(nb, nb);
+    for (int i = 0; i < nb; i++) {
+        double f = (eval[i] > 1e-8) ? 1.0 / std::sqrt(eval[i]) : 0.0;
+        for (int j = 0; j < nb; j++) {
+            zs(j, i) = z(j, i) * f;
+        }
+    }
+    la::wrap(la::lib_t::blas).gemm('N', 'C', nb, nb, nb, &la::constant<F>::one(), zs.at(sddk::memory_t::host),
+            zs.ld(), z.at(sddk::memory_t::host), z.ld(), &la::constant<F>::zero(), a.at(sddk::memory_t::host), a.ld());
+
+    la::dmatrix<F> u(nb, nb);
+    la::wrap(la::lib_t::blas).gemm('N', 'N', nb, nb, nb, &la::constant<F>::one(), o.at(sddk::memory_t::host),
+            o.ld(), a.at(sddk::memory_t::host), a.ld(), &la::constant<F>::zero(), u.at(sddk::memory_t::host), u.ld());
+
+    return u;
+}
+
+/* psi_ref <- c0 * psi_ref + sum_j c_j * psi_j U_j, where psi_j are aligned to psi_ref */
+template <typename F>
+static void
+extrapolate_wf(Simulation_context& ctx__, double c0__, std::vector<double> const& c__,
+        std::vector<wf::Wave_functions<double> const*> const& psi__, wf::Wave_functions<double>& psi_ref__)
+{
+    int nb = psi_ref__.num_wf().get();
+
+    /* the same transformation is applied to both spinor components */
+    int num_steps = (ctx__.num_mag_dims() == 3) ? 1 : ctx__.num_spins();
+    for (int ispn_step = 0; ispn_step < num_steps; ispn_step++) {
+        auto sr = (ctx__.num_mag_dims() == 3) ? wf::spin_range(0, 2) : wf::spin_range(ispn_step);
+
+        std::vector<la::dmatrix<F>> u;
+        for (size_t j = 0; j < psi__.size(); j++) {
+            u.emplace_back(align_wave_functions<F>(ctx__, sr, *psi__[j], psi_ref__));
+        }
+        for (auto s = sr.begin(); s != sr.end(); s++) {
+            for (size_t j = 0; j < psi__.size(); j++) {
+                wf::transform(ctx__.spla_context(), sddk::memory_t::host, u[j], 0, 0, c__[j], *psi__[j], s,
+                        wf::band_range(0, nb), (j == 0) ? c0__ : 1.0, psi_ref__, s, wf::band_range(0, nb));
+            }
+        }
+    }
+}
+
+std::pair<double, double>
+DFT_ground_state::extrapolation_coefficients(int order__) const
+{
+    /* number of previous geometries used in the extrapolation */
+    int n = std::min(order__, static_cast<int>(positions_hist_.size()) - 1);
+
+    if (n <= 0) {
+        return std::make_pair(0.0, 0.0);
+    }
+
+    /* displacements in Cartesian coordinates; fractional differences are brought to the nearest image */
+    auto displacement = [&](std::vector<r3::vector<double>> const& r1, std::vector<r3::vector<double>> const& r0,
+            int ia) {
+        r3::vector<double> d;
+        for (int x : {0, 1, 2}) {
+            d[x] = r1[ia][x] - r0[ia][x];
+            d[x] -= std::round(d[x]);
+        }
+        return dot(unit_cell_.lattice_vectors(), d);
+    };
+
+    double a11{0}, a12{0}, a22{0}, b1{0}, b2{0};
+    for (int ia = 0; ia < unit_cell_.num_atoms(); ia++) {
+        auto dr = displacement(positions_, positions_hist_[0], ia);
+        auto d1 = displacement(positions_hist_[0], positions_hist_[1], ia);
+        a11 += dot(d1, d1);
+        b1 += dot(d1, dr);
+        if (n == 2) {
+            auto d2 = displacement(positions_hist_[1], positions_hist_[2], ia);
+            a12 += dot(d1, d2);
+            a22 += dot(d2, d2);
+            b2 += dot(d2, dr);
+        }
+    }
+
+    if (a11 < 1e-12) {
+        return std::make_pair(0.0, 0.0);
+    }
+    if (n == 2) {
+        double det = a11 * a22 - a12 * a12;
+        if (det > 1e-8 * a11 * a22) {
+            return std::make_pair((b1 * a22 - b2 * a12) / det, (a11 * b2 - a12 * b1) / det);
+        }
+    }
+    return std::make_pair(b1 / a11, 0.0);
+}
+
+void
+DFT_ground_state::extrapolate_density(std::string const& type__)
+{
+    PROFILE("sirius::DFT_ground_state::extrapolate_density");
+
+    std::map<std::string, int> order = {{"atomic", 0}, {"first_order", 1}, {"second_order", 2}};
+
+    /* drho(t) = rho(t) - rho_atomic(t) for the geometry which has just been left */
+    std::vector<std::complex<double>> drho(ctx_.gvec().count());
+    for (int igloc = 0; igloc < ctx_.gvec().count(); igloc++) {
+        drho[igloc] = density_.rho().rg().f_pw_local(igloc) - rho_atomic_[igloc];
+    }
+    drho_hist_.push_front(std::move(drho));
+    while (static_cast<int>(drho_hist_.size()) > order.at(type__) + 1) {
+        drho_hist_.pop_back();
+    }
+
+    rho_atomic_ = density_.atomic_density_pw();
+
+    auto ab = extrapolation_coefficients(static_cast<int>(drho_hist_.size()) - 1);
+
+    std::stringstream s;
+    s << "density extrapolation from " << drho_hist_.size() << " geometries, alpha : " << ab.first
+      << ", beta : " << ab.second;
+    ctx_.message(1, __func__, s);
+
+    /* rho(t+1) = rho_atomic(t+1) + drho(t) + alpha (drho(t) - drho(t-1)) + beta (drho(t-1) - drho(t-2)) */
+    #pragma omp parallel for
+    for (int igloc = 0; igloc < ctx_.gvec().count(); igloc++) {
+        auto z = rho_atomic_[igloc] + drho_hist_[0][igloc];
+        if (drho_hist_.size() > 1) {
+            z += ab.first * (drho_hist_[0][igloc] - drho_hist_[1][igloc]);
+        }
+        if (drho_hist_.size() > 2) {
+            z += ab.second * (drho_hist_[1][igloc] - drho_hist_[2][igloc]);
+        }
+        density_.rho().rg().f_pw_local(igloc) = z;
+    }
+    density_.rho().rg().fft_transform(1);
+}
+
+void
+DFT_ground_state::extrapolate_wave_functions(std::string const& type__)
+{
+    PROFILE("sirius::DFT_ground_state::extrapolate_wave_functions");
+
+    std::map<std::string, int> order = {{"first_order", 1}, {"second_order", 2}};
+
+    /* number of previous geometries used in the extrapolation */
+    int n = std::min(order.at(type__), static_cast<int>(psi_hist_.size()));
+
+    auto ab = extrapolation_coefficients(n);
+
+    /* save the wave-functions of the geometry which has just been left */
+    std::map<int, std::unique_ptr<wf::Wave_functions<double>>> psi_now;
+    for (int ikloc = 0; ikloc < kset_.spl_num_kpoints().local_size(); ikloc++) {
+        int ik  = kset_.spl_num_kpoints(ikloc);
+        auto kp = kset_.get<double>(ik);
+
+        auto& psi = kp->spinor_wave_functions();
+        psi_now[ik] = wave_function_factory(ctx_, *kp, psi.num_wf(), psi.num_md(), false);
+        for (int is = 0; is < psi.num_sc().get(); is++) {
+            wf::copy(sddk::memory_t::host, psi, wf::spin_index(is), wf::band_range(0, psi.num_wf().get()),
+                    *psi_now[ik], wf::spin_index(is), wf::band_range(0, psi.num_wf().get()));
+        }
+
+        /* psi(t+1) = (1 + alpha) psi(t) + (beta - alpha) psi(t-1) - beta psi(t-2) */
+        std::vector<wf::Wave_functions<double> const*> psi_prev;
+        for (int j = 0; j < n; j++) {
+            /* k-points could have been redistributed between the geometries */
+            if (!psi_hist_[j].count(ik) || &psi_hist_[j].at(ik)->gkvec() != &psi.gkvec()) {
+                break;
+            }
+            psi_prev.push_back(psi_hist_[j].at(ik).get());
+        }
+        if (psi_prev.empty() || ab.first == 0) {
+            continue;
+        }
+        std::vector<double> c({-ab.first});
+        if (psi_prev.size() == 2) {
+            c = {ab.second - ab.first, -ab.second};
+        }
+        double c0 = 1 + ab.first;
+        if (kp->gkvec().reduced()) {
+            extrapolate_wf<double>(ctx_, c0, c, psi_prev, psi);
+        } else {
+            extrapolate_wf<std::complex<double>>(ctx_, c0, c, psi_prev, psi);
+        }
+    }
+    psi_hist_.push_front(std::move(psi_now));
+    while (static_cast<int>(psi_hist_.size()) > order.at(type__)) {
+        psi_hist_.pop_back();
+    }
+}
+
 void
 DFT_ground_state::update()
 {
@@ -63,6 +309,25 @@ DFT_ground_state::update()
 
     if (!ctx_.full_potential()) {
         ewald_energy_ = sirius::ewald_energy(ctx_, ctx_.gvec(), ctx_.unit_cell());
+
+        positions_hist_.push_front(positions_);
+        while (positions_hist_.size() > 3) {
+            positions_hist_.pop_back();
+        }
+        for (int ia = 0; ia < unit_cell_.num_atoms(); ia++) {
+            positions_[ia] = unit_cell_.atom(ia).position();
+        }
+
+        auto& cfg = ctx_.cfg().settings();
+        if (cfg.extrapolation_rho() != "none") {
+            extrapolate_density(cfg.extrapolation_rho());
+        }
+        if (cfg.extrapolation_wf() != "none" && ctx_.cfg().parameters().precision_wf() == "fp64") {
+            extrapolate_wave_functions(cfg.extrapolation_wf());
+        }
+        if (cfg.extrapolation_rho() != "none") {
+            potential_.generate(density_, ctx_.use_symmetry(), true);
+        }
     }
 }
 
@@ -214,6 +479,11 @@ DFT_ground_state::find(double density_tol__, double energy_tol__, double iter_so
           << "+------------------------------+" << std::endl;
         ctx_.message(2, __func__, s);
 
+        /* use the timings of the previous iteration to balance the k-points */
+        if (iter > 0 && ctx_.cfg().control().kpoint_distribution() == "measured") {
+            kset_.rebalance();
+        }
+
         if (ctx_.cfg().parameters().precision_wf() == "fp32") {
 #if defined(USE_FP32)
             Hamiltonian0<float> H0(potential_, true);
@@ -365,7 +635,9 @@ DFT_ground_state::find(double density_tol__, double energy_tol__, double iter_so
         }
         potential_.save();
         density_.save();
-        // kset_.save(storage_file_name);
+        if (!ctx_.full_potential() && ctx_.cfg().control().save_wave_functions()) {
+            kset_.save(storage_file_name);
+        }
     }
 
     auto tstop = std::chrono::high_resolution_clock::now();
@@ -25,6 +25,8 @@
 #ifndef __DFT_GROUND_STATE_HPP__
 #define __DFT_GROUND_STATE_HPP__
 
+#include <deque>
+#include <map>
 #include "k_point/k_point_set.hpp"
 #include "utils/json.hpp"
 #include "hubbard/hubbard.hpp"
@@ -72,6 +74,37 @@ class DFT_ground_state
     /// Correction to total energy from the SCF density minimisation.
     double scf_correction_energy_{0};
 
+    /// Fractional atomic positions of the current geometry.
+    std::vector<r3::vector<double>> positions_;
+
+    /// Superposition of the free atom densities at the current atomic positions (local set of G-vectors).
+    std::vector<std::complex<double>> rho_atomic_;
+
+    /// Atomic positions of the previous geometries; the most recent geometry goes first.
+    std::deque<std::vector<r3::vector<double>>> positions_hist_;
+
+    /// Difference between the density and the superposed free atom densities of the previous geometries.
+    std::deque<std::vector<std::complex<double>>> drho_hist_;
+
+    /// Wave-functions of the local k-points at the previous geometries, indexed by the global k-point index.
+    std::deque<std::map<int, std::unique_ptr<wf::Wave_functions<double>>>> psi_hist_;
+
+    /// Get the extrapolation coefficients from the atomic positions of the previous geometries.
+    /** The displacement to the new geometry is approximated as
+     *  \f[
+     *    {\bf R}(t+1) - {\bf R}(t) \approx \alpha \big({\bf R}(t) - {\bf R}(t-1)\big) +
+     *      \beta \big({\bf R}(t-1) - {\bf R}(t-2)\big)
+     *  \f]
+     *  and the coefficients are found in the least-squares sense. The same coefficients are used to extrapolate
+     *  the density and the wave-functions. */
+    std::pair<double, double> extrapolation_coefficients(int order__) const;
+
+    /// Extrapolate the density to the new atomic positions.
+    void extrapolate_density(std::string const& type__);
+
+    /// Extrapolate the wave-functions to the new atomic positions.
+    void extrapolate_wave_functions(std::string const& type__);
+
   public:
     /// Constructor.
     DFT_ground_state(K_point_set& kset__)
@@ -86,6 +119,12 @@ class DFT_ground_state
     {
         if (!ctx_.full_potential()) {
             ewald_energy_ = sirius::ewald_energy(ctx_, ctx_.gvec(), ctx_.unit_cell());
+            for (int ia = 0; ia < unit_cell_.num_atoms(); ia++) {
+                positions_.push_back(unit_cell_.atom(ia).position());
+            }
+            if (ctx_.cfg().settings().extrapolation_rho() != "none") {
+                rho_atomic_ = density_.atomic_density_pw();
+            }
         }
     }
     ~DFT_ground_state()
@@ -153,7 +192,16 @@ class DFT_ground_state
     /// Generate initial density, potential and a subspace of wave-functions.
     void initial_state();
 
+    /// Load density, potential and wave-functions from the storage file.
+    /** If the file contains the saved k-point set (see control.save_wave_functions), the initial subspace is
+     *  replaced by the saved wave-functions, such that the first iterative diagonalization starts from the
+     *  converged states. */
+    void restart_state();
+
     /// Update the parameters after the change of lattice vectors or atomic positions.
+    /** In the pseudopotential case the density and the wave-functions are extrapolated to the new atomic
+     *  positions (see settings.extrapolation_rho and settings.extrapolation_wf) and the effective potential
+     *  is regenerated, such that the next SCF cycle starts close to the new ground state. */
     void update();
 
     /// Run the SCF ground state calculation and find a total energy minimum.
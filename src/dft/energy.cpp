@@ -23,6 +23,7 @@
  */
 
 #include "energy.hpp"
+#include "ewald.hpp"
 
 namespace sirius {
 
@@ -32,18 +33,13 @@ ewald_energy(const Simulation_context& ctx, const fft::Gvec& gvec, const Unit_ce
     double alpha{ctx.ewald_lambda()};
     double ewald_g{0};
 
+    auto rho = ewald_structure_factor(ctx, gvec);
+
     #pragma omp parallel for reduction(+ : ewald_g)
     for (int igloc = gvec.skip_g0(); igloc < gvec.count(); igloc++) {
         double g2 = std::pow(gvec.gvec_len<sddk::index_domain_t::local>(igloc), 2);
 
-        std::complex<double> rho(0, 0);
-
-        for (int ia = 0; ia < unit_cell.num_atoms(); ia++) {
-            rho += ctx.gvec_phase_factor(gvec.gvec<sddk::index_domain_t::local>(igloc), ia) *
-                   static_cast<double>(unit_cell.atom(ia).zn());
-        }
-
-        ewald_g += std::pow(std::abs(rho), 2) * std::exp(-g2 / 4 / alpha) / g2;
+        ewald_g += std::pow(std::abs(rho[igloc]), 2) * std::exp(-g2 / 4 / alpha) / g2;
     }
 
     ctx.comm().allreduce(&ewald_g, 1);
@@ -0,0 +1,298 @@
+// Copyright (c) 2013-2023 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file ewald.cpp
+ *
+ *  \brief Structure factor of the ionic charges for the reciprocal-space part of the Ewald sum.
+ */
+
+#include "ewald.hpp"
+
+namespace sirius {
+
+/* wrap grid coordinate to [0, n) */
+static inline int
+wrap_coord(int k__, int n__)
+{
+    k__ %= n__;
+    return (k__ < 0) ? k__ + n__ : k__;
+}
+
+Ewald_pme::Ewald_pme(Simulation_context const& ctx__, int order__)
+    : ctx_(ctx__)
+    , order_(order__)
+{
+    PROFILE("sirius::Ewald_pme");
+
+    if (order_ < 4 || order_ % 2) {
+        RTE_THROW("order of the B-splines in the particle-mesh Ewald method must be even and not smaller than 4");
+    }
+
+    grid_ = fft::get_min_grid(2 * ctx_.pw_cutoff(), ctx_.unit_cell().reciprocal_lattice_vectors());
+
+    /* B-spline at integer points */
+    int k0;
+    std::vector<double> m(order_);
+    std::vector<double> dm(order_);
+    bspline(0, k0, m.data(), dm.data());
+
+    for (int x : {0, 1, 2}) {
+        bfac_[x] = std::vector<std::complex<double>>(grid_[x]);
+        for (int i = 0; i < grid_[x]; i++) {
+            std::complex<double> z(0, 0);
+            for (int k = 0; k <= order_ - 2; k++) {
+                z += m[k + 1] * std::exp(std::complex<double>(0, twopi * i * k / grid_[x]));
+            }
+            bfac_[x][i] = std::exp(std::complex<double>(0, twopi * (order_ - 1) * i / grid_[x])) / z;
+        }
+    }
+
+    /* the PME grid is distributed in the same way as the dense FFT grid */
+    auto& gvp  = *ctx_.gvec_fft_sptr();
+    auto spl_z = fft::split_z_dimension(grid_[2], ctx_.comm_fft());
+
+    spfft_grid_ = std::unique_ptr<spfft::Grid>(new spfft::Grid(grid_[0], grid_[1], grid_[2], gvp.zcol_count(),
+        spl_z.local_size(), SPFFT_PU_HOST, -1, ctx_.comm_fft().native(), SPFFT_EXCH_DEFAULT));
+
+    const auto fft_type = ctx_.gvec().reduced() ? SPFFT_TRANS_R2C : SPFFT_TRANS_C2C;
+
+    auto const& gv = gvp.gvec_array();
+
+    spfft_ = std::unique_ptr<spfft::Transform>(new spfft::Transform(spfft_grid_->create_transform(
+        SPFFT_PU_HOST, fft_type, grid_[0], grid_[1], grid_[2], spl_z.local_size(), gvp.count(),
+        SPFFT_INDEX_TRIPLETS, gv.at(sddk::memory_t::host))));
+}
+
+void
+Ewald_pme::bspline(double u__, int& k0__, double* m__, double* dm__) const
+{
+    double fl = std::floor(u__);
+    double w  = u__ - fl;
+    k0__      = static_cast<int>(fl);
+
+    std::fill(m__, m__ + order_, 0.0);
+    /* M_2(w + j) */
+    m__[0] = w;
+    m__[1] = 1 - w;
+    /* recursion M_p(x) = (x M_{p-1}(x) + (p - x) M_{p-1}(x - 1)) / (p - 1) */
+    for (int p = 3; p <= order_; p++) {
+        if (p == order_) {
+            /* M_n'(x) = M_{n-1}(x) - M_{n-1}(x - 1) */
+            for (int j = 0; j < order_; j++) {
+                dm__[j] = m__[j] - ((j > 0) ? m__[j - 1] : 0);
+            }
+        }
+        for (int j = p - 1; j >= 0; j--) {
+            m__[j] = ((w + j) * m__[j] + (p - w - j) * ((j > 0) ? m__[j - 1] : 0)) / (p - 1);
+        }
+    }
+}
+
+std::vector<double>
+Ewald_pme::spread() const
+{
+    PROFILE("sirius::Ewald_pme::spread");
+
+    auto& uc = ctx_.unit_cell();
+
+    int z0 = spfft_->local_z_offset();
+    int nz = spfft_->local_z_length();
+
+    std::vector<double> q(grid_[0] * grid_[1] * nz, 0);
+
+    std::vector<double> m(3 * order_);
+    std::vector<double> dm(3 * order_);
+
+    for (int ia = 0; ia < uc.num_atoms(); ia++) {
+        auto pos = uc.atom(ia).position();
+        std::array<int, 3> k0;
+        for (int x : {0, 1, 2}) {
+            bspline(grid_[x] * pos[x], k0[x], &m[x * order_], &dm[x * order_]);
+        }
+        double zn = uc.atom(ia).zn();
+        for (int j3 = 0; j3 < order_; j3++) {
+            int k3 = wrap_coord(k0[2] - j3, grid_[2]) - z0;
+            if (k3 < 0 || k3 >= nz) {
+                continue;
+            }
+            for (int j2 = 0; j2 < order_; j2++) {
+                int k2  = wrap_coord(k0[1] - j2, grid_[1]);
+                double w = zn * m[2 * order_ + j3] * m[order_ + j2];
+                for (int j1 = 0; j1 < order_; j1++) {
+                    int k1 = wrap_coord(k0[0] - j1, grid_[0]);
+                    q[grid_.index_by_coord(k1, k2, k3)] += w * m[j1];
+                }
+            }
+        }
+    }
+    return q;
+}
+
+sddk::mdarray<std::complex<double>, 1>
+Ewald_pme::structure_factor() const
+{
+    PROFILE("sirius::Ewald_pme::structure_factor");
+
+    auto& gvec = ctx_.gvec();
+    auto& gvp  = *ctx_.gvec_fft_sptr();
+
+    auto q = spread();
+
+    fft::spfft_input<double>(*spfft_, [&](int ir) { return q[ir]; });
+
+    sddk::mdarray<std::complex<double>, 1> fpw(gvp.count());
+    spfft_->forward(SPFFT_PU_HOST, reinterpret_cast<double*>(fpw.at(sddk::memory_t::host)), SPFFT_NO_SCALING);
+
+    /* offset of the local G-vectors inside the FFT set of G-vectors */
+    int offs = gvp.gvec_slab().offsets[gvp.comm_ortho_fft().rank()];
+
+    sddk::mdarray<std::complex<double>, 1> sf(gvec.count());
+    #pragma omp parallel for
+    for (int igloc = 0; igloc < gvec.count(); igloc++) {
+        /* Q(k) is real, so sum_k Q(k) e^{iGk} is the complex conjugate of the forward transform */
+        sf[igloc] = bfac(gvec.gvec<sddk::index_domain_t::local>(igloc)) * std::conj(fpw[offs + igloc]);
+    }
+    return sf;
+}
+
+sddk::mdarray<double, 2>
+Ewald_pme::forces(sddk::mdarray<std::complex<double>, 1> const& sf__, std::vector<double> const& f__) const
+{
+    PROFILE("sirius::Ewald_pme::forces");
+
+    auto& uc   = ctx_.unit_cell();
+    auto& gvec = ctx_.gvec();
+    auto& gvp  = *ctx_.gvec_fft_sptr();
+
+    sddk::mdarray<std::complex<double>, 1> phi(gvec.count());
+    #pragma omp parallel for
+    for (int igloc = 0; igloc < gvec.count(); igloc++) {
+        phi[igloc] = f__[igloc] * std::conj(sf__[igloc]) * bfac(gvec.gvec<sddk::index_domain_t::local>(igloc));
+    }
+
+    sddk::mdarray<std::complex<double>, 1> phi_fft;
+    if (gvp.comm_ortho_fft().size() != 1) {
+        phi_fft = sddk::mdarray<std::complex<double>, 1>(gvp.count());
+        gvp.gather_pw_fft(phi.at(sddk::memory_t::host), phi_fft.at(sddk::memory_t::host));
+    } else {
+        phi_fft = sddk::mdarray<std::complex<double>, 1>(phi.at(sddk::memory_t::host), gvec.count());
+    }
+    spfft_->backward(reinterpret_cast<double const*>(phi_fft.at(sddk::memory_t::host)), SPFFT_PU_HOST);
+
+    int z0 = spfft_->local_z_offset();
+    int nz = spfft_->local_z_length();
+
+    std::vector<double> theta(grid_[0] * grid_[1] * nz);
+    if (theta.size()) {
+        fft::spfft_output<double>(*spfft_, theta.data());
+    }
+
+    /* derivative of the energy with respect to the spread charge */
+    double prefac = 2 * twopi / uc.omega();
+
+    auto const& inv = uc.inverse_lattice_vectors();
+
+    sddk::mdarray<double, 2> forces(3, uc.num_atoms());
+    forces.zero();
+
+    #pragma omp parallel
+    {
+        std::vector<double> m(3 * order_);
+        std::vector<double> dm(3 * order_);
+
+        #pragma omp for
+        for (int ia = 0; ia < uc.num_atoms(); ia++) {
+            auto pos = uc.atom(ia).position();
+            std::array<int, 3> k0;
+            for (int x : {0, 1, 2}) {
+                bspline(grid_[x] * pos[x], k0[x], &m[x * order_], &dm[x * order_]);
+            }
+            /* gradient with respect to the scaled fractional coordinates u_i = K_i x_i */
+            double du[] = {0, 0, 0};
+            for (int j3 = 0; j3 < order_; j3++) {
+                int k3 = wrap_coord(k0[2] - j3, grid_[2]) - z0;
+                if (k3 < 0 || k3 >= nz) {
+                    continue;
+                }
+                for (int j2 = 0; j2 < order_; j2++) {
+                    int k2 = wrap_coord(k0[1] - j2, grid_[1]);
+                    for (int j1 = 0; j1 < order_; j1++) {
+                        int k1   = wrap_coord(k0[0] - j1, grid_[0]);
+                        double t = theta[grid_.index_by_coord(k1, k2, k3)];
+                        du[0] += t * dm[j1] * m[order_ + j2] * m[2 * order_ + j3];
+                        du[1] += t * m[j1] * dm[order_ + j2] * m[2 * order_ + j3];
+                        du[2] += t * m[j1] * m[order_ + j2] * dm[2 * order_ + j3];
+                    }
+                }
+            }
+            /* du_i / dr_c = K_i (A^{-1})_{ic} */
+            for (int c : {0, 1, 2}) {
+                double v{0};
+                for (int i : {0, 1, 2}) {
+                    v += grid_[i] * du[i] * inv(i, c);
+                }
+                forces(c, ia) = -prefac * uc.atom(ia).zn() * v;
+            }
+        }
+    }
+    /* each rank of the FFT communicator has collected the contribution of its z-slab */
+    ctx_.comm_fft().allreduce(&forces(0, 0), static_cast<int>(forces.size()));
+
+    return forces;
+}
+
+sddk::mdarray<std::complex<double>, 1>
+ewald_structure_factor(Simulation_context const& ctx__, fft::Gvec const& gvec__)
+{
+    PROFILE("sirius::ewald_structure_factor");
+
+    if (ctx__.cfg().settings().ewald() == "pme" && &gvec__ == &ctx__.gvec()) {
+        return ctx__.ewald_pme().structure_factor();
+    }
+
+    auto& uc = ctx__.unit_cell();
+
+    sddk::mdarray<std::complex<double>, 1> sf(gvec__.count());
+
+    /* use cached structure factors of atom types */
+    if (&gvec__ == &ctx__.gvec()) {
+        #pragma omp parallel for
+        for (int igloc = 0; igloc < gvec__.count(); igloc++) {
+            std::complex<double> rho(0, 0);
+            for (int iat = 0; iat < uc.num_atom_types(); iat++) {
+                rho += ctx__.structure_factor(igloc, iat) * static_cast<double>(uc.atom_type(iat).zn());
+            }
+            sf[igloc] = rho;
+        }
+        return sf;
+    }
+
+    #pragma omp parallel for
+    for (int igloc = 0; igloc < gvec__.count(); igloc++) {
+        std::complex<double> rho(0, 0);
+        for (int ia = 0; ia < uc.num_atoms(); ia++) {
+            rho += ctx__.gvec_phase_factor(gvec__.gvec<sddk::index_domain_t::local>(igloc), ia) *
+                   static_cast<double>(uc.atom(ia).zn());
+        }
+        sf[igloc] = rho;
+    }
+    return sf;
+}
+
+} // namespace sirius
@@ -0,0 +1,129 @@
+// Copyright (c) 2013-2023 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file ewald.hpp
+ *
+ *  \brief Structure factor of the ionic charges for the reciprocal-space part of the Ewald sum.
+ */
+
+#ifndef __EWALD_HPP__
+#define __EWALD_HPP__
+
+#include "context/simulation_context.hpp"
+
+namespace sirius {
+
+/// Smooth particle-mesh Ewald approximation of the ionic structure factor.
+/** The reciprocal-space part of the Ewald energy, forces and stress depends on the atomic positions only through
+ *  the structure factor
+ *  \f[
+ *    S({\bf G}) = \sum_{\alpha} Z_{\alpha} e^{i{\bf G}{\bf r}_{\alpha}}
+ *  \f]
+ *  which costs \f$ O(N_{atoms} N_{G}) \f$ if computed directly. Following Essmann et al. (J. Chem. Phys. 103,
+ *  8577 (1995)) the plane waves are interpolated with the cardinal B-splines \f$ M_n \f$ of order \f$ n \f$:
+ *  \f[
+ *    e^{2\pi i m u / K} \approx b(m) \sum_{k} M_n(u - k) e^{2\pi i m k / K}, \quad
+ *    b(m) = \frac{e^{2\pi i (n-1) m / K}}{\sum_{k=0}^{n-2} M_n(k+1) e^{2\pi i m k / K}}
+ *  \f]
+ *  so that \f$ S({\bf G}) \approx b_1(m_1) b_2(m_2) b_3(m_3) \sum_{\bf k} Q({\bf k}) e^{i{\bf G}{\bf k}} \f$,
+ *  where \f$ Q({\bf k}) \f$ is the ionic charge spread on a regular grid. The grid is constructed for the
+ *  doubled plane-wave cutoff; for the default spline order the relative error of the forces is about
+ *  \f$ 10^{-11} \f$ and the error of the energy is smaller. The charge is spread on the local z-slab of the grid and the
+ *  structure factor is obtained with one FFT, distributed in the same way as the dense G-vectors.
+ */
+class Ewald_pme
+{
+  private:
+    /// Simulation context.
+    Simulation_context const& ctx_;
+
+    /// Order of the B-splines.
+    int order_;
+
+    /// PME grid.
+    fft::Grid grid_;
+
+    /// Euler exponential spline factors \f$ b_i(m) \f$ for \f$ m = 0...K_i-1 \f$.
+    std::array<std::vector<std::complex<double>>, 3> bfac_;
+
+    /// SpFFT grid for the PME transform.
+    std::unique_ptr<spfft::Grid> spfft_grid_;
+
+    /// SpFFT transform for the dense G-vectors on the PME grid.
+    std::unique_ptr<spfft::Transform> spfft_;
+
+    /// Compute values and derivatives of the B-spline weights of a point with the fractional grid coordinate u.
+    /** On output m__[j] = \f$ M_n(u - k_j) \f$ and dm__[j] = \f$ M_n'(u - k_j) \f$ for the grid points
+     *  \f$ k_j = \lfloor u \rfloor - j \f$, \f$ j = 0...n-1 \f$. */
+    void bspline(double u__, int& k0__, double* m__, double* dm__) const;
+
+    /// Return the product \f$ b_1(m_1) b_2(m_2) b_3(m_3) \f$ for a G-vector with integer components.
+    inline std::complex<double> bfac(r3::vector<int> G__) const
+    {
+        std::complex<double> z(1, 0);
+        for (int x : {0, 1, 2}) {
+            int m = G__[x] % grid_[x];
+            if (m < 0) {
+                m += grid_[x];
+            }
+            z *= bfac_[x][m];
+        }
+        return z;
+    }
+
+    /// Spread the ionic charges on the local part of the PME grid.
+    std::vector<double> spread() const;
+
+  public:
+    /// Constructor.
+    Ewald_pme(Simulation_context const& ctx__, int order__);
+
+    /// PME grid.
+    inline auto const& grid() const
+    {
+        return grid_;
+    }
+
+    /// Structure factor of the ionic charges for the local set of dense G-vectors.
+    sddk::mdarray<std::complex<double>, 1> structure_factor() const;
+
+    /// Forces from the reciprocal-space energy.
+    /** Compute \f$ {\bf F}_{\alpha} = -\partial E / \partial {\bf r}_{\alpha} \f$ for
+     *  \f[
+     *    E = \frac{2\pi}{\Omega} \sum_{{\bf G} \neq 0} f(G) |S({\bf G})|^2
+     *  \f]
+     *  where the sum runs over all G-vectors. The interpolated structure factor sf__ and the kernel f__ are given
+     *  for the local G-vectors. The field \f$ \sum_{\bf G} f(G) S^{*}({\bf G}) b({\bf G}) e^{i{\bf G}{\bf k}} \f$
+     *  is computed with one backward FFT and the forces are collected from the grid with the derivatives of
+     *  the B-splines.
+     */
+    sddk::mdarray<double, 2> forces(sddk::mdarray<std::complex<double>, 1> const& sf__,
+                                    std::vector<double> const& f__) const;
+};
+
+/// Structure factor of the ionic charges for the local G-vectors.
+/** The smooth particle-mesh Ewald method of the context is used if it is selected in settings.ewald and the
+ *  G-vectors are the dense G-vectors of the context. Otherwise the cached structure factors of atom types are summed with the
+ *  ionic charges; for a different set of G-vectors the phase factors of all atoms are summed directly. */
+sddk::mdarray<std::complex<double>, 1> ewald_structure_factor(Simulation_context const& ctx__,
+                                                              fft::Gvec const& gvec__);
+
+} // namespace sirius
+
+#endif
@@ -739,6 +739,111 @@ Gvec_shells::Gvec_shells(Gvec const& gvec__)
     }
 }
 
+Gvec_redistribution::Gvec_redistribution(Gvec const& gvec__, mpi::Communicator const& comm__, int ngv__,
+                                         int const* gvl__, bool scatter__)
+    : comm_(comm__)
+    , count_(gvec__.count())
+    , ngv_ext_(ngv__)
+    , scatter_(scatter__)
+{
+    PROFILE("fft::Gvec_redistribution");
+
+    /* ranges of native G-vectors stored by the ranks of the communicator */
+    std::vector<int> ranges(2 * comm_.size());
+    ranges[2 * comm_.rank()]     = gvec__.offset();
+    ranges[2 * comm_.rank() + 1] = gvec__.count();
+    comm_.allgather(ranges.data(), 2, 2 * comm_.rank());
+
+    /* map the first global index of a native range to the list of ranks storing this range */
+    std::map<int, std::vector<int>> owners;
+    for (int r = 0; r < comm_.size(); r++) {
+        if (ranges[2 * r + 1]) {
+            owners[ranges[2 * r]].push_back(r);
+        }
+    }
+    /* prefer the own rank */
+    for (auto& e : owners) {
+        auto it = std::find(e.second.begin(), e.second.end(), comm_.rank());
+        if (it != e.second.end()) {
+            std::swap(*it, e.second.front());
+        }
+    }
+
+    /* global index of the native G-vector for each external G-vector */
+    std::vector<std::tuple<int, int, bool>> ext;
+    /* when the coefficients are scattered, the last occurence of the native G-vector wins */
+    std::map<int, int> pos;
+    for (int i = 0; i < ngv__; i++) {
+        r3::vector<int> G(gvl__[3 * i], gvl__[3 * i + 1], gvl__[3 * i + 2]);
+        bool conj{false};
+        int ig = gvec__.index_by_gvec(G);
+        if (ig < 0 && gvec__.reduced()) {
+            ig   = gvec__.index_by_gvec(G * (-1));
+            conj = true;
+        }
+        if (ig < 0) {
+            missing_.push_back(i);
+        } else if (scatter__ && pos.count(ig)) {
+            ext[pos[ig]] = std::make_tuple(i, ig, conj);
+        } else {
+            pos[ig] = static_cast<int>(ext.size());
+            ext.push_back(std::make_tuple(i, ig, conj));
+        }
+    }
+
+    /* list of destination ranks for each external G-vector */
+    std::vector<std::vector<std::tuple<int, int, bool>>> send(comm_.size());
+    for (auto const& e : ext) {
+        int ig = std::get<1>(e);
+        auto it = owners.upper_bound(ig);
+        if (it == owners.begin()) {
+            continue;
+        }
+        it--;
+        int r0 = it->second.front();
+        if (ig >= ranges[2 * r0] + ranges[2 * r0 + 1]) {
+            continue;
+        }
+        for (int r : it->second) {
+            send[r].push_back(e);
+            if (!scatter__) {
+                break;
+            }
+        }
+    }
+
+    a2a_ext_ = mpi::block_data_descriptor(comm_.size());
+    for (int r = 0; r < comm_.size(); r++) {
+        a2a_ext_.counts[r] = static_cast<int>(send[r].size());
+    }
+    a2a_ext_.calc_offsets();
+
+    a2a_native_ = mpi::block_data_descriptor(comm_.size());
+    comm_.alltoall(a2a_ext_.counts.data(), 1, a2a_native_.counts.data(), 1);
+    a2a_native_.calc_offsets();
+
+    idx_ext_  = std::vector<int>(a2a_ext_.size());
+    conj_ext_ = std::vector<char>(a2a_ext_.size());
+    std::vector<int> ig_ext(a2a_ext_.size());
+    for (int r = 0; r < comm_.size(); r++) {
+        for (int j = 0; j < a2a_ext_.counts[r]; j++) {
+            int k       = a2a_ext_.offsets[r] + j;
+            idx_ext_[k]  = std::get<0>(send[r][j]);
+            ig_ext[k]    = std::get<1>(send[r][j]);
+            conj_ext_[k] = std::get<2>(send[r][j]);
+        }
+    }
+
+    /* send the global indices of the G-vectors once; owners store the local indices */
+    idx_native_ = std::vector<int>(a2a_native_.size());
+    comm_.alltoall(ig_ext.data(), a2a_ext_.counts.data(), a2a_ext_.offsets.data(), idx_native_.data(),
+                   a2a_native_.counts.data(), a2a_native_.offsets.data());
+    for (auto& ig : idx_native_) {
+        ig -= gvec__.offset();
+        RTE_ASSERT(ig >= 0 && ig < gvec__.count());
+    }
+}
+
 void serialize(sddk::serializer& s__, Gvec const& gv__)
 {
     serialize(s__, gv__.vk_);
@@ -1035,6 +1035,106 @@ class Gvec_shells
     }
 };
 
+/// Redistribution plan between an external list of G-vectors and the native distribution of G-vectors.
+/** Host codes store plane-wave coefficients of periodic functions for their own local sets of G-vectors, given by
+ *  the Miller indices. The plan is built once for such a list and afterwards only the needed coefficients are moved
+ *  with a single MPI_Alltoallv in each direction. For the reduced set of G-vectors (Gamma-point case) the external
+ *  vector G is matched to -G and the coefficient is complex conjugated. The exchange is done over the communicator
+ *  comm__; only the native G-vectors of the ranks of this communicator take part in the exchange.
+ */
+class Gvec_redistribution
+{
+  private:
+    /// Communicator of the exchange; a copy is kept because the plan can outlive the communicator object of the caller.
+    mpi::Communicator comm_;
+
+    /// Local number of native G-vectors.
+    int count_{0};
+
+    /// Local number of external G-vectors.
+    int ngv_ext_{0};
+
+    /// Counts and offsets of the external coefficients sent to the owners of native G-vectors.
+    mpi::block_data_descriptor a2a_ext_;
+
+    /// Counts and offsets of the coefficients of the local native G-vectors received from the external side.
+    mpi::block_data_descriptor a2a_native_;
+
+    /// Index of the external G-vector for each element of the external buffer.
+    std::vector<int> idx_ext_;
+
+    /// True if the coefficient of the external G-vector is complex conjugated.
+    std::vector<char> conj_ext_;
+
+    /// Local index of the native G-vector for each element of the native buffer.
+    std::vector<int> idx_native_;
+
+    /// Local indices of the external G-vectors which are not found in the native list.
+    std::vector<int> missing_;
+
+    /// Owners of the native G-vectors are not unique if some ranks of comm__ have the same distribution.
+    bool scatter_{true};
+
+  public:
+    /// Constructor.
+    /** The list of external G-vectors is given by the (3, ngv__) array of Miller indices. If scatter__ is true,
+     *  the coefficients of each G-vector are sent to all ranks of the communicator that store this G-vector;
+     *  otherwise a single owner is used, which is enough to gather the coefficients. */
+    Gvec_redistribution(Gvec const& gvec__, mpi::Communicator const& comm__, int ngv__, int const* gvl__,
+                        bool scatter__);
+
+    /// Set the local native coefficients from the external ones.
+    /** Contributions from different ranks to the same G-vector are summed, such that each native G-vector must be
+     *  present only in one of the external lists. */
+    template <typename T>
+    void scatter(std::complex<T> const* f_ext__, std::complex<T>* f_pw__) const
+    {
+        PROFILE("fft::Gvec_redistribution::scatter");
+
+        RTE_ASSERT(scatter_);
+
+        std::vector<std::complex<T>> send_buf(a2a_ext_.size());
+        for (int i = 0; i < a2a_ext_.size(); i++) {
+            send_buf[i] = conj_ext_[i] ? std::conj(f_ext__[idx_ext_[i]]) : f_ext__[idx_ext_[i]];
+        }
+        std::vector<std::complex<T>> recv_buf(a2a_native_.size());
+        comm_.alltoall(send_buf.data(), a2a_ext_.counts.data(), a2a_ext_.offsets.data(), recv_buf.data(),
+                       a2a_native_.counts.data(), a2a_native_.offsets.data());
+
+        std::fill(f_pw__, f_pw__ + count_, std::complex<T>(0, 0));
+        for (int i = 0; i < a2a_native_.size(); i++) {
+            f_pw__[idx_native_[i]] += recv_buf[i];
+        }
+    }
+
+    /// Get the external coefficients from the local native ones.
+    /** Coefficients of the G-vectors which are not found in the native list are set to zero. */
+    template <typename T>
+    void gather(std::complex<T> const* f_pw__, std::complex<T>* f_ext__) const
+    {
+        PROFILE("fft::Gvec_redistribution::gather");
+
+        std::vector<std::complex<T>> send_buf(a2a_native_.size());
+        for (int i = 0; i < a2a_native_.size(); i++) {
+            send_buf[i] = f_pw__[idx_native_[i]];
+        }
+        std::vector<std::complex<T>> recv_buf(a2a_ext_.size());
+        comm_.alltoall(send_buf.data(), a2a_native_.counts.data(), a2a_native_.offsets.data(), recv_buf.data(),
+                       a2a_ext_.counts.data(), a2a_ext_.offsets.data());
+
+        std::fill(f_ext__, f_ext__ + ngv_ext_, std::complex<T>(0, 0));
+        for (int i = 0; i < a2a_ext_.size(); i++) {
+            f_ext__[idx_ext_[i]] = conj_ext_[i] ? std::conj(recv_buf[i]) : recv_buf[i];
+        }
+    }
+
+    /// Local indices of the external G-vectors which are not found in the native list.
+    inline auto const& missing() const
+    {
+        return missing_;
+    }
+};
+
 /// This is only for debug purpose.
 inline std::shared_ptr<Gvec>
 gkvec_factory(double gk_cutoff__, mpi::Communicator const& comm__)
@@ -229,6 +229,22 @@ class Spheric_vector_function : public std::array<Spheric_function<domain_t, T>,
         }
     }
 
+    /// Constructor of the vector function with the three components stored in the external buffer.
+    /** The components are separated by stride__ elements; by default they are stored one after another. */
+    Spheric_vector_function(T* ptr__, int angular_domain_size__, Radial_grid<double> const& radial_grid__,
+                            size_t stride__ = 0)
+        : radial_grid_(&radial_grid__)
+        , angular_domain_size_(angular_domain_size__)
+    {
+        size_t sz = static_cast<size_t>(angular_domain_size__) * radial_grid__.num_points();
+        if (stride__ == 0) {
+            stride__ = sz;
+        }
+        for (int x: {0, 1, 2}) {
+            (*this)[x] = Spheric_function<domain_t, T>(ptr__ + x * stride__, angular_domain_size__, radial_grid__);
+        }
+    }
+
     inline Radial_grid<double> const& radial_grid() const
     {
         RTE_ASSERT(radial_grid_ != nullptr);
@@ -241,6 +257,203 @@ class Spheric_vector_function : public std::array<Spheric_function<domain_t, T>,
     }
 };
 
+/// Functions of several atoms with the same radial grid and angular domain stored one after another in memory.
+/** The batch does not own the memory. All functions of the batch are transformed between the spectral and spatial
+ *  domains with one call to SHT, which is a single GEMM with the radial points of all atoms as columns. Elementwise
+ *  operations can run over the whole batch as a flat array of size() elements. */
+template <function_domain_t domain_t, typename T>
+class Spheric_function_batch
+{
+  private:
+    T* ptr_{nullptr};
+
+    int angular_domain_size_{0};
+
+    Radial_grid<double> const* radial_grid_{nullptr};
+
+    int num_functions_{0};
+
+  public:
+    Spheric_function_batch()
+    {
+    }
+
+    Spheric_function_batch(T* ptr__, int angular_domain_size__, Radial_grid<double> const& radial_grid__,
+                           int num_functions__)
+        : ptr_{ptr__}
+        , angular_domain_size_{angular_domain_size__}
+        , radial_grid_{&radial_grid__}
+        , num_functions_{num_functions__}
+    {
+    }
+
+    /// View of the i-th function of the batch.
+    inline auto operator[](int i__) const
+    {
+        RTE_ASSERT(i__ >= 0 && i__ < num_functions_);
+        return Spheric_function<domain_t, T>(ptr_ + i__ * this->function_size(), angular_domain_size_, *radial_grid_);
+    }
+
+    inline T* at() const
+    {
+        return ptr_;
+    }
+
+    inline int num_functions() const
+    {
+        return num_functions_;
+    }
+
+    /// Number of elements of one function.
+    inline size_t function_size() const
+    {
+        return static_cast<size_t>(angular_domain_size_) * radial_grid_->num_points();
+    }
+
+    /// Total number of elements in the batch.
+    inline size_t size() const
+    {
+        return this->function_size() * num_functions_;
+    }
+
+    inline int angular_domain_size() const
+    {
+        return angular_domain_size_;
+    }
+
+    inline Radial_grid<double> const& radial_grid() const
+    {
+        RTE_ASSERT(radial_grid_ != nullptr);
+        return *radial_grid_;
+    }
+};
+
+/// Vector functions of several atoms with the same radial grid and angular domain.
+/** Each Cartesian component is stored as a Spheric_function_batch, so that it can be transformed for all atoms at
+ *  once. */
+template <function_domain_t domain_t, typename T>
+class Spheric_vector_function_batch : public std::array<Spheric_function_batch<domain_t, T>, 3>
+{
+  public:
+    Spheric_vector_function_batch()
+    {
+    }
+
+    /// Constructor of the batch with the three components stored one after another in the external buffer.
+    Spheric_vector_function_batch(T* ptr__, int angular_domain_size__, Radial_grid<double> const& radial_grid__,
+                                  int num_functions__)
+    {
+        size_t sz = static_cast<size_t>(angular_domain_size__) * radial_grid__.num_points() * num_functions__;
+        for (int x: {0, 1, 2}) {
+            (*this)[x] = Spheric_function_batch<domain_t, T>(ptr__ + x * sz, angular_domain_size__, radial_grid__,
+                                                             num_functions__);
+        }
+    }
+
+    /// View of the vector function of the i-th atom.
+    inline auto function(int i__) const
+    {
+        auto& f = (*this)[0];
+        return Spheric_vector_function<domain_t, T>(f.at() + i__ * f.function_size(), f.angular_domain_size(),
+                                                    f.radial_grid(), f.size());
+    }
+
+    inline int num_functions() const
+    {
+        return (*this)[0].num_functions();
+    }
+};
+
+/// Scratch memory of the in-place differential operators of the spheric functions.
+/** The buffers are only grown, so the repeated operations on functions of the same or smaller size do not allocate
+ *  memory. Buffers 0-2 are used by radial_derivative(), buffer 3 holds the radial derivative in gradient() and
+ *  laplacian(), buffers 4-6 hold the complex-harmonics representations in gradient() and divergence() and the
+ *  second derivative in laplacian(). */
+class Spheric_function_workspace
+{
+  private:
+    std::array<std::vector<double>, 7> buf_;
+
+  public:
+    /// Return the buffer with the given index which has room for at least size__ elements of type T.
+    template <typename T>
+    T* get(int idx__, size_t size__)
+    {
+        static_assert(sizeof(T) % sizeof(double) == 0, "wrong type of the buffer");
+        size_t sz = size__ * (sizeof(T) / sizeof(double));
+        if (buf_[idx__].size() < sz) {
+            buf_[idx__].resize(sz);
+        }
+        return reinterpret_cast<T*>(buf_[idx__].data());
+    }
+};
+
+/// Radial derivative of all components of a function in spectral domain.
+/** The result is the first derivative of the cubic spline which interpolates each component (see Spline::deriv()).
+ *  The tridiagonal system of the spline equations depends only on the radial grid, so it is eliminated once for all
+ *  components and the inner loops run over the contiguous angular index. The output can be the same function as
+ *  the input. */
+template <typename T>
+inline void
+radial_derivative(Spheric_function<function_domain_t::spectral, T> const& f__,
+                  Spheric_function<function_domain_t::spectral, T>& df__, Spheric_function_workspace& ws__)
+{
+    auto& rgrid = f__.radial_grid();
+    int nr      = rgrid.num_points();
+    int n       = f__.angular_domain_size();
+    RTE_ASSERT(nr >= 4);
+
+    /* lower, main and upper diagonals of the matrix */
+    double* dl = ws__.get<double>(0, 3 * nr);
+    double* d  = dl + nr;
+    double* du = d + nr;
+    /* derivatives of the linear interpolation */
+    sddk::mdarray<T, 2> dy(ws__.get<T>(1, static_cast<size_t>(n) * nr), n, nr);
+    /* m_i = 2 c_i */
+    sddk::mdarray<T, 2> m(ws__.get<T>(2, static_cast<size_t>(n) * nr), n, nr);
+
+    for (int i = 0; i < nr - 1; i++) {
+        for (int lm = 0; lm < n; lm++) {
+            dy(lm, i) = (f__(lm, i + 1) - f__(lm, i)) / rgrid.dx(i);
+        }
+    }
+    for (int i = 0; i < nr - 2; i++) {
+        for (int lm = 0; lm < n; lm++) {
+            m(lm, i + 1) = (dy(lm, i + 1) - dy(lm, i)) * 6.0;
+        }
+    }
+    for (int lm = 0; lm < n; lm++) {
+        m(lm, 0)      = m(lm, 1);
+        m(lm, nr - 1) = m(lm, nr - 2);
+    }
+
+    /* the same matrix with the not-a-knot boundary conditions as in Spline::interpolate() */
+    Spline<double>::setup_matrix(rgrid, dl, d, du);
+
+    /* one elimination for all right-hand sides */
+    if (Spline<double>::solve(dl, d, du, m.at(sddk::memory_t::host), nr, n)) {
+        RTE_THROW("singular system of spline equations");
+    }
+
+    /* b_i coefficients of the splines */
+    for (int i = 0; i < nr - 1; i++) {
+        double h = rgrid.dx(i);
+        for (int lm = 0; lm < n; lm++) {
+            T c        = m(lm, i) / 2.0;
+            T t        = (m(lm, i + 1) - m(lm, i)) / 6.0;
+            df__(lm, i) = dy(lm, i) - (c + t) * h;
+        }
+    }
+    /* derivative at the last point is taken from the last segment */
+    int i    = nr - 2;
+    double h = rgrid.dx(i);
+    for (int lm = 0; lm < n; lm++) {
+        T c          = m(lm, i) / 2.0;
+        T t          = (m(lm, i + 1) - m(lm, i)) / 6.0;
+        df__(lm, nr - 1) = df__(lm, i) + (c * 2.0 + (t / h) * h * 3.0) * h;
+    }
+}
+
 /// Multiplication of two functions in spatial domain.
 /** The result of the operation is a scalar function in spatial domain */
 template <typename T>
@@ -395,35 +608,42 @@ inner(Spheric_function<domain_t, T> const& f1, Spheric_function<domain_t, T> con
     \f]
  */
 template <typename T>
-inline auto
-laplacian(Spheric_function<function_domain_t::spectral, T> const& f__)
+inline void
+laplacian(Spheric_function<function_domain_t::spectral, T> const& f__,
+          Spheric_function<function_domain_t::spectral, T>& g__, Spheric_function_workspace& ws__)
 {
-    Spheric_function<function_domain_t::spectral, T> g;
     auto& rgrid = f__.radial_grid();
-    int lmmax = f__.angular_domain_size();
-    int lmax = utils::lmax(lmmax);
-    g = Spheric_function<function_domain_t::spectral, T>(lmmax, rgrid);
-
-    Spline<T> s1(rgrid);
-    for (int l = 0; l <= lmax; l++) {
-        int ll = l * (l + 1);
-        for (int m = -l; m <= l; m++) {
-            int lm = utils::lm(l, m);
-            /* get lm component */
-            auto s = f__.component(lm);
-            /* compute 1st derivative */
-            for (int ir = 0; ir < s.num_points(); ir++) {
-                s1(ir) = s.deriv(1, ir);
-            }
-            s1.interpolate();
-
-            for (int ir = 0; ir < s.num_points(); ir++) {
-                g(lm, ir) = 2.0 * s1(ir) * rgrid.x_inv(ir) + s1.deriv(1, ir) -
-                    s(ir) * static_cast<double>(ll) / std::pow(rgrid[ir], 2);
+    int lmmax   = f__.angular_domain_size();
+    int lmax    = utils::lmax(lmmax);
+    size_t sz   = static_cast<size_t>(lmmax) * rgrid.num_points();
+
+    /* first and second radial derivatives */
+    Spheric_function<function_domain_t::spectral, T> s1(ws__.get<T>(3, sz), lmmax, rgrid);
+    Spheric_function<function_domain_t::spectral, T> s2(ws__.get<T>(6, sz), lmmax, rgrid);
+    radial_derivative(f__, s1, ws__);
+    radial_derivative(s1, s2, ws__);
+
+    for (int ir = 0; ir < rgrid.num_points(); ir++) {
+        double r2 = std::pow(rgrid[ir], 2);
+        for (int l = 0; l <= lmax; l++) {
+            int ll = l * (l + 1);
+            for (int m = -l; m <= l; m++) {
+                int lm = utils::lm(l, m);
+                g__(lm, ir) = 2.0 * s1(lm, ir) * rgrid.x_inv(ir) + s2(lm, ir) -
+                              f__(lm, ir) * static_cast<double>(ll) / r2;
             }
         }
     }
+}
 
+/// Compute Laplacian of the spheric function.
+template <typename T>
+inline auto
+laplacian(Spheric_function<function_domain_t::spectral, T> const& f__)
+{
+    Spheric_function<function_domain_t::spectral, T> g(f__.angular_domain_size(), f__.radial_grid());
+    Spheric_function_workspace ws;
+    laplacian(f__, g, ws);
     return g;
 }
 
@@ -433,29 +653,22 @@ convert(Spheric_function<function_domain_t::spectral, std::complex<double>> cons
         Spheric_function<function_domain_t::spectral, double>& g__)
 {
     int lmax = utils::lmax(f__.angular_domain_size());
+    int nr   = f__.radial_grid().num_points();
 
-    /* cache transformation arrays */
-    std::vector<std::complex<double>> tpp(f__.angular_domain_size());
-    std::vector<std::complex<double>> tpm(f__.angular_domain_size());
     for (int l = 0; l <= lmax; l++) {
         for (int m = -l; m <= l; m++) {
             int lm = utils::lm(l, m);
-            tpp[lm] = SHT::rlm_dot_ylm(l, m, m);
-            tpm[lm] = SHT::rlm_dot_ylm(l, m, -m);
-        }
-    }
-
-    for (int ir = 0; ir < f__.radial_grid().num_points(); ir++) {
-        int lm = 0;
-        for (int l = 0; l <= lmax; l++) {
-            for (int m = -l; m <= l; m++) {
-                if (m == 0) {
+            if (m == 0) {
+                for (int ir = 0; ir < nr; ir++) {
                     g__(lm, ir) = std::real(f__(lm, ir));
-                } else {
-                    int lm1 = utils::lm(l, -m);
-                    g__(lm, ir) = std::real(tpp[lm] * f__(lm, ir) + tpm[lm] * f__(lm1, ir));
                 }
-                lm++;
+            } else {
+                int lm1  = utils::lm(l, -m);
+                auto tpp = SHT::rlm_dot_ylm(l, m, m);
+                auto tpm = SHT::rlm_dot_ylm(l, m, -m);
+                for (int ir = 0; ir < nr; ir++) {
+                    g__(lm, ir) = std::real(tpp * f__(lm, ir) + tpm * f__(lm1, ir));
+                }
             }
         }
     }
@@ -476,29 +689,22 @@ convert(Spheric_function<function_domain_t::spectral, double> const& f__,
         Spheric_function<function_domain_t::spectral, std::complex<double>>& g__)
 {
     int lmax = utils::lmax(f__.angular_domain_size());
+    int nr   = f__.radial_grid().num_points();
 
-    /* cache transformation arrays */
-    std::vector<std::complex<double>> tpp(f__.angular_domain_size());
-    std::vector<std::complex<double>> tpm(f__.angular_domain_size());
     for (int l = 0; l <= lmax; l++) {
         for (int m = -l; m <= l; m++) {
             int lm = utils::lm(l, m);
-            tpp[lm] = SHT::ylm_dot_rlm(l, m, m);
-            tpm[lm] = SHT::ylm_dot_rlm(l, m, -m);
-        }
-    }
-
-    for (int ir = 0; ir < f__.radial_grid().num_points(); ir++) {
-        int lm = 0;
-        for (int l = 0; l <= lmax; l++) {
-            for (int m = -l; m <= l; m++) {
-                if (m == 0) {
+            if (m == 0) {
+                for (int ir = 0; ir < nr; ir++) {
                     g__(lm, ir) = f__(lm, ir);
-                } else {
-                    int lm1 = utils::lm(l, -m);
-                    g__(lm, ir) = tpp[lm] * f__(lm, ir) + tpm[lm] * f__(lm1, ir);
                 }
-                lm++;
+            } else {
+                int lm1  = utils::lm(l, -m);
+                auto tpp = SHT::ylm_dot_rlm(l, m, m);
+                auto tpm = SHT::ylm_dot_rlm(l, m, -m);
+                for (int ir = 0; ir < nr; ir++) {
+                    g__(lm, ir) = tpp * f__(lm, ir) + tpm * f__(lm1, ir);
+                }
             }
         }
     }
@@ -550,73 +756,141 @@ transform(SHT const& sht__, Spheric_function<function_domain_t::spatial, T> cons
     return g;
 }
 
+/// Transform a batch of functions to spatial domain.
+template <typename T>
+inline void
+transform(SHT const& sht__, Spheric_function_batch<function_domain_t::spectral, T> const& f__,
+          Spheric_function_batch<function_domain_t::spatial, T> const& g__)
+{
+    RTE_ASSERT(f__.num_functions() == g__.num_functions());
+    RTE_ASSERT(g__.angular_domain_size() == sht__.num_points());
+    sht__.backward_transform(f__.angular_domain_size(), f__.at(), f__.radial_grid().num_points() * f__.num_functions(),
+                             std::min(sht__.lmmax(), f__.angular_domain_size()), g__.at());
+}
+
+/// Transform a batch of functions to spectral domain.
+template <typename T>
+inline void
+transform(SHT const& sht__, Spheric_function_batch<function_domain_t::spatial, T> const& f__,
+          Spheric_function_batch<function_domain_t::spectral, T> const& g__)
+{
+    RTE_ASSERT(f__.num_functions() == g__.num_functions());
+    RTE_ASSERT(g__.angular_domain_size() == sht__.lmmax());
+    sht__.forward_transform(f__.at(), f__.radial_grid().num_points() * f__.num_functions(), sht__.lmmax(),
+                            sht__.lmmax(), g__.at());
+}
+
 /// Gradient of the function in complex spherical harmonics.
-inline auto
-gradient(Spheric_function<function_domain_t::spectral, std::complex<double>> const& f)
+/** If comp__ is 0, 1 or 2, only this Cartesian component of the gradient is computed. */
+inline void
+gradient(Spheric_function<function_domain_t::spectral, std::complex<double>> const& f__,
+         Spheric_vector_function<function_domain_t::spectral, std::complex<double>>& g__,
+         Spheric_function_workspace& ws__, int comp__ = -1)
 {
-    Spheric_vector_function<function_domain_t::spectral, std::complex<double>> g(f.angular_domain_size(), f.radial_grid());
-    for (int i = 0; i < 3; i++) {
-        g[i].zero();
+    auto& rgrid = f__.radial_grid();
+    int nr      = rgrid.num_points();
+    int lmmax   = f__.angular_domain_size();
+    int lmax    = utils::lmax(lmmax);
+
+    /* radial derivative of all components */
+    Spheric_function<function_domain_t::spectral, std::complex<double>> df(
+        ws__.get<std::complex<double>>(3, static_cast<size_t>(lmmax) * nr), lmmax, rgrid);
+    radial_derivative(f__, df, ws__);
+
+    /* mu = 1 and mu = -1 components are needed for x and y, mu = 0 component is z */
+    bool need_xy = (comp__ != 2);
+    bool need_z  = (comp__ < 0 || comp__ == 2);
+
+    for (int j = 0; j < 3; j++) {
+        if ((j < 2 && need_xy) || (j == 2 && need_z)) {
+            g__[j].zero();
+        }
     }
 
-    int lmax = utils::lmax(f.angular_domain_size());
-
     for (int l = 0; l <= lmax; l++) {
         double d1 = std::sqrt(double(l + 1) / double(2 * l + 3));
         double d2 = std::sqrt(double(l) / double(2 * l - 1));
 
         for (int m = -l; m <= l; m++) {
             int lm = utils::lm(l, m);
-            auto s = f.component(lm);
 
             for (int mu = -1; mu <= 1; mu++) {
+                if ((mu == 0 && !need_z) || (mu != 0 && !need_xy)) {
+                    continue;
+                }
                 int j = (mu + 2) % 3; // map -1,0,1 to 1,2,0 (to y,z,x)
 
                 if ((l + 1) <= lmax && std::abs(m + mu) <= l + 1) {
-                    int lm1 = utils::lm(l + 1, m + mu); 
+                    int lm1 = utils::lm(l + 1, m + mu);
                     double d = d1 * SHT::clebsch_gordan(l, 1, l + 1, m, mu, m + mu);
-                    for (int ir = 0; ir < f.radial_grid().num_points(); ir++) {
-                        g[j](lm1, ir) += (s.deriv(1, ir) - f(lm, ir) * f.radial_grid().x_inv(ir) * double(l)) * d;
+                    for (int ir = 0; ir < nr; ir++) {
+                        g__[j](lm1, ir) += (df(lm, ir) - f__(lm, ir) * rgrid.x_inv(ir) * double(l)) * d;
                     }
                 }
                 if ((l - 1) >= 0 && std::abs(m + mu) <= l - 1) {
-                    int lm1 = utils::lm(l - 1, m + mu); 
-                    double d = d2 * SHT::clebsch_gordan(l, 1, l - 1, m, mu, m + mu); 
-                    for (int ir = 0; ir < f.radial_grid().num_points(); ir++) {
-                        g[j](lm1, ir) -= (s.deriv(1, ir) + f(lm, ir) * f.radial_grid().x_inv(ir) * double(l + 1)) * d;
+                    int lm1 = utils::lm(l - 1, m + mu);
+                    double d = d2 * SHT::clebsch_gordan(l, 1, l - 1, m, mu, m + mu);
+                    for (int ir = 0; ir < nr; ir++) {
+                        g__[j](lm1, ir) -= (df(lm, ir) + f__(lm, ir) * rgrid.x_inv(ir) * double(l + 1)) * d;
                     }
                 }
             }
         }
     }
 
-    std::complex<double> d1(1.0 / std::sqrt(2.0), 0);
-    std::complex<double> d2(0, 1.0 / std::sqrt(2.0));
+    if (need_xy) {
+        std::complex<double> d1(1.0 / std::sqrt(2.0), 0);
+        std::complex<double> d2(0, 1.0 / std::sqrt(2.0));
 
-    for (int ir = 0; ir < f.radial_grid().num_points(); ir++) {
-        for (int lm = 0; lm < f.angular_domain_size(); lm++) {
-            std::complex<double> g_p = g[0](lm, ir);
-            std::complex<double> g_m = g[1](lm, ir);
-            g[0](lm, ir) = d1 * (g_m - g_p);
-            g[1](lm, ir) = d2 * (g_m + g_p);
+        for (int ir = 0; ir < nr; ir++) {
+            for (int lm = 0; lm < lmmax; lm++) {
+                std::complex<double> g_p = g__[0](lm, ir);
+                std::complex<double> g_m = g__[1](lm, ir);
+                g__[0](lm, ir) = d1 * (g_m - g_p);
+                g__[1](lm, ir) = d2 * (g_m + g_p);
+            }
         }
     }
+}
 
+/// Gradient of the function in complex spherical harmonics.
+inline auto
+gradient(Spheric_function<function_domain_t::spectral, std::complex<double>> const& f)
+{
+    Spheric_vector_function<function_domain_t::spectral, std::complex<double>> g(f.angular_domain_size(), f.radial_grid());
+    Spheric_function_workspace ws;
+    gradient(f, g, ws);
     return g;
 }
 
+/// Gradient of the function in real spherical harmonics.
+inline void
+gradient(Spheric_function<function_domain_t::spectral, double> const& f__,
+         Spheric_vector_function<function_domain_t::spectral, double>& g__, Spheric_function_workspace& ws__)
+{
+    auto& rgrid = f__.radial_grid();
+    int lmmax   = f__.angular_domain_size();
+    size_t sz   = static_cast<size_t>(lmmax) * rgrid.num_points();
+
+    Spheric_function<function_domain_t::spectral, std::complex<double>> zf(ws__.get<std::complex<double>>(4, sz),
+                                                                           lmmax, rgrid);
+    Spheric_vector_function<function_domain_t::spectral, std::complex<double>> zg(
+        ws__.get<std::complex<double>>(5, 3 * sz), lmmax, rgrid);
+
+    convert(f__, zf);
+    gradient(zf, zg, ws__);
+    for (int x: {0, 1, 2}) {
+        convert(zg[x], g__[x]);
+    }
+}
+
 /// Gradient of the function in real spherical harmonics.
 inline auto
 gradient(Spheric_function<function_domain_t::spectral, double> const& f__)
 {
-    int lmax = utils::lmax(f__.angular_domain_size());
-    SHT sht(sddk::device_t::CPU, lmax);
-    auto zf = convert(f__);
-    auto zg = gradient(zf);
     Spheric_vector_function<function_domain_t::spectral, double> g(f__.angular_domain_size(), f__.radial_grid());
-    for (int x: {0, 1, 2}) {
-        g[x] = convert(zg[x]);
-    }
+    Spheric_function_workspace ws;
+    gradient(f__, g, ws);
     return g;
 }
 
@@ -634,18 +908,37 @@ divergence(Spheric_vector_function<function_domain_t::spectral, std::complex<dou
     return g;
 }
 
+/// Divergence of the vector function in real spherical harmonics.
+/** Only the x-th component of the gradient of the x-th component of the function is computed. */
+inline void
+divergence(Spheric_vector_function<function_domain_t::spectral, double> const& vf__,
+           Spheric_function<function_domain_t::spectral, double>& g__, Spheric_function_workspace& ws__)
+{
+    auto& rgrid = vf__.radial_grid();
+    int lmmax   = vf__.angular_domain_size();
+    size_t sz   = static_cast<size_t>(lmmax) * rgrid.num_points();
+
+    Spheric_function<function_domain_t::spectral, std::complex<double>> zf(ws__.get<std::complex<double>>(4, sz),
+                                                                           lmmax, rgrid);
+    Spheric_vector_function<function_domain_t::spectral, std::complex<double>> zg(
+        ws__.get<std::complex<double>>(5, 3 * sz), lmmax, rgrid);
+    Spheric_function<function_domain_t::spectral, std::complex<double>> zdiv(ws__.get<std::complex<double>>(6, sz),
+                                                                             lmmax, rgrid);
+    zdiv.zero();
+    for (int x: {0, 1, 2}) {
+        convert(vf__[x], zf);
+        gradient(zf, zg, ws__, x);
+        zdiv += zg[x];
+    }
+    convert(zdiv, g__);
+}
+
 inline auto
 divergence(Spheric_vector_function<function_domain_t::spectral, double> const& vf)
 {
     Spheric_function<function_domain_t::spectral, double> g(vf.angular_domain_size(), vf.radial_grid());
-    g.zero();
-
-    for (int x: {0, 1, 2}) {
-        auto zf = convert(vf[x]);
-        auto zf1 = gradient(zf);
-        auto f2 = convert(zf1[x]);
-        g += f2;
-    }
+    Spheric_function_workspace ws;
+    divergence(vf, g, ws);
     return g;
 }
 
@@ -23,6 +23,7 @@
  */
 
 #include "force.hpp"
+#include "dft/ewald.hpp"
 #include "k_point/k_point.hpp"
 #include "k_point/k_point_set.hpp"
 #include "density/density.hpp"
@@ -352,41 +353,45 @@ Force::calc_forces_ewald()
 
     int ig0 = ctx_.gvec().skip_g0();
 
-    sddk::mdarray<std::complex<double>, 1> rho_tmp(ctx_.gvec().count());
-    rho_tmp.zero();
-    #pragma omp parallel for schedule(static)
-    for (int igloc = ig0; igloc < ctx_.gvec().count(); igloc++) {
-        int ig = ctx_.gvec().offset() + igloc;
+    if (ctx_.cfg().settings().ewald() == "pme") {
+        auto& pme = ctx_.ewald_pme();
 
-        std::complex<double> rho(0, 0);
-
-        for (int ja = 0; ja < unit_cell.num_atoms(); ja++) {
-            rho += ctx_.gvec_phase_factor(ig, ja) * static_cast<double>(unit_cell.atom(ja).zn());
+        std::vector<double> f(ctx_.gvec().count(), 0);
+        for (int igloc = ig0; igloc < ctx_.gvec().count(); igloc++) {
+            double g2 = std::pow(ctx_.gvec().gvec_len<sddk::index_domain_t::local>(igloc), 2);
+            f[igloc]  = std::exp(-g2 / (4 * alpha)) / g2;
         }
+        /* returned forces are already summed over all G-vectors */
+        forces_ewald_ = pme.forces(pme.structure_factor(), f);
+    } else {
+        #pragma omp parallel for
+        for (int ja = 0; ja < unit_cell.num_atoms(); ja++) {
+            for (int igloc = ig0; igloc < ctx_.gvec().count(); igloc++) {
+                int ig = ctx_.gvec().offset() + igloc;
 
-        rho_tmp[igloc] = std::conj(rho);
-    }
-
-    #pragma omp parallel for
-    for (int ja = 0; ja < unit_cell.num_atoms(); ja++) {
-        for (int igloc = ig0; igloc < ctx_.gvec().count(); igloc++) {
-            int ig = ctx_.gvec().offset() + igloc;
+                double g2 = std::pow(ctx_.gvec().gvec_len<sddk::index_domain_t::local>(igloc), 2);
 
-            double g2 = std::pow(ctx_.gvec().gvec_len<sddk::index_domain_t::local>(igloc), 2);
+                /* cartesian form for getting cartesian force components */
+                auto gvec_cart = ctx_.gvec().gvec_cart<sddk::index_domain_t::local>(igloc);
 
-            /* cartesian form for getting cartesian force components */
-            auto gvec_cart = ctx_.gvec().gvec_cart<sddk::index_domain_t::local>(igloc);
+                /* complex conjugate of the ionic charge density, built from the cached structure factors */
+                std::complex<double> rho(0, 0);
+                for (int iat = 0; iat < unit_cell.num_atom_types(); iat++) {
+                    rho += std::conj(ctx_.structure_factor(igloc, iat)) *
+                           static_cast<double>(unit_cell.atom_type(iat).zn());
+                }
 
-            double scalar_part = prefac * (rho_tmp[igloc] * ctx_.gvec_phase_factor(ig, ja)).imag() *
-                                 static_cast<double>(unit_cell.atom(ja).zn()) * std::exp(-g2 / (4 * alpha)) / g2;
+                double scalar_part = prefac * (rho * ctx_.gvec_phase_factor(ig, ja)).imag() *
+                                     static_cast<double>(unit_cell.atom(ja).zn()) * std::exp(-g2 / (4 * alpha)) / g2;
 
-            for (int x : {0, 1, 2}) {
-                forces_ewald_(x, ja) += scalar_part * gvec_cart[x];
+                for (int x : {0, 1, 2}) {
+                    forces_ewald_(x, ja) += scalar_part * gvec_cart[x];
+                }
             }
         }
-    }
 
-    ctx_.comm().allreduce(&forces_ewald_(0, 0), 3 * ctx_.unit_cell().num_atoms());
+        ctx_.comm().allreduce(&forces_ewald_(0, 0), 3 * ctx_.unit_cell().num_atoms());
+    }
 
     double invpi = 1. / pi;
 
@@ -420,6 +425,11 @@ Force::calc_forces_us()
 {
     PROFILE("sirius::Force::calc_forces_us");
 
+    /* the real-space augmentation uses the filtered Q(r); its derivatives are not implemented */
+    if (ctx_.cfg().settings().augmentation() == "real_space" && ctx_.unit_cell().augment()) {
+        RTE_THROW("forces are not available for the real-space augmentation");
+    }
+
     forces_us_ = sddk::mdarray<double, 2>(3, ctx_.unit_cell().num_atoms());
     forces_us_.zero();
 
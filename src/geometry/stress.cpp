@@ -28,6 +28,7 @@
 #include "non_local_functor.hpp"
 #include "utils/profiler.hpp"
 #include "dft/energy.hpp"
+#include "dft/ewald.hpp"
 #include "symmetry/crystal_symmetry.hpp"
 
 namespace sirius {
@@ -374,6 +375,11 @@ Stress::calc_stress_us()
 {
     PROFILE("sirius::Stress|us");
 
+    /* the real-space augmentation uses the filtered Q(r); its derivatives are not implemented */
+    if (ctx_.cfg().settings().augmentation() == "real_space" && ctx_.unit_cell().augment()) {
+        RTE_THROW("stress is not available for the real-space augmentation");
+    }
+
     stress_us_.zero();
 
     /* check if we have beta projectors. Only for pseudo potentials */
@@ -498,21 +504,15 @@ Stress::calc_stress_ewald()
 
     auto& uc = ctx_.unit_cell();
 
+    auto rho = ewald_structure_factor(ctx_, ctx_.gvec());
+
     int ig0 = ctx_.gvec().skip_g0();
     for (int igloc = ig0; igloc < ctx_.gvec().count(); igloc++) {
-        int ig = ctx_.gvec().offset() + igloc;
-
         auto G          = ctx_.gvec().gvec_cart<sddk::index_domain_t::local>(igloc);
         double g2       = std::pow(G.length(), 2);
         double g2lambda = g2 / 4.0 / lambda;
 
-        std::complex<double> rho(0, 0);
-
-        for (int ia = 0; ia < uc.num_atoms(); ia++) {
-            rho += ctx_.gvec_phase_factor(ig, ia) * static_cast<double>(uc.atom(ia).zn());
-        }
-
-        double a1 = twopi * std::pow(std::abs(rho) / uc.omega(), 2) * std::exp(-g2lambda) / g2;
+        double a1 = twopi * std::pow(std::abs(rho[igloc]) / uc.omega(), 2) * std::exp(-g2lambda) / g2;
 
         for (int mu : {0, 1, 2}) {
             for (int nu : {0, 1, 2}) {
@@ -463,8 +463,10 @@ class Hamiltonian_k
 
         if (hphi__ != nullptr) {
             /* apply local part of Hamiltonian */
+            auto& batch = kp().spfft_transform_batch();
             H0().local_op().apply_h(reinterpret_cast<fft::spfft_transform_type<T>&>(kp().spfft_transform()),
-                                    kp().gkvec_fft_sptr(), spins__, phi__, *hphi__, br__);
+                                    kp().gkvec_fft_sptr(), spins__, phi__, *hphi__, br__,
+                                    batch.empty() ? nullptr : &batch);
         }
 
         auto mem = H0().ctx().processing_unit_memory_t();
@@ -276,10 +276,51 @@ mul_by_veff(fft::spfft_transform_type<T>& spfftk__, T const* in__,
     }
 }
 
+/// Multiply FFT buffers of a batch of transforms by the same diagonal block of the effective potential.
+/** On CPU the loop over batch is the inner one such that the value of the potential is reused for all
+ *  bands. */
+template <typename T>
+static inline void
+mul_by_veff_batch(std::vector<fft::spfft_transform_type<T>>& spfftk__, int n__,
+    std::array<std::unique_ptr<Smooth_periodic_function<T>>, 6> const& veff_vec__, int idx_veff__)
+{
+    PROFILE("sirius::mul_by_veff");
+
+    auto spfft_pu = spfftk__[0].processing_unit();
+
+    if (spfft_pu == SPFFT_PU_GPU) {
+        for (int j = 0; j < n__; j++) {
+            auto buf = spfftk__[j].space_domain_data(spfft_pu);
+            mul_by_veff<T>(spfftk__[j], buf, veff_vec__, idx_veff__, buf);
+        }
+        return;
+    }
+
+    int nr = spfftk__[0].local_slice_size();
+    /* number of real values per point: R2C transform has real buffer, C2C has complex buffer */
+    int nc = (spfftk__[0].type() == SPFFT_TRANS_R2C) ? 1 : 2;
+
+    std::vector<T*> buf(n__);
+    for (int j = 0; j < n__; j++) {
+        buf[j] = spfftk__[j].space_domain_data(spfft_pu);
+    }
+
+    #pragma omp parallel for schedule(static)
+    for (int ir = 0; ir < nr; ir++) {
+        auto v = veff_vec__[idx_veff__]->value(ir);
+        for (int j = 0; j < n__; j++) {
+            for (int k = 0; k < nc; k++) {
+                buf[j][ir * nc + k] *= v;
+            }
+        }
+    }
+}
+
 template <typename T>
 void
 Local_operator<T>::apply_h(fft::spfft_transform_type<T>& spfftk__, std::shared_ptr<fft::Gvec_fft> gkvec_fft__,
-    wf::spin_range spins__, wf::Wave_functions<T> const& phi__, wf::Wave_functions<T>& hphi__, wf::band_range br__)
+    wf::spin_range spins__, wf::Wave_functions<T> const& phi__, wf::Wave_functions<T>& hphi__, wf::band_range br__,
+    std::vector<fft::spfft_transform_type<T>>* spfftk_batch__)
 {
     PROFILE("sirius::Local_operator::apply_h");
 
@@ -338,7 +379,7 @@ Local_operator<T>::apply_h(fft::spfft_transform_type<T>& spfftk__, std::shared_p
        spin block (ispn_block) is used as a bit mask:
         - first bit: spin component which is updated
         - second bit: add or not kinetic energy term */
-    auto add_to_hphi = [&](int ispn_block, wf::band_index i) {
+    auto add_to_hphi = [&](int ispn_block, wf::band_index i, sddk::mdarray<std::complex<T>, 1>& vphi) {
         PROFILE("add_to_hphi");
         /* index of spin component */
         int ispn = ispn_block & 1;
@@ -350,18 +391,18 @@ Local_operator<T>::apply_h(fft::spfft_transform_type<T>& spfftk__, std::shared_p
         switch (hphi_mem) {
             case sddk::memory_t::host: {
                 if (spfft_pu == SPFFT_PU_GPU) {
-                    vphi_.copy_to(sddk::memory_t::host);
+                    vphi.copy_to(sddk::memory_t::host);
                 }
                 /* CPU case */
                 if (ekin) {
                     #pragma omp parallel for
                     for (int ig = 0; ig < ngv_fft; ig++) {
-                        hphi_fft[ispn].pw_coeffs(ig, i) += phi_fft[ispn].pw_coeffs(ig, i) * pw_ekin_[ig] + vphi_[ig];
+                        hphi_fft[ispn].pw_coeffs(ig, i) += phi_fft[ispn].pw_coeffs(ig, i) * pw_ekin_[ig] + vphi[ig];
                     }
                 } else {
                     #pragma omp parallel for
                     for (int ig = 0; ig < ngv_fft; ig++) {
-                        hphi_fft[ispn].pw_coeffs(ig, wf::band_index(i)) += vphi_[ig];
+                        hphi_fft[ispn].pw_coeffs(ig, wf::band_index(i)) += vphi[ig];
                     }
                 }
                 break;
@@ -369,7 +410,7 @@ Local_operator<T>::apply_h(fft::spfft_transform_type<T>& spfftk__, std::shared_p
             case sddk::memory_t::device: {
                 add_to_hphi_pw_gpu(ngv_fft, ekin, pw_ekin_.at(sddk::memory_t::device),
                         phi_fft[ispn].at(sddk::memory_t::device, 0, wf::band_index(i)),
-                        vphi_.at(sddk::memory_t::device),
+                        vphi.at(sddk::memory_t::device),
                         hphi_fft[ispn].at(sddk::memory_t::device, 0, wf::band_index(i)));
                 break;
             }
@@ -396,6 +437,63 @@ Local_operator<T>::apply_h(fft::spfft_transform_type<T>& spfftk__, std::shared_p
         }
     };
 
+    /* number of bands transformed together */
+    int nb = (spfftk_batch__ == nullptr) ? 1 : static_cast<int>(spfftk_batch__->size());
+
+    /* batched transformation of bands in the spin-collinear or non-magnetic case */
+    if (spins__.size() == 1 && nb > 1) {
+        auto ispn = spins__.begin();
+        auto phi_mem = phi_fft[ispn.get()].on_device() ? sddk::memory_t::device : sddk::memory_t::host;
+
+        for (auto& e : *spfftk_batch__) {
+            if (e.num_local_elements() != ngv_fft || e.processing_unit() != spfft_pu) {
+                RTE_THROW("wrong batch of FFT transforms");
+            }
+        }
+
+        /* [V*phi](G) for each band in a batch */
+        std::vector<sddk::mdarray<std::complex<T>, 1>> vphi(nb);
+        for (int j = 0; j < nb; j++) {
+            vphi[j] = sddk::mdarray<std::complex<T>, 1>(ngv_fft, get_memory_pool(sddk::memory_t::host),
+                    "Local_operator::vphi_batch");
+            if (spfft_pu == SPFFT_PU_GPU) {
+                vphi[j].allocate(get_memory_pool(sddk::memory_t::device));
+            }
+        }
+
+        std::vector<T const*> inp(nb);
+        std::vector<T*> out(nb);
+        std::vector<SpfftProcessingUnitType> pu(nb, spfft_pu);
+        std::vector<SpfftScalingType> scaling(nb, SPFFT_FULL_SCALING);
+
+        PROFILE_START("sirius::Local_operator::apply_h|bands");
+        for (int i0 = 0; i0 < spl_num_wf.local_size(); i0 += nb) {
+            int n = std::min(nb, spl_num_wf.local_size() - i0);
+            for (int j = 0; j < n; j++) {
+                inp[j] = phi_fft[ispn.get()].pw_coeffs_spfft(phi_mem, wf::band_index(i0 + j));
+                out[j] = reinterpret_cast<T*>(vphi[j].at(spfft_mem));
+            }
+            /* phi(G) -> phi(r) */
+            {
+                PROFILE("phi_to_r");
+                spfft::multi_transform_backward(n, spfftk_batch__->data(), inp.data(), pu.data());
+            }
+            /* multiply by effective potential */
+            mul_by_veff_batch<T>(*spfftk_batch__, n, veff_vec_, ispn.get());
+            /* V(r)phi(r) -> [V*phi](G) */
+            {
+                PROFILE("vphi_to_G");
+                spfft::multi_transform_forward(n, spfftk_batch__->data(), pu.data(), out.data(), scaling.data());
+            }
+            /* add kinetic energy */
+            for (int j = 0; j < n; j++) {
+                add_to_hphi(ispn.get(), wf::band_index(i0 + j), vphi[j]);
+            }
+        }
+        PROFILE_STOP("sirius::Local_operator::apply_h|bands");
+        return;
+    }
+
     PROFILE_START("sirius::Local_operator::apply_h|bands");
     for (int i = 0; i < spl_num_wf.local_size(); i++) {
 
@@ -432,13 +530,13 @@ Local_operator<T>::apply_h(fft::spfft_transform_type<T>& spfftk__, std::shared_p
             /* V_{uu}(r)phi_{u}(r) -> [V*phi]_{u}(G) */
             vphi_to_G();
             /* add kinetic energy */
-            add_to_hphi(0, wf::band_index(i));
+            add_to_hphi(0, wf::band_index(i), vphi_);
             /* multiply phi_{u} by V_{du} and copy to FFT buffer */
             mul_by_veff<T>(spfftk__, reinterpret_cast<T*>(buf_rg_.at(spfft_mem)), veff_vec_, 3, spfft_buf);
             /* V_{du}(r)phi_{u}(r) -> [V*phi]_{d}(G) */
             vphi_to_G();
             /* add to hphi_{d} */
-            add_to_hphi(3, wf::band_index(i));
+            add_to_hphi(3, wf::band_index(i), vphi_);
 
             /* for the second spin component */
 
@@ -451,13 +549,13 @@ Local_operator<T>::apply_h(fft::spfft_transform_type<T>& spfftk__, std::shared_p
            /* V_{dd}(r)phi_{d}(r) -> [V*phi]_{d}(G) */
             vphi_to_G();
             /* add kinetic energy */
-            add_to_hphi(1, wf::band_index(i));
+            add_to_hphi(1, wf::band_index(i), vphi_);
             /* multiply phi_{d} by V_{ud} and copy to FFT buffer */
             mul_by_veff<T>(spfftk__, reinterpret_cast<T*>(buf_rg_.at(spfft_mem)), veff_vec_, 2, spfft_buf);
             /* V_{ud}(r)phi_{d}(r) -> [V*phi]_{u}(G) */
             vphi_to_G();
             /* add to hphi_{u} */
-            add_to_hphi(2, wf::band_index(i));
+            add_to_hphi(2, wf::band_index(i), vphi_);
         } else { /* spin-collinear or non-magnetic case */
             /* phi(G) -> phi(r) */
             phi_to_r(spins__.begin(), wf::band_index(i));
@@ -466,7 +564,7 @@ Local_operator<T>::apply_h(fft::spfft_transform_type<T>& spfftk__, std::shared_p
             /* V(r)phi(r) -> [V*phi](G) */
             vphi_to_G();
             /* add kinetic energy */
-            add_to_hphi(spins__.begin().get(), wf::band_index(i));
+            add_to_hphi(spins__.begin().get(), wf::band_index(i), vphi_);
         }
     }
     PROFILE_STOP("sirius::Local_operator::apply_h|bands");
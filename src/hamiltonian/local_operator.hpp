@@ -281,6 +281,9 @@ class Local_operator
      *  \param [out] hphi    Local hamiltonian applied to wave-function.
      *  \param [in]  idx0    Starting index of wave-functions.
      *  \param [in]  n       Number of wave-functions to which H is applied.
+     *  \param [in]  spfftk_batch Optional batch of independent SpFFT transforms for G+k vectors. If provided,
+     *                            bands are transformed in groups using SpFFT multi-transforms (only in the
+     *                            spin-collinear or non-magnetic case).
      *
      *  Spin range can take the following values:
      *    - [0, 0]: apply H_{uu} to the up- component of wave-functions
@@ -291,7 +294,7 @@ class Local_operator
      */
     void apply_h(fft::spfft_transform_type<T>& spfftk__, std::shared_ptr<fft::Gvec_fft> gkvec_fft__,
             wf::spin_range spins__, wf::Wave_functions<T> const& phi__, wf::Wave_functions<T>& hphi__,
-            wf::band_range br__);
+            wf::band_range br__, std::vector<fft::spfft_transform_type<T>>* spfftk_batch__ = nullptr);
 
     /// Apply local part of LAPW Hamiltonian and overlap operators.
     /** \param [in]  spfftk  SpFFT transform object for G+k vectors.
@@ -374,6 +374,18 @@ K_point<T>::generate_gkvec(double gk_cutoff__)
         spfft_pu, fft_type, ctx_.fft_coarse_grid()[0], ctx_.fft_coarse_grid()[1], ctx_.fft_coarse_grid()[2],
         ctx_.spfft_coarse<double>().local_z_length(), gkvec_partition_->count(), SPFFT_INDEX_TRIPLETS,
         gv.at(sddk::memory_t::host))));
+    /* transforms of the k-points processed concurrently can't share the coarse FFT grid */
+    if (!ctx_.full_potential() && ctx_.cfg().control().num_kpoint_teams() > 1) {
+        spfft_transform_.reset(new fft::spfft_transform_type<T>(spfft_transform_->clone()));
+    }
+
+    /* each transform in a batch must have its own grid, so the clones are created */
+    spfft_transform_batch_.clear();
+    if (!ctx_.full_potential() && ctx_.cfg().control().fft_batch_size() > 1) {
+        for (int i = 0; i < ctx_.cfg().control().fft_batch_size(); i++) {
+            spfft_transform_batch_.emplace_back(spfft_transform_->clone());
+        }
+    }
 
     sddk::splindex<sddk::splindex_t::block_cyclic> spl_ngk_row(num_gkvec(), num_ranks_row_, rank_row_, ctx_.cyclic_block_size());
     num_gkvec_row_ = spl_ngk_row.local_size();
@@ -543,13 +555,16 @@ K_point<T>::get_fv_eigen_vectors(sddk::mdarray<std::complex<T>, 2>& fv_evec__) c
 /** The following HDF5 data structure is created:
   \verbatim
   /K_point_set/ik/vk
+  /K_point_set/ik/num_gkvec
+  /K_point_set/ik/num_bands
+  /K_point_set/ik/num_spins
   /K_point_set/ik/band_energies
   /K_point_set/ik/band_occupancies
-  /K_point_set/ik/gkvec
   /K_point_set/ik/gvec
-  /K_point_set/ik/bands/ibnd/spinor_wave_function/ispn/pw
-  /K_point_set/ik/bands/ibnd/spinor_wave_function/ispn/mt
   \endverbatim
+  Plane-wave coefficients are stored in double precision in the order of G-vectors given by the \em gvec array.
+  They are written to the slice \em ik of the /K_point_set/pw dataset of dimensions
+  (2, max_num_gkvec, num_bands, num_spins, num_kpoints), which must be created by the caller.
 */
 template <typename T>
 void
@@ -562,74 +577,129 @@ K_point<T>::save(std::string const& name__, int id__) const
         /* create /K_point_set/ik */
         fout["K_point_set"].create_node(id__);
         fout["K_point_set"][id__].write("vk", &vk_[0], 3);
+        fout["K_point_set"][id__].write("num_gkvec", num_gkvec());
+        fout["K_point_set"][id__].write("num_bands", ctx_.num_bands());
+        fout["K_point_set"][id__].write("num_spins", ctx_.num_spins());
         fout["K_point_set"][id__].write("band_energies", band_energies_);
         fout["K_point_set"][id__].write("band_occupancies", band_occupancies_);
+        fout["K_point_set"][id__].write("gvec", this->gvec_array());
+    }
+    /* wait for rank 0 */
+    comm().barrier();
+
+    if (ctx_.full_potential()) {
+        return;
+    }
+
+    int gkvec_count  = gkvec().count();
+    int gkvec_offset = gkvec().offset();
+    std::vector<std::complex<double>> wf_loc(gkvec_count);
+    sddk::mdarray<std::complex<double>, 1> wf_tmp(num_gkvec());
 
-        /* save the entire G+k object */
-        //TODO: only the list of z-columns is probably needed to recreate the G+k vectors
-        //serializer s;
-        //gkvec().pack(s);
-        //fout["K_point_set"][id__].write("gkvec", s.stream());
-
-        /* save the order of G-vectors */
-        sddk::mdarray<int, 2> gv(3, num_gkvec());
-        for (int i = 0; i < num_gkvec(); i++) {
-            auto v = gkvec().template gvec<sddk::index_domain_t::global>(i);
-            for (int x : {0, 1, 2}) {
-                gv(x, i) = v[x];
+    std::unique_ptr<sddk::HDF5_tree> fout;
+    /* rank 0 opens a file */
+    if (comm().rank() == 0) {
+        fout = std::make_unique<sddk::HDF5_tree>(name__, sddk::hdf5_access_t::read_write);
+    }
+
+    /* store wave-functions */
+    for (int i = 0; i < ctx_.num_bands(); i++) {
+        for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
+            for (int ig = 0; ig < gkvec_count; ig++) {
+                wf_loc[ig] = spinor_wave_functions_->pw_coeffs(ig, wf::spin_index(ispn), wf::band_index(i));
             }
-        }
-        fout["K_point_set"][id__].write("gvec", gv);
-        fout["K_point_set"][id__].create_node("bands");
-        for (int i = 0; i < ctx_.num_bands(); i++) {
-            fout["K_point_set"][id__]["bands"].create_node(i);
-            fout["K_point_set"][id__]["bands"][i].create_node("spinor_wave_function");
-            for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
-                fout["K_point_set"][id__]["bands"][i]["spinor_wave_function"].create_node(ispn);
+            /* gather full column of PW coefficients on rank 0 */
+            comm().gather(wf_loc.data(), wf_tmp.at(sddk::memory_t::host), gkvec_offset, gkvec_count, 0);
+            if (comm().rank() == 0) {
+                (*fout)["K_point_set"].write_hyperslab("pw", reinterpret_cast<double*>(wf_tmp.at(sddk::memory_t::host)),
+                    {0, 0, i, ispn, id__}, {2, num_gkvec(), 1, 1, 1});
             }
         }
     }
-    /* wait for rank 0 */
     comm().barrier();
-    //int gkvec_count  = gkvec().count();
-    //int gkvec_offset = gkvec().offset();
-    //std::vector<std::complex<T>> wf_tmp(num_gkvec());
-
-    //std::unique_ptr<sddk::HDF5_tree> fout;
-    /* rank 0 opens a file */
-    //if (comm().rank() == 0) {
-    //    fout = std::make_unique<sddk::HDF5_tree>(name__, sddk::hdf5_access_t::read_write);
-    //}
+}
 
-    RTE_THROW("re-implement");
-
-    ///* store wave-functions */
-    //for (int i = 0; i < ctx_.num_bands(); i++) {
-    //    for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
-    //        /* gather full column of PW coefficients on rank 0 */
-    //        comm().gather(&spinor_wave_functions_->pw_coeffs(ispn).prime(0, i), wf_tmp.data(), gkvec_offset,
-    //                      gkvec_count, 0);
-    //        if (comm().rank() == 0) {
-    //            (*fout)["K_point_set"][id__]["bands"][i]["spinor_wave_function"][ispn].write("pw", wf_tmp);
-    //        }
-    //    }
-    //    comm().barrier();
-    //}
+template <typename T>
+sddk::mdarray<int, 2>
+K_point<T>::gvec_array() const
+{
+    sddk::mdarray<int, 2> gv(3, num_gkvec());
+    for (int i = 0; i < num_gkvec(); i++) {
+        auto v = gkvec().template gvec<sddk::index_domain_t::global>(i);
+        for (int x : {0, 1, 2}) {
+            gv(x, i) = v[x];
+        }
+    }
+    return gv;
 }
 
+/** Band energies, occupancies and plane-wave coefficients of the wave-functions are read from the node
+ *  /K_point_set/id and from the slice \em id of the /K_point_set/pw dataset of the HDF5 file. The saved G+k vectors are matched to the current G+k vectors by their
+ *  integer coordinates, so the saved k-point can have a different order and distribution of the G-vectors
+ *  (for example when the number of MPI ranks has changed). Coefficients of the G-vectors which are not present
+ *  in the saved set are set to zero. */
 template <typename T>
 void
 K_point<T>::load(sddk::HDF5_tree h5in, int id)
 {
-    STOP();
-    //== band_energies_.resize(ctx_.num_bands());
-    //== h5in[id].read("band_energies", band_energies_);
-
-    //== band_occupancies_.resize(ctx_.num_bands());
-    //== h5in[id].read("band_occupancies", band_occupancies_);
-    //==
-    //== h5in[id].read_mdarray("fv_eigen_vectors", fv_eigen_vectors_panel_);
-    //== h5in[id].read_mdarray("sv_eigen_vectors", sv_eigen_vectors_);
+    PROFILE("sirius::K_point::load");
+
+    if (ctx_.full_potential()) {
+        RTE_THROW("loading of the full-potential wave-functions is not implemented");
+    }
+
+    int num_bands_in{0};
+    h5in[id].read("num_bands", &num_bands_in, 1);
+    int num_spins_in{0};
+    h5in[id].read("num_spins", &num_spins_in, 1);
+    if (num_spins_in != ctx_.num_spins()) {
+        std::stringstream s;
+        s << "wrong number of spins in the saved k-point " << id << std::endl
+          << "  saved : " << num_spins_in << ", current : " << ctx_.num_spins();
+        RTE_THROW(s);
+    }
+    int num_gkvec_in{0};
+    h5in[id].read("num_gkvec", &num_gkvec_in, 1);
+
+    /* restore band energies and occupancies */
+    sddk::mdarray<double, 2> band_energies(num_bands_in, ctx_.num_spinors());
+    h5in[id].read("band_energies", band_energies);
+    sddk::mdarray<double, 2> band_occupancies(num_bands_in, ctx_.num_spinors());
+    h5in[id].read("band_occupancies", band_occupancies);
+
+    int num_bands = std::min(num_bands_in, ctx_.num_bands());
+    for (int ispn = 0; ispn < ctx_.num_spinors(); ispn++) {
+        for (int i = 0; i < num_bands; i++) {
+            band_energies_(i, ispn)    = band_energies(i, ispn);
+            band_occupancies_(i, ispn) = band_occupancies(i, ispn);
+        }
+    }
+
+    /* map the local G+k vectors to the saved order */
+    sddk::mdarray<int, 2> gv(3, num_gkvec_in);
+    h5in[id].read("gvec", gv);
+
+    int gkvec_count  = gkvec().count();
+    int gkvec_offset = gkvec().offset();
+    std::vector<int> idx_in(gkvec_count, -1);
+    for (int i = 0; i < num_gkvec_in; i++) {
+        int ig = gkvec().index_by_gvec(r3::vector<int>(gv(0, i), gv(1, i), gv(2, i)));
+        if (ig >= gkvec_offset && ig < gkvec_offset + gkvec_count) {
+            idx_in[ig - gkvec_offset] = i;
+        }
+    }
+
+    sddk::mdarray<std::complex<double>, 1> wf_tmp(num_gkvec_in);
+    for (int i = 0; i < num_bands; i++) {
+        for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
+            h5in.read_hyperslab("pw", reinterpret_cast<double*>(wf_tmp.at(sddk::memory_t::host)),
+                {0, 0, i, ispn, id}, {2, num_gkvec_in, 1, 1, 1});
+            for (int ig = 0; ig < gkvec_count; ig++) {
+                spinor_wave_functions_->pw_coeffs(ig, wf::spin_index(ispn), wf::band_index(i)) =
+                    (idx_in[ig] >= 0) ? static_cast<std::complex<T>>(wf_tmp[idx_in[ig]]) : std::complex<T>(0);
+            }
+        }
+    }
 }
 
 //== void K_point::save_wave_functions(int id)
@@ -71,6 +71,9 @@ class K_point
 
     std::unique_ptr<fft::spfft_transform_type<T>> spfft_transform_;
 
+    /// Independent copies of the coarse-grid FFT transform for the batched application of the local operator.
+    std::vector<fft::spfft_transform_type<T>> spfft_transform_batch_;
+
     /// First-variational eigen values
     sddk::mdarray<double, 1> fv_eigen_values_;
 
@@ -332,8 +335,12 @@ class K_point
     /// Save data to HDF5 file.
     void save(std::string const& name__, int id__) const;
 
+    /// Load data from HDF5 file.
     void load(sddk::HDF5_tree h5in, int id);
 
+    /// Return integer coordinates of all G+k vectors in the global order.
+    sddk::mdarray<int, 2> gvec_array() const;
+
     //== void save_wave_functions(int id);
 
     //== void load_wave_functions(int id);
@@ -736,6 +743,12 @@ class K_point
         return *spfft_transform_;
     }
 
+    /// Return the batch of FFT transforms (empty if the batched transformation is switched off).
+    auto& spfft_transform_batch()
+    {
+        return spfft_transform_batch_;
+    }
+
     inline auto const& gkvec_fft() const
     {
         return *gkvec_partition_;
@@ -18,10 +18,13 @@
 // OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <limits>
+#include <numeric>
+#include <exception>
 #include "dft/smearing.hpp"
 #include "k_point/k_point.hpp"
 #include "k_point/k_point_set.hpp"
 #include "symmetry/get_irreducible_reciprocal_mesh.hpp"
+#include "SDDK/omp.hpp"
 #include <iomanip>
 
 namespace sirius {
@@ -139,12 +142,20 @@ void K_point_set::initialize(std::vector<int> const& counts)
     PROFILE("sirius::K_point_set::initialize");
     /* distribute k-points along the 1-st dimension of the MPI grid */
     if (counts.empty()) {
-        sddk::splindex<sddk::splindex_t::block> spl_tmp(num_kpoints(), comm().size(), comm().rank());
-        spl_num_kpoints_ = sddk::splindex<sddk::splindex_t::chunk>(num_kpoints(), comm().size(), comm().rank(), spl_tmp.counts());
+        if (ctx_.cfg().control().kpoint_distribution() == "block") {
+            sddk::splindex<sddk::splindex_t::block> spl_tmp(num_kpoints(), comm().size(), comm().rank());
+            spl_num_kpoints_ = sddk::splindex<sddk::splindex_t::chunk>(num_kpoints(), comm().size(), comm().rank(),
+                                                                       spl_tmp.counts());
+        } else {
+            spl_num_kpoints_ = sddk::splindex<sddk::splindex_t::chunk>(num_kpoints(), comm().size(), comm().rank(),
+                                                                       partition(cost_estimate(), comm().size()));
+        }
     } else {
         spl_num_kpoints_ = sddk::splindex<sddk::splindex_t::chunk>(num_kpoints(), comm().size(), comm().rank(), counts);
     }
 
+    solve_time_ = std::vector<double>(num_kpoints(), 0);
+
     for (int ikloc = 0; ikloc < spl_num_kpoints_.local_size(); ikloc++) {
         kpoints_[spl_num_kpoints_[ikloc]]->initialize();
 #if defined(USE_FP32)
@@ -515,6 +526,233 @@ double K_point_set::entropy_sum() const
     }
 }
 
+std::vector<double> K_point_set::cost_estimate() const
+{
+    double nb = ctx_.num_bands();
+    double nfft = ctx_.fft_coarse_grid().num_points();
+    /* total number of beta-projectors */
+    double nbeta{0};
+    if (!ctx_.full_potential()) {
+        for (int ia = 0; ia < ctx_.unit_cell().num_atoms(); ia++) {
+            nbeta += ctx_.unit_cell().atom(ia).mt_basis_size();
+        }
+    }
+
+    std::vector<double> cost(num_kpoints());
+    for (int ik = 0; ik < num_kpoints(); ik++) {
+        double ngk = kpoints_[ik]->num_gkvec();
+        if (ctx_.full_potential()) {
+            /* diagonalization of the Hamiltonian in the full LAPW+lo basis */
+            cost[ik] = std::pow(ngk + ctx_.unit_cell().mt_lo_basis_size(), 3);
+        } else {
+            /* dense linear algebra of the iterative solver, application of the non-local operator and the
+             * FFTs of the local operator */
+            cost[ik] = nb * (ngk * (nb + nbeta) + nfft * std::log2(nfft));
+        }
+    }
+    return cost;
+}
+
+std::vector<int> K_point_set::partition(std::vector<double> const& cost__, int num_ranks__)
+{
+    int nk = static_cast<int>(cost__.size());
+    double total = std::accumulate(cost__.begin(), cost__.end(), 0.0);
+
+    std::vector<int> counts(num_ranks__, 0);
+    double acc{0};
+    int r{0};
+    for (int ik = 0; ik < nk; ik++) {
+        /* rank which covers the middle of this k-point's cost interval */
+        int r1 = (total > 0) ? static_cast<int>((acc + 0.5 * cost__[ik]) * num_ranks__ / total) : 0;
+        /* don't leave ranks without k-points; leave enough k-points for the remaining ranks */
+        r1 = std::min(std::max(r1, r), (counts[r] == 0) ? r : r + 1);
+        r1 = std::max(r1, num_ranks__ - (nk - ik));
+        r  = std::min(r1, num_ranks__ - 1);
+        counts[r]++;
+        acc += cost__[ik];
+    }
+    return counts;
+}
+
+template <typename T>
+void K_point_set::move_kpoints(std::vector<std::unique_ptr<K_point<T>>>& kpoints__,
+                               sddk::splindex<sddk::splindex_t::chunk> const& spl_new__)
+{
+    int nb = ctx_.num_bands();
+
+    for (int ik = 0; ik < num_kpoints(); ik++) {
+        int r_old = spl_num_kpoints_.local_rank(ik);
+        int r_new = spl_new__.local_rank(ik);
+        if (r_old == r_new) {
+            continue;
+        }
+        auto& kp = kpoints__[ik];
+        if (comm().rank() == r_new) {
+            kp->initialize();
+        }
+        if (comm().rank() == r_old || comm().rank() == r_new) {
+            /* G+k distribution inside the k-point communicator doesn't depend on the rank of the k-point, so the
+             * local coefficients are sent between the ranks with the same position in the band communicator */
+            int ngk = kp->gkvec().count();
+            int ns  = kp->spinor_wave_functions().num_sc().get();
+            sddk::mdarray<std::complex<T>, 3> buf(ngk, nb, ns);
+            /* band energies and occupancies are sent together with the wave-functions and are set on the new rank
+             * after the k-point is initialized */
+            sddk::mdarray<double, 3> band(nb, ctx_.num_spinors(), 2);
+            if (comm().rank() == r_old) {
+                for (int ispn = 0; ispn < ctx_.num_spinors(); ispn++) {
+                    for (int i = 0; i < nb; i++) {
+                        band(i, ispn, 0) = kp->band_energy(i, ispn);
+                        band(i, ispn, 1) = kp->band_occupancy(i, ispn);
+                    }
+                }
+                comm().send(band.at(sddk::memory_t::host), static_cast<int>(band.size()), r_new,
+                            num_kpoints() + ik);
+                for (int ispn = 0; ispn < ns; ispn++) {
+                    for (int i = 0; i < nb; i++) {
+                        std::copy(&kp->spinor_wave_functions().pw_coeffs(0, wf::spin_index(ispn), wf::band_index(i)),
+                                  &kp->spinor_wave_functions().pw_coeffs(0, wf::spin_index(ispn), wf::band_index(i)) + ngk,
+                                  &buf(0, i, ispn));
+                    }
+                }
+                comm().send(buf.at(sddk::memory_t::host), static_cast<int>(buf.size()), r_new, ik);
+                /* release the k-point data and keep only the G+k vectors, band energies and occupancies */
+                std::unique_ptr<K_point<T>> kp_new(new K_point<T>(ctx_, kp->gkvec_, kp->weight()));
+                for (int ispn = 0; ispn < ctx_.num_spinors(); ispn++) {
+                    for (int i = 0; i < nb; i++) {
+                        kp_new->band_energy(i, ispn, kp->band_energy(i, ispn));
+                        kp_new->band_occupancy(i, ispn, kp->band_occupancy(i, ispn));
+                    }
+                }
+                kp = std::move(kp_new);
+            } else {
+                comm().recv(band.at(sddk::memory_t::host), static_cast<int>(band.size()), r_old,
+                            num_kpoints() + ik);
+                comm().recv(buf.at(sddk::memory_t::host), static_cast<int>(buf.size()), r_old, ik);
+                for (int ispn = 0; ispn < ns; ispn++) {
+                    for (int i = 0; i < nb; i++) {
+                        std::copy(&buf(0, i, ispn), &buf(0, i, ispn) + ngk,
+                                  &kp->spinor_wave_functions().pw_coeffs(0, wf::spin_index(ispn), wf::band_index(i)));
+                    }
+                }
+                for (int ispn = 0; ispn < ctx_.num_spinors(); ispn++) {
+                    for (int i = 0; i < nb; i++) {
+                        kp->band_energy(i, ispn, band(i, ispn, 0));
+                        kp->band_occupancy(i, ispn, band(i, ispn, 1));
+                    }
+                }
+            }
+        }
+    }
+}
+
+bool K_point_set::rebalance()
+{
+    PROFILE("sirius::K_point_set::rebalance");
+
+    /* wave-functions can be moved only in the pseudopotential case */
+    if (ctx_.full_potential() || comm().size() == 1) {
+        return false;
+    }
+
+    std::vector<double> t(num_kpoints(), 0);
+    if (ctx_.comm_band().rank() == 0) {
+        for (int ikloc = 0; ikloc < spl_num_kpoints_.local_size(); ikloc++) {
+            int ik = spl_num_kpoints_[ikloc];
+            t[ik] = solve_time_[ik];
+        }
+    }
+    ctx_.comm().allreduce(t);
+    /* timings are not available for all k-points */
+    if (*std::min_element(t.begin(), t.end()) <= 0) {
+        return false;
+    }
+
+    auto load = [&](std::vector<int> const& counts) {
+        double tmax{0};
+        int ik{0};
+        for (int r = 0; r < comm().size(); r++) {
+            double tr{0};
+            for (int i = 0; i < counts[r]; i++) {
+                tr += t[ik++];
+            }
+            tmax = std::max(tmax, tr);
+        }
+        return tmax;
+    };
+    std::vector<int> counts_old(comm().size());
+    for (int r = 0; r < comm().size(); r++) {
+        counts_old[r] = spl_num_kpoints_.local_size(r);
+    }
+    auto counts_new = partition(t, comm().size());
+    double t_old = load(counts_old);
+    double t_new = load(counts_new);
+
+    /* redistribute only if the gain is noticeable */
+    if (t_new > 0.95 * t_old) {
+        return false;
+    }
+
+    sddk::splindex<sddk::splindex_t::chunk> spl_new(num_kpoints(), comm().size(), comm().rank(), counts_new);
+    move_kpoints(kpoints_, spl_new);
+#if defined(USE_FP32)
+    move_kpoints(kpoints_float_, spl_new);
+#endif
+    spl_num_kpoints_ = spl_new;
+
+    std::stringstream s;
+    s << "k-points are redistributed, estimated time of the band solver: " << t_old << " -> " << t_new << " sec.";
+    ctx_.message(1, __func__, s);
+
+    return true;
+}
+
+int K_point_set::num_kpoint_teams() const
+{
+    int n = std::min(ctx_.cfg().control().num_kpoint_teams(), spl_num_kpoints_.local_size());
+    n     = std::min(n, omp_get_max_threads());
+
+    if (n <= 1 || ctx_.full_potential() || ctx_.cfg().iterative_solver().type() == "exact" ||
+        ctx_.processing_unit() != sddk::device_t::CPU || ctx_.comm_band().size() != 1) {
+        return 1;
+    }
+    return n;
+}
+
+void K_point_set::for_each_local_kpoint(std::function<void(int, int)> f__) const
+{
+    int num_teams = num_kpoint_teams();
+
+    if (num_teams == 1) {
+        for (int ikloc = 0; ikloc < spl_num_kpoints_.local_size(); ikloc++) {
+            f__(ikloc, 0);
+        }
+        return;
+    }
+
+    ctx_.init_thread_teams(num_teams);
+
+    std::exception_ptr eptr;
+
+    sddk::run_in_thread_teams(num_teams, [&](int team) {
+        #pragma omp for schedule(dynamic, 1)
+        for (int ikloc = 0; ikloc < spl_num_kpoints_.local_size(); ikloc++) {
+            try {
+                f__(ikloc, team);
+            } catch (...) {
+                #pragma omp critical
+                if (!eptr) {
+                    eptr = std::current_exception();
+                }
+            }
+        }
+    });
+
+    if (eptr) {
+        std::rethrow_exception(eptr);
+    }
+}
+
 void K_point_set::print_info()
 {
     mpi::pstdout pout(this->comm());
@@ -547,6 +785,29 @@ void K_point_set::print_info()
 
 void K_point_set::save(std::string const& name__) const
 {
+    PROFILE("sirius::K_point_set::save");
+
+    /* dimensions of the datasets must be known by all ranks */
+    std::vector<int> num_gkvec(num_kpoints(), 0);
+    for (int ikloc = 0; ikloc < spl_num_kpoints_.local_size(); ikloc++) {
+        int ik = spl_num_kpoints_[ikloc];
+        num_gkvec[ik] = kpoints_[ik]->num_gkvec();
+    }
+    ctx_.comm().allreduce<int, mpi::op_t::max>(num_gkvec);
+
+    if (ctx_.cfg().control().hdf5_io() == "parallel") {
+        if (ctx_.cfg().parameters().precision_wf() == "fp32") {
+#if defined(USE_FP32)
+            this->save_parallel<float>(name__, num_gkvec);
+#else
+            RTE_THROW("not compiled with FP32 support");
+#endif
+        } else {
+            this->save_parallel<double>(name__, num_gkvec);
+        }
+        return;
+    }
+
     if (ctx_.comm().rank() == 0) {
         if (!utils::file_exists(name__)) {
             sddk::HDF5_tree(name__, sddk::hdf5_access_t::truncate);
@@ -554,52 +815,162 @@ void K_point_set::save(std::string const& name__) const
         sddk::HDF5_tree fout(name__, sddk::hdf5_access_t::read_write);
         fout.create_node("K_point_set");
         fout["K_point_set"].write("num_kpoints", num_kpoints());
+        if (!ctx_.full_potential()) {
+            int ngk_max = *std::max_element(num_gkvec.begin(), num_gkvec.end());
+            fout["K_point_set"].create_dataset<double>("pw",
+                {2, ngk_max, ctx_.num_bands(), ctx_.num_spins(), num_kpoints()});
+        }
     }
     ctx_.comm().barrier();
     for (int ik = 0; ik < num_kpoints(); ik++) {
         /* check if this ranks stores the k-point */
         if (ctx_.comm_k().rank() == spl_num_kpoints_.local_rank(ik)) {
-            this->get<double>(ik)->save(name__, ik);
+            if (ctx_.cfg().parameters().precision_wf() == "fp32") {
+#if defined(USE_FP32)
+                this->get<float>(ik)->save(name__, ik);
+#else
+                RTE_THROW("not compiled with FP32 support");
+#endif
+            } else {
+                this->get<double>(ik)->save(name__, ik);
+            }
         }
         /* wait for all */
         ctx_.comm().barrier();
     }
 }
 
-/// \todo check parameters of saved data in a separate function
-void K_point_set::load()
+template <typename T>
+void K_point_set::save_parallel(std::string const& name__, std::vector<int> const& num_gkvec__) const
 {
-    STOP();
-
-    //== HDF5_tree fin(storage_file_name, false);
-
-    //== int num_kpoints_in;
-    //== fin["K_point_set"].read("num_kpoints", &num_kpoints_in);
-
-    //== std::vector<int> ikidx(num_kpoints(), -1);
-    //== // read available k-points
-    //== double vk_in[3];
-    //== for (int jk = 0; jk < num_kpoints_in; jk++)
-    //== {
-    //==     fin["K_point_set"][jk].read("coordinates", vk_in, 3);
-    //==     for (int ik = 0; ik < num_kpoints(); ik++)
-    //==     {
-    //==         r3::vector<double> dvk;
-    //==         for (int x = 0; x < 3; x++) dvk[x] = vk_in[x] - kpoints_[ik]->vk(x);
-    //==         if (dvk.length() < 1e-12)
-    //==         {
-    //==             ikidx[ik] = jk;
-    //==             break;
-    //==         }
-    //==     }
-    //== }
-
-    //== for (int ik = 0; ik < num_kpoints(); ik++)
-    //== {
-    //==     int rank = spl_num_kpoints_.local_rank(ik);
-    //==
-    //==     if (comm_.rank() == rank) kpoints_[ik]->load(fin["K_point_set"], ikidx[ik]);
-    //== }
+    PROFILE("sirius::K_point_set::save_parallel");
+
+    int nb = ctx_.num_bands();
+    int ns = ctx_.num_spins();
+
+    sddk::HDF5_tree fout(name__, utils::file_exists(name__) ? sddk::hdf5_access_t::read_write :
+        sddk::hdf5_access_t::truncate, ctx_.comm());
+
+    /* all ranks create the same groups and datasets */
+    fout.create_node("K_point_set");
+    fout["K_point_set"].write("num_kpoints", num_kpoints());
+    if (!ctx_.full_potential()) {
+        int ngk_max = *std::max_element(num_gkvec__.begin(), num_gkvec__.end());
+        fout["K_point_set"].create_dataset<double>("pw", {2, ngk_max, nb, ns, num_kpoints()});
+    }
+    for (int ik = 0; ik < num_kpoints(); ik++) {
+        fout["K_point_set"].create_node(ik);
+        auto node = fout["K_point_set"][ik];
+        node.write("vk", &kpoints_[ik]->vk()[0], 3);
+        node.write("num_gkvec", num_gkvec__[ik]);
+        node.write("num_bands", nb);
+        node.write("num_spins", ns);
+        node.create_dataset<double>("band_energies", {nb, ctx_.num_spinors()});
+        node.create_dataset<double>("band_occupancies", {nb, ctx_.num_spinors()});
+        node.create_dataset<int>("gvec", {3, num_gkvec__[ik]});
+    }
+
+    /* data known only by the owners of k-points is written independently by the root rank of each k-point */
+    for (int ikloc = 0; ikloc < spl_num_kpoints_.local_size(); ikloc++) {
+        int ik  = spl_num_kpoints_[ikloc];
+        auto kp = this->get<T>(ik);
+        if (kp->comm().rank() == 0) {
+            sddk::mdarray<double, 2> e(nb, ctx_.num_spinors());
+            sddk::mdarray<double, 2> o(nb, ctx_.num_spinors());
+            for (int ispn = 0; ispn < ctx_.num_spinors(); ispn++) {
+                for (int j = 0; j < nb; j++) {
+                    e(j, ispn) = kp->band_energy(j, ispn);
+                    o(j, ispn) = kp->band_occupancy(j, ispn);
+                }
+            }
+            auto node = fout["K_point_set"][ik];
+            node.write_hyperslab("band_energies", e.at(sddk::memory_t::host), {0, 0}, {nb, ctx_.num_spinors()});
+            node.write_hyperslab("band_occupancies", o.at(sddk::memory_t::host), {0, 0}, {nb, ctx_.num_spinors()});
+            auto gv = kp->gvec_array();
+            node.write_hyperslab("gvec", gv.at(sddk::memory_t::host), {0, 0}, {3, kp->num_gkvec()});
+        }
+    }
+
+    if (ctx_.full_potential()) {
+        return;
+    }
+
+    /* collective write of the wave-functions; in each round every rank writes the local part of its next
+     * k-point, ranks without k-points take part with the empty selection */
+    int num_rounds = spl_num_kpoints_.local_size();
+    ctx_.comm().allreduce<int, mpi::op_t::max>(&num_rounds, 1);
+    for (int r = 0; r < num_rounds; r++) {
+        if (r < spl_num_kpoints_.local_size()) {
+            int ik  = spl_num_kpoints_[r];
+            auto kp = this->get<T>(ik);
+            int gkvec_count  = kp->gkvec().count();
+            int gkvec_offset = kp->gkvec().offset();
+            sddk::mdarray<std::complex<double>, 3> wf(gkvec_count, nb, ns);
+            for (int ispn = 0; ispn < ns; ispn++) {
+                for (int i = 0; i < nb; i++) {
+                    for (int ig = 0; ig < gkvec_count; ig++) {
+                        wf(ig, i, ispn) = kp->spinor_wave_functions().pw_coeffs(ig, wf::spin_index(ispn),
+                                                                                 wf::band_index(i));
+                    }
+                }
+            }
+            fout["K_point_set"].write_hyperslab("pw", reinterpret_cast<double*>(wf.at(sddk::memory_t::host)),
+                {0, gkvec_offset, 0, 0, ik}, {2, gkvec_count, nb, ns, 1}, true);
+        } else {
+            fout["K_point_set"].write_hyperslab<double>("pw", nullptr, {}, {}, true);
+        }
+    }
+}
+
+int K_point_set::load(std::string const& name__)
+{
+    PROFILE("sirius::K_point_set::load");
+
+    sddk::HDF5_tree fin(name__, sddk::hdf5_access_t::read_only);
+
+    int num_kpoints_in{0};
+    fin["K_point_set"].read("num_kpoints", &num_kpoints_in, 1);
+
+    /* index of the current k-points in the HDF5 file, which (in general) may contain a different set of k-points */
+    std::vector<int> ikidx(num_kpoints(), -1);
+    for (int jk = 0; jk < num_kpoints_in; jk++) {
+        r3::vector<double> vk_in;
+        fin["K_point_set"][jk].read("vk", &vk_in[0], 3);
+        for (int ik = 0; ik < num_kpoints(); ik++) {
+            if ((vk_in - kpoints_[ik]->vk()).length() < 1e-12) {
+                ikidx[ik] = jk;
+                break;
+            }
+        }
+    }
+
+    for (int ikloc = 0; ikloc < spl_num_kpoints_.local_size(); ikloc++) {
+        int ik = spl_num_kpoints_[ikloc];
+        if (ikidx[ik] < 0) {
+            continue;
+        }
+        if (ctx_.cfg().parameters().precision_wf() == "fp32") {
+#if defined(USE_FP32)
+            this->get<float>(ik)->load(fin["K_point_set"], ikidx[ik]);
+#else
+            RTE_THROW("not compiled with FP32 support");
+#endif
+        } else {
+            this->get<double>(ik)->load(fin["K_point_set"], ikidx[ik]);
+        }
+    }
+
+    if (ctx_.cfg().parameters().precision_wf() == "fp32") {
+#if defined(USE_FP32)
+        this->sync_band<float, sync_band_t::energy>();
+        this->sync_band<float, sync_band_t::occupancy>();
+#endif
+    } else {
+        this->sync_band<double, sync_band_t::energy>();
+        this->sync_band<double, sync_band_t::occupancy>();
+    }
+
+    return static_cast<int>(std::count_if(ikidx.begin(), ikidx.end(), [](int i) { return i >= 0; }));
 }
 
 //== void K_point_set::save_wave_functions()
@@ -25,6 +25,7 @@
 #ifndef __K_POINT_SET_HPP__
 #define __K_POINT_SET_HPP__
 
+#include <functional>
 #include "k_point.hpp"
 #include "dft/smearing.hpp"
 
@@ -68,6 +69,22 @@ class K_point_set
 
     bool initialized_{false};
 
+    /// Time spent by the band solver on each local k-point in the last SCF iteration.
+    std::vector<double> solve_time_;
+
+    /// Estimate the relative cost of the band diagonalization for each k-point.
+    std::vector<double> cost_estimate() const;
+
+    /// Split the list of k-points into contiguous chunks of approximately equal cost.
+    static std::vector<int> partition(std::vector<double> const& cost__, int num_ranks__);
+
+    /// Move k-points to the new owners according to the new distribution.
+    /** New owners initialize the k-points and receive the plane-wave coefficients of the wave-functions; old owners
+     *  release the k-point data. */
+    template <typename T>
+    void move_kpoints(std::vector<std::unique_ptr<K_point<T>>>& kpoints__,
+                      sddk::splindex<sddk::splindex_t::chunk> const& spl_new__);
+
     /// Return sum of valence eigen-values store in Kpoint<T>.
     template <typename T>
     double valence_eval_sum() const;
@@ -75,6 +92,12 @@ class K_point_set
     /// Return entropy contribution from smearing store in Kpoint<T>.
     template <typename T>
     double entropy_sum() const;
+
+    /// Save k-point set to HDF5 file opened with the parallel access by all ranks.
+    /** Groups and datasets are created collectively; the wave-functions of all k-points are written to the single
+     *  /K_point_set/pw dataset with the collective hyperslab writes. */
+    template <typename T>
+    void save_parallel(std::string const& name__, std::vector<int> const& num_gkvec__) const;
   public:
     /// Create empty k-point set.
     K_point_set(Simulation_context& ctx__)
@@ -119,10 +142,39 @@ class K_point_set
     /// Print basic info to the standard output.
     void print_info();
 
+    /// Store the time spent by the band solver on a local k-point.
+    inline void solve_time(int ik__, double t__)
+    {
+        solve_time_[ik__] = t__;
+    }
+
+    /// Redistribute k-points between MPI ranks using the measured time of the band solver.
+    /** Returns true if the k-points were moved. Redistribution happens only if the estimated time of the slowest
+     *  rank is reduced by more than 5%. Only the pseudopotential case is supported. */
+    bool rebalance();
+
+    /// Number of thread teams used to process the local k-points concurrently.
+    /** Concurrent processing is enabled by the control.num_kpoint_teams parameter and is used only for the
+     *  pseudopotential methods with an iterative solver on CPU when each k-point is handled by a single MPI rank.
+     *  The number of teams never exceeds the number of local k-points. */
+    int num_kpoint_teams() const;
+
+    /// Call f(ikloc, team) for each local k-point.
+    /** With a single team the k-points are processed one after another by the calling thread. Otherwise the
+     *  OpenMP threads are split into num_kpoint_teams() teams which take the local k-points dynamically; each team
+     *  runs its share of the threads in nested parallel regions and has its own memory pools and SPLA context
+     *  (see sddk::thread_team_id()). Timers of the teams other than the main one are discarded. */
+    void for_each_local_kpoint(std::function<void(int, int)> f__) const;
+
     /// Save k-point set to HDF5 file.
+    /** Depending on the control.hdf5_io parameter the k-points are written one after another by the root rank
+     *  of each k-point or concurrently by all ranks with the parallel HDF5 (see save_parallel()). */
     void save(std::string const& name__) const;
 
-    void load();
+    /// Load band energies, occupancies and wave-functions from HDF5 file.
+    /** K-points are matched to the saved ones by their coordinates. Returns the number of k-points found in the
+     *  file; k-points which are not found keep their current wave-functions. */
+    int load(std::string const& name__);
 
     /// Return sum of valence eigen-values.
     double valence_eval_sum() const;
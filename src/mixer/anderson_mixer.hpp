@@ -102,24 +102,25 @@ class Anderson : public Mixer<FUNCS...>
             }
         }
 
-        // Set up the next x_{n+1} = x_n.
-        // Can't use this->output_history_[idx_step + 1] directly here,
+        // Collect the terms of x_{n+1} = x_n + beta * f_n - ..., which is computed in a single pass at the end.
+        // Can't use this->output_history_[idx_step + 1] directly as output,
         // as it's still used when history is full.
-        this->copy(this->output_history_[idx_step], this->input_);
-
-        // + beta * f_n
-        this->axpy(this->beta_, this->residual_history_[idx_step], this->input_);
+        std::vector<double> coeffs{1.0, this->beta_};
+        std::vector<std::tuple<std::unique_ptr<FUNCS>...> const*> vecs{&this->output_history_[idx_step],
+                                                                     &this->residual_history_[idx_step]};
 
         if (history_size > 0) {
             // Compute the difference residual[step] - residual[step - 1]
             // and store it in residual[step - 1], but don't destroy
             // residual[step]
-            this->scale(-1.0, this->residual_history_[idx_prev_step]);
-            this->axpy(1.0, this->residual_history_[idx_step], this->residual_history_[idx_prev_step]);
+            this->linear_combination({1.0, -1.0},
+                                     {&this->residual_history_[idx_step], &this->residual_history_[idx_prev_step]},
+                                     this->residual_history_[idx_prev_step]);
 
             // Do the same for difference x
-            this->scale(-1.0, this->output_history_[idx_prev_step]);
-            this->axpy(1.0, this->output_history_[idx_step], this->output_history_[idx_prev_step]);
+            this->linear_combination({1.0, -1.0},
+                                     {&this->output_history_[idx_step], &this->output_history_[idx_prev_step]},
+                                     this->output_history_[idx_prev_step]);
 
             // Compute the new Gram matrix for the least-squares problem
             for (int i = 0; i <= history_size - 1; ++i) {
@@ -150,13 +151,15 @@ class Anderson : public Mixer<FUNCS...>
                 // - beta * (delta F) * h
                 for (int i = 1; i <= history_size; ++i) {
                     auto j = this->idx_hist(this->step_ - i);
-                    this->axpy(-this->beta_ * h(history_size - i), this->residual_history_[j], this->input_);
+                    coeffs.push_back(-this->beta_ * h(history_size - i));
+                    vecs.push_back(&this->residual_history_[j]);
                 }
 
                 // - (delta X) * h
                 for (int i = 1; i <= history_size; ++i) {
                     auto j = this->idx_hist(this->step_ - i);
-                    this->axpy(-h(history_size - i), this->output_history_[j], this->input_);
+                    coeffs.push_back(-h(history_size - i));
+                    vecs.push_back(&this->output_history_[j]);
                 }
             } else {
                 this->history_size_ = 0;
@@ -172,7 +175,10 @@ class Anderson : public Mixer<FUNCS...>
             }
         }
 
-        this->copy(this->input_, this->output_history_[idx_next_step]);
+        this->linear_combination(coeffs, vecs, this->input_);
+
+        // The input is set again before the next step, so the new output can be swapped in.
+        std::swap(this->input_, this->output_history_[idx_next_step]);
         this->history_size_ = std::min(this->history_size_ + 1, this->max_history_ - 1);
     }
 };
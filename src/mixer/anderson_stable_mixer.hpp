@@ -91,24 +91,25 @@ class Anderson_stable : public Mixer<FUNCS...>
 
         // TODO: beta scaling?
 
-        // Set up the next x_{n+1} = x_n.
-        // Can't use this->output_history_[idx_step + 1] directly here,
+        // Collect the terms of x_{n+1} = x_n + beta * f_n - ..., which is computed in a single pass at the end.
+        // Can't use this->output_history_[idx_step + 1] directly as output,
         // as it's still used when history is full.
-        this->copy(this->output_history_[idx_step], this->input_);
-
-        // + beta * f_n
-        this->axpy(this->beta_, this->residual_history_[idx_step], this->input_);
+        std::vector<double> coeffs{1.0, this->beta_};
+        std::vector<std::tuple<std::unique_ptr<FUNCS>...> const*> vecs{&this->output_history_[idx_step],
+                                                                     &this->residual_history_[idx_step]};
 
         if (history_size > 0) {
             // Compute the difference residual[step] - residual[step - 1]
             // and store it in residual[step - 1], but don't destroy
             // residual[step]
-            this->scale(-1.0, this->residual_history_[idx_step_prev]);
-            this->axpy(1.0, this->residual_history_[idx_step], this->residual_history_[idx_step_prev]);
+            this->linear_combination({1.0, -1.0},
+                                     {&this->residual_history_[idx_step], &this->residual_history_[idx_step_prev]},
+                                     this->residual_history_[idx_step_prev]);
 
             // Do the same for difference x
-            this->scale(-1.0, this->output_history_[idx_step_prev]);
-            this->axpy(1.0, this->output_history_[idx_step], this->output_history_[idx_step_prev]);
+            this->linear_combination({1.0, -1.0},
+                                     {&this->output_history_[idx_step], &this->output_history_[idx_step_prev]},
+                                     this->output_history_[idx_step_prev]);
 
             // orthogonalize residual_history_[step-1] w.r.t. residual_history_[1:step-2] using modified Gram-Schmidt.
             for (int i = 1; i <= history_size - 1; ++i) {
@@ -168,13 +169,15 @@ class Anderson_stable : public Mixer<FUNCS...>
                 // - beta * Q * h
                 for (int i = 1; i <= history_size; ++i) {
                     auto j = this->idx_hist(this->step_ - i);
-                    this->axpy(-this->beta_ * h(history_size - i), this->residual_history_[j], this->input_);
+                    coeffs.push_back(-this->beta_ * h(history_size - i));
+                    vecs.push_back(&this->residual_history_[j]);
                 }
 
                 // - (delta X) k
                 for (int i = 1; i <= history_size; ++i) {
                     auto j = this->idx_hist(this->step_ - i);
-                    this->axpy(-k(history_size - i), this->output_history_[j], this->input_);
+                    coeffs.push_back(-k(history_size - i));
+                    vecs.push_back(&this->output_history_[j]);
                 }
             } else {
                 // In the unlikely event of a breakdown when exactly
@@ -184,6 +187,9 @@ class Anderson_stable : public Mixer<FUNCS...>
             }
         }
 
+        // Compute x_{n+1} before the residual history is rotated below.
+        this->linear_combination(coeffs, vecs, this->input_);
+
         // When the history is full, drop the first column.
         // Basically we have delta F = [q1 Q2] * [r11 R12; O R22]
         // and we apply a couple rotations to make [R12; R22] upper triangular again
@@ -233,7 +239,8 @@ class Anderson_stable : public Mixer<FUNCS...>
             }
         }
 
-        this->copy(this->input_, this->output_history_[idx_next_step]);
+        // The input is set again before the next step, so the new output can be swapped in.
+        std::swap(this->input_, this->output_history_[idx_next_step]);
         this->history_size_ = std::min(this->history_size_ + 1, this->max_history_ - 1);
     }
 };
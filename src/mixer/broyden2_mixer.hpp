@@ -145,35 +145,47 @@ class Broyden2 : public Mixer<FUNCS...>
             this->gamma_(n - i) /= this->S_(n - i + 1, n - i + 1) - this->S_(n - i + 1, n - i) - this->S_(n - i, n - i + 1) + this->S_(n - i, n - i);
         }
 
-        this->copy(this->output_history_[idx_step], this->input_);
+        /* collect the terms of x_{n+1} and compute it in a single pass */
+        std::vector<double> coeffs{1.0};
+        std::vector<std::tuple<std::unique_ptr<FUNCS>...> const*> vecs{&this->output_history_[idx_step]};
 
         if (n > 0) {
             // first vec is special
             {
                 int j = this->idx_hist(this->step_ - n);
-                this->axpy(-this->beta_ * this->gamma_(0), this->residual_history_[j], this->input_);
-                this->axpy(-this->gamma_(0), this->output_history_[j], this->input_);
+                coeffs.push_back(-this->beta_ * this->gamma_(0));
+                vecs.push_back(&this->residual_history_[j]);
+                coeffs.push_back(-this->gamma_(0));
+                vecs.push_back(&this->output_history_[j]);
             }
 
             for (int i = 1; i < n; ++i) {
                 auto coeff = this->gamma_(n - i - 1) - this->gamma_(n - i);
                 int j = this->idx_hist(this->step_ - i);
-                this->axpy(this->beta_ * coeff, this->residual_history_[j], this->input_);
-                this->axpy(coeff, this->output_history_[j], this->input_);
+                coeffs.push_back(this->beta_ * coeff);
+                vecs.push_back(&this->residual_history_[j]);
+                coeffs.push_back(coeff);
+                vecs.push_back(&this->output_history_[j]);
             }
 
             // last vec is special.
             {
                 int j = this->idx_hist(this->step_);
-                this->axpy(this->beta_ * (this->gamma_(n - 1) + 1), this->residual_history_[j], this->input_);
-                this->axpy(this->gamma_(n - 1), this->output_history_[j], this->input_);
+                coeffs.push_back(this->beta_ * (this->gamma_(n - 1) + 1));
+                vecs.push_back(&this->residual_history_[j]);
+                coeffs.push_back(this->gamma_(n - 1));
+                vecs.push_back(&this->output_history_[j]);
             }
         } else {
             // Linear mixing step.
-            this->axpy(this->beta_, this->residual_history_[idx_step], this->input_);
+            coeffs.push_back(this->beta_);
+            vecs.push_back(&this->residual_history_[idx_step]);
         }
 
-        this->copy(this->input_, this->output_history_[idx_next_step]);
+        this->linear_combination(coeffs, vecs, this->input_);
+
+        /* the input is set again before the next step, so the new output can be swapped in */
+        std::swap(this->input_, this->output_history_[idx_next_step]);
 
         if (n == static_cast<int>(this->max_history_) - 1) {
             for (int col = 0; col < n; ++col) {
@@ -51,11 +51,12 @@ class Linear : public Mixer<FUNCS...>
 
     void mix_impl() override
     {
-        const auto idx = this->idx_hist(this->step_ + 1);
+        const auto idx_step      = this->idx_hist(this->step_);
+        const auto idx_next_step = this->idx_hist(this->step_ + 1);
 
-        this->copy(this->input_, this->output_history_[idx]);
-        this->scale(beta_, this->output_history_[idx]);
-        this->axpy(1.0 - beta_, this->output_history_[this->idx_hist(this->step_)], this->output_history_[idx]);
+        /* x_{n+1} = x_n + beta * f_n; the residual f_n is already preconditioned */
+        this->linear_combination({1.0, beta_}, {&this->output_history_[idx_step], &this->residual_history_[idx_step]},
+                                 this->output_history_[idx_next_step]);
     }
 
   private:
@@ -26,6 +26,7 @@
 #define __MIXER_HPP__
 
 #include <tuple>
+#include <algorithm>
 #include <functional>
 #include <utility>
 #include <vector>
@@ -55,20 +56,47 @@ struct FunctionProperties
      *  \param [in]  scal_         Function, which scales the input (x = alpha * x).
      *  \param [in]  copy_         Function, which copies from one object to the other (y = x).
      *  \param [in]  axpy_         Function, which scales and adds one object to the other (y = alpha * x + y).
+     *  \param [in]  rotate_       Function, which applies a Givens rotation to two objects.
+     *  \param [in]  precondition_ Function, which applies a preconditioner to the residual (x = P x).
+     *  \param [in]  linear_combination_ Function, which computes a linear combination of several objects in one
+     *                                   pass (y = sum_i c_i x_i). If not given, it is expressed through copy,
+     *                                   scal and axpy.
      */
     FunctionProperties(std::function<double(const FUNC&)> size_,
                        std::function<double(const FUNC&, const FUNC&)> inner_,
                        std::function<void(double, FUNC&)> scal_,
                        std::function<void(const FUNC&, FUNC&)> copy_,
                        std::function<void(double, const FUNC&, FUNC&)> axpy_,
-                       std::function<void(double, double, FUNC&, FUNC&)> rotate_)
+                       std::function<void(double, double, FUNC&, FUNC&)> rotate_,
+                       std::function<void(FUNC&)> precondition_ = [](FUNC&) -> void {},
+                       std::function<void(std::vector<double> const&, std::vector<FUNC const*> const&, FUNC&)>
+                           linear_combination_ = nullptr)
         : size(size_)
         , inner(inner_)
         , scal(scal_)
         , copy(copy_)
         , axpy(axpy_)
         , rotate(rotate_)
+        , precondition(precondition_)
+        , linear_combination(linear_combination_)
     {
+        if (!linear_combination) {
+            linear_combination = [scal_, copy_, axpy_](std::vector<double> const& c, std::vector<FUNC const*> const& x,
+                                                       FUNC& y) -> void {
+                /* y can be one of x; it has to be scaled first */
+                auto it = std::find(x.begin(), x.end(), &y);
+                std::size_t k0 = (it == x.end()) ? 0 : static_cast<std::size_t>(it - x.begin());
+                if (it == x.end()) {
+                    copy_(*x[k0], y);
+                }
+                scal_(c[k0], y);
+                for (std::size_t k = 0; k < x.size(); ++k) {
+                    if (k != k0) {
+                        axpy_(c[k], *x[k], y);
+                    }
+                }
+            };
+        }
     }
 
     FunctionProperties()
@@ -78,6 +106,8 @@ struct FunctionProperties
         , copy([](const FUNC&, FUNC&) -> void {})
         , axpy([](double, const FUNC&, FUNC&) -> void {})
         , rotate([](double, double, FUNC&, FUNC&) -> void {})
+        , precondition([](FUNC&) -> void {})
+        , linear_combination([](std::vector<double> const&, std::vector<FUNC const*> const&, FUNC&) -> void {})
     {
     }
 
@@ -98,6 +128,12 @@ struct FunctionProperties
 
     // rotate function [x y] * [c -s; s c]
     std::function<void(double, double, FUNC&, FUNC&)> rotate;
+
+    // preconditioner of the residual. x = P * x
+    std::function<void(FUNC&)> precondition;
+
+    // linear combination y = sum_i c_i * x_i; y is allowed to be one of x_i
+    std::function<void(std::vector<double> const&, std::vector<FUNC const*> const&, FUNC&)> linear_combination;
 };
 
 // Implementation of templated recursive calls through tuples
@@ -266,6 +302,73 @@ struct Rotate<0, FUNCS...>
     }
 };
 
+template <std::size_t FUNC_REVERSE_INDEX, typename... FUNCS>
+struct Precondition
+{
+    static void apply(const std::tuple<FunctionProperties<FUNCS>...>& function_prop,
+                      std::tuple<std::unique_ptr<FUNCS>...>& x)
+    {
+        if (std::get<FUNC_REVERSE_INDEX>(x)) {
+            std::get<FUNC_REVERSE_INDEX>(function_prop).precondition(*std::get<FUNC_REVERSE_INDEX>(x));
+        }
+        Precondition<FUNC_REVERSE_INDEX - 1, FUNCS...>::apply(function_prop, x);
+    }
+};
+
+template <typename... FUNCS>
+struct Precondition<0, FUNCS...>
+{
+    static void apply(const std::tuple<FunctionProperties<FUNCS>...>& function_prop,
+                      std::tuple<std::unique_ptr<FUNCS>...>& x)
+    {
+        if (std::get<0>(x)) {
+            std::get<0>(function_prop).precondition(*std::get<0>(x));
+        }
+    }
+};
+
+template <std::size_t FUNC_REVERSE_INDEX, typename... FUNCS>
+struct LinearCombination
+{
+    static void apply(const std::tuple<FunctionProperties<FUNCS>...>& function_prop, std::vector<double> const& c,
+                      std::vector<std::tuple<std::unique_ptr<FUNCS>...> const*> const& x,
+                      std::tuple<std::unique_ptr<FUNCS>...>& y)
+    {
+        using FUNC = typename std::tuple_element<FUNC_REVERSE_INDEX, std::tuple<FUNCS...>>::type;
+        if (std::get<FUNC_REVERSE_INDEX>(y)) {
+            std::vector<FUNC const*> xp(x.size());
+            for (std::size_t k = 0; k < x.size(); ++k) {
+                xp[k] = std::get<FUNC_REVERSE_INDEX>(*x[k]).get();
+            }
+            if (std::find(xp.begin(), xp.end(), nullptr) == xp.end()) {
+                std::get<FUNC_REVERSE_INDEX>(function_prop)
+                    .linear_combination(c, xp, *std::get<FUNC_REVERSE_INDEX>(y));
+            }
+        }
+        LinearCombination<FUNC_REVERSE_INDEX - 1, FUNCS...>::apply(function_prop, c, x, y);
+    }
+};
+
+template <typename... FUNCS>
+struct LinearCombination<0, FUNCS...>
+{
+    static void apply(const std::tuple<FunctionProperties<FUNCS>...>& function_prop, std::vector<double> const& c,
+                      std::vector<std::tuple<std::unique_ptr<FUNCS>...> const*> const& x,
+                      std::tuple<std::unique_ptr<FUNCS>...>& y)
+    {
+        using FUNC = typename std::tuple_element<0, std::tuple<FUNCS...>>::type;
+        if (std::get<0>(y)) {
+            std::vector<FUNC const*> xp(x.size());
+            for (std::size_t k = 0; k < x.size(); ++k) {
+                xp[k] = std::get<0>(*x[k]).get();
+            }
+            if (std::find(xp.begin(), xp.end(), nullptr) == xp.end()) {
+                std::get<0>(function_prop).linear_combination(c, xp, *std::get<0>(y));
+            }
+        }
+    }
+};
+
 } // namespace mixer_impl
 
 /// Abstract mixer for variadic number of Function objects, which are described by FunctionProperties.
@@ -370,6 +473,10 @@ class Mixer
             return rmse;
         }
 
+        /* the RMS is computed from the bare residual; the mixers see the preconditioned one, which turns the
+         * fixed-point problem x = F(x) into x = x + P(F(x) - x) */
+        this->precondition(residual_history_[idx_hist(step_)]);
+
         /* call mixing implementation */
         this->mix_impl();
 
@@ -432,6 +539,31 @@ class Mixer
         mixer_impl::Rotate<sizeof...(FUNCS) - 1, FUNCS...>::apply(functions_, c, s, x, y);
     }
 
+    void precondition(std::tuple<std::unique_ptr<FUNCS>...>& x)
+    {
+        mixer_impl::Precondition<sizeof...(FUNCS) - 1, FUNCS...>::apply(functions_, x);
+    }
+
+    // y = sum_i c_i * x_i; every output is written in a single pass
+    void linear_combination(std::vector<double> const& c,
+                            std::vector<std::tuple<std::unique_ptr<FUNCS>...> const*> const& x,
+                            std::tuple<std::unique_ptr<FUNCS>...>& y)
+    {
+        /* merge repeated vectors to save a pass over them */
+        std::vector<double> c1;
+        std::vector<std::tuple<std::unique_ptr<FUNCS>...> const*> x1;
+        for (std::size_t k = 0; k < x.size(); ++k) {
+            auto it = std::find(x1.begin(), x1.end(), x[k]);
+            if (it == x1.end()) {
+                c1.push_back(c[k]);
+                x1.push_back(x[k]);
+            } else {
+                c1[it - x1.begin()] += c[k];
+            }
+        }
+        mixer_impl::LinearCombination<sizeof...(FUNCS) - 1, FUNCS...>::apply(functions_, c1, x1, y);
+    }
+
     // Strictly increasing counter, indicating the number of mixing steps
     std::size_t step_;
 
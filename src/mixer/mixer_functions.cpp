@@ -30,6 +30,63 @@ namespace sirius {
 
 namespace mixer {
 
+/// Compute y = sum_k c_k x_k for plain arrays of length n__.
+/** The output is written in one pass, block by block. The partial sums of a block are kept in a small buffer, which
+ *  stays in the L1 cache, so the inner loops vectorize and y__ is allowed to coincide with one of the x__ arrays. */
+template <typename T>
+static void
+linear_combination_array(std::size_t n__, std::vector<double> const& c__, std::vector<T const*> const& x__, T* y__)
+{
+    if (x__.empty()) {
+        return;
+    }
+    const std::size_t block_size = 512;
+    const std::size_t num_blocks = (n__ + block_size - 1) / block_size;
+
+    #pragma omp parallel
+    {
+        std::vector<T> tmp(block_size);
+        #pragma omp for schedule(static)
+        for (std::size_t ib = 0; ib < num_blocks; ib++) {
+            std::size_t i0 = ib * block_size;
+            std::size_t m  = std::min(block_size, n__ - i0);
+            auto c = c__[0];
+            auto x = x__[0] + i0;
+            for (std::size_t i = 0; i < m; i++) {
+                tmp[i] = c * x[i];
+            }
+            for (std::size_t k = 1; k < x__.size(); k++) {
+                c = c__[k];
+                x = x__[k] + i0;
+                for (std::size_t i = 0; i < m; i++) {
+                    tmp[i] += c * x[i];
+                }
+            }
+            std::copy(tmp.begin(), tmp.begin() + m, y__ + i0);
+        }
+    }
+}
+
+/// Linear combination of the regular-grid parts of periodic functions.
+/** Both the real-space values and the local plane-wave coefficients are combined, as in copy(), scale() and axpy()
+ *  of the smooth periodic functions; the plane-wave coefficients are used by the Hartree inner product. */
+static void
+linear_combination_rg(std::vector<double> const& c__, std::vector<Periodic_function<double> const*> const& x__,
+                      Periodic_function<double>& y__)
+{
+    std::vector<double const*> xp(x__.size());
+    for (std::size_t k = 0; k < x__.size(); k++) {
+        xp[k] = x__[k]->rg().values().at(sddk::memory_t::host);
+    }
+    linear_combination_array(y__.rg().values().size(), c__, xp, y__.rg().values().at(sddk::memory_t::host));
+
+    std::vector<std::complex<double> const*> zp(x__.size());
+    for (std::size_t k = 0; k < x__.size(); k++) {
+        zp[k] = x__[k]->rg().f_pw_local().at(sddk::memory_t::host);
+    }
+    linear_combination_array(y__.rg().f_pw_local().size(), c__, zp, y__.rg().f_pw_local().at(sddk::memory_t::host));
+}
+
 FunctionProperties<Periodic_function<double>> periodic_function_property()
 {
     auto global_size_func = [](const Periodic_function<double>& x) -> double
@@ -89,8 +146,24 @@ FunctionProperties<Periodic_function<double>> periodic_function_property()
         }
     };
 
+    auto linear_combination_function = [](std::vector<double> const& c, std::vector<Periodic_function<double> const*> const& x,
+                                          Periodic_function<double>& y) -> void {
+        linear_combination_rg(c, x, y);
+        if (y.ctx().full_potential()) {
+            std::vector<double const*> xp(x.size());
+            for (int ialoc = 0; ialoc < y.ctx().unit_cell().spl_num_atoms().local_size(); ialoc++) {
+                int ia = y.ctx().unit_cell().spl_num_atoms(ialoc);
+                for (std::size_t k = 0; k < x.size(); k++) {
+                    xp[k] = x[k]->mt()[ia].at(sddk::memory_t::host);
+                }
+                linear_combination_array(y.mt()[ia].size(), c, xp, y.mt()[ia].at(sddk::memory_t::host));
+            }
+        }
+    };
+
     return FunctionProperties<Periodic_function<double>>(global_size_func, inner_prod_func, scal_function, copy_function,
-                                                         axpy_function, rotate_function);
+                                                         axpy_function, rotate_function, [](Periodic_function<double>&) {},
+                                                         linear_combination_function);
 }
 
 /// Only for the PP-PW case.
@@ -153,7 +226,8 @@ FunctionProperties<Periodic_function<double>> periodic_function_property_modifie
     };
 
     return FunctionProperties<Periodic_function<double>>(global_size_func, inner_prod_func, scal_function, copy_function,
-                                                         axpy_function, rotate_function);
+                                                         axpy_function, rotate_function, [](Periodic_function<double>&) {},
+                                                         linear_combination_rg);
 }
 
 FunctionProperties<sddk::mdarray<std::complex<double>, 4>> density_function_property()
@@ -199,8 +273,21 @@ FunctionProperties<sddk::mdarray<std::complex<double>, 4>> density_function_prop
         }
     };
 
+    auto linear_combination_function = [](std::vector<double> const& c,
+                                          std::vector<sddk::mdarray<std::complex<double>, 4> const*> const& x,
+                                          sddk::mdarray<std::complex<double>, 4>& y) -> void {
+        std::vector<std::complex<double> const*> xp(x.size());
+        for (std::size_t k = 0; k < x.size(); k++) {
+            assert(x[k]->size() == y.size());
+            xp[k] = x[k]->at(sddk::memory_t::host);
+        }
+        linear_combination_array(y.size(), c, xp, y.at(sddk::memory_t::host));
+    };
+
     return FunctionProperties<sddk::mdarray<std::complex<double>, 4>>(global_size_func, inner_prod_func, scal_function,
-                                                                copy_function, axpy_function, rotate_function);
+                                                                copy_function, axpy_function, rotate_function,
+                                                                [](sddk::mdarray<std::complex<double>, 4>&) {},
+                                                                linear_combination_function);
 }
 
 FunctionProperties<PAW_density<double>> paw_density_function_property()
@@ -267,8 +354,31 @@ FunctionProperties<PAW_density<double>> paw_density_function_property()
         }
     };
 
+    auto linear_combination_function = [](std::vector<double> const& c, std::vector<PAW_density<double> const*> const& x,
+                                          PAW_density<double>& y) -> void
+    {
+        std::vector<double const*> xp(x.size());
+        for (int i = 0; i < y.unit_cell().spl_num_paw_atoms().local_size(); i++) {
+            int ipaw = y.unit_cell().spl_num_paw_atoms(i);
+            int ia = y.unit_cell().paw_atom_index(ipaw);
+            for (int j = 0; j < y.unit_cell().parameters().num_mag_dims() + 1; j++) {
+                for (std::size_t k = 0; k < x.size(); k++) {
+                    xp[k] = x[k]->ae_density(j, ia).at(sddk::memory_t::host);
+                }
+                linear_combination_array(y.ae_density(j, ia).size(), c, xp,
+                                         y.ae_density(j, ia).at(sddk::memory_t::host));
+                for (std::size_t k = 0; k < x.size(); k++) {
+                    xp[k] = x[k]->ps_density(j, ia).at(sddk::memory_t::host);
+                }
+                linear_combination_array(y.ps_density(j, ia).size(), c, xp,
+                                         y.ps_density(j, ia).at(sddk::memory_t::host));
+            }
+        }
+    };
+
     return FunctionProperties<PAW_density<double>>(global_size_func, inner_prod_func, scale_func, copy_function,
-                                           axpy_function, rotate_function);
+                                           axpy_function, rotate_function, [](PAW_density<double>&) {},
+                                           linear_combination_function);
 }
 
 FunctionProperties<Hubbard_matrix> hubbard_matrix_function_property()
@@ -345,9 +455,153 @@ FunctionProperties<Hubbard_matrix> hubbard_matrix_function_property()
         }
     };
 
+    auto linear_combination_func = [](std::vector<double> const& c, std::vector<Hubbard_matrix const*> const& x,
+                                      Hubbard_matrix& y) -> void
+    {
+        std::vector<std::complex<double> const*> xp(x.size());
+        for (size_t at_lvl = 0; at_lvl < y.local().size(); at_lvl++) {
+            for (std::size_t k = 0; k < x.size(); k++) {
+                xp[k] = x[k]->local(at_lvl).at(sddk::memory_t::host);
+            }
+            linear_combination_array(y.local(at_lvl).size(), c, xp, y.local(at_lvl).at(sddk::memory_t::host));
+        }
+        for (size_t at_lvl = 0; at_lvl < y.nonlocal().size(); at_lvl++) {
+            for (std::size_t k = 0; k < x.size(); k++) {
+                xp[k] = x[k]->nonlocal(at_lvl).at(sddk::memory_t::host);
+            }
+            linear_combination_array(y.nonlocal(at_lvl).size(), c, xp, y.nonlocal(at_lvl).at(sddk::memory_t::host));
+        }
+    };
+
     return FunctionProperties<Hubbard_matrix>(global_size_func, inner_prod_func, scale_func, copy_func, axpy_func,
-                                              rotate_func);
+                                              rotate_func, [](Hubbard_matrix&) {}, linear_combination_func);
 }
+
+FunctionProperties<Gvec_function> gvec_function_property(config_t::mixer_t const& mixer_cfg__, bool charge__)
+{
+    bool use_hartree = charge__ && mixer_cfg__.use_hartree();
+
+    auto global_size_func = [use_hartree](Gvec_function const& x) -> double
+    {
+        double omega = x.gvec().gvec().omega();
+        return use_hartree ? 1.0 / omega : omega;
+    };
+
+    auto inner_prod_func = [use_hartree](Gvec_function const& x, Gvec_function const& y) -> double
+    {
+        auto& gv = x.gvec();
+        double result{0};
+        for (int j = 0; j < x.num_components(); j++) {
+            #pragma omp parallel for schedule(static) reduction(+:result)
+            for (int i = 0; i < gv.count(); i++) {
+                double w = gv.weight(i);
+                if (use_hartree) {
+                    w = gv.is_g0(i) ? 0 : w / std::pow(gv.glen(i), 2);
+                }
+                result += w * std::real(std::conj(x.value(i, j)) * y.value(i, j));
+            }
+        }
+        result *= use_hartree ? fourpi : gv.gvec().omega();
+        gv.gvec().comm().allreduce(&result, 1);
+        return result;
+    };
+
+    auto scal_function = [](double alpha, Gvec_function& x) -> void
+    {
+        for (int j = 0; j < x.num_components(); j++) {
+            #pragma omp parallel for schedule(static)
+            for (int i = 0; i < x.gvec().count(); i++) {
+                x.value(i, j, alpha * x.value(i, j));
+            }
+        }
+    };
+
+    auto copy_function = [](Gvec_function const& x, Gvec_function& y) -> void
+    {
+        for (int j = 0; j < x.num_components(); j++) {
+            #pragma omp parallel for schedule(static)
+            for (int i = 0; i < x.gvec().count(); i++) {
+                y.value(i, j, x.value(i, j));
+            }
+        }
+    };
+
+    auto axpy_function = [](double alpha, Gvec_function const& x, Gvec_function& y) -> void
+    {
+        for (int j = 0; j < x.num_components(); j++) {
+            #pragma omp parallel for schedule(static)
+            for (int i = 0; i < x.gvec().count(); i++) {
+                y.value(i, j, alpha * x.value(i, j) + y.value(i, j));
+            }
+        }
+    };
+
+    auto rotate_function = [](double c, double s, Gvec_function& x, Gvec_function& y) -> void
+    {
+        for (int j = 0; j < x.num_components(); j++) {
+            #pragma omp parallel for schedule(static)
+            for (int i = 0; i < x.gvec().count(); i++) {
+                auto xi = x.value(i, j);
+                auto yi = y.value(i, j);
+                x.value(i, j, xi * c + yi * s);
+                y.value(i, j, xi * -s + yi * c);
+            }
+        }
+    };
+
+    /* preconditioner of the charge density residual */
+    std::function<void(Gvec_function&)> precond_function = [](Gvec_function&) -> void {};
+
+    if (charge__ && mixer_cfg__.preconditioner() != "none") {
+        auto type = mixer_cfg__.preconditioner();
+        auto q2   = std::pow(mixer_cfg__.q0(), 2);
+        auto eps0 = mixer_cfg__.resta_eps0();
+        auto rs   = mixer_cfg__.resta_rs();
+
+        precond_function = [type, q2, eps0, rs](Gvec_function& x) -> void
+        {
+            auto& gv = x.gvec();
+            #pragma omp parallel for schedule(static)
+            for (int i = 0; i < gv.count(); i++) {
+                double g  = gv.glen(i);
+                double g2 = g * g;
+                double p{1};
+                if (type == "kerker") {
+                    /* Kerker: P(G) = G^2 / (G^2 + q0^2) */
+                    p = g2 / (g2 + q2);
+                } else {
+                    /* Resta: P(G) = (q0^2 sin(G rs) / (eps0 G rs) + G^2) / (q0^2 + G^2) */
+                    double grs = g * rs;
+                    double sinc = (grs < 1e-8) ? 1.0 : std::sin(grs) / grs;
+                    p = (q2 * sinc / eps0 + g2) / (q2 + g2);
+                }
+                for (int j = 0; j < x.num_components(); j++) {
+                    x.value(i, j, p * x.value(i, j));
+                }
+            }
+        };
+    }
+
+    auto linear_combination_function = [](std::vector<double> const& c, std::vector<Gvec_function const*> const& x,
+                                          Gvec_function& y) -> void
+    {
+        for (int j = 0; j < y.num_components(); j++) {
+            #pragma omp parallel for schedule(static)
+            for (int i = 0; i < y.gvec().count(); i++) {
+                std::complex<double> z{0};
+                for (std::size_t k = 0; k < x.size(); k++) {
+                    z += c[k] * x[k]->value(i, j);
+                }
+                y.value(i, j, z);
+            }
+        }
+    };
+
+    return FunctionProperties<Gvec_function>(global_size_func, inner_prod_func, scal_function, copy_function,
+                                             axpy_function, rotate_function, precond_function,
+                                             linear_combination_function);
+}
+
 } // namespace mixer
 
 } // namespace sirius
@@ -30,6 +30,7 @@
 #include "SDDK/memory.hpp"
 #include "mixer/mixer.hpp"
 #include "hubbard/hubbard_matrix.hpp"
+#include "mixer/mixer_gvec.hpp"
 
 namespace sirius {
 
@@ -45,6 +46,11 @@ FunctionProperties<PAW_density<double>> paw_density_function_property();
 
 FunctionProperties<Hubbard_matrix> hubbard_matrix_function_property();
 
+/// Properties of the plane-wave coefficients in the G-space mixing mode.
+/** For the charge density the Hartree metric (if use_hartree is set) and the Kerker or Resta preconditioner of the
+ *  residual are applied; the magnetization is mixed with the plain metric and without preconditioner. */
+FunctionProperties<Gvec_function> gvec_function_property(config_t::mixer_t const& mixer_cfg__, bool charge__);
+
 } // namespace mixer
 
 } // namespace sirius
@@ -0,0 +1,197 @@
+// Copyright (c) 2013-2023 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file mixer_gvec.hpp
+ *
+ *  \brief Plane-wave coefficients of the density and magnetization used in the G-space mixing mode.
+ */
+
+#ifndef __MIXER_GVEC_HPP__
+#define __MIXER_GVEC_HPP__
+
+#include <memory>
+#include <vector>
+#include "SDDK/memory.hpp"
+#include "fft/gvec.hpp"
+
+namespace sirius {
+
+namespace mixer {
+
+/// Local G-vectors which are mixed in the G-space mixing mode.
+/** Only the G-vectors with \f$ |{\bf G}| \le G_{max} \f$ are mixed. The list is shared by all history vectors of
+ *  the mixer. */
+class Mixer_gvec
+{
+  private:
+    /// Dense G-vectors.
+    fft::Gvec const& gvec_;
+
+    /// Local indices of the mixed G-vectors in the list of dense G-vectors.
+    std::vector<int> igloc_;
+
+    /// Lengths of the mixed G-vectors.
+    std::vector<double> glen_;
+
+    /// Weights of the G-vectors in the inner product (2 for G != 0 in case of the reduced G-vector set).
+    std::vector<double> weight_;
+
+  public:
+    Mixer_gvec(fft::Gvec const& gvec__, double gmax__)
+        : gvec_{gvec__}
+    {
+        for (int igloc = 0; igloc < gvec_.count(); igloc++) {
+            double g = gvec_.gvec_len<sddk::index_domain_t::local>(igloc);
+            if (g <= gmax__ + 1e-12) {
+                igloc_.push_back(igloc);
+                glen_.push_back(g);
+                bool is_g0 = (igloc == 0 && gvec_.skip_g0());
+                weight_.push_back((gvec_.reduced() && !is_g0) ? 2.0 : 1.0);
+            }
+        }
+    }
+
+    /// Number of local G-vectors which are mixed.
+    inline int count() const
+    {
+        return static_cast<int>(igloc_.size());
+    }
+
+    /// Local index of the mixed G-vector in the list of dense G-vectors.
+    inline int igloc(int i__) const
+    {
+        return igloc_[i__];
+    }
+
+    /// Length of the mixed G-vector.
+    inline double glen(int i__) const
+    {
+        return glen_[i__];
+    }
+
+    /// Weight of the mixed G-vector in the inner product.
+    inline double weight(int i__) const
+    {
+        return weight_[i__];
+    }
+
+    /// True if the i-th mixed G-vector is G=0.
+    inline bool is_g0(int i__) const
+    {
+        return igloc_[i__] == 0 && gvec_.skip_g0();
+    }
+
+    inline auto const& gvec() const
+    {
+        return gvec_;
+    }
+};
+
+/// Plane-wave coefficients of one or several smooth periodic functions below the mixing cutoff.
+/** This is the function type of the G-space mixing mode. Compared to the full Periodic_function, which is stored on
+ *  the real-space grid, it holds only the coefficients of the mixed G-vectors. The coefficients can be stored in
+ *  single precision to reduce the memory of the mixer history further; the arithmetic is done in double precision.
+ *  Note that in this case the mixed density is also rounded to single precision, which limits the attainable
+ *  accuracy of the density to about \f$ 10^{-7} \f$ relative. */
+class Gvec_function
+{
+  private:
+    /// List of mixed G-vectors.
+    std::shared_ptr<Mixer_gvec const> gv_;
+
+    /// Number of components.
+    int num_components_;
+
+    /// True if the coefficients are stored in single precision.
+    bool fp32_;
+
+    /// Coefficients in double precision.
+    sddk::mdarray<std::complex<double>, 2> f64_;
+
+    /// Coefficients in single precision.
+    sddk::mdarray<std::complex<float>, 2> f32_;
+
+  public:
+    Gvec_function(std::shared_ptr<Mixer_gvec const> gv__, int num_components__, bool fp32__)
+        : gv_{gv__}
+        , num_components_{num_components__}
+        , fp32_{fp32__}
+    {
+        if (fp32_) {
+            f32_ = sddk::mdarray<std::complex<float>, 2>(gv_->count(), num_components_, sddk::memory_t::host,
+                                                         "Gvec_function.f32_");
+            f32_.zero();
+        } else {
+            f64_ = sddk::mdarray<std::complex<double>, 2>(gv_->count(), num_components_, sddk::memory_t::host,
+                                                          "Gvec_function.f64_");
+            f64_.zero();
+        }
+    }
+
+    inline auto const& gvec() const
+    {
+        return *gv_;
+    }
+
+    inline int num_components() const
+    {
+        return num_components_;
+    }
+
+    /// Get the coefficient of the i-th mixed G-vector.
+    inline std::complex<double> value(int i__, int j__) const
+    {
+        return fp32_ ? std::complex<double>(f32_(i__, j__)) : f64_(i__, j__);
+    }
+
+    /// Set the coefficient of the i-th mixed G-vector.
+    inline void value(int i__, int j__, std::complex<double> z__)
+    {
+        if (fp32_) {
+            f32_(i__, j__) = std::complex<float>(z__);
+        } else {
+            f64_(i__, j__) = z__;
+        }
+    }
+
+    /// Pick the coefficients of the mixed G-vectors from the local plane-wave coefficients of a function.
+    inline void pack(int j__, sddk::mdarray<std::complex<double>, 1> const& f_pw__)
+    {
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < gv_->count(); i++) {
+            this->value(i, j__, f_pw__[gv_->igloc(i)]);
+        }
+    }
+
+    /// Put the coefficients of the mixed G-vectors back to the local plane-wave coefficients of a function.
+    /** The coefficients of the G-vectors above the mixing cutoff are not changed. */
+    inline void unpack(int j__, sddk::mdarray<std::complex<double>, 1>& f_pw__) const
+    {
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < gv_->count(); i++) {
+            f_pw__[gv_->igloc(i)] = this->value(i, j__);
+        }
+    }
+};
+
+} // namespace mixer
+
+} // namespace sirius
+
+#endif
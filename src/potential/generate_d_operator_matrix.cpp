@@ -43,6 +43,11 @@ void Potential::generate_D_operator_matrix()
 {
     PROFILE("sirius::Potential::generate_D_operator_matrix");
 
+    if (ctx_.cfg().settings().augmentation() == "real_space") {
+        generate_D_operator_matrix_rs();
+        return;
+    }
+
     /* local number of G-vectors */
     int gvec_count = ctx_.gvec().count();
     auto spl_ngv_loc = utils::split_in_blocks(gvec_count, ctx_.cfg().control().gvec_chunk_size());
@@ -234,4 +239,72 @@ void Potential::generate_D_operator_matrix()
     } // iat
 }
 
+void Potential::generate_D_operator_matrix_rs()
+{
+    PROFILE("sirius::Potential::generate_D_operator_matrix_rs");
+
+    int ncomp = ctx_.num_mag_dims() + 1;
+
+    auto const& atg = ctx_.aug_to_grid_idx();
+
+    /* the plane-wave coefficients of the potential can be changed after the last transformation to real space
+     * (e.g. by symmetrization), so the real-space values are recomputed here */
+    sddk::mdarray<double, 2> veff(fft::spfft_grid_size_local(ctx_.spfft<double>()), ncomp);
+    Smooth_periodic_function<double> f(ctx_.spfft<double>(), ctx_.gvec_fft_sptr());
+    for (int iv = 0; iv < ncomp; iv++) {
+        #pragma omp parallel for schedule(static)
+        for (int igloc = 0; igloc < ctx_.gvec().count(); igloc++) {
+            f.f_pw_local(igloc) = component(iv).rg().f_pw_local(igloc);
+        }
+        f.fft_transform(1);
+        #pragma omp parallel for schedule(static)
+        for (int ir = 0; ir < static_cast<int>(veff.size(0)); ir++) {
+            veff(ir, iv) = f.value(ir);
+        }
+    }
+
+    double dv = unit_cell_.omega() / fft::spfft_grid_size(ctx_.spfft<double>());
+
+    for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
+        auto& atom_type = unit_cell_.atom_type(iat);
+        /* number of beta-projector functions */
+        int nbf = atom_type.mt_basis_size();
+        /* number of Q_{xi,xi'} components */
+        int nqlm = nbf * (nbf + 1) / 2;
+
+        if (atom_type.num_atoms() == 0) {
+            continue;
+        }
+
+        sddk::mdarray<double, 3> d_tmp(nqlm, atom_type.num_atoms(), ncomp);
+        d_tmp.zero();
+
+        /* in absence of augmentation charge D-matrix is zero */
+        if (atom_type.augment()) {
+            #pragma omp parallel for schedule(dynamic)
+            for (int i = 0; i < atom_type.num_atoms(); i++) {
+                ctx_.augmentation_op_rs(iat).integrate(atg, atom_type.atom_id(i), i, veff, dv, d_tmp);
+            }
+            /* sum over the slabs of the FFT grid */
+            mpi::Communicator(ctx_.spfft<double>().communicator())
+                .allreduce(d_tmp.at(sddk::memory_t::host), static_cast<int>(d_tmp.size()));
+        }
+
+        for (int iv = 0; iv < ncomp; iv++) {
+            #pragma omp parallel for schedule(static)
+            for (int i = 0; i < atom_type.num_atoms(); i++) {
+                auto& atom = unit_cell_.atom(atom_type.atom_id(i));
+
+                for (int xi2 = 0; xi2 < nbf; xi2++) {
+                    for (int xi1 = 0; xi1 <= xi2; xi1++) {
+                        int idx12 = xi2 * (xi2 + 1) / 2 + xi1;
+                        /* D-matix is symmetric */
+                        atom.d_mtrx(xi1, xi2, iv) = atom.d_mtrx(xi2, xi1, iv) = d_tmp(idx12, i, iv);
+                    }
+                }
+            }
+        }
+    }
+}
+
 } // namespace sirius
@@ -282,7 +282,7 @@ void Potential::calc_PAW_local_Dij(int ia__, sddk::mdarray<double, 3>& paw_dij__
             for (int imagn = 0; imagn < ctx_.num_mag_dims() + 1; imagn++) {
                 /* add nonzero coefficients */
                 for (int inz = 0; inz < num_non_zero_gk; inz++) {
-                    auto& lm3coef = GC.gaunt(lm1, lm2, inz);
+                    auto lm3coef = GC.gaunt(lm1, lm2, inz);
 
                     /* add to atom Dij an integral of dij array */
                     paw_dij__(ib1, ib2, imagn) += lm3coef.coef * integrals(lm3coef.lm3, iqij, imagn);
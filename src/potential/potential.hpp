@@ -28,14 +28,12 @@
 #include "density/density.hpp"
 #include "hubbard/hubbard.hpp"
 #include "xc_functional.hpp"
+#include "xc_mt.hpp"
 
 namespace sirius {
 
 void check_xc_potential(Density const& rho__);
 
-void xc_mt(Radial_grid<double> const& rgrid__, SHT const& sht__, std::vector<XC_functional> const& xc_func__,
-        int num_mag_dims__, std::vector<Flm const*> rho__, std::vector<Flm*> vxc__, Flm* exc__);
-
 double density_residual_hartree_energy(Density const& rho1__, Density const& rho2__);
 
 /// Generate effective potential from charge density and magnetization.
@@ -104,6 +102,9 @@ class Potential : public Field4D
 
     std::vector<XC_functional> xc_func_;
 
+    /// Workspaces of the muffin-tin XC potential, one per OpenMP thread.
+    std::vector<Xc_mt_workspace> xc_mt_ws_;
+
     /// Plane-wave coefficients of the effective potential weighted by the unit step-function.
     sddk::mdarray<std::complex<double>, 1> veff_pw_;
 
@@ -656,6 +657,17 @@ class Potential : public Field4D
      */
     void generate_D_operator_matrix();
 
+    /// Calculate D operator from the potential on the real-space grid.
+    /** The integrals
+     *  \f[
+     *      D_{\xi \xi'}^{\alpha} = \int V({\bf r}) \tilde Q_{\xi \xi'}({\bf r} - \tau_{\alpha}) d{\bf r}
+     *  \f]
+     *  with the filtered augmentation functions (see Augmentation_operator_rs) are computed as the sums over the
+     *  grid points inside the sphere around each atom. Used if the real-space augmentation is selected in
+     *  settings.augmentation.
+     */
+    void generate_D_operator_matrix_rs();
+
     void generate_PAW_effective_potential(Density const& density);
 
     double PAW_xc_total_energy(Density const& density__) const
@@ -32,8 +32,85 @@
 
 namespace sirius {
 
-void xc_mt_nonmagnetic(Radial_grid<double> const& rgrid__, SHT const& sht__, std::vector<XC_functional> const& xc_func__,
-                       Flm const& rho_lm__, Ftp& rho_tp__, Flm& vxc_lm__, Flm& exc_lm__)
+using Flm_batch = Spheric_function_batch<function_domain_t::spectral, double>;
+using Ftp_batch = Spheric_function_batch<function_domain_t::spatial, double>;
+using Vlm_batch = Spheric_vector_function_batch<function_domain_t::spectral, double>;
+using Vtp_batch = Spheric_vector_function_batch<function_domain_t::spatial, double>;
+
+/* The functions below operate on the batches of views into the arena of Xc_mt_workspace. Elementwise operations in
+   (theta, phi) domain are done by the fused loops over all points of the batch instead of the operators of
+   Spheric_function, which allocate the result. */
+
+/// Dot product of two vector functions: c = a * b.
+static void dot(Vtp_batch const& a__, Vtp_batch const& b__, Ftp_batch const& c__)
+{
+    auto c = c__.at();
+    for (size_t i = 0; i < c__.size(); i++) {
+        c[i] = a__[0].at()[i] * b__[0].at()[i] + a__[1].at()[i] * b__[1].at()[i] + a__[2].at()[i] * b__[2].at()[i];
+    }
+}
+
+/// Accumulate the dot product of two vector functions: c = c + alpha * a * b.
+static void add_dot(double alpha__, Vtp_batch const& a__, Vtp_batch const& b__, Ftp_batch const& c__)
+{
+    auto c = c__.at();
+    for (size_t i = 0; i < c__.size(); i++) {
+        c[i] += alpha__ * (a__[0].at()[i] * b__[0].at()[i] + a__[1].at()[i] * b__[1].at()[i] +
+                           a__[2].at()[i] * b__[2].at()[i]);
+    }
+}
+
+/// Forward transform the batch to Rlm and add it to the output functions.
+/** The output function of the i-th atom of the batch is flm__[i * stride__ + offset__]. */
+static void add_transform(SHT const& sht__, Ftp_batch const& ftp__, Flm_batch const& tmp_lm__,
+                          std::vector<Flm*> const& flm__, int stride__, int offset__)
+{
+    transform(sht__, ftp__, tmp_lm__);
+    for (int i = 0; i < tmp_lm__.num_functions(); i++) {
+        *flm__[i * stride__ + offset__] += tmp_lm__[i];
+    }
+}
+
+/// Backward transform all components of the vector functions.
+static void transform(SHT const& sht__, Vlm_batch const& flm__, Vtp_batch const& ftp__)
+{
+    for (int x: {0, 1, 2}) {
+        transform(sht__, flm__[x], ftp__[x]);
+    }
+}
+
+/// Size of the arena of Xc_mt_workspace which is needed for xc_mt().
+static size_t xc_mt_workspace_size(Radial_grid<double> const& rgrid__, SHT const& sht__, int lmmax_rho__,
+                                   int num_mag_dims__, bool is_gga__, int num_atoms__)
+{
+    size_t ntp = static_cast<size_t>(sht__.num_points()) * rgrid__.num_points() * num_atoms__;
+    size_t nlm = static_cast<size_t>(std::max(sht__.lmmax(), lmmax_rho__)) * rgrid__.num_points() * num_atoms__;
+
+    /* density and magnetization in (theta, phi) */
+    size_t size = (num_mag_dims__ + 1) * ntp;
+    if (num_mag_dims__ == 0) {
+        /* exc, vxc; forward transform */
+        size += 2 * ntp + nlm;
+        if (is_gga__) {
+            /* grad(rho), sigma, vsigma, vsigma * grad(rho) in (theta, phi); grad(rho), vsigma * grad(rho) in Rlm */
+            size += 8 * ntp + 6 * nlm;
+        }
+    } else {
+        /* exc, vxc, rho_up, rho_dn, vxc_up, vxc_dn, bxc; rho_up, rho_dn and forward transform in Rlm */
+        size += (6 + num_mag_dims__) * ntp + 3 * nlm;
+        if (is_gga__) {
+            /* grad(rho_up), grad(rho_dn), three sigma, three vsigma, two Laplacians and grad(vsigma) in (theta, phi);
+               gradient and vsigma in Rlm */
+            size += 17 * ntp + 4 * nlm;
+        }
+    }
+    return size;
+}
+
+static void xc_mt_nonmagnetic(Radial_grid<double> const& rgrid__, SHT const& sht__,
+                              std::vector<XC_functional> const& xc_func__, std::vector<Flm const*> const& rho_lm__,
+                              Ftp_batch const& rho_tp__, std::vector<Flm*> const& vxc_lm__,
+                              std::vector<Flm*> const& exc_lm__, Xc_mt_workspace& ws__)
 {
     bool is_gga{false};
     for (auto& ixc : xc_func__) {
@@ -42,90 +119,79 @@ void xc_mt_nonmagnetic(Radial_grid<double> const& rgrid__, SHT const& sht__, std
         }
     }
 
-    Ftp exc_tp(sht__.num_points(), rgrid__);
-    Ftp vxc_tp(sht__.num_points(), rgrid__);
+    int nb = rho_tp__.num_functions();
+    int np = static_cast<int>(rho_tp__.size());
 
-    assert(rho_tp__.size() == vxc_tp.size());
-    assert(rho_tp__.size() == exc_tp.size());
+    auto exc_tp = ws__.batch<function_domain_t::spatial>(sht__.num_points(), rgrid__, nb);
+    auto vxc_tp = ws__.batch<function_domain_t::spatial>(sht__.num_points(), rgrid__, nb);
+    auto tmp_lm = ws__.batch<function_domain_t::spectral>(sht__.lmmax(), rgrid__, nb);
 
-    Ftp grad_rho_grad_rho_tp;
-    Ftp vsigma_tp;
-    Ftp lapl_rho_tp;
-    Spheric_vector_function<function_domain_t::spatial, double> grad_rho_tp;
-
-    /* use Laplacian (true) or divergence of gradient (false) */
-    bool use_lapl{false};
+    Vlm_batch grad_rho_lm;
+    Vlm_batch vsigma_grad_rho_lm;
+    Vtp_batch grad_rho_tp;
+    Vtp_batch vsigma_grad_rho_tp;
+    Ftp_batch grad_rho_grad_rho_tp;
+    Ftp_batch vsigma_tp;
 
     if (is_gga) {
+        grad_rho_lm = ws__.vector_batch<function_domain_t::spectral>(rho_lm__[0]->angular_domain_size(), rgrid__, nb);
+        vsigma_grad_rho_lm = ws__.vector_batch<function_domain_t::spectral>(sht__.lmmax(), rgrid__, nb);
+        grad_rho_tp = ws__.vector_batch<function_domain_t::spatial>(sht__.num_points(), rgrid__, nb);
+        vsigma_grad_rho_tp = ws__.vector_batch<function_domain_t::spatial>(sht__.num_points(), rgrid__, nb);
+        grad_rho_grad_rho_tp = ws__.batch<function_domain_t::spatial>(sht__.num_points(), rgrid__, nb);
+        vsigma_tp = ws__.batch<function_domain_t::spatial>(sht__.num_points(), rgrid__, nb);
+
         /* compute gradient in Rlm spherical harmonics */
-        auto grad_rho_lm = gradient(rho_lm__);
-        grad_rho_tp = Spheric_vector_function<function_domain_t::spatial, double>(sht__.num_points(), rgrid__);
-        /* backward transform gradient from Rlm to (theta, phi) */
-        for (int x = 0; x < 3; x++) {
-            transform(sht__, grad_rho_lm[x], grad_rho_tp[x]);
+        for (int i = 0; i < nb; i++) {
+            auto g = grad_rho_lm.function(i);
+            gradient(*rho_lm__[i], g, ws__.sf_ws());
         }
+        /* backward transform gradient from Rlm to (theta, phi) */
+        transform(sht__, grad_rho_lm, grad_rho_tp);
         /* compute density gradient product */
-        grad_rho_grad_rho_tp = grad_rho_tp * grad_rho_tp;
-        assert(rho_tp__.size() == grad_rho_grad_rho_tp.size());
-
-        vsigma_tp = Ftp(sht__.num_points(), rgrid__);
-        assert(rho_tp__.size() == vsigma_tp.size());
-        if (use_lapl) {
-            /* backward transform Laplacian from Rlm to (theta, phi) */
-            lapl_rho_tp = transform(sht__, laplacian(rho_lm__));
-            assert(lapl_rho_tp.size() == rho_tp__.size());
-        }
+        dot(grad_rho_tp, grad_rho_tp, grad_rho_grad_rho_tp);
     }
 
     for (auto& ixc: xc_func__) {
         /* if this is an LDA functional */
         if (ixc.is_lda()) {
-            ixc.get_lda(sht__.num_points() * rgrid__.num_points(), rho_tp__.at(sddk::memory_t::host),
-                vxc_tp.at(sddk::memory_t::host), exc_tp.at(sddk::memory_t::host));
+            ixc.get_lda(np, rho_tp__.at(), vxc_tp.at(), exc_tp.at());
         }
         /* if this is a GGA functional */
         if (ixc.is_gga()) {
 
             /* compute vrho and vsigma */
-            ixc.get_gga(sht__.num_points() * rgrid__.num_points(), rho_tp__.at(sddk::memory_t::host),
-                grad_rho_grad_rho_tp.at(sddk::memory_t::host), vxc_tp.at(sddk::memory_t::host), vsigma_tp.at(sddk::memory_t::host),
-                exc_tp.at(sddk::memory_t::host));
-
-            if (use_lapl) {
-                vxc_tp -= 2.0 * vsigma_tp * lapl_rho_tp;
-
-                /* compute gradient of vsgima in spherical harmonics */
-                auto grad_vsigma_lm = gradient(transform(sht__, vsigma_tp));
-
-                /* backward transform gradient from Rlm to (theta, phi) */
-                Spheric_vector_function<function_domain_t::spatial, double> grad_vsigma_tp(sht__.num_points(), rgrid__);
-                for (int x = 0; x < 3; x++) {
-                    transform(sht__, grad_vsigma_lm[x], grad_vsigma_tp[x]);
+            ixc.get_gga(np, rho_tp__.at(), grad_rho_grad_rho_tp.at(), vxc_tp.at(), vsigma_tp.at(), exc_tp.at());
+
+            /* forward transform vsigma * grad(rho) to Rlm */
+            for (int x: {0, 1, 2}) {
+                auto f = vsigma_grad_rho_tp[x].at();
+                auto g = grad_rho_tp[x].at();
+                for (int i = 0; i < np; i++) {
+                    f[i] = vsigma_tp.at()[i] * g[i];
                 }
-
-                /* compute scalar product of two gradients */
-                auto grad_vsigma_grad_rho_tp = grad_vsigma_tp * grad_rho_tp;
-                /* add remaining term to Vxc */
-                vxc_tp -= 2.0 * grad_vsigma_grad_rho_tp;
-            } else {
-                Spheric_vector_function<function_domain_t::spectral, double> vsigma_grad_rho_lm(sht__.lmmax(), rgrid__);
-                for (int x: {0, 1, 2}) {
-                    auto vsigma_grad_rho_tp = vsigma_tp * grad_rho_tp[x];
-                    transform(sht__, vsigma_grad_rho_tp, vsigma_grad_rho_lm[x]);
-                }
-                auto div_vsigma_grad_rho_tp = transform(sht__, divergence(vsigma_grad_rho_lm));
-                /* add remaining term to Vxc */
-                vxc_tp -= 2.0 * div_vsigma_grad_rho_tp;
+                transform(sht__, vsigma_grad_rho_tp[x], vsigma_grad_rho_lm[x]);
+            }
+            /* divergence of vsigma * grad(rho) in (theta, phi) */
+            for (int i = 0; i < nb; i++) {
+                auto div = tmp_lm[i];
+                divergence(vsigma_grad_rho_lm.function(i), div, ws__.sf_ws());
+            }
+            auto& div_tp = vsigma_grad_rho_tp[0];
+            transform(sht__, tmp_lm, div_tp);
+            /* add remaining term to Vxc */
+            for (int i = 0; i < np; i++) {
+                vxc_tp.at()[i] -= 2.0 * div_tp.at()[i];
             }
         }
-        exc_lm__ += transform(sht__, exc_tp);
-        vxc_lm__ += transform(sht__, vxc_tp);
+        add_transform(sht__, exc_tp, tmp_lm, exc_lm__, 1, 0);
+        add_transform(sht__, vxc_tp, tmp_lm, vxc_lm__, 1, 0);
     } //ixc
 }
 
-void xc_mt_magnetic(Radial_grid<double> const& rgrid__, SHT const& sht__, int num_mag_dims__,
-                    std::vector<XC_functional> const& xc_func__, std::vector<Ftp> const& rho_tp__,
-                    std::vector<Flm*> vxc__, Flm& exc__)
+static void xc_mt_magnetic(Radial_grid<double> const& rgrid__, SHT const& sht__, int num_mag_dims__,
+                           std::vector<XC_functional> const& xc_func__, std::array<Ftp_batch, 4> const& rho_tp__,
+                           std::vector<Flm*> const& vxc__, std::vector<Flm*> const& exc__, Xc_mt_workspace& ws__)
 {
     bool is_gga{false};
     for (auto& ixc : xc_func__) {
@@ -134,183 +200,217 @@ void xc_mt_magnetic(Radial_grid<double> const& rgrid__, SHT const& sht__, int nu
         }
     }
 
-    Ftp exc_tp(sht__.num_points(), rgrid__);
-    Ftp vxc_tp(sht__.num_points(), rgrid__);
+    int nb = rho_tp__[0].num_functions();
+    int np = static_cast<int>(rho_tp__[0].size());
 
-    /* convert to rho_up, rho_dn */
-    Ftp rho_dn_tp(sht__.num_points(), rgrid__);
-    Ftp rho_up_tp(sht__.num_points(), rgrid__);
-    /* loop over radial grid points */
-    for (int ir = 0; ir < rgrid__.num_points(); ir++) {
-        /* loop over points on the sphere */
-        for (int itp = 0; itp < sht__.num_points(); itp++) {
-            r3::vector<double> m;
-            for (int j = 0; j < num_mag_dims__; j++) {
-                m[j] = rho_tp__[1 + j](itp, ir);
-            }
-            auto rud = get_rho_up_dn(num_mag_dims__, rho_tp__[0](itp, ir), m);
+    auto spatial_batch = [&]() { return ws__.batch<function_domain_t::spatial>(sht__.num_points(), rgrid__, nb); };
+    auto spectral_batch = [&]() { return ws__.batch<function_domain_t::spectral>(sht__.lmmax(), rgrid__, nb); };
+
+    auto exc_tp = spatial_batch();
+    auto vxc_tp = spatial_batch();
 
-            /* compute "up" and "dn" components */
-            rho_up_tp(itp, ir) = rud.first;
-            rho_dn_tp(itp, ir) = rud.second;
+    /* convert to rho_up, rho_dn */
+    auto rho_dn_tp = spatial_batch();
+    auto rho_up_tp = spatial_batch();
+    /* loop over all points of the batch */
+    for (int i = 0; i < np; i++) {
+        r3::vector<double> m;
+        for (int j = 0; j < num_mag_dims__; j++) {
+            m[j] = rho_tp__[1 + j].at()[i];
         }
+        auto rud = get_rho_up_dn(num_mag_dims__, rho_tp__[0].at()[i], m);
+
+        /* compute "up" and "dn" components */
+        rho_up_tp.at()[i] = rud.first;
+        rho_dn_tp.at()[i] = rud.second;
     }
     /* transform from (theta, phi) to Rlm */
-    auto rho_up_lm = transform(sht__, rho_up_tp);
-    auto rho_dn_lm = transform(sht__, rho_dn_tp);
+    auto rho_up_lm = spectral_batch();
+    auto rho_dn_lm = spectral_batch();
+    auto tmp_lm    = spectral_batch();
+    transform(sht__, rho_up_tp, rho_up_lm);
+    transform(sht__, rho_dn_tp, rho_dn_lm);
 
-    std::vector<Ftp> bxc_tp(num_mag_dims__);
+    std::array<Ftp_batch, 3> bxc_tp;
 
-    Ftp vxc_up_tp(sht__.num_points(), rgrid__);
-    Ftp vxc_dn_tp(sht__.num_points(), rgrid__);
+    auto vxc_up_tp = spatial_batch();
+    auto vxc_dn_tp = spatial_batch();
     for (int j = 0; j < num_mag_dims__; j++) {
-        bxc_tp[j] = Ftp(sht__.num_points(), rgrid__);
+        bxc_tp[j] = spatial_batch();
     }
 
-    Ftp grad_rho_up_grad_rho_up_tp;
-    Ftp grad_rho_up_grad_rho_dn_tp;
-    Ftp grad_rho_dn_grad_rho_dn_tp;
-    Ftp vsigma_uu_tp;
-    Ftp vsigma_ud_tp;
-    Ftp vsigma_dd_tp;
-    Ftp lapl_rho_up_tp;
-    Ftp lapl_rho_dn_tp;
-    Spheric_vector_function<function_domain_t::spatial, double> grad_rho_up_tp;
-    Spheric_vector_function<function_domain_t::spatial, double> grad_rho_dn_tp;
+    Ftp_batch grad_rho_up_grad_rho_up_tp;
+    Ftp_batch grad_rho_up_grad_rho_dn_tp;
+    Ftp_batch grad_rho_dn_grad_rho_dn_tp;
+    Ftp_batch vsigma_uu_tp;
+    Ftp_batch vsigma_ud_tp;
+    Ftp_batch vsigma_dd_tp;
+    Ftp_batch lapl_rho_up_tp;
+    Ftp_batch lapl_rho_dn_tp;
+    Flm_batch vsigma_lm;
+    Vlm_batch grad_lm;
+    Vtp_batch grad_rho_up_tp;
+    Vtp_batch grad_rho_dn_tp;
+    Vtp_batch grad_vsigma_tp;
+
+    /* gradient of the batch in (theta, phi) */
+    auto grad = [&](Flm_batch const& f_lm, Vtp_batch const& grad_tp)
+    {
+        for (int i = 0; i < nb; i++) {
+            auto g = grad_lm.function(i);
+            gradient(f_lm[i], g, ws__.sf_ws());
+        }
+        transform(sht__, grad_lm, grad_tp);
+    };
 
     if (is_gga) {
-        /* compute gradient in Rlm spherical harmonics */
-        auto grad_rho_up_lm = gradient(rho_up_lm);
-        auto grad_rho_dn_lm = gradient(rho_dn_lm);
-        grad_rho_up_tp = Spheric_vector_function<function_domain_t::spatial, double>(sht__.num_points(), rgrid__);
-        grad_rho_dn_tp = Spheric_vector_function<function_domain_t::spatial, double>(sht__.num_points(), rgrid__);
-        /* backward transform gradient from Rlm to (theta, phi) */
-        for (int x = 0; x < 3; x++) {
-            transform(sht__, grad_rho_up_lm[x], grad_rho_up_tp[x]);
-            transform(sht__, grad_rho_dn_lm[x], grad_rho_dn_tp[x]);
-        }
+        grad_rho_up_grad_rho_up_tp = spatial_batch();
+        grad_rho_up_grad_rho_dn_tp = spatial_batch();
+        grad_rho_dn_grad_rho_dn_tp = spatial_batch();
+        vsigma_uu_tp               = spatial_batch();
+        vsigma_ud_tp               = spatial_batch();
+        vsigma_dd_tp               = spatial_batch();
+        lapl_rho_up_tp             = spatial_batch();
+        lapl_rho_dn_tp             = spatial_batch();
+        vsigma_lm                  = spectral_batch();
+        grad_lm        = ws__.vector_batch<function_domain_t::spectral>(sht__.lmmax(), rgrid__, nb);
+        grad_rho_up_tp = ws__.vector_batch<function_domain_t::spatial>(sht__.num_points(), rgrid__, nb);
+        grad_rho_dn_tp = ws__.vector_batch<function_domain_t::spatial>(sht__.num_points(), rgrid__, nb);
+        grad_vsigma_tp = ws__.vector_batch<function_domain_t::spatial>(sht__.num_points(), rgrid__, nb);
+
+        /* compute gradients in Rlm spherical harmonics and backward transform them to (theta, phi) */
+        grad(rho_up_lm, grad_rho_up_tp);
+        grad(rho_dn_lm, grad_rho_dn_tp);
         /* compute density gradient products */
-        grad_rho_up_grad_rho_up_tp = grad_rho_up_tp * grad_rho_up_tp;
-        grad_rho_up_grad_rho_dn_tp = grad_rho_up_tp * grad_rho_dn_tp;
-        grad_rho_dn_grad_rho_dn_tp = grad_rho_dn_tp * grad_rho_dn_tp;
-
-        vsigma_uu_tp = Ftp(sht__.num_points(), rgrid__);
-        vsigma_ud_tp = Ftp(sht__.num_points(), rgrid__);
-        vsigma_dd_tp = Ftp(sht__.num_points(), rgrid__);
+        dot(grad_rho_up_tp, grad_rho_up_tp, grad_rho_up_grad_rho_up_tp);
+        dot(grad_rho_up_tp, grad_rho_dn_tp, grad_rho_up_grad_rho_dn_tp);
+        dot(grad_rho_dn_tp, grad_rho_dn_tp, grad_rho_dn_grad_rho_dn_tp);
 
         /* backward transform Laplacians from Rlm to (theta, phi) */
-        lapl_rho_up_tp = transform(sht__, laplacian(rho_up_lm));
-        lapl_rho_dn_tp = transform(sht__, laplacian(rho_dn_lm));
+        for (int i = 0; i < nb; i++) {
+            auto lapl = tmp_lm[i];
+            laplacian(rho_up_lm[i], lapl, ws__.sf_ws());
+        }
+        transform(sht__, tmp_lm, lapl_rho_up_tp);
+        for (int i = 0; i < nb; i++) {
+            auto lapl = tmp_lm[i];
+            laplacian(rho_dn_lm[i], lapl, ws__.sf_ws());
+        }
+        transform(sht__, tmp_lm, lapl_rho_dn_tp);
     }
 
+    /* gradient of vsigma in (theta, phi) */
+    auto grad_vsigma = [&](Ftp_batch const& vsigma_tp)
+    {
+        transform(sht__, vsigma_tp, vsigma_lm);
+        grad(vsigma_lm, grad_vsigma_tp);
+    };
+
     for (auto& ixc: xc_func__) {
         if (ixc.is_lda()) {
-            ixc.get_lda(sht__.num_points() * rgrid__.num_points(), rho_up_tp.at(sddk::memory_t::host),
-                rho_dn_tp.at(sddk::memory_t::host), vxc_up_tp.at(sddk::memory_t::host), vxc_dn_tp.at(sddk::memory_t::host),
-                exc_tp.at(sddk::memory_t::host));
+            ixc.get_lda(np, rho_up_tp.at(), rho_dn_tp.at(), vxc_up_tp.at(), vxc_dn_tp.at(), exc_tp.at());
         }
         if (ixc.is_gga()) {
             /* get the vrho and vsigma */
-            ixc.get_gga(sht__.num_points() * rgrid__.num_points(), rho_up_tp.at(sddk::memory_t::host),
-                    rho_dn_tp.at(sddk::memory_t::host), grad_rho_up_grad_rho_up_tp.at(sddk::memory_t::host),
-                    grad_rho_up_grad_rho_dn_tp.at(sddk::memory_t::host), grad_rho_dn_grad_rho_dn_tp.at(sddk::memory_t::host),
-                    vxc_up_tp.at(sddk::memory_t::host), vxc_dn_tp.at(sddk::memory_t::host), vsigma_uu_tp.at(sddk::memory_t::host),
-                    vsigma_ud_tp.at(sddk::memory_t::host), vsigma_dd_tp.at(sddk::memory_t::host), exc_tp.at(sddk::memory_t::host));
+            ixc.get_gga(np, rho_up_tp.at(), rho_dn_tp.at(), grad_rho_up_grad_rho_up_tp.at(),
+                        grad_rho_up_grad_rho_dn_tp.at(), grad_rho_dn_grad_rho_dn_tp.at(), vxc_up_tp.at(),
+                        vxc_dn_tp.at(), vsigma_uu_tp.at(), vsigma_ud_tp.at(), vsigma_dd_tp.at(), exc_tp.at());
 
             /* directly add to Vxc available contributions */
-            vxc_up_tp -= (2.0 * vsigma_uu_tp * lapl_rho_up_tp + vsigma_ud_tp * lapl_rho_dn_tp);
-            vxc_dn_tp -= (2.0 * vsigma_dd_tp * lapl_rho_dn_tp + vsigma_ud_tp * lapl_rho_up_tp);
-
-            /* forward transform vsigma to Rlm */
-            auto vsigma_uu_lm = transform(sht__, vsigma_uu_tp);
-            auto vsigma_ud_lm = transform(sht__, vsigma_ud_tp);
-            auto vsigma_dd_lm = transform(sht__, vsigma_dd_tp);
-
-            /* compute gradient of vsgima in spherical harmonics */
-            auto grad_vsigma_uu_lm = gradient(vsigma_uu_lm);
-            auto grad_vsigma_ud_lm = gradient(vsigma_ud_lm);
-            auto grad_vsigma_dd_lm = gradient(vsigma_dd_lm);
-
-            /* backward transform gradient from Rlm to (theta, phi) */
-            Spheric_vector_function<function_domain_t::spatial, double> grad_vsigma_uu_tp(sht__.num_points(), rgrid__);
-            Spheric_vector_function<function_domain_t::spatial, double> grad_vsigma_ud_tp(sht__.num_points(), rgrid__);
-            Spheric_vector_function<function_domain_t::spatial, double> grad_vsigma_dd_tp(sht__.num_points(), rgrid__);
-            for (int x = 0; x < 3; x++) {
-                grad_vsigma_uu_tp[x] = transform(sht__, grad_vsigma_uu_lm[x]);
-                grad_vsigma_ud_tp[x] = transform(sht__, grad_vsigma_ud_lm[x]);
-                grad_vsigma_dd_tp[x] = transform(sht__, grad_vsigma_dd_lm[x]);
+            for (int i = 0; i < np; i++) {
+                vxc_up_tp.at()[i] -= (2.0 * vsigma_uu_tp.at()[i] * lapl_rho_up_tp.at()[i] +
+                                      vsigma_ud_tp.at()[i] * lapl_rho_dn_tp.at()[i]);
+                vxc_dn_tp.at()[i] -= (2.0 * vsigma_dd_tp.at()[i] * lapl_rho_dn_tp.at()[i] +
+                                      vsigma_ud_tp.at()[i] * lapl_rho_up_tp.at()[i]);
             }
 
-            /* compute scalar product of two gradients */
-            auto grad_vsigma_uu_grad_rho_up_tp = grad_vsigma_uu_tp * grad_rho_up_tp;
-            auto grad_vsigma_dd_grad_rho_dn_tp = grad_vsigma_dd_tp * grad_rho_dn_tp;
-            auto grad_vsigma_ud_grad_rho_up_tp = grad_vsigma_ud_tp * grad_rho_up_tp;
-            auto grad_vsigma_ud_grad_rho_dn_tp = grad_vsigma_ud_tp * grad_rho_dn_tp;
+            /* add remaining terms to Vxc; gradients of vsigma are computed one at a time */
+            grad_vsigma(vsigma_uu_tp);
+            add_dot(-2.0, grad_vsigma_tp, grad_rho_up_tp, vxc_up_tp);
 
-            /* add remaining terms to Vxc */
-            vxc_up_tp -= (2.0 * grad_vsigma_uu_grad_rho_up_tp + grad_vsigma_ud_grad_rho_dn_tp);
-            vxc_dn_tp -= (2.0 * grad_vsigma_dd_grad_rho_dn_tp + grad_vsigma_ud_grad_rho_up_tp);
+            grad_vsigma(vsigma_ud_tp);
+            add_dot(-1.0, grad_vsigma_tp, grad_rho_dn_tp, vxc_up_tp);
+            add_dot(-1.0, grad_vsigma_tp, grad_rho_up_tp, vxc_dn_tp);
+
+            grad_vsigma(vsigma_dd_tp);
+            add_dot(-2.0, grad_vsigma_tp, grad_rho_dn_tp, vxc_dn_tp);
         }
         /* genertate magnetic filed and effective potential inside MT sphere */
-        for (int ir = 0; ir < rgrid__.num_points(); ir++) {
-            for (int itp = 0; itp < sht__.num_points(); itp++) {
-                /* Vxc = 0.5 * (V_up + V_dn) */
-                vxc_tp(itp, ir) = 0.5 * (vxc_up_tp(itp, ir) + vxc_dn_tp(itp, ir));
-                /* Bxc = 0.5 * (V_up - V_dn) */
-                double bxc = 0.5 * (vxc_up_tp(itp, ir) - vxc_dn_tp(itp, ir));
-                /* get the sign between mag and B */
-                auto s = utils::sign((rho_up_tp(itp, ir) - rho_dn_tp(itp, ir)) * bxc);
-
-                r3::vector<double> m;
+        for (int i = 0; i < np; i++) {
+            /* Vxc = 0.5 * (V_up + V_dn) */
+            vxc_tp.at()[i] = 0.5 * (vxc_up_tp.at()[i] + vxc_dn_tp.at()[i]);
+            /* Bxc = 0.5 * (V_up - V_dn) */
+            double bxc = 0.5 * (vxc_up_tp.at()[i] - vxc_dn_tp.at()[i]);
+            /* get the sign between mag and B */
+            auto s = utils::sign((rho_up_tp.at()[i] - rho_dn_tp.at()[i]) * bxc);
+
+            r3::vector<double> m;
+            for (int j = 0; j < num_mag_dims__; j++) {
+                m[j] = rho_tp__[1 + j].at()[i];
+            }
+            auto m_len = m.length();
+            if (m_len > 1e-8) {
                 for (int j = 0; j < num_mag_dims__; j++) {
-                    m[j] = rho_tp__[1 + j](itp, ir);
+                    bxc_tp[j].at()[i] = std::abs(bxc) * s * m[j] / m_len;
                 }
-                auto m_len = m.length();
-                if (m_len > 1e-8) {
-                    for (int j = 0; j < num_mag_dims__; j++) {
-                        bxc_tp[j](itp, ir) = std::abs(bxc) * s * m[j] / m_len;
-                    }
-                } else {
-                    for (int j = 0; j < num_mag_dims__; j++) {
-                        bxc_tp[j](itp, ir) = 0.0;
-                    }
+            } else {
+                for (int j = 0; j < num_mag_dims__; j++) {
+                    bxc_tp[j].at()[i] = 0.0;
                 }
             }
         }
         /* convert magnetic field back to Rlm */
         for (int j = 0; j < num_mag_dims__; j++) {
-            *vxc__[j + 1] += transform(sht__, bxc_tp[j]);
+            add_transform(sht__, bxc_tp[j], tmp_lm, vxc__, num_mag_dims__ + 1, j + 1);
         }
         /* forward transform from (theta, phi) to Rlm */
-        *vxc__[0] += transform(sht__, vxc_tp);
-        exc__ += transform(sht__, exc_tp);
+        add_transform(sht__, vxc_tp, tmp_lm, vxc__, num_mag_dims__ + 1, 0);
+        add_transform(sht__, exc_tp, tmp_lm, exc__, 1, 0);
     } // ixc
 }
 
 void xc_mt(Radial_grid<double> const& rgrid__, SHT const& sht__, std::vector<XC_functional> const& xc_func__,
-        int num_mag_dims__, std::vector<Flm const*> rho__, std::vector<Flm*> vxc__, Flm* exc__)
+           int num_mag_dims__, std::vector<Flm const*> const& rho__, std::vector<Flm*> const& vxc__,
+           std::vector<Flm*> const& exc__, Xc_mt_workspace& ws__)
 {
+    bool is_gga{false};
+    for (auto& ixc : xc_func__) {
+        if (ixc.is_gga() || ixc.is_vdw()) {
+            is_gga = true;
+        }
+    }
+    int nb    = static_cast<int>(exc__.size());
+    int ncomp = num_mag_dims__ + 1;
+    RTE_ASSERT(static_cast<int>(rho__.size()) == nb * ncomp);
+    RTE_ASSERT(static_cast<int>(vxc__.size()) == nb * ncomp);
+
+    ws__.reset(xc_mt_workspace_size(rgrid__, sht__, rho__[0]->angular_domain_size(), num_mag_dims__, is_gga, nb));
+
     /* zero the fields */
-    exc__->zero();
-    for (int j = 0; j < num_mag_dims__ + 1; j++) {
-        vxc__[j]->zero();
+    for (int i = 0; i < nb; i++) {
+        exc__[i]->zero();
+        for (int j = 0; j < ncomp; j++) {
+            vxc__[i * ncomp + j]->zero();
+        }
     }
 
-    std::vector<Ftp> rho_tp(num_mag_dims__ + 1);
-    for (int j = 0; j < num_mag_dims__ + 1; j++) {
-        /* convert density and magnetization to theta, phi */
-        rho_tp[j] = transform(sht__, *rho__[j]);
+    std::array<Ftp_batch, 4> rho_tp;
+    for (int j = 0; j < ncomp; j++) {
+        rho_tp[j] = ws__.batch<function_domain_t::spatial>(sht__.num_points(), rgrid__, nb);
+        /* convert density and magnetization to theta, phi; the input functions are not stored in one batch */
+        for (int i = 0; i < nb; i++) {
+            auto f = rho_tp[j][i];
+            transform(sht__, *rho__[i * ncomp + j], f);
+        }
     }
 
     /* check if density has negative values */
     double rhomin{0};
-    for (int ir = 0; ir < rgrid__.num_points(); ir++) {
-        for (int itp = 0; itp < sht__.num_points(); itp++) {
-            rhomin = std::min(rhomin, rho_tp[0](itp, ir));
-            /* fix negative density */
-            if (rho_tp[0](itp, ir) < 0.0) {
-                rho_tp[0](itp, ir) = 0.0;
-            }
+    for (size_t i = 0; i < rho_tp[0].size(); i++) {
+        rhomin = std::min(rhomin, rho_tp[0].at()[i]);
+        /* fix negative density */
+        if (rho_tp[0].at()[i] < 0.0) {
+            rho_tp[0].at()[i] = 0.0;
         }
     }
 
@@ -322,40 +422,87 @@ void xc_mt(Radial_grid<double> const& rgrid__, SHT const& sht__, std::vector<XC_
     }
 
     if (num_mag_dims__ == 0) {
-        xc_mt_nonmagnetic(rgrid__, sht__, xc_func__, *rho__[0], rho_tp[0], *vxc__[0], *exc__);
+        xc_mt_nonmagnetic(rgrid__, sht__, xc_func__, rho__, rho_tp[0], vxc__, exc__, ws__);
     } else {
-        xc_mt_magnetic(rgrid__, sht__, num_mag_dims__, xc_func__, rho_tp, vxc__, *exc__);
+        xc_mt_magnetic(rgrid__, sht__, num_mag_dims__, xc_func__, rho_tp, vxc__, exc__, ws__);
     }
 }
 
+void xc_mt(Radial_grid<double> const& rgrid__, SHT const& sht__, std::vector<XC_functional> const& xc_func__,
+        int num_mag_dims__, std::vector<Flm const*> rho__, std::vector<Flm*> vxc__, Flm* exc__)
+{
+    Xc_mt_workspace ws;
+    xc_mt(rgrid__, sht__, xc_func__, num_mag_dims__, rho__, vxc__, std::vector<Flm*>({exc__}), ws);
+}
+
 void Potential::xc_mt(Density const& density__)
 {
     PROFILE("sirius::Potential::xc_mt");
 
-    #pragma omp parallel for
+    int num_threads = omp_get_max_threads();
+    if (static_cast<int>(xc_mt_ws_.size()) < num_threads) {
+        xc_mt_ws_.resize(num_threads);
+    }
+
+    /* split the local atoms of each type into batches; the batches are small enough to keep all threads busy */
+    std::vector<std::vector<int>> atoms_of_type(unit_cell_.num_atom_types());
     for (int ialoc = 0; ialoc < unit_cell_.spl_num_atoms().local_size(); ialoc++) {
         int ia = unit_cell_.spl_num_atoms(ialoc);
-        auto& rgrid = unit_cell_.atom(ia).radial_grid();
-        std::vector<Flm const*> rho(ctx_.num_mag_dims() + 1);
-        std::vector<Flm*> vxc(ctx_.num_mag_dims() + 1);
-        rho[0] = &density__.rho().mt()[ia];
-        vxc[0] = &xc_potential_->mt()[ia];
-        for (int j = 0; j < ctx_.num_mag_dims(); j++) {
-            rho[j + 1] = &density__.mag(j).mt()[ia];
-            vxc[j + 1] = &effective_magnetic_field(j).mt()[ia];
+        atoms_of_type[unit_cell_.atom(ia).type_id()].push_back(ia);
+    }
+    std::vector<std::vector<int>> batches;
+    for (auto& atoms : atoms_of_type) {
+        int na = static_cast<int>(atoms.size());
+        int bs = std::max(1, std::min(ctx_.cfg().settings().xc_mt_batch_size(), utils::num_blocks(na, num_threads)));
+        for (int i = 0; i < na; i += bs) {
+            batches.emplace_back(atoms.begin() + i, atoms.begin() + std::min(na, i + bs));
         }
-        sirius::xc_mt(rgrid, *sht_, xc_func_, ctx_.num_mag_dims(), rho, vxc, &xc_energy_density_->mt()[ia]);
-
-        /* z, x, y order */
-        std::array<int, 3> comp_map = {2, 0, 1};
-        /* add auxiliary magnetic field antiparallel to starting magnetization */
-        for (int j = 0; j < ctx_.num_mag_dims(); j++) {
-            for (int ir = 0; ir < rgrid.num_points(); ir++) {
-                effective_magnetic_field(j).mt()[ia](0, ir) -=
-                    aux_bf_(j, ia) * ctx_.unit_cell().atom(ia).vector_field()[comp_map[j]];
+    }
+
+    int ncomp = ctx_.num_mag_dims() + 1;
+
+    #pragma omp parallel
+    {
+        auto& ws = xc_mt_ws_[omp_get_thread_num()];
+
+        std::vector<Flm const*> rho;
+        std::vector<Flm*> vxc;
+        std::vector<Flm*> exc;
+
+        #pragma omp for schedule(dynamic)
+        for (int ib = 0; ib < static_cast<int>(batches.size()); ib++) {
+            auto& atoms = batches[ib];
+            int nb = static_cast<int>(atoms.size());
+
+            rho.resize(nb * ncomp);
+            vxc.resize(nb * ncomp);
+            exc.resize(nb);
+            for (int i = 0; i < nb; i++) {
+                int ia = atoms[i];
+                rho[i * ncomp] = &density__.rho().mt()[ia];
+                vxc[i * ncomp] = &xc_potential_->mt()[ia];
+                for (int j = 0; j < ctx_.num_mag_dims(); j++) {
+                    rho[i * ncomp + j + 1] = &density__.mag(j).mt()[ia];
+                    vxc[i * ncomp + j + 1] = &effective_magnetic_field(j).mt()[ia];
+                }
+                exc[i] = &xc_energy_density_->mt()[ia];
             }
-        }
-    } // ialoc
+            auto& rgrid = unit_cell_.atom(atoms[0]).radial_grid();
+            sirius::xc_mt(rgrid, *sht_, xc_func_, ctx_.num_mag_dims(), rho, vxc, exc, ws);
+
+            /* z, x, y order */
+            std::array<int, 3> comp_map = {2, 0, 1};
+            /* add auxiliary magnetic field antiparallel to starting magnetization */
+            for (int ia : atoms) {
+                for (int j = 0; j < ctx_.num_mag_dims(); j++) {
+                    for (int ir = 0; ir < rgrid.num_points(); ir++) {
+                        effective_magnetic_field(j).mt()[ia](0, ir) -=
+                            aux_bf_(j, ia) * ctx_.unit_cell().atom(ia).vector_field()[comp_map[j]];
+                    }
+                }
+            }
+        } // ib
+    }
 }
 
 } // namespace sirius
@@ -0,0 +1,108 @@
+// Copyright (c) 2013-2023 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+/** \file xc_mt.hpp
+ *
+ *  \brief Generate XC potential in the muffin-tins.
+ */
+
+#ifndef __XC_MT_HPP__
+#define __XC_MT_HPP__
+
+#include "function3d/spheric_function.hpp"
+#include "xc_functional.hpp"
+
+namespace sirius {
+
+/// Scratch memory of the XC potential calculation in a muffin-tin sphere.
+/** All intermediate functions of xc_mt() are batches of views into the arena of this class. The arena is sized for
+ *  the largest batch of muffin-tins on the first call and is reused for all atoms handled by the same thread, so that
+ *  the calculation does not allocate memory in the subsequent calls. */
+class Xc_mt_workspace
+{
+  private:
+    /// Memory of the intermediate functions.
+    std::vector<double> arena_;
+
+    /// Offset of the first free element of the arena.
+    size_t offset_{0};
+
+    /// Scratch memory of the differential operators.
+    Spheric_function_workspace sf_ws_;
+
+    /// Take the next part of the arena.
+    inline double* take(size_t size__)
+    {
+        if (offset_ + size__ > arena_.size()) {
+            RTE_THROW("workspace is too small");
+        }
+        auto ptr = &arena_[offset_];
+        offset_ += size__;
+        return ptr;
+    }
+
+  public:
+    /// Release all functions and make sure that the arena has room for at least size__ elements.
+    inline void reset(size_t size__)
+    {
+        if (arena_.size() < size__) {
+            arena_.resize(size__);
+        }
+        offset_ = 0;
+    }
+
+    /// Batch of scalar functions in spatial or spectral domain.
+    template <function_domain_t domain_t>
+    inline auto batch(int angular_domain_size__, Radial_grid<double> const& rgrid__, int num_functions__)
+    {
+        size_t sz = static_cast<size_t>(angular_domain_size__) * rgrid__.num_points() * num_functions__;
+        return Spheric_function_batch<domain_t, double>(take(sz), angular_domain_size__, rgrid__, num_functions__);
+    }
+
+    /// Batch of vector functions in spatial or spectral domain.
+    template <function_domain_t domain_t>
+    inline auto vector_batch(int angular_domain_size__, Radial_grid<double> const& rgrid__, int num_functions__)
+    {
+        size_t sz = static_cast<size_t>(angular_domain_size__) * rgrid__.num_points() * num_functions__;
+        return Spheric_vector_function_batch<domain_t, double>(take(3 * sz), angular_domain_size__, rgrid__,
+                                                               num_functions__);
+    }
+
+    inline auto& sf_ws()
+    {
+        return sf_ws_;
+    }
+};
+
+/// Compute XC potential and energy density in the muffin-tin spheres of a batch of atoms.
+/** All atoms of the batch must share the radial grid, which is the case for the atoms of the same type. The batch
+ *  size is the size of exc__; rho__ and vxc__ hold num_mag_dims__ + 1 components of the first atom, followed by the
+ *  components of the second atom, etc. The spherical harmonic transformations are done for the whole batch. */
+void xc_mt(Radial_grid<double> const& rgrid__, SHT const& sht__, std::vector<XC_functional> const& xc_func__,
+           int num_mag_dims__, std::vector<Flm const*> const& rho__, std::vector<Flm*> const& vxc__,
+           std::vector<Flm*> const& exc__, Xc_mt_workspace& ws__);
+
+/// Compute XC potential and energy density in a muffin-tin sphere using a temporary workspace.
+void xc_mt(Radial_grid<double> const& rgrid__, SHT const& sht__, std::vector<XC_functional> const& xc_func__,
+        int num_mag_dims__, std::vector<Flm const*> rho__, std::vector<Flm*> vxc__, Flm* exc__);
+
+} // namespace sirius
+
+#endif
@@ -22,18 +22,118 @@
  *  \brief Implementation of various radial integrals.
  */
 
+#include <random>
 #include "radial_integrals.hpp"
+#include "linalg/linalg.hpp"
+#include "SDDK/hdf5_tree.hpp"
 
 namespace sirius {
 
+/// Compute the radial integrals of a set of functions with the spherical Bessel functions for all q-points.
+/** The integrals \f$ \int S[j_{\ell_i}(q x)](x) f_i(x) x^m dx \f$ are linear in the values of \f$ j_{\ell}(q x) \f$
+ *  on the radial grid with the integration weights of \f$ f_i(x) \f$ (see Spline::inner_weights()). The Bessel
+ *  functions are tabulated for a block of local q-points and the integrals of all functions with the same
+ *  \f$ \ell \f$ are computed as one matrix-matrix product of the table with the matrix of weights. The result is
+ *  identical to sirius::inner() of the splines up to the rounding errors.
+ *
+ *  \param [in] rgrid     Radial grid of the functions.
+ *  \param [in] grid_q    Grid of q-points.
+ *  \param [in] spl_q     Distribution of q-points between MPI ranks.
+ *  \param [in] comm      Communicator, which is used to gather the integrals of all q-points.
+ *  \param [in] l         Orbital quantum number of the Bessel function for each radial function.
+ *  \param [in] f         Pointers to the radial functions.
+ *  \param [in] m         Power of the \f$ x^m \f$ prefactor.
+ *  \param [in] jl_deriv  Use the derivatives of the Bessel functions with respect to q.
+ *  \return  Array of integrals with dimensions (number of functions, number of q-points).
+ */
+static sddk::mdarray<double, 2>
+integrals_with_jl(Radial_grid<double> const& rgrid__, Radial_grid<double> const& grid_q__,
+                  sddk::splindex<sddk::splindex_t::block> const& spl_q__, mpi::Communicator const& comm__,
+                  std::vector<int> const& l__, std::vector<Spline<double> const*> const& f__, int m__,
+                  bool jl_deriv__)
+{
+    PROFILE("sirius::Radial_integrals|jl_gemm");
+
+    int nf = static_cast<int>(f__.size());
+    int nr = rgrid__.num_points();
+    int nq = spl_q__.local_size();
+
+    sddk::mdarray<double, 2> result(nf, grid_q__.num_points());
+    result.zero();
+    if (nf == 0) {
+        return result;
+    }
+
+    int lmax = *std::max_element(l__.begin(), l__.end());
+
+    /* functions grouped by l */
+    std::vector<std::vector<int>> idx_l(lmax + 1);
+    for (int i = 0; i < nf; i++) {
+        idx_l[l__[i]].push_back(i);
+    }
+
+    /* integration weights w(ir, j) of the functions with a given l */
+    std::vector<sddk::mdarray<double, 2>> w(lmax + 1);
+    for (int l = 0; l <= lmax; l++) {
+        int n = static_cast<int>(idx_l[l].size());
+        if (n) {
+            w[l] = sddk::mdarray<double, 2>(nr, n);
+            #pragma omp parallel for
+            for (int j = 0; j < n; j++) {
+                auto v = f__[idx_l[l][j]]->inner_weights(m__, nr);
+                std::copy(v.begin(), v.end(), &w[l](0, j));
+            }
+        }
+    }
+
+    /* block of q-points for which the table of Bessel functions is stored */
+    int nqb = std::min(nq, 64);
+
+    sddk::mdarray<double, 3> jl(nr, std::max(nqb, 1), lmax + 1);
+    sddk::mdarray<double, 2> tmp(std::max(nqb, 1), nf);
+
+    for (int iq0 = 0; iq0 < nq; iq0 += nqb) {
+        int n = std::min(nqb, nq - iq0);
+
+        #pragma omp parallel
+        {
+            sddk::mdarray<double, 2> jl_q(nr, lmax + 1);
+            #pragma omp for
+            for (int iq = 0; iq < n; iq++) {
+                Spherical_Bessel_functions::tabulate(lmax, rgrid__, grid_q__[spl_q__[iq0 + iq]], jl_deriv__, jl_q);
+                for (int l = 0; l <= lmax; l++) {
+                    std::copy(&jl_q(0, l), &jl_q(0, l) + nr, &jl(0, iq, l));
+                }
+            }
+        }
+
+        for (int l = 0; l <= lmax; l++) {
+            int nfl = static_cast<int>(idx_l[l].size());
+            if (!nfl) {
+                continue;
+            }
+            /* tmp(iq, j) = sum_{ir} jl(ir, iq, l) * w(ir, j) */
+            la::wrap(la::lib_t::blas).gemm('T', 'N', n, nfl, nr, &la::constant<double>::one(), &jl(0, 0, l),
+                                           jl.ld(), &w[l](0, 0), w[l].ld(), &la::constant<double>::zero(),
+                                           &tmp(0, 0), tmp.ld());
+            for (int j = 0; j < nfl; j++) {
+                for (int iq = 0; iq < n; iq++) {
+                    result(idx_l[l][j], spl_q__[iq0 + iq]) = tmp(iq, j);
+                }
+            }
+        }
+    }
+    /* q-points of each rank are contiguous in the result, so a single packed exchange is enough */
+    comm__.allgather(&result(0, 0), nf * nq, nf * spl_q__.global_offset());
+
+    return result;
+}
+
 template <bool jl_deriv>
 void Radial_integrals_atomic_wf<jl_deriv>::generate(std::function<Spline<double> const&(int, int)> fl__)
 {
     PROFILE("sirius::Radial_integrals|atomic_wfs");
 
-    /* spherical Bessel functions jl(qx) */
-    sddk::mdarray<Spherical_Bessel_functions, 1> jl(nq());
-
     for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
 
         auto& atom_type = unit_cell_.atom_type(iat);
@@ -43,29 +143,22 @@ void Radial_integrals_atomic_wf<jl_deriv>::generate(std::function<Spline<double>
             continue;
         }
 
-        /* create jl(qx) */
-        #pragma omp parallel for
-        for (int iq = 0; iq < nq(); iq++) {
-            jl(iq) = Spherical_Bessel_functions(indexr_(iat).lmax(), atom_type.radial_grid(), grid_q_[iq]);
-        }
-
         /* loop over all pseudo wave-functions */
+        std::vector<int> l(nwf);
+        std::vector<Spline<double> const*> f(nwf);
         for (int i = 0; i < nwf; i++) {
-            values_(i, iat) = Spline<double>(grid_q_);
+            l[i] = indexr_(iat).am(i).l();
+            f[i] = &fl__(iat, i);
+        }
 
-            int l = indexr_(iat).am(i).l();
-            auto& rwf = fl__(iat, i);
+        auto v = integrals_with_jl(atom_type.radial_grid(), grid_q_, spl_q_, unit_cell_.comm(), l, f, 1, jl_deriv);
 
-            #pragma omp parallel for
+        #pragma omp parallel for
+        for (int i = 0; i < nwf; i++) {
+            values_(i, iat) = Spline<double>(grid_q_);
             for (int iq = 0; iq < nq(); iq++) {
-                if (jl_deriv) {
-                    auto s              = jl(iq).deriv_q(l);
-                    values_(i, iat)(iq) = sirius::inner(s, rwf, 1);
-                } else {
-                    values_(i, iat)(iq) = sirius::inner(jl(iq)[l], rwf, 1);
-                }
+                values_(i, iat)(iq) = v(i, iq);
             }
-
             values_(i, iat).interpolate();
         }
     }
@@ -89,6 +182,29 @@ void Radial_integrals_aug<jl_deriv>::generate()
         /* maximum l of beta-projectors */
         int lmax_beta = atom_type.indexr().lmax();
 
+        /* list of non-zero integrals */
+        std::vector<std::pair<int, int>> idx_l;
+        std::vector<int> l;
+        std::vector<Spline<double> const*> f;
+        for (int l3 = 0; l3 <= 2 * lmax_beta; l3++) {
+            for (int idxrf2 = 0; idxrf2 < nbrf; idxrf2++) {
+                int l2 = atom_type.indexr(idxrf2).l;
+                for (int idxrf1 = 0; idxrf1 <= idxrf2; idxrf1++) {
+                    int l1 = atom_type.indexr(idxrf1).l;
+
+                    int idx = idxrf2 * (idxrf2 + 1) / 2 + idxrf1;
+
+                    if (l3 >= std::abs(l1 - l2) && l3 <= (l1 + l2) && (l1 + l2 + l3) % 2 == 0) {
+                        idx_l.push_back(std::make_pair(idx, l3));
+                        l.push_back(l3);
+                        f.push_back(&atom_type.q_radial_function(idxrf1, idxrf2, l3));
+                    }
+                }
+            }
+        }
+
+        auto v = integrals_with_jl(atom_type.radial_grid(), grid_q_, spl_q_, unit_cell_.comm(), l, f, 0, jl_deriv);
+
         for (int l = 0; l <= 2 * lmax_beta; l++) {
             for (int idx = 0; idx < nbrf * (nbrf + 1) / 2; idx++) {
                 values_(idx, l, iat) = Spline<double>(grid_q_);
@@ -96,36 +212,10 @@ void Radial_integrals_aug<jl_deriv>::generate()
         }
 
         #pragma omp parallel for
-        for (int iq_loc = 0; iq_loc < spl_q_.local_size(); iq_loc++) {
-            int iq = spl_q_[iq_loc];
-
-            Spherical_Bessel_functions jl(2 * lmax_beta, atom_type.radial_grid(), grid_q_[iq]);
-
-            for (int l3 = 0; l3 <= 2 * lmax_beta; l3++) {
-                for (int idxrf2 = 0; idxrf2 < nbrf; idxrf2++) {
-                    int l2 = atom_type.indexr(idxrf2).l;
-                    for (int idxrf1 = 0; idxrf1 <= idxrf2; idxrf1++) {
-                        int l1 = atom_type.indexr(idxrf1).l;
-
-                        int idx = idxrf2 * (idxrf2 + 1) / 2 + idxrf1;
-
-                        if (l3 >= std::abs(l1 - l2) && l3 <= (l1 + l2) && (l1 + l2 + l3) % 2 == 0) {
-                            if (jl_deriv) {
-                                auto s = jl.deriv_q(l3);
-                                values_(idx, l3, iat)(iq) =
-                                    sirius::inner(s, atom_type.q_radial_function(idxrf1, idxrf2, l3), 0);
-                            } else {
-                                values_(idx, l3, iat)(iq) =
-                                    sirius::inner(jl[l3], atom_type.q_radial_function(idxrf1, idxrf2, l3), 0);
-                            }
-                        }
-                    }
-                }
-            }
-        }
-        for (int l = 0; l <= 2 * lmax_beta; l++) {
-            for (int idx = 0; idx < nbrf * (nbrf + 1) / 2; idx++) {
-                unit_cell_.comm().allgather(&values_(idx, l, iat)(0), spl_q_.local_size(), spl_q_.global_offset());
+        for (int i = 0; i < static_cast<int>(idx_l.size()); i++) {
+            auto& s = values_(idx_l[i].first, idx_l[i].second, iat);
+            for (int iq = 0; iq < nq(); iq++) {
+                s(iq) = v(i, iq);
             }
         }
 
@@ -211,29 +301,23 @@ void Radial_integrals_beta<jl_deriv>::generate()
             continue;
         }
 
+        /* compute \int j_l(q * r) beta_l(r) r^2 dr or \int d (j_l(q*r) / dq) beta_l(r) r^2  */
+        /* remember that beta(r) are defined as miltiplied by r */
+        std::vector<int> l(nrb);
+        std::vector<Spline<double> const*> f(nrb);
         for (int idxrf = 0; idxrf < nrb; idxrf++) {
-            values_(idxrf, iat) = Spline<double>(grid_q_);
+            l[idxrf] = atom_type.indexr(idxrf).l;
+            f[idxrf] = &atom_type.beta_radial_function(idxrf);
         }
 
-        #pragma omp parallel for
-        for (int iq_loc = 0; iq_loc < spl_q_.local_size(); iq_loc++) {
-            int iq = spl_q_[iq_loc];
-            Spherical_Bessel_functions jl(unit_cell_.lmax(), atom_type.radial_grid(), grid_q_[iq]);
-            for (int idxrf = 0; idxrf < nrb; idxrf++) {
-                int l  = atom_type.indexr(idxrf).l;
-                /* compute \int j_l(q * r) beta_l(r) r^2 dr or \int d (j_l(q*r) / dq) beta_l(r) r^2  */
-                /* remember that beta(r) are defined as miltiplied by r */
-                if (jl_deriv) {
-                    auto s  = jl.deriv_q(l);
-                    values_(idxrf, iat)(iq) = sirius::inner(s, atom_type.beta_radial_function(idxrf), 1);
-                } else {
-                    values_(idxrf, iat)(iq) = sirius::inner(jl[l], atom_type.beta_radial_function(idxrf), 1);
-                }
-            }
-        }
+        auto v = integrals_with_jl(atom_type.radial_grid(), grid_q_, spl_q_, unit_cell_.comm(), l, f, 1, jl_deriv);
 
+        #pragma omp parallel for
         for (int idxrf = 0; idxrf < nrb; idxrf++) {
-            unit_cell_.comm().allgather(&values_(idxrf, iat)(0), spl_q_.local_size(), spl_q_.global_offset());
+            values_(idxrf, iat) = Spline<double>(grid_q_);
+            for (int iq = 0; iq < nq(); iq++) {
+                values_(idxrf, iat)(iq) = v(idxrf, iq);
+            }
             values_(idxrf, iat).interpolate();
         }
     }
@@ -373,6 +457,117 @@ void Radial_integrals_rho_free_atom::generate()
     }
 }
 
+bool load_radial_integrals(std::string const& fname__, std::vector<uint8_t> const& key__,
+                           Radial_grid<double> const& grid_q__, mpi::Communicator const& comm__,
+                           Spline<double>* values__, int size__)
+{
+    PROFILE("sirius::load_radial_integrals");
+
+    int nq = grid_q__.num_points();
+
+    /* flags of the non-empty splines */
+    std::vector<int> flag(size__, 0);
+    /* values of the splines on the q-grid */
+    sddk::mdarray<double, 2> tab(nq, size__);
+
+    int found{0};
+    if (comm__.rank() == 0 && utils::file_exists(fname__)) {
+        sddk::HDF5_tree fin(fname__, sddk::hdf5_access_t::read_only);
+        if (fin.exists("version") && fin.exists("key") && fin.exists("dims") && fin.exists("grid_q") &&
+            fin.exists("flag") && fin.exists("values")) {
+            std::vector<int> version(1);
+            fin.read("version", version);
+            std::vector<uint8_t> key(key__.size());
+            fin.read("key", key);
+            std::vector<int> dims(2);
+            fin.read("dims", dims);
+            if (version[0] == radial_integrals_cache_version && key == key__ && dims[0] == nq && dims[1] == size__) {
+                std::vector<double> q(nq);
+                fin.read("grid_q", q);
+                found = 1;
+                for (int iq = 0; iq < nq; iq++) {
+                    if (q[iq] != grid_q__[iq]) {
+                        found = 0;
+                    }
+                }
+                if (found) {
+                    fin.read("flag", flag);
+                    fin.read("values", tab);
+                }
+            }
+        }
+    }
+    comm__.bcast(&found, 1, 0);
+    if (!found) {
+        return false;
+    }
+    comm__.bcast(flag.data(), size__, 0);
+    comm__.bcast(tab.at(sddk::memory_t::host), nq * size__, 0);
+
+    #pragma omp parallel for schedule(dynamic)
+    for (int i = 0; i < size__; i++) {
+        if (flag[i]) {
+            values__[i] = Spline<double>(grid_q__);
+            for (int iq = 0; iq < nq; iq++) {
+                values__[i](iq) = tab(iq, i);
+            }
+            values__[i].interpolate();
+        }
+    }
+    return true;
+}
+
+void save_radial_integrals(std::string const& fname__, std::vector<uint8_t> const& key__,
+                           Radial_grid<double> const& grid_q__, mpi::Communicator const& comm__,
+                           Spline<double> const* values__, int size__)
+{
+    PROFILE("sirius::save_radial_integrals");
+
+    if (comm__.rank() != 0) {
+        return;
+    }
+
+    int nq = grid_q__.num_points();
+
+    std::vector<int> flag(size__, 0);
+    sddk::mdarray<double, 2> tab(nq, size__);
+    tab.zero();
+    for (int i = 0; i < size__; i++) {
+        if (values__[i].num_points()) {
+            flag[i] = 1;
+            for (int iq = 0; iq < nq; iq++) {
+                tab(iq, i) = values__[i](iq);
+            }
+        }
+    }
+    std::vector<double> q(nq);
+    for (int iq = 0; iq < nq; iq++) {
+        q[iq] = grid_q__[iq];
+    }
+
+    /* the file is written under a temporary name and then renamed, so other jobs which share the cache never
+       read a partially written file */
+    std::stringstream s;
+    s << fname__ << ".tmp" << std::hex << std::random_device{}();
+    if (!std::ofstream(s.str()).is_open()) {
+        std::stringstream msg;
+        msg << "can't write to the cache of radial integrals" << std::endl
+            << "  file name : " << s.str();
+        WARNING(msg);
+        return;
+    }
+    {
+        sddk::HDF5_tree fout(s.str(), sddk::hdf5_access_t::truncate);
+        fout.write("version", std::vector<int>({radial_integrals_cache_version}));
+        fout.write("key", key__);
+        fout.write("dims", std::vector<int>({nq, size__}));
+        fout.write("grid_q", q);
+        fout.write("flag", flag);
+        fout.write("values", tab);
+    }
+    std::rename(s.str().c_str(), fname__.c_str());
+}
+
 template class Radial_integrals_atomic_wf<true>;
 template class Radial_integrals_atomic_wf<false>;
 
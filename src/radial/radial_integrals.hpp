@@ -31,6 +31,27 @@
 
 namespace sirius {
 
+/// Version of the format of the cache files of radial integrals.
+/** It is a part of the file name and of the key of the inputs; increase it if the layout of the file or the
+ *  definition of the stored integrals changes. */
+const int radial_integrals_cache_version = 2;
+
+/// Read the tables of radial integrals from the cache file.
+/** The file is read by the root rank and broadcast to all ranks of the communicator. The splines are interpolated
+ *  from the stored values on the q-grid. Return false if the file does not exist, has a different format version,
+ *  was computed for a different q-grid or a different number of integrals or if the stored key of the inputs is
+ *  not equal to key__. */
+bool load_radial_integrals(std::string const& fname__, std::vector<uint8_t> const& key__,
+                           Radial_grid<double> const& grid_q__, mpi::Communicator const& comm__,
+                           Spline<double>* values__, int size__);
+
+/// Store the tables of radial integrals in the cache file.
+/** Only the values on the q-grid are written, together with the format version and the key of the inputs. The file
+ *  is written by the root rank of the communicator. */
+void save_radial_integrals(std::string const& fname__, std::vector<uint8_t> const& key__,
+                           Radial_grid<double> const& grid_q__, mpi::Communicator const& comm__,
+                           Spline<double> const* values__, int size__);
+
 /// Base class for all kinds of radial integrals.
 template <int N>
 class Radial_integrals_base
@@ -51,6 +72,59 @@ class Radial_integrals_base
     /// Maximum length of the reciprocal wave-vector.
     double qmax_{0};
 
+    /// Update the hash with the points of a radial grid.
+    static utils::hash128 hash(Radial_grid<double> const& rgrid__, utils::hash128 h__)
+    {
+        return h__.update(rgrid__.x().at(sddk::memory_t::host), rgrid__.num_points() * sizeof(double));
+    }
+
+    /// Update the hash with the radial grid and coefficients of a spline.
+    static utils::hash128 hash(Spline<double> const& s__, utils::hash128 h__)
+    {
+        h__ = hash(static_cast<Radial_grid<double> const&>(s__), h__);
+        return h__.update(s__.coeffs().at(sddk::memory_t::host), s__.coeffs().size() * sizeof(double));
+    }
+
+    /// Update the hash with the values of a radial function.
+    static utils::hash128 hash(std::vector<double> const& v__, utils::hash128 h__)
+    {
+        return h__.update(v__.data(), v__.size() * sizeof(double));
+    }
+
+    /// Update the hash with an integer parameter.
+    static utils::hash128 hash(int v__, utils::hash128 h__)
+    {
+        return h__.update(&v__, sizeof(int));
+    }
+
+    /// Load the radial integrals from the on-disk cache or generate them.
+    /** If the cache directory is set in the input, the tables are looked up in the file with the name made of the
+     *  label, the format version and the 128-bit hash of the q-grid and of the input radial functions, which is
+     *  computed by hash__. The hash is also stored in the file and compared on load. If the file is not found or
+     *  doesn't match, the integrals are generated and stored in the cache. */
+    template <typename H, typename G>
+    void load_or_generate(std::string const& label__, H&& hash__, G&& generate__)
+    {
+        auto dir = unit_cell_.parameters().cfg().settings().ri_cache();
+        if (dir.empty() || values_.size() == 0) {
+            generate__();
+            return;
+        }
+        utils::hash128 h0;
+        h0.update(&radial_integrals_cache_version, sizeof(int)).update(label__.data(), label__.size());
+        auto h = hash__(hash(grid_q_, h0));
+
+        std::stringstream s;
+        s << dir << "/" << label__ << "_v" << radial_integrals_cache_version << "_" << h.str() << ".h5";
+
+        if (!load_radial_integrals(s.str(), h.digest(), grid_q_, unit_cell_.comm(),
+                                   values_.at(sddk::memory_t::host), static_cast<int>(values_.size()))) {
+            generate__();
+            save_radial_integrals(s.str(), h.digest(), grid_q_, unit_cell_.comm(),
+                                  values_.at(sddk::memory_t::host), static_cast<int>(values_.size()));
+        }
+    }
+
   public:
     /// Constructor.
     Radial_integrals_base(Unit_cell const& unit_cell__, double const qmax__, int const np__)
@@ -139,7 +213,18 @@ class Radial_integrals_atomic_wf : public Radial_integrals_base<2>
 
             values_ = sddk::mdarray<Spline<double>, 2>(nrf_max, unit_cell_.num_atom_types());
 
-            generate(fl__);
+            this->load_or_generate(jl_deriv ? "atomic_wf_djl" : "atomic_wf",
+                [&](utils::hash128 h)
+                {
+                    for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
+                        h = hash(static_cast<int>(indexr_(iat).size()), h);
+                        for (int i = 0; i < static_cast<int>(indexr_(iat).size()); i++) {
+                            h = hash(indexr_(iat).am(i).l(), hash(fl__(iat, i), h));
+                        }
+                    }
+                    return h;
+                },
+                [&]() { generate(fl__); });
         }
     }
 
@@ -191,7 +276,30 @@ class Radial_integrals_aug : public Radial_integrals_base<3>
             values_ =
                 sddk::mdarray<Spline<double>, 3>(nmax * (nmax + 1) / 2, 2 * lmax + 1, unit_cell_.num_atom_types());
 
-            generate();
+            this->load_or_generate(jl_deriv ? "aug_djl" : "aug",
+                [&](utils::hash128 h)
+                {
+                    for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
+                        auto& atom_type = unit_cell_.atom_type(iat);
+                        if (!atom_type.augment()) {
+                            continue;
+                        }
+                        int nbrf = atom_type.mt_radial_basis_size();
+                        h = hash(iat, hash(nbrf, h));
+                        for (int idxrf2 = 0; idxrf2 < nbrf; idxrf2++) {
+                            int l2 = atom_type.indexr(idxrf2).l;
+                            for (int idxrf1 = 0; idxrf1 <= idxrf2; idxrf1++) {
+                                int l1 = atom_type.indexr(idxrf1).l;
+                                h = hash(l1, hash(l2, h));
+                                for (int l3 = std::abs(l1 - l2); l3 <= l1 + l2; l3 += 2) {
+                                    h = hash(atom_type.q_radial_function(idxrf1, idxrf2, l3), h);
+                                }
+                            }
+                        }
+                    }
+                    return h;
+                },
+                [&]() { generate(); });
         }
     }
 
@@ -232,7 +340,17 @@ class Radial_integrals_rho_pseudo : public Radial_integrals_base<1>
     {
         if (ri_callback__ == nullptr) {
             values_ = sddk::mdarray<Spline<double>, 1>(unit_cell_.num_atom_types());
-            generate();
+            this->load_or_generate("rho_pseudo",
+                [&](utils::hash128 h)
+                {
+                    for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
+                        auto& atom_type = unit_cell_.atom_type(iat);
+                        h = hash(atom_type.ps_total_charge_density(), hash(atom_type.radial_grid(), h));
+                        h = hash(atom_type.num_mt_points(), h);
+                    }
+                    return h;
+                },
+                [&]() { generate(); });
 
             if (unit_cell_.parameters().cfg().control().print_checksum() && unit_cell_.comm().rank() == 0) {
                 double cs{0};
@@ -286,7 +404,17 @@ class Radial_integrals_rho_core_pseudo : public Radial_integrals_base<1>
     {
         if (ri_callback_ == nullptr) {
             values_ = sddk::mdarray<Spline<double>, 1>(unit_cell_.num_atom_types());
-            generate();
+            this->load_or_generate(jl_deriv ? "rho_core_pseudo_djl" : "rho_core_pseudo",
+                [&](utils::hash128 h)
+                {
+                    for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
+                        auto& atom_type = unit_cell_.atom_type(iat);
+                        h = hash(atom_type.ps_core_charge_density(), hash(atom_type.radial_grid(), h));
+                        h = hash(atom_type.num_mt_points(), h);
+                    }
+                    return h;
+                },
+                [&]() { generate(); });
         }
     }
 
@@ -335,7 +463,19 @@ class Radial_integrals_beta : public Radial_integrals_base<2>
         if (ri_callback_ == nullptr) {
             /* create space for <j_l(qr)|beta> or <d j_l(qr) / dq|beta> radial integrals */
             values_ = sddk::mdarray<Spline<double>, 2>(unit_cell_.max_mt_radial_basis_size(), unit_cell_.num_atom_types());
-            generate();
+            this->load_or_generate(jl_deriv ? "beta_djl" : "beta",
+                [&](utils::hash128 h)
+                {
+                    for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
+                        auto& atom_type = unit_cell_.atom_type(iat);
+                        h = hash(atom_type.num_beta_radial_functions(), h);
+                        for (int idxrf = 0; idxrf < atom_type.num_beta_radial_functions(); idxrf++) {
+                            h = hash(atom_type.indexr(idxrf).l, hash(atom_type.beta_radial_function(idxrf), h));
+                        }
+                    }
+                    return h;
+                },
+                [&]() { generate(); });
         }
     }
 
@@ -371,7 +511,17 @@ class Radial_integrals_vloc : public Radial_integrals_base<1>
     {
         if (ri_callback_ == nullptr) {
             values_ = sddk::mdarray<Spline<double>, 1>(unit_cell_.num_atom_types());
-            generate();
+            this->load_or_generate(jl_deriv ? "vloc_djl" : "vloc",
+                [&](utils::hash128 h)
+                {
+                    for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
+                        auto& atom_type = unit_cell_.atom_type(iat);
+                        h = hash(atom_type.local_potential(), hash(atom_type.radial_grid(), h));
+                        h = hash(atom_type.zn(), hash(atom_type.num_mt_points(), h));
+                    }
+                    return h;
+                },
+                [&]() { generate(); });
         }
     }
 
@@ -81,10 +81,57 @@ class Spline : public Radial_grid<U>
     Spline(Spline<T, U> const& src__) = delete;
     /* forbid assignment operator */
     Spline<T, U>& operator=(Spline<T, U> const& src__) = delete;
-    /// Solver tridiagonal system of linear equaitons.
-    int solve(T* dl, T* d, T* du, T* b, int n)
+    /// Init the underlying radial grid.
+    void init_grid(Radial_grid<U> const& radial_grid__)
+    {
+        /* copy the grid points */
+        this->x_ = sddk::mdarray<U, 1>(radial_grid__.num_points());
+        sddk::copy(radial_grid__.x(), this->x_);
+        this->init();
+    }
+
+  public:
+    /// Setup the tridiagonal matrix of the spline equations for the second derivatives \f$ m_i \f$.
+    /** The matrix includes the not-a-knot boundary conditions and depends only on the radial grid. The diagonals
+     *  must have room for the number of grid points. */
+    template <typename V>
+    static void setup_matrix(Radial_grid<U> const& grid__, V* dl__, V* d__, V* du__)
+    {
+        int ns = grid__.num_points();
+        assert(ns >= 4);
+
+        /* main diagonal */
+        for (int i = 0; i < ns - 2; i++) {
+            d__[i + 1] = static_cast<V>(grid__[i + 2] - grid__[i]) * 2.0;
+        }
+        /* subdiagonals */
+        for (int i = 0; i < ns - 1; i++) {
+            du__[i] = grid__.dx(i);
+            dl__[i] = grid__.dx(i);
+        }
+
+        /* last part of n-a-k boundary condition */
+        U h0    = grid__.dx(0);
+        U h1    = grid__.dx(1);
+        d__[0]  = h0 - (h1 / h0) * h1;
+        du__[0] = h1 * ((h1 / h0) + 1) + 2 * (h0 + h1);
+
+        h0           = grid__.dx(ns - 2);
+        h1           = grid__.dx(ns - 3);
+        d__[ns - 1]  = h0 - (h1 / h0) * h1;
+        dl__[ns - 2] = h1 * ((h1 / h0) + 1) + 2 * (h0 + h1);
+    }
+
+    /// Solve tridiagonal system of linear equations for several right-hand sides.
+    /** The right-hand sides are stored with the index of the equation running slowest: the \f$ j \f$-th component
+     *  of the \f$ i \f$-th equation is b[i * nrhs + j]. The matrix is overwritten. Return the index of the zero
+     *  pivot (counting from 1) or 0 on success. */
+    template <typename V>
+    static int solve(T* dl, T* d, T* du, V* b, int n, int nrhs)
     {
         for (int i = 0; i < n - 1; i++) {
+            V* b0 = b + static_cast<size_t>(i) * nrhs;
+            V* b1 = b0 + nrhs;
             if (std::abs(dl[i]) == 0) {
                 if (std::abs(d[i]) == 0) {
                     return i + 1;
@@ -92,7 +139,9 @@ class Spline : public Radial_grid<U>
             } else if (std::abs(d[i]) >= std::abs(dl[i])) {
                 T mult = dl[i] / d[i];
                 d[i + 1] -= mult * du[i];
-                b[i + 1] -= mult * b[i];
+                for (int j = 0; j < nrhs; j++) {
+                    b1[j] -= mult * b0[j];
+                }
                 if (i < n - 2) {
                     dl[i] = 0;
                 }
@@ -105,34 +154,40 @@ class Spline : public Radial_grid<U>
                     dl[i]     = du[i + 1];
                     du[i + 1] = -mult * dl[i];
                 }
-                du[i]    = tmp;
-                tmp      = b[i];
-                b[i]     = b[i + 1];
-                b[i + 1] = tmp - mult * b[i + 1];
+                du[i] = tmp;
+                for (int j = 0; j < nrhs; j++) {
+                    V t   = b0[j];
+                    b0[j] = b1[j];
+                    b1[j] = t - mult * b1[j];
+                }
             }
         }
         if (std::abs(d[n - 1]) == 0) {
             return n;
         }
-        b[n - 1] /= d[n - 1];
+        auto row = [&](int i) { return b + static_cast<size_t>(i) * nrhs; };
+        for (int j = 0; j < nrhs; j++) {
+            row(n - 1)[j] /= d[n - 1];
+        }
         if (n > 1) {
-            b[n - 2] = (b[n - 2] - du[n - 2] * b[n - 1]) / d[n - 2];
+            for (int j = 0; j < nrhs; j++) {
+                row(n - 2)[j] = (row(n - 2)[j] - du[n - 2] * row(n - 1)[j]) / d[n - 2];
+            }
         }
         for (int i = n - 3; i >= 0; i--) {
-            b[i] = (b[i] - du[i] * b[i + 1] - dl[i] * b[i + 2]) / d[i];
+            for (int j = 0; j < nrhs; j++) {
+                row(i)[j] = (row(i)[j] - du[i] * row(i + 1)[j] - dl[i] * row(i + 2)[j]) / d[i];
+            }
         }
         return 0;
     }
-    /// Init the underlying radial grid.
-    void init_grid(Radial_grid<U> const& radial_grid__)
+
+    /// Solve tridiagonal system of linear equations.
+    static int solve(T* dl, T* d, T* du, T* b, int n)
     {
-        /* copy the grid points */
-        this->x_ = sddk::mdarray<U, 1>(radial_grid__.num_points());
-        sddk::copy(radial_grid__.x(), this->x_);
-        this->init();
+        return solve<T>(dl, d, du, b, n, 1);
     }
 
-  public:
     /// Default constructor.
     Spline()
     {
@@ -299,26 +354,8 @@ class Spline : public Radial_grid<U>
         m[0]      = m[1];
         m[ns - 1] = m[ns - 2];
 
-        /* main diagonal of "A" matrix */
-        for (int i = 0; i < ns - 2; i++) {
-            d[i + 1] = static_cast<T>(this->x(i + 2) - this->x(i)) * 2.0;
-        }
-        /* subdiagonals of "A" matrix */
-        for (int i = 0; i < ns - 1; i++) {
-            du[i] = this->dx(i);
-            dl[i] = this->dx(i);
-        }
-
-        /* last part of n-a-k boundary condition */
-        U h0  = this->dx(0);
-        U h1  = this->dx(1);
-        d[0]  = h0 - (h1 / h0) * h1;
-        du[0] = h1 * ((h1 / h0) + 1) + 2 * (h0 + h1);
-
-        h0         = this->dx(ns - 2);
-        h1         = this->dx(ns - 3);
-        d[ns - 1]  = h0 - (h1 / h0) * h1;
-        dl[ns - 2] = h1 * ((h1 / h0) + 1) + 2 * (h0 + h1);
+        /* "A" matrix */
+        setup_matrix(*this, dl, d, du);
 
         ///* this should be boundary conditions for natural spline (with zero second derivatives at boundaries) */
         // m[0] = m[ns-1] = 0;
@@ -582,6 +619,90 @@ class Spline : public Radial_grid<U>
         return integrate(g, m__);
     }
 
+    /// Integration weights of the product with this spline.
+    /** Return the vector \f$ w_i \f$ such that for any values \f$ y_i \f$ on the same radial grid
+     *  \f[
+     *    \sum_i w_i y_i = \int_{x_0}^{x_{n-1}} S[y](x) g(x) x^m dx = {\rm inner}(S[y], g, m, n)
+     *  \f]
+     *  where \f$ S[y] \f$ is the cubic spline interpolating \f$ y_i \f$, \f$ g(x) \f$ is this spline and
+     *  \f$ n \f$ is num_points__. The integral is linear in \f$ y_i \f$ and the weights are obtained by
+     *  propagating the polynomial moments of \f$ g(x) x^m \f$ on each segment back through the spline
+     *  construction in interpolate() (its adjoint). This allows to evaluate many inner products with the same
+     *  function as one matrix-vector or matrix-matrix product, with the same result as sirius::inner().
+     */
+    std::vector<T> inner_weights(int m__, int num_points__) const
+    {
+        int ns = this->num_points();
+        assert(ns >= 4);
+        assert(num_points__ <= ns);
+        if (m__ < 0 || m__ > 2) {
+            throw std::runtime_error("wrong r^m prefactor");
+        }
+
+        /* adjoints of the values, derivatives and second derivatives */
+        std::vector<T> yb(ns, 0);
+        std::vector<T> dyb(ns - 1, 0);
+        std::vector<T> mb(ns, 0);
+
+        for (int i = 0; i < num_points__ - 1; i++) {
+            U x0 = this->x(i);
+            U h  = this->dx(i);
+            /* coefficients of (x0 + t)^m */
+            std::array<U, 3> cn{1, 0, 0};
+            if (m__ == 1) {
+                cn = {x0, 1, 0};
+            }
+            if (m__ == 2) {
+                cn = {x0 * x0, 2 * x0, 1};
+            }
+            /* moments mu_k = \int_0^h t^k g(x0 + t) (x0 + t)^m dt */
+            std::array<T, 4> mu{0, 0, 0, 0};
+            for (int k = 0; k < 4; k++) {
+                for (int p = 0; p < 4; p++) {
+                    for (int n = 0; n <= m__; n++) {
+                        int j = k + p + n + 1;
+                        mu[k] += coeffs_(i, p) * cn[n] * std::pow(h, j) / static_cast<double>(j);
+                    }
+                }
+            }
+            /* adjoint of the segment coefficients: a_i = y_i, b_i = y_i' - (c_i + t_i) h_i, c_i = m_i / 2,
+             * d_i = t_i / h_i with t_i = (m_{i+1} - m_i) / 6 */
+            yb[i] += mu[0];
+            dyb[i] += mu[1];
+            T cb = mu[2] - h * mu[1];
+            T tb = mu[3] / h - h * mu[1];
+            mb[i] += cb / 2.0;
+            mb[i + 1] += tb / 6.0;
+            mb[i] -= tb / 6.0;
+        }
+
+        /* adjoint of the tridiagonal solve: solve the transposed system */
+        std::vector<T> dl(ns), d(ns), du(ns);
+        setup_matrix(*this, &dl[0], &d[0], &du[0]);
+
+        /* sub- and super-diagonals are swapped for the transposed matrix */
+        int info = solve(&du[0], &d[0], &dl[0], &mb[0], ns);
+        if (info) {
+            std::stringstream s;
+            s << "[sirius::Spline::inner_weights] error in tridiagonal solver: " << info;
+            throw std::runtime_error(s.str());
+        }
+
+        /* adjoint of the n-a-k boundary condition and of the right-hand side 6 (y_{i+1}' - y_i') */
+        mb[1] += mb[0];
+        mb[ns - 2] += mb[ns - 1];
+        for (int i = 0; i < ns - 2; i++) {
+            dyb[i + 1] += mb[i + 1] * 6.0;
+            dyb[i] -= mb[i + 1] * 6.0;
+        }
+        /* adjoint of y_i' = (y_{i+1} - y_i) / h_i */
+        for (int i = 0; i < ns - 1; i++) {
+            yb[i + 1] += dyb[i] / this->dx(i);
+            yb[i] -= dyb[i] / this->dx(i);
+        }
+        return yb;
+    }
+
     inline void scale(double a__)
     {
         for (int i = 0; i < this->num_points(); i++) {
@@ -25,6 +25,9 @@
 #ifndef __GAUNT_HPP__
 #define __GAUNT_HPP__
 
+#include <complex>
+#include <functional>
+#include <numeric>
 #include "memory.hpp"
 #include "typedefs.hpp"
 #include "utils/utils.hpp"
@@ -49,9 +52,81 @@ struct gaunt_L1_L2
     T   coef;
 };
 
+/// Non-zero Gaunt coefficients for a fixed pair of lm1 and lm2 in the packed (CSR) storage.
+/** The row points to the contiguous chunks of lm3 indices and coefficients and provides the contraction kernels
+ *  with a vector indexed by lm3. Complex quantities are accumulated as separate real and imaginary parts, which
+ *  keeps the loops free of complex arithmetic and allows the compiler to vectorize them. */
+template <typename T>
+struct gaunt_L3_row
+{
+    /// Number of non-zero coefficients.
+    int size;
+    /// Indices of the inner spherical harmonic.
+    int const* lm3;
+    /// Values of the coefficients.
+    T const* coef;
+
+    /// Return \f$ \sum_{k} c_k v_{\ell_3 m_3(k)} \f$ for a real vector.
+    inline T dot(double const* v__) const
+    {
+        return dot_real(v__, T());
+    }
+
+    /// Return \f$ \sum_{k} c_k v_{\ell_3 m_3(k)} \f$ for a complex vector.
+    inline std::complex<double> dot(std::complex<double> const* v__) const
+    {
+        auto v = reinterpret_cast<double const*>(v__);
+        double sr{0};
+        double si{0};
+        for (int k = 0; k < size; k++) {
+            double vr = v[2 * lm3[k]];
+            double vi = v[2 * lm3[k] + 1];
+            sr += coef_re(k) * vr - coef_im(k) * vi;
+            si += coef_re(k) * vi + coef_im(k) * vr;
+        }
+        return std::complex<double>(sr, si);
+    }
+
+  private:
+    inline double dot_real(double const* v__, double) const
+    {
+        double sum{0};
+        for (int k = 0; k < size; k++) {
+            sum += coef_re(k) * v__[lm3[k]];
+        }
+        return sum;
+    }
+
+    inline std::complex<double> dot_real(double const* v__, std::complex<double>) const
+    {
+        double sr{0};
+        double si{0};
+        for (int k = 0; k < size; k++) {
+            double v = v__[lm3[k]];
+            sr += coef_re(k) * v;
+            si += coef_im(k) * v;
+        }
+        return std::complex<double>(sr, si);
+    }
+
+    inline double coef_re(int k__) const
+    {
+        return std::real(coef[k__]);
+    }
+
+    inline double coef_im(int k__) const
+    {
+        return std::imag(coef[k__]);
+    }
+};
+
 /// Compact storage of non-zero Gaunt coefficients \f$ \langle \ell_1 m_1 | \ell_3 m_3 | \ell_2 m_2 \rangle \f$.
 /** Very important! The following notation is adopted and used everywhere: lm1 and lm2 represent 'bra' and 'ket' 
  *  spherical harmonics of the Gaunt integral and lm3 represent the inner spherical harmonic. 
+ *
+ *  Both groupings of the coefficients are stored in the compressed sparse row format: one array of row offsets
+ *  and contiguous arrays of indices and values (structure of arrays). The {lm1, lm2} : {lm3} rows are ordered
+ *  with lm1 running fastest.
  */
 template <typename T>
 class Gaunt_coefficients
@@ -72,11 +147,31 @@ class Gaunt_coefficients
     /// lmmax of |lm2>
     int lmmax2_;
 
-    /// List of non-zero Gaunt coefficients for each lm3.
-    sddk::mdarray<std::vector<gaunt_L1_L2<T>>, 1> gaunt_packed_L1_L2_;
+    /// Offsets of the {lm1, lm2, coefficient} lists for each lm3 (lmmax3 + 1 elements).
+    std::vector<int> offset_L1_L2_;
+    /// Packed lm1 indices of the {lm1, lm2, coefficient} lists.
+    std::vector<int> lm1_;
+    /// Packed lm2 indices of the {lm1, lm2, coefficient} lists.
+    std::vector<int> lm2_;
+    /// Packed coefficients of the {lm1, lm2, coefficient} lists.
+    std::vector<T> coef_L1_L2_;
 
-    /// List of non-zero Gaunt coefficients for each combination of lm1, lm2.
-    sddk::mdarray<std::vector<gaunt_L3<T>>, 2> gaunt_packed_L3_;
+    /// Offsets of the {lm3, coefficient} lists for each combination of lm1, lm2 (lmmax1 * lmmax2 + 1 elements).
+    std::vector<int> offset_L3_;
+    /// Packed lm3 indices of the {lm3, coefficient} lists.
+    std::vector<int> lm3_;
+    /// Packed l3 indices of the {lm3, coefficient} lists.
+    std::vector<int> l3_;
+    /// Packed coefficients of the {lm3, coefficient} lists.
+    std::vector<T> coef_L3_;
+
+    /// Index of the {lm1, lm2} row.
+    inline int row_L3(int lm1__, int lm2__) const
+    {
+        assert(lm1__ >= 0 && lm1__ < lmmax1_);
+        assert(lm2__ >= 0 && lm2__ < lmmax2_);
+        return lm1__ + lm2__ * lmmax1_;
+    }
 
   public:
     /// Class constructor.
@@ -89,11 +184,18 @@ class Gaunt_coefficients
         lmmax3_ = utils::lmmax(lmax3_);
         lmmax2_ = utils::lmmax(lmax2_);
 
-        gaunt_packed_L1_L2_ = sddk::mdarray<std::vector<gaunt_L1_L2<T>>, 1>(lmmax3_);
-        gaunt_L1_L2<T> g12;
+        struct gaunt_entry
+        {
+            int lm1;
+            int lm2;
+            int lm3;
+            int l3;
+            T coef;
+        };
+        std::vector<gaunt_entry> entries;
 
-        gaunt_packed_L3_ = sddk::mdarray<std::vector<gaunt_L3<T>>, 2>(lmmax1_, lmmax2_);
-        gaunt_L3<T> g3;
+        offset_L1_L2_ = std::vector<int>(lmmax3_ + 1, 0);
+        offset_L3_    = std::vector<int>(lmmax1_ * lmmax2_ + 1, 0);
 
         for (int l1 = 0, lm1 = 0; l1 <= lmax1_; l1++) {
             for (int m1 = -l1; m1 <= l1; m1++, lm1++) {
@@ -104,15 +206,9 @@ class Gaunt_coefficients
 
                                 T gc = get__(l1, l3, l2, m1, m3, m2);
                                 if (std::abs(gc) > 1e-12) {
-                                    g12.lm1  = lm1;
-                                    g12.lm2  = lm2;
-                                    g12.coef = gc;
-                                    gaunt_packed_L1_L2_[lm3].push_back(g12);
-
-                                    g3.lm3  = lm3;
-                                    g3.l3   = l3;
-                                    g3.coef = gc;
-                                    gaunt_packed_L3_(lm1, lm2).push_back(g3);
+                                    entries.push_back({lm1, lm2, lm3, l3, gc});
+                                    offset_L1_L2_[lm3 + 1]++;
+                                    offset_L3_[row_L3(lm1, lm2) + 1]++;
                                 }
                             }
                         }
@@ -120,13 +216,38 @@ class Gaunt_coefficients
                 }
             }
         }
+        std::partial_sum(offset_L1_L2_.begin(), offset_L1_L2_.end(), offset_L1_L2_.begin());
+        std::partial_sum(offset_L3_.begin(), offset_L3_.end(), offset_L3_.begin());
+
+        int n = static_cast<int>(entries.size());
+        lm1_        = std::vector<int>(n);
+        lm2_        = std::vector<int>(n);
+        coef_L1_L2_ = std::vector<T>(n);
+        lm3_        = std::vector<int>(n);
+        l3_         = std::vector<int>(n);
+        coef_L3_    = std::vector<T>(n);
+
+        /* stable counting sort of the entries into both groupings */
+        std::vector<int> pos_L1_L2(offset_L1_L2_.begin(), offset_L1_L2_.end() - 1);
+        std::vector<int> pos_L3(offset_L3_.begin(), offset_L3_.end() - 1);
+        for (auto const& e : entries) {
+            int i          = pos_L1_L2[e.lm3]++;
+            lm1_[i]        = e.lm1;
+            lm2_[i]        = e.lm2;
+            coef_L1_L2_[i] = e.coef;
+
+            int j       = pos_L3[row_L3(e.lm1, e.lm2)]++;
+            lm3_[j]     = e.lm3;
+            l3_[j]      = e.l3;
+            coef_L3_[j] = e.coef;
+        }
     }
 
     /// Return number of non-zero Gaunt coefficients for a given lm3.
     inline int num_gaunt(int lm3) const
     {
         assert(lm3 >= 0 && lm3 < lmmax3_);
-        return static_cast<int>(gaunt_packed_L1_L2_[lm3].size());
+        return offset_L1_L2_[lm3 + 1] - offset_L1_L2_[lm3];
     }
 
     /// Return a structure containing {lm1, lm2, coef} for a given lm3 and index.
@@ -144,23 +265,35 @@ class Gaunt_coefficients
      *  }
      *  \endcode
      */
-    inline gaunt_L1_L2<T> const& gaunt(int lm3, int idx) const
+    inline gaunt_L1_L2<T> gaunt(int lm3, int idx) const
     {
         assert(lm3 >= 0 && lm3 < lmmax3_);
-        assert(idx >= 0 && idx < (int)gaunt_packed_L1_L2_[lm3].size());
-        return gaunt_packed_L1_L2_[lm3][idx];
+        assert(idx >= 0 && idx < num_gaunt(lm3));
+        int i = offset_L1_L2_[lm3] + idx;
+        return gaunt_L1_L2<T>{lm1_[i], lm2_[i], coef_L1_L2_[i]};
     }
 
     /// Return number of non-zero Gaunt coefficients for a combination of lm1 and lm2.
     inline int num_gaunt(int lm1, int lm2) const
     {
-        return static_cast<int>(gaunt_packed_L3_(lm1, lm2).size());
+        int r = row_L3(lm1, lm2);
+        return offset_L3_[r + 1] - offset_L3_[r];
     }
 
     /// Return a structure containing {lm3, coef} for a given lm1, lm2 and index
-    inline gaunt_L3<T> const& gaunt(int lm1, int lm2, int idx) const
+    inline gaunt_L3<T> gaunt(int lm1, int lm2, int idx) const
+    {
+        assert(idx >= 0 && idx < num_gaunt(lm1, lm2));
+        int i = offset_L3_[row_L3(lm1, lm2)] + idx;
+        return gaunt_L3<T>{lm3_[i], l3_[i], coef_L3_[i]};
+    }
+
+    /// Return the packed row of non-zero Gaunt coefficients for a given combination of lm1 and lm2.
+    inline gaunt_L3_row<T> gaunt_row(int lm1, int lm2) const
     {
-        return gaunt_packed_L3_(lm1, lm2)[idx];
+        int r = row_L3(lm1, lm2);
+        int i = offset_L3_[r];
+        return gaunt_L3_row<T>{offset_L3_[r + 1] - i, lm3_.data() + i, coef_L3_.data() + i};
     }
 
     /// Return a sum over L3 (lm3) index of Gaunt coefficients and a complex vector.
@@ -172,11 +305,7 @@ class Gaunt_coefficients
      */
     inline auto sum_L3_gaunt(int lm1, int lm2, std::complex<double> const* v) const
     {
-        std::complex<double> zsum(0, 0);
-        for (int k = 0; k < (int)gaunt_packed_L3_(lm1, lm2).size(); k++) {
-            zsum += gaunt_packed_L3_(lm1, lm2)[k].coef * v[gaunt_packed_L3_(lm1, lm2)[k].lm3];
-        }
-        return zsum;
+        return gaunt_row(lm1, lm2).dot(v);
     }
 
     /// Return a sum over L3 (lm3) index of Gaunt coefficients and a real vector.
@@ -188,17 +317,7 @@ class Gaunt_coefficients
      */
     inline T sum_L3_gaunt(int lm1, int lm2, double const* v) const
     {
-        T sum = 0;
-        for (int k = 0; k < (int)gaunt_packed_L3_(lm1, lm2).size(); k++) {
-            sum += gaunt_packed_L3_(lm1, lm2)[k].coef * v[gaunt_packed_L3_(lm1, lm2)[k].lm3];
-        }
-        return sum;
-    }
-
-    /// Return vector of non-zero Gaunt coefficients for a given combination of lm1 and lm2
-    inline std::vector<gaunt_L3<T>> const& gaunt_vector(int lm1, int lm2) const
-    {
-        return gaunt_packed_L3_(lm1, lm2);
+        return gaunt_row(lm1, lm2).dot(v);
     }
 
     /// Return the full tensor of Gaunt coefficients <R_{L1}|R_{L3}|R_{L2}> with a (L3, L1, L2) order of indices.
@@ -208,9 +327,9 @@ class Gaunt_coefficients
         gc.zero();
         for (int lm2 = 0; lm2 < lmmax2_; lm2++) {
             for (int lm1 = 0; lm1 < lmmax1_; lm1++) {
-                for (int k = 0; k < (int)gaunt_packed_L3_(lm1, lm2).size(); k++) {
-                    int lm3 = gaunt_packed_L3_(lm1, lm2)[k].lm3;
-                    gc(lm3, lm1, lm2) = gaunt_packed_L3_(lm1, lm2)[k].coef;
+                auto row = gaunt_row(lm1, lm2);
+                for (int k = 0; k < row.size; k++) {
+                    gc(row.lm3[k], lm1, lm2) = row.coef[k];
                 }
             }
         }
@@ -121,5 +121,28 @@ Spherical_Bessel_functions::deriv_q(int l__)
     return s;
 }
 
+void
+Spherical_Bessel_functions::tabulate(int lmax__, Radial_grid<double> const& rgrid__, double q__, bool deriv_q__,
+                                     sddk::mdarray<double, 2>& jl__)
+{
+    assert(q__ >= 0);
+    assert(static_cast<int>(jl__.size(0)) >= rgrid__.num_points());
+    assert(static_cast<int>(jl__.size(1)) >= lmax__ + 1);
+
+    std::vector<double> jl(lmax__ + 2);
+    for (int ir = 0; ir < rgrid__.num_points(); ir++) {
+        double x = rgrid__[ir];
+        custom_bessel(lmax__ + 1, x * q__, &jl[0]);
+        for (int l = 0; l <= lmax__; l++) {
+            if (!deriv_q__) {
+                jl__(ir, l) = jl[l];
+            } else if (q__ != 0) {
+                jl__(ir, l) = (l / q__) * jl[l] - x * jl[l + 1];
+            } else {
+                jl__(ir, l) = (l == 1) ? x / 3 : 0;
+            }
+        }
+    }
+}
 
 }  // sirius
@@ -59,6 +59,13 @@ class Spherical_Bessel_functions
      */
     Spline<double> deriv_q(int l__);
 
+    /// Tabulate the spherical Bessel functions or their derivatives with respect to q on a radial grid.
+    /** On output jl__(ir, l) contains \f$ j_{\ell}(q x_{ir}) \f$ (or \f$ \partial j_{\ell}(q x_{ir}) / \partial q \f$)
+     *  for \f$ \ell = 0...\ell_{max} \f$. These are the same values which are interpolated by the splines of
+     *  this class and by deriv_q(). */
+    static void tabulate(int lmax__, Radial_grid<double> const& rgrid__, double q__, bool deriv_q__,
+                         sddk::mdarray<double, 2>& jl__);
+
 };
 
 }; // namespace sirius
@@ -428,44 +428,36 @@ class Atom
      */
     template <spin_block_t sblock>
     inline std::complex<double>
-    radial_integrals_sum_L3(int idxrf1__, int idxrf2__, std::vector<gaunt_L3<std::complex<double>>> const& gnt__) const
+    radial_integrals_sum_L3(int idxrf1__, int idxrf2__, gaunt_L3_row<std::complex<double>> const& gnt__) const
     {
-        std::complex<double> zsum(0, 0);
+        /* radial integrals are stored with lm3 running fastest; contract the packed row of Gaunt coefficients with
+         * the contiguous slices of h and B integrals */
+        auto h = [&]() { return gnt__.dot(&h_radial_integrals_(0, idxrf1__, idxrf2__)); };
+        auto b = [&](int x) { return gnt__.dot(&b_radial_integrals_(0, idxrf1__, idxrf2__, x)); };
 
-        for (size_t i = 0; i < gnt__.size(); i++) {
-            switch (sblock) {
-                case spin_block_t::nm: {
-                    /* just the Hamiltonian */
-                    zsum += gnt__[i].coef * h_radial_integrals_(gnt__[i].lm3, idxrf1__, idxrf2__);
-                    break;
-                }
-                case spin_block_t::uu: {
-                    /* h + Bz */
-                    zsum += gnt__[i].coef * (h_radial_integrals_(gnt__[i].lm3, idxrf1__, idxrf2__) +
-                                             b_radial_integrals_(gnt__[i].lm3, idxrf1__, idxrf2__, 0));
-                    break;
-                }
-                case spin_block_t::dd: {
-                    /* h - Bz */
-                    zsum += gnt__[i].coef * (h_radial_integrals_(gnt__[i].lm3, idxrf1__, idxrf2__) -
-                                             b_radial_integrals_(gnt__[i].lm3, idxrf1__, idxrf2__, 0));
-                    break;
-                }
-                case spin_block_t::ud: {
-                    /* Bx - i By */
-                    zsum += gnt__[i].coef * std::complex<double>(b_radial_integrals_(gnt__[i].lm3, idxrf1__, idxrf2__, 1),
-                                                           -b_radial_integrals_(gnt__[i].lm3, idxrf1__, idxrf2__, 2));
-                    break;
-                }
-                case spin_block_t::du: {
-                    /* Bx + i By */
-                    zsum += gnt__[i].coef * std::complex<double>(b_radial_integrals_(gnt__[i].lm3, idxrf1__, idxrf2__, 1),
-                                                           b_radial_integrals_(gnt__[i].lm3, idxrf1__, idxrf2__, 2));
-                    break;
-                }
+        switch (sblock) {
+            case spin_block_t::nm: {
+                /* just the Hamiltonian */
+                return h();
+            }
+            case spin_block_t::uu: {
+                /* h + Bz */
+                return h() + b(0);
+            }
+            case spin_block_t::dd: {
+                /* h - Bz */
+                return h() - b(0);
+            }
+            case spin_block_t::ud: {
+                /* Bx - i By */
+                return b(1) - std::complex<double>(0, 1) * b(2);
+            }
+            case spin_block_t::du: {
+                /* Bx + i By */
+                return b(1) + std::complex<double>(0, 1) * b(2);
             }
         }
-        return zsum;
+        return std::complex<double>(0, 0);
     }
 
     inline int num_mt_points() const
@@ -39,8 +39,8 @@ Unit_cell::~Unit_cell() = default;
 std::vector<double>
 Unit_cell::find_mt_radii(int auto_rmt__, bool inflate__)
 {
-    if (nearest_neighbours_.size() == 0) {
-        RTE_THROW("array of nearest neighbours is empty");
+    if (static_cast<int>(closest_neighbour_.size()) != num_atoms()) {
+        RTE_THROW("closest neighbours are not computed");
     }
 
     std::vector<double> Rmt(num_atom_types(), 1e10);
@@ -48,11 +48,11 @@ Unit_cell::find_mt_radii(int auto_rmt__, bool inflate__)
     if (auto_rmt__ == 1) {
         for (int ia = 0; ia < num_atoms(); ia++) {
             int id1 = atom(ia).type_id();
-            if (nearest_neighbours_[ia].size() > 1) {
-                int ja  = nearest_neighbours_[ia][1].atom_id;
+            int ja  = closest_neighbour_[ia].atom_id;
+            if (ja >= 0) {
                 int id2 = atom(ja).type_id();
                 /* don't allow spheres to touch: take a smaller value than half a distance */
-                double R = std::min(parameters_.rmt_max(), 0.95 * nearest_neighbours_[ia][1].distance / 2);
+                double R = std::min(parameters_.rmt_max(), 0.95 * closest_neighbour_[ia].distance / 2);
                 /* take minimal R for the given atom type */
                 Rmt[id1] = std::min(R, Rmt[id1]);
                 Rmt[id2] = std::min(R, Rmt[id2]);
@@ -67,11 +67,11 @@ Unit_cell::find_mt_radii(int auto_rmt__, bool inflate__)
 
         for (int ia = 0; ia < num_atoms(); ia++) {
             int id1 = atom(ia).type_id();
-            if (nearest_neighbours_[ia].size() > 1) {
-                int ja  = nearest_neighbours_[ia][1].atom_id;
+            int ja  = closest_neighbour_[ia].atom_id;
+            if (ja >= 0) {
                 int id2 = atom(ja).type_id();
 
-                double d   = nearest_neighbours_[ia][1].distance;
+                double d   = closest_neighbour_[ia].distance;
                 double s   = 0.95 * d / (atom_type(id1).mt_radius() + atom_type(id2).mt_radius());
                 scale[id1] = std::min(s, scale[id1]);
                 scale[id2] = std::min(s, scale[id2]);
@@ -94,10 +94,10 @@ Unit_cell::find_mt_radii(int auto_rmt__, bool inflate__)
         for (int ia = 0; ia < num_atoms(); ia++) {
             int id1 = atom(ia).type_id();
 
-            if (nearest_neighbours_[ia].size() > 1) {
-                int ja      = nearest_neighbours_[ia][1].atom_id;
+            int ja = closest_neighbour_[ia].atom_id;
+            if (ja >= 0) {
                 int id2     = atom(ja).type_id();
-                double dist = nearest_neighbours_[ia][1].distance;
+                double dist = closest_neighbour_[ia].distance;
 
                 if (Rmt[id1] + Rmt[id2] > dist * 0.94) {
                     scale_Rmt[id1] = false;
@@ -110,16 +110,19 @@ Unit_cell::find_mt_radii(int auto_rmt__, bool inflate__)
 
         for (int ia = 0; ia < num_atoms(); ia++) {
             int id1 = atom(ia).type_id();
-            if (nearest_neighbours_[ia].size() > 1) {
-                int ja      = nearest_neighbours_[ia][1].atom_id;
+            int ja  = closest_neighbour_[ia].atom_id;
+            if (ja >= 0) {
                 int id2     = atom(ja).type_id();
-                double dist = nearest_neighbours_[ia][1].distance;
+                double dist = closest_neighbour_[ia].distance;
 
                 if (scale_Rmt[id1] && !scale_Rmt[id2]) {
-                    Rmt_infl[id1] = std::min(Rmt_infl[id1], std::min(parameters_.rmt_max(), 0.95 * (dist - Rmt[id2])));
+                    Rmt_infl[id1] = std::min(Rmt_infl[id1],
+                                             std::min(parameters_.rmt_max(), 0.95 * (dist - Rmt[id2])));
                 } else {
                     Rmt_infl[id1] = Rmt[id1];
                 }
+            } else {
+                Rmt_infl[id1] = std::min(Rmt_infl[id1], Rmt[id1]);
             }
         }
         for (int iat = 0; iat < num_atom_types(); iat++) {
@@ -142,20 +145,15 @@ Unit_cell::find_mt_radii(int auto_rmt__, bool inflate__)
 bool
 Unit_cell::check_mt_overlap(int& ia__, int& ja__)
 {
-    if (num_atoms() != 0 && nearest_neighbours_.size() == 0) {
-        RTE_THROW("array of nearest neighbours is empty");
+    if (static_cast<int>(closest_neighbour_.size()) != num_atoms()) {
+        RTE_THROW("closest neighbours are not computed");
     }
 
     for (int ia = 0; ia < num_atoms(); ia++) {
-        /* first atom is always the central one itself */
-        if (nearest_neighbours_[ia].size() <= 1) {
-            continue;
-        }
+        int ja      = closest_neighbour_[ia].atom_id;
+        double dist = closest_neighbour_[ia].distance;
 
-        int ja      = nearest_neighbours_[ia][1].atom_id;
-        double dist = nearest_neighbours_[ia][1].distance;
-
-        if (atom(ia).mt_radius() + atom(ja).mt_radius() >= dist) {
+        if (ja >= 0 && atom(ia).mt_radius() + atom(ja).mt_radius() >= dist) {
             ia__ = ia;
             ja__ = ja;
             return true;
@@ -400,23 +398,48 @@ Unit_cell::serialize(bool cart_pos__) const
     return dict;
 }
 
+/// Order neighbours by distance; ties are resolved by translation and atom index.
+/** This is the order in which the direct search visits the neighbours, so both search methods
+ *  produce identical lists. */
+static bool
+compare_nearest_neighbours(nearest_neighbour_descriptor const& a__, nearest_neighbour_descriptor const& b__)
+{
+    if (a__.distance != b__.distance) {
+        return a__.distance < b__.distance;
+    }
+    if (a__.translation != b__.translation) {
+        return a__.translation < b__.translation;
+    }
+    return a__.atom_id < b__.atom_id;
+}
+
 void
 Unit_cell::find_nearest_neighbours(double cluster_radius)
 {
     PROFILE("sirius::Unit_cell::find_nearest_neighbours");
 
-    auto max_frac_coord = find_translations(cluster_radius, lattice_vectors_);
-
     nearest_neighbours_.clear();
     nearest_neighbours_.resize(num_atoms());
 
+    if (parameters_.cfg().settings().nn_search() == "direct") {
+        find_nearest_neighbours_direct(cluster_radius);
+    } else {
+        find_nearest_neighbours_cell_list(cluster_radius);
+    }
+}
+
+void
+Unit_cell::find_nearest_neighbours_direct(double cluster_radius__)
+{
+    PROFILE("sirius::Unit_cell::find_nearest_neighbours_direct");
+
+    auto max_frac_coord = r3::find_translations(cluster_radius__, lattice_vectors_);
+
     #pragma omp parallel for default(shared)
     for (int ia = 0; ia < num_atoms(); ia++) {
 
         std::vector<nearest_neighbour_descriptor> nn;
 
-        std::vector<std::pair<double, int>> nn_sort;
-
         for (int i0 = -max_frac_coord[0]; i0 <= max_frac_coord[0]; i0++) {
             for (int i1 = -max_frac_coord[1]; i1 <= max_frac_coord[1]; i1++) {
                 for (int i2 = -max_frac_coord[2]; i2 <= max_frac_coord[2]; i2++) {
@@ -433,21 +456,217 @@ Unit_cell::find_nearest_neighbours(double cluster_radius)
                         nnd.rc = rc;
                         nnd.distance = rc.length();
 
-                        if (nnd.distance <= cluster_radius) {
+                        if (nnd.distance <= cluster_radius__) {
                             nn.push_back(nnd);
+                        }
+                    }
+                }
+            }
+        }
+
+        std::sort(nn.begin(), nn.end(), compare_nearest_neighbours);
+        nearest_neighbours_[ia] = std::move(nn);
+    }
+}
+
+/// Linked-cell list of atoms of the unit cell.
+/** Atoms are binned in a regular grid of cells in fractional coordinates. For each atom only the cells (and their
+ *  periodic images) that overlap with the box circumscribing the search sphere are visited. */
+class Atom_cell_list
+{
+  private:
+    Unit_cell const& uc_;
+    /// Distance between the opposite faces of the unit cell.
+    r3::vector<double> width_;
+    /// Number of cells along each lattice direction.
+    r3::vector<int> num_cells_;
+    /// Position of the atom inside the unit cell.
+    std::vector<r3::vector<double>> pos_red_;
+    /// Translation that brings the reduced position back to the original position of the atom.
+    std::vector<r3::vector<int>> pos_shift_;
+    /// Offset of the list of atoms of each cell.
+    std::vector<int> cell_offset_;
+    /// Packed list of atoms of all cells.
+    std::vector<int> cell_atoms_;
+
+    inline int cell_index(int i0__, int i1__, int i2__) const
+    {
+        return (i0__ * num_cells_[1] + i1__) * num_cells_[2] + i2__;
+    }
+
+  public:
+    Atom_cell_list(Unit_cell const& uc__)
+        : uc_(uc__)
+    {
+        int na = uc_.num_atoms();
+
+        /* a sphere of radius R spans 2 * R / width[x] of the unit cell along the x-th lattice direction */
+        for (int x : {0, 1, 2}) {
+            width_[x] = uc_.omega() /
+                        cross(uc_.lattice_vector((x + 1) % 3), uc_.lattice_vector((x + 2) % 3)).length();
+        }
+
+        /* choose the cell size such that there is roughly one atom per cell */
+        double cell_size = std::pow(uc_.omega() / na, 1.0 / 3);
+        for (int x : {0, 1, 2}) {
+            num_cells_[x] = std::max(1, static_cast<int>(width_[x] / cell_size));
+        }
+
+        pos_red_.resize(na);
+        pos_shift_.resize(na);
+        /* index of the cell for each atom */
+        std::vector<int> atom_cell(na);
+
+        for (int ia = 0; ia < na; ia++) {
+            auto const& pos = uc_.atom(ia).position();
+            r3::vector<int> ic;
+            for (int x : {0, 1, 2}) {
+                pos_shift_[ia][x] = static_cast<int>(std::floor(pos[x]));
+                pos_red_[ia][x]   = pos[x] - pos_shift_[ia][x];
+                ic[x] = std::min(num_cells_[x] - 1, static_cast<int>(pos_red_[ia][x] * num_cells_[x]));
+            }
+            atom_cell[ia] = cell_index(ic[0], ic[1], ic[2]);
+        }
+
+        /* list of atoms in each cell stored in compressed form */
+        int ncell    = num_cells_[0] * num_cells_[1] * num_cells_[2];
+        cell_offset_ = std::vector<int>(ncell + 1, 0);
+        for (int ia = 0; ia < na; ia++) {
+            cell_offset_[atom_cell[ia] + 1]++;
+        }
+        for (int i = 0; i < ncell; i++) {
+            cell_offset_[i + 1] += cell_offset_[i];
+        }
+        cell_atoms_.resize(na);
+        auto pos = cell_offset_;
+        for (int ia = 0; ia < na; ia++) {
+            cell_atoms_[pos[atom_cell[ia]]++] = ia;
+        }
+    }
+
+    /// Average distance between atoms, which is also the size of the cell.
+    inline double cell_size() const
+    {
+        return std::pow(uc_.omega() / uc_.num_atoms(), 1.0 / 3);
+    }
 
-                            nn_sort.push_back(std::pair<double, int>(nnd.distance, (int)nn.size() - 1));
+    /// Call a function for each neighbour (including the atom itself) inside the sphere of a given radius.
+    template <typename F>
+    void for_each_neighbour(int ia__, double R__, F&& f__) const
+    {
+        /* range of cells (including the periodic images) overlapping with the search box */
+        r3::vector<int> cmin, cmax;
+        for (int x : {0, 1, 2}) {
+            double box = R__ / width_[x];
+            cmin[x]    = static_cast<int>(std::floor((pos_red_[ia__][x] - box) * num_cells_[x]));
+            cmax[x]    = static_cast<int>(std::floor((pos_red_[ia__][x] + box) * num_cells_[x]));
+        }
+
+        for (int c0 = cmin[0]; c0 <= cmax[0]; c0++) {
+            for (int c1 = cmin[1]; c1 <= cmax[1]; c1++) {
+                for (int c2 = cmin[2]; c2 <= cmax[2]; c2++) {
+                    r3::vector<int> c(c0, c1, c2);
+                    /* cell inside the unit cell and the lattice translation of its image */
+                    r3::vector<int> ic, T;
+                    for (int x : {0, 1, 2}) {
+                        ic[x] = ((c[x] % num_cells_[x]) + num_cells_[x]) % num_cells_[x];
+                        T[x]  = (c[x] - ic[x]) / num_cells_[x];
+                    }
+                    int i = cell_index(ic[0], ic[1], ic[2]);
+                    for (int j = cell_offset_[i]; j < cell_offset_[i + 1]; j++) {
+                        int ja = cell_atoms_[j];
+
+                        nearest_neighbour_descriptor nnd;
+                        for (int x : {0, 1, 2}) {
+                            nnd.translation[x] = T[x] - pos_shift_[ja][x] + pos_shift_[ia__][x];
+                        }
+                        auto v1 = uc_.atom(ja).position() + r3::vector<int>(nnd.translation) -
+                                  uc_.atom(ia__).position();
+                        auto rc = uc_.get_cartesian_coordinates(v1);
+
+                        nnd.atom_id  = ja;
+                        nnd.rc       = rc;
+                        nnd.distance = rc.length();
+
+                        if (nnd.distance <= R__) {
+                            f__(nnd);
                         }
                     }
                 }
             }
         }
+    }
+};
+
+void
+Unit_cell::find_nearest_neighbours_cell_list(double cluster_radius__)
+{
+    PROFILE("sirius::Unit_cell::find_nearest_neighbours_cell_list");
+
+    if (num_atoms() == 0) {
+        return;
+    }
+
+    Atom_cell_list cl(*this);
+
+    #pragma omp parallel for default(shared)
+    for (int ia = 0; ia < num_atoms(); ia++) {
+
+        std::vector<nearest_neighbour_descriptor> nn;
+
+        cl.for_each_neighbour(ia, cluster_radius__, [&nn](nearest_neighbour_descriptor const& nnd) {
+            nn.push_back(nnd);
+        });
 
-        std::sort(nn_sort.begin(), nn_sort.end());
-        nearest_neighbours_[ia].resize(nn.size());
-        for (int i = 0; i < (int)nn.size(); i++) {
-            nearest_neighbours_[ia][i] = nn[nn_sort[i].second];
+        std::sort(nn.begin(), nn.end(), compare_nearest_neighbours);
+        nearest_neighbours_[ia] = std::move(nn);
+    }
+}
+
+void
+Unit_cell::find_closest_neighbours()
+{
+    PROFILE("sirius::Unit_cell::find_closest_neighbours");
+
+    closest_neighbour_.resize(num_atoms());
+
+    if (num_atoms() == 0) {
+        return;
+    }
+
+    Atom_cell_list cl(*this);
+
+    /* the periodic image of the atom itself is always a candidate, so the search radius is bounded
+     * by the length of the longest lattice vector; an explicit parameters.nn_radius limits it further */
+    double rmax{0};
+    for (int x : {0, 1, 2}) {
+        rmax = std::max(rmax, lattice_vector(x).length());
+    }
+    if (parameters_.cfg().parameters().nn_radius() >= 0) {
+        rmax = std::min(rmax, parameters_.cfg().parameters().nn_radius());
+    }
+
+    #pragma omp parallel for schedule(dynamic) default(shared)
+    for (int ia = 0; ia < num_atoms(); ia++) {
+        bool found{false};
+        nearest_neighbour_descriptor nn;
+        /* no neighbour inside the search radius */
+        nn.atom_id  = -1;
+        nn.distance = 0;
+        /* start from a sphere containing a few atoms on average and grow it until a neighbour is found */
+        for (double R = std::min(1.5 * cl.cell_size(), rmax);; R = std::min(2 * R, rmax)) {
+            cl.for_each_neighbour(ia, R, [&](nearest_neighbour_descriptor const& nnd) {
+                bool self = (nnd.atom_id == ia) && (nnd.translation == std::array<int, 3>({0, 0, 0}));
+                if (!self && (!found || compare_nearest_neighbours(nnd, nn))) {
+                    nn    = nnd;
+                    found = true;
+                }
+            });
+            if (found || R >= rmax) {
+                break;
+            }
         }
+        closest_neighbour_[ia] = nn;
     }
 }
 
@@ -460,6 +679,9 @@ Unit_cell::print_nearest_neighbours(std::ostream& out__) const
         out__ << "Central atom: " << atom(ia).type().symbol() << "(" << ia << ")" << std::endl
               << utils::hbar(80, '-') << std::endl;
         out__ << "atom (ia)        D [a.u.]        T                     r_local" << std::endl;
+        if (ia >= static_cast<int>(nearest_neighbours_.size())) {
+            continue;
+        }
         for (int i = 0; i < (int)nearest_neighbours_[ia].size(); i++) {
             int ja = nearest_neighbours_[ia][i].atom_id;
             auto ja_symbol = atom(ja).type().symbol();
@@ -651,9 +873,9 @@ Unit_cell::min_bond_length() const
 {
     double len{1e10};
 
-    for (int ia = 0; ia < num_atoms(); ia++) {
-        if (nearest_neighbours_[ia].size() > 1) {
-            len = std::min(len, nearest_neighbours_[ia][1].distance);
+    for (int ia = 0; ia < static_cast<int>(closest_neighbour_.size()); ia++) {
+        if (closest_neighbour_[ia].atom_id >= 0) {
+            len = std::min(len, closest_neighbour_[ia].distance);
         }
     }
     return len;
@@ -851,19 +1073,17 @@ Unit_cell::update()
 {
     PROFILE("sirius::Unit_cell::update");
 
-    auto v0 = lattice_vector(0);
-    auto v1 = lattice_vector(1);
-    auto v2 = lattice_vector(2);
+    /* MT radii, overlap check and minimum bond length only need the closest neighbour of each atom */
+    find_closest_neighbours();
 
-    double r{0};
-    if (parameters_.cfg().parameters().nn_radius() < 0) {
-        r = std::max(v0.length(), std::max(v1.length(), v2.length()));
+    /* the full list of neighbours is built here only if its radius is set explicitly; the real-space part
+     * of the Ewald summation needs a much smaller list, which is built by Simulation_context::update() */
+    if (parameters_.cfg().parameters().nn_radius() >= 0) {
+        find_nearest_neighbours(parameters_.cfg().parameters().nn_radius());
     } else {
-        r = parameters_.cfg().parameters().nn_radius();
+        nearest_neighbours_.clear();
     }
 
-    find_nearest_neighbours(r);
-
     if (parameters_.full_potential()) {
         /* find new MT radii and initialize radial grid */
         if (parameters_.auto_rmt()) {
@@ -883,7 +1103,7 @@ Unit_cell::update()
               << " and " << ja << "(" << atom(ja).type().symbol() << ")" << std::endl
               << "  radius of atom " << ia << " : " << atom(ia).mt_radius() << std::endl
               << "  radius of atom " << ja << " : " << atom(ja).mt_radius() << std::endl
-              << "  distance : " << nearest_neighbours_[ia][1].distance << " " << nearest_neighbours_[ja][1].distance;
+              << "  distance : " << closest_neighbour_[ia].distance << " " << closest_neighbour_[ja].distance;
             RTE_THROW(s);
         }
 
@@ -147,6 +147,9 @@ class Unit_cell
     /// List of nearest neighbours for each atom.
     std::vector<std::vector<nearest_neighbour_descriptor>> nearest_neighbours_;
 
+    /// Closest neighbour of each atom, excluding the atom itself but including its periodic images.
+    std::vector<nearest_neighbour_descriptor> closest_neighbour_;
+
     /// Minimum muffin-tin radius.
     double min_mt_radius_{0};
 
@@ -165,6 +168,15 @@ class Unit_cell
     /// Check if MT spheres overlap
     inline bool check_mt_overlap(int& ia__, int& ja__);
 
+    /// Find nearest neighbours by checking all atoms in all translations of the bounding supercell.
+    void find_nearest_neighbours_direct(double cluster_radius__);
+
+    /// Find nearest neighbours using a linked-cell list.
+    /** Atoms are binned in a regular grid of cells in fractional coordinates. For each atom only the cells
+     *  (and their periodic images) that overlap with the box circumscribing the search sphere are visited.
+     *  The cost scales linearly with the number of atoms for a fixed cluster radius. */
+    void find_nearest_neighbours_cell_list(double cluster_radius__);
+
     int next_atom_type_id(std::string label__);
 
   public:
@@ -256,8 +268,16 @@ class Unit_cell
     void set_lattice_vectors(r3::vector<double> a0__, r3::vector<double> a1__, r3::vector<double> a2__);
 
     /// Find the cluster of nearest neighbours around each atom
+    /** The list of neighbours of each atom is sorted by distance; the atom itself is always the first element.
+     *  The search algorithm is selected by the settings.nn_search input parameter. */
     void find_nearest_neighbours(double cluster_radius);
 
+    /// Find the closest neighbour of each atom.
+    /** The linked-cell list is searched in a sphere that starts at the average interatomic distance and grows
+     *  only for the atoms without a neighbour inside it. This is much cheaper than building the full list of
+     *  neighbours and is sufficient to determine the muffin-tin radii and to check the overlap of spheres. */
+    void find_closest_neighbours();
+
     bool is_point_in_mt(r3::vector<double> vc, int& ja, int& jr, double& dr, double tp[2]) const;
 
     void generate_radial_functions(std::ostream& out__);
@@ -547,6 +567,12 @@ class Unit_cell
         return nearest_neighbours_[ia][i];
     }
 
+    /// Return the closest neighbour of the atom.
+    inline auto const& closest_neighbour(int ia) const
+    {
+        return closest_neighbour_[ia];
+    }
+
     inline auto const& symmetry() const
     {
         RTE_ASSERT(symmetry_ != nullptr);
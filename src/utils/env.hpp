@@ -112,6 +112,18 @@ get_ev_solver()
     }
 }
 
+/// Return the type of the memory pool ("first_fit" or "size_class").
+inline std::string
+get_memory_pool_type()
+{
+    auto val = get_value_ptr<std::string>("SIRIUS_MEMORY_POOL");
+    if (val) {
+        return *val;
+    } else {
+        return "first_fit";
+    }
+}
+
 inline int
 get_verbosity()
 {
@@ -31,6 +31,7 @@
 #include <apex_api.hpp>
 #endif
 #include "rt_graph.hpp"
+#include "SDDK/omp.hpp"
 #if defined(SIRIUS_GPU) && defined(SIRIUS_CUDA_NVTX)
 #include "nvtx_profiler.hpp"
 #endif
@@ -43,6 +44,25 @@ extern ::rt_graph::Timer global_rtgraph_timer;
 extern ::nvtxprofiler::Timer global_nvtx_timer;
 #endif
 
+/// Return the timer of the calling thread.
+/** The main thread team records into the global timer. All threads of the concurrent k-point teams, including
+ *  the workers of the parallel regions nested inside a team, use private thread-local timers. Their timings are
+ *  discarded: a timer left over from a finished run_in_thread_teams() call is cleared the next time its thread
+ *  asks for it, so the memory of the worker timers is bounded by a single team run. */
+inline ::rt_graph::Timer& rtgraph_timer()
+{
+    if (sddk::thread_team_id() == 0) {
+        return global_rtgraph_timer;
+    }
+    static thread_local ::rt_graph::Timer timer(1024);
+    static thread_local int generation{0};
+    if (generation != sddk::thread_team_generation()) {
+        timer.clear(0);
+        generation = sddk::thread_team_generation();
+    }
+    return timer;
+}
+
 // TODO: add calls to apex and cudaNvtx
 
 #if defined(SIRIUS_PROFILE)
@@ -52,20 +72,20 @@ extern ::nvtxprofiler::Timer global_nvtx_timer;
 #if defined(SIRIUS_CUDA_NVTX)
     #define PROFILE(identifier) \
         ::nvtxprofiler::ScopedTiming PROFILER_CONCAT(GeneratedScopedTimer, __COUNTER__)(identifier, ::utils::global_nvtx_timer); \
-        ::rt_graph::ScopedTiming PROFILER_CONCAT(GeneratedScopedTimer, __COUNTER__)(identifier, ::utils::global_rtgraph_timer);
+        ::rt_graph::ScopedTiming PROFILER_CONCAT(GeneratedScopedTimer, __COUNTER__)(identifier, ::utils::rtgraph_timer());
     #define PROFILE_START(identifier) \
         ::utils::global_nvtx_timer.start(identifier); \
-        ::utils::global_rtgraph_timer.start(identifier);
+        ::utils::rtgraph_timer().start(identifier);
     #define PROFILE_STOP(identifier) \
-        ::utils::global_rtgraph_timer.stop(identifier); \
+        ::utils::rtgraph_timer().stop(identifier); \
         ::utils::global_nvtx_timer.stop(identifier);
 #else
     #define PROFILE(identifier) \
-        ::rt_graph::ScopedTiming PROFILER_CONCAT(GeneratedScopedTimer, __COUNTER__)(identifier, ::utils::global_rtgraph_timer);
+        ::rt_graph::ScopedTiming PROFILER_CONCAT(GeneratedScopedTimer, __COUNTER__)(identifier, ::utils::rtgraph_timer());
     #define PROFILE_START(identifier) \
-        ::utils::global_rtgraph_timer.start(identifier);
+        ::utils::rtgraph_timer().start(identifier);
     #define PROFILE_STOP(identifier) \
-        ::utils::global_rtgraph_timer.stop(identifier);
+        ::utils::rtgraph_timer().stop(identifier);
 #endif
 
 #else
@@ -293,6 +293,56 @@ inline uint64_t hash(void const* buff, size_t size, uint64_t h = 5381)
     return h;
 }
 
+/// 128-bit FNV-1a hash.
+/** Used to identify the data which is shared between independent runs (e.g. the files of the on-disk caches), where
+ *  the collisions of the simple 64-bit hash() are not acceptable. Example:
+ *  \code{.cpp}
+ *  auto key = utils::hash128().update(buff, size).str();
+ *  \endcode
+ */
+class hash128
+{
+  private:
+    /// High and low 64-bit words of the hash value.
+    uint64_t hi_{0x6c62272e07bb0142ULL};
+    uint64_t lo_{0x62b821756295c58dULL};
+
+  public:
+    /// Update the hash with the bytes of a buffer.
+    inline hash128& update(void const* buff__, size_t size__)
+    {
+        unsigned char const* p = static_cast<unsigned char const*>(buff__);
+        for (size_t i = 0; i < size__; i++) {
+            lo_ ^= p[i];
+            /* multiply by the FNV prime 2^88 + 0x13B modulo 2^128 */
+            uint64_t c  = ((lo_ >> 32) * 0x13B + (((lo_ & 0xFFFFFFFFULL) * 0x13B) >> 32)) >> 32;
+            uint64_t hi = hi_ * 0x13B + c + (lo_ << 24);
+            lo_ *= 0x13B;
+            hi_ = hi;
+        }
+        return *this;
+    }
+
+    /// Return the 16 bytes of the hash value, most significant first.
+    inline std::vector<uint8_t> digest() const
+    {
+        std::vector<uint8_t> d(16);
+        for (int i = 0; i < 8; i++) {
+            d[i]     = static_cast<uint8_t>(hi_ >> (56 - 8 * i));
+            d[i + 8] = static_cast<uint8_t>(lo_ >> (56 - 8 * i));
+        }
+        return d;
+    }
+
+    /// Return the hash value as a string of 32 hexadecimal digits.
+    inline std::string str() const
+    {
+        std::stringstream s;
+        s << std::hex << std::setfill('0') << std::setw(16) << hi_ << std::setw(16) << lo_;
+        return s.str();
+    }
+};
+
 /// Simple pseudo-random generator.
 inline uint32_t rand()
 {